@@ -4,6 +4,7 @@
 
 #include "frc/apriltag/AprilTagDetector.h"
 
+#include <algorithm>
 #include <cmath>
 #include <numbers>
 
@@ -27,19 +28,68 @@
 
 using namespace frc;
 
-AprilTagDetector::Results::Results(void* impl, const private_init&)
-    : span{reinterpret_cast<AprilTagDetection**>(
-               static_cast<zarray_t*>(impl)->data),
-           static_cast<size_t>(static_cast<zarray_t*>(impl)->size)},
-      m_impl{impl} {}
+namespace {
+// Moves a detection made in a sub-image into full image coordinates.
+void OffsetDetection(apriltag_detection_t* det, double dx, double dy) {
+  det->c[0] += dx;
+  det->c[1] += dy;
+  for (auto& p : det->p) {
+    p[0] += dx;
+    p[1] += dy;
+  }
+  // the homography output is homogeneous, so offset by a multiple of w
+  for (int col = 0; col < 3; ++col) {
+    MATD_EL(det->H, 0, col) += dx * MATD_EL(det->H, 2, col);
+    MATD_EL(det->H, 1, col) += dy * MATD_EL(det->H, 2, col);
+  }
+}
+
+// Destroys the detections in an array, leaving it empty for reuse.
+void ClearDetections(zarray_t* detections) {
+  for (int i = 0; i < zarray_size(detections); ++i) {
+    apriltag_detection_t* det;
+    zarray_get(detections, i, &det);
+    apriltag_detection_destroy(det);
+  }
+  zarray_clear(detections);
+}
+
+// Appends the detections in from to to, offset by (dx, dy), and destroys
+// from.  The detections are then owned by to.
+void MoveDetections(zarray_t* from, zarray_t* to, double dx = 0,
+                    double dy = 0) {
+  for (int i = 0; i < zarray_size(from); ++i) {
+    apriltag_detection_t* det;
+    zarray_get(from, i, &det);
+    if (dx != 0 || dy != 0) {
+      OffsetDetection(det, dx, dy);
+    }
+    zarray_add(to, &det);
+  }
+  zarray_destroy(from);
+}
+}  // namespace
+
+AprilTagDetector::Results::Results(void* impl, const private_init&) {
+  Reset(impl);
+}
 
 AprilTagDetector::Results& AprilTagDetector::Results::operator=(Results&& rhs) {
   Destroy();
+  span::operator=(rhs);
   m_impl = rhs.m_impl;
   rhs.m_impl = nullptr;
   return *this;
 }
 
+void AprilTagDetector::Results::Reset(void* impl) {
+  auto detections = static_cast<zarray_t*>(impl);
+  span::operator=(
+      span{reinterpret_cast<AprilTagDetection**>(detections->data),
+           static_cast<size_t>(detections->size)});
+  m_impl = impl;
+}
+
 void AprilTagDetector::Results::Destroy() {
   if (m_impl) {
     apriltag_detections_destroy(static_cast<zarray_t*>(m_impl));
@@ -55,6 +105,9 @@ AprilTagDetector& AprilTagDetector::operator=(AprilTagDetector&& rhs) {
   m_families = std::move(rhs.m_families);
   rhs.m_families.clear();
   m_qtpCriticalAngle = rhs.m_qtpCriticalAngle;
+  m_tracking = rhs.m_tracking;
+  m_tracks = std::move(rhs.m_tracks);
+  m_framesSinceSearch = rhs.m_framesSinceSearch;
   return *this;
 }
 
@@ -107,6 +160,16 @@ AprilTagDetector::GetQuadThresholdParameters() const {
   };
 }
 
+void AprilTagDetector::SetTrackingConfig(const TrackingConfig& config) {
+  m_tracking = config;
+  ResetTracking();
+}
+
+void AprilTagDetector::ResetTracking() {
+  m_tracks.clear();
+  m_framesSinceSearch = 0;
+}
+
 bool AprilTagDetector::AddFamily(std::string_view fam, int bitsCorrected) {
   auto& data = m_families[fam];
   if (data) {
@@ -159,10 +222,127 @@ void AprilTagDetector::ClearFamilies() {
 
 AprilTagDetector::Results AprilTagDetector::Detect(int width, int height,
                                                    int stride, uint8_t* buf) {
+  Results results;
+  Detect(width, height, stride, buf, &results);
+  return results;
+}
+
+void AprilTagDetector::Detect(int width, int height, int stride, uint8_t* buf,
+                              Results* results) {
+  auto storage = static_cast<zarray_t*>(results->m_impl);
+  if (storage) {
+    ClearDetections(storage);
+  } else {
+    storage = zarray_create(sizeof(apriltag_detection_t*));
+  }
+  if (m_tracking.enabled && !m_tracks.empty() &&
+      m_framesSinceSearch < m_tracking.fullFrameInterval) {
+    if (DetectTracked(width, height, stride, buf, storage)) {
+      ++m_framesSinceSearch;
+      UpdateTracks(storage);
+      results->Reset(storage);
+      return;
+    }
+    // a track was lost; fall back to searching the full frame
+  }
+
   image_u8_t img{width, height, stride, buf};
-  return {
-      apriltag_detector_detect(static_cast<apriltag_detector_t*>(m_impl), &img),
-      Results::private_init{}};
+  MoveDetections(apriltag_detector_detect(
+                     static_cast<apriltag_detector_t*>(m_impl), &img),
+                 storage);
+  if (m_tracking.enabled) {
+    m_framesSinceSearch = 1;
+    UpdateTracks(storage);
+  }
+  results->Reset(storage);
+}
+
+bool AprilTagDetector::DetectTracked(int width, int height, int stride,
+                                     uint8_t* buf, void* detections) {
+  auto impl = static_cast<apriltag_detector_t*>(m_impl);
+  auto dets = static_cast<zarray_t*>(detections);
+  auto overlaps = [](const Roi& a, const Roi& b) {
+    return a.x0 < b.x1 && b.x0 < a.x1 && a.y0 < b.y1 && b.y0 < a.y1;
+  };
+
+  // padded search regions around the last known positions; overlapping
+  // regions are merged so a tag is never found twice
+  auto& rois = m_rois;
+  rois.clear();
+  for (auto&& track : m_tracks) {
+    double padX = std::max((track.maxX - track.minX) * m_tracking.roiPadding,
+                           static_cast<double>(m_tracking.minRoiPadding));
+    double padY = std::max((track.maxY - track.minY) * m_tracking.roiPadding,
+                           static_cast<double>(m_tracking.minRoiPadding));
+    Roi roi{std::max(static_cast<int>(track.minX - padX), 0),
+            std::max(static_cast<int>(track.minY - padY), 0),
+            std::min(static_cast<int>(std::ceil(track.maxX + padX)), width),
+            std::min(static_cast<int>(std::ceil(track.maxY + padY)), height)};
+    if (roi.x0 >= roi.x1 || roi.y0 >= roi.y1) {
+      return false;  // tag left the image
+    }
+    rois.push_back(roi);
+  }
+  for (bool merged = true; merged;) {
+    merged = false;
+    for (size_t i = 0; i < rois.size() && !merged; ++i) {
+      for (size_t j = i + 1; j < rois.size(); ++j) {
+        if (overlaps(rois[i], rois[j])) {
+          rois[i].x0 = std::min(rois[i].x0, rois[j].x0);
+          rois[i].y0 = std::min(rois[i].y0, rois[j].y0);
+          rois[i].x1 = std::max(rois[i].x1, rois[j].x1);
+          rois[i].y1 = std::max(rois[i].y1, rois[j].y1);
+          rois.erase(rois.begin() + j);
+          merged = true;
+          break;
+        }
+      }
+    }
+  }
+
+  // the regions are small, so search them at full resolution
+  float quadDecimate = impl->quad_decimate;
+  impl->quad_decimate = 1.0f;
+  for (auto&& roi : rois) {
+    image_u8_t img{roi.x1 - roi.x0, roi.y1 - roi.y0, stride,
+                   buf + roi.y0 * stride + roi.x0};
+    MoveDetections(apriltag_detector_detect(impl, &img), dets, roi.x0,
+                   roi.y0);
+  }
+  impl->quad_decimate = quadDecimate;
+
+  // every track must be found again
+  for (auto&& track : m_tracks) {
+    bool found = false;
+    for (int i = 0; i < zarray_size(dets) && !found; ++i) {
+      apriltag_detection_t* det;
+      zarray_get(dets, i, &det);
+      found = det->family == track.family && det->id == track.id;
+    }
+    if (!found) {
+      ClearDetections(dets);
+      return false;
+    }
+  }
+  return true;
+}
+
+void AprilTagDetector::UpdateTracks(void* detections) {
+  auto dets = static_cast<zarray_t*>(detections);
+  m_tracks.clear();
+  for (int i = 0; i < zarray_size(dets); ++i) {
+    apriltag_detection_t* det;
+    zarray_get(dets, i, &det);
+    Track track{det->family, det->id, det->p[0][0], det->p[0][1],
+                det->p[0][0], det->p[0][1]};
+    for (auto& p : det->p) {
+      track.minX = std::min(track.minX, p[0]);
+      track.minY = std::min(track.minY, p[1]);
+      track.maxX = std::max(track.maxX, p[0]);
+      track.maxY = std::max(track.maxY, p[1]);
+    }
+    m_tracks.push_back(track);
+  }
 }
 
 void AprilTagDetector::Destroy() {
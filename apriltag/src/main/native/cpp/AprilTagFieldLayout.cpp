@@ -4,7 +4,11 @@
 
 #include "frc/apriltag/AprilTagFieldLayout.h"
 
+#include <algorithm>
+#include <cmath>
+#include <string>
 #include <system_error>
+#include <utility>
 
 #include <units/angle.h>
 #include <units/length.h>
@@ -14,6 +18,161 @@
 
 using namespace frc;
 
+namespace {
+// Builds a layout directly from JSON parser events
+class LayoutSaxParser : public wpi::json::json_sax_t {
+ public:
+  bool null() override { return true; }
+  bool boolean(bool) override { return true; }
+  bool number_integer(number_integer_t val) override { return Number(val); }
+  bool number_unsigned(number_unsigned_t val) override { return Number(val); }
+  bool number_float(number_float_t val, const string_t&) override {
+    return Number(val);
+  }
+  bool string(string_t&) override { return true; }
+  bool binary(binary_t&) override { return true; }
+  bool start_object(size_t) override { return Push(); }
+  bool key(string_t& val) override;
+  bool end_object() override;
+  bool start_array(size_t) override { return Push(); }
+  bool end_array() override {
+    m_key = kOther;
+    --m_depth;
+    return true;
+  }
+  bool parse_error(size_t, const std::string& msg,
+                   const wpi::detail::exception&) override {
+    error = msg;
+    return false;
+  }
+
+  std::vector<AprilTag> tags;
+  double fieldLength = 0;
+  double fieldWidth = 0;
+  int fieldMask = 0;
+  std::string error;
+
+ private:
+  enum Key {
+    kOther,
+    kTags,
+    kField,
+    kId,
+    kPose,
+    kTranslation,
+    kRotation,
+    kQuaternion,
+    kLength,
+    kWidth,
+    kX,
+    kY,
+    kZ,
+    kQW,
+    kQX,
+    kQY,
+    kQZ
+  };
+  static constexpr int kMaxDepth = 8;
+
+  bool Push() {
+    if (m_depth >= kMaxDepth) {
+      error = "layout nested too deeply";
+      return false;
+    }
+    m_containers[m_depth++] = m_key;
+    m_key = kOther;
+    return true;
+  }
+  // key of the container at the given level up (0 is the innermost)
+  Key Container(int up) const {
+    return m_depth > up ? m_containers[m_depth - 1 - up] : kOther;
+  }
+  bool InTag() const { return m_depth == 3 && Container(1) == kTags; }
+  bool Number(double val);
+
+  Key m_containers[kMaxDepth];
+  int m_depth = 0;
+  Key m_key = kOther;
+
+  // tag being parsed, and which of its values have been seen
+  int m_id = 0;
+  double m_values[7];  // x, y, z, W, X, Y, Z
+  int m_mask = 0;
+};
+}  // namespace
+
+bool LayoutSaxParser::key(string_t& val) {
+  static constexpr std::pair<std::string_view, Key> kKeys[] = {
+      {"tags", kTags},
+      {"field", kField},
+      {"ID", kId},
+      {"pose", kPose},
+      {"translation", kTranslation},
+      {"rotation", kRotation},
+      {"quaternion", kQuaternion},
+      {"length", kLength},
+      {"width", kWidth},
+      {"x", kX},
+      {"y", kY},
+      {"z", kZ},
+      {"W", kQW},
+      {"X", kQX},
+      {"Y", kQY},
+      {"Z", kQZ}};
+  m_key = kOther;
+  for (auto&& [name, key] : kKeys) {
+    if (val == name) {
+      m_key = key;
+      break;
+    }
+  }
+  return true;
+}
+
+bool LayoutSaxParser::Number(double val) {
+  if (InTag() && m_key == kId) {
+    m_id = static_cast<int>(val);
+    m_mask |= 1 << 7;
+  } else if (m_depth == 5 && Container(0) == kTranslation &&
+             Container(1) == kPose && m_key >= kX && m_key <= kZ) {
+    m_values[m_key - kX] = val;
+    m_mask |= 1 << (m_key - kX);
+  } else if (m_depth == 6 && Container(0) == kQuaternion &&
+             Container(1) == kRotation && m_key >= kQW && m_key <= kQZ) {
+    m_values[3 + m_key - kQW] = val;
+    m_mask |= 1 << (3 + m_key - kQW);
+  } else if (m_depth == 2 && Container(0) == kField) {
+    if (m_key == kLength) {
+      fieldLength = val;
+      fieldMask |= 1;
+    } else if (m_key == kWidth) {
+      fieldWidth = val;
+      fieldMask |= 2;
+    }
+  }
+  m_key = kOther;
+  return true;
+}
+
+bool LayoutSaxParser::end_object() {
+  if (InTag()) {
+    if (m_mask != 0xff) {
+      error = "tag is missing ID or pose values";
+      return false;
+    }
+    tags.emplace_back(AprilTag{
+        m_id, Pose3d{Translation3d{units::meter_t{m_values[0]},
+                                   units::meter_t{m_values[1]},
+                                   units::meter_t{m_values[2]}},
+                     Rotation3d{Quaternion{m_values[3], m_values[4],
+                                           m_values[5], m_values[6]}}}});
+    m_mask = 0;
+  }
+  m_key = kOther;
+  --m_depth;
+  return true;
+}
+
 AprilTagFieldLayout::AprilTagFieldLayout(std::string_view path) {
   std::error_code ec;
   std::unique_ptr<wpi::MemoryBuffer> fileBuffer =
@@ -22,13 +181,8 @@ AprilTagFieldLayout::AprilTagFieldLayout(std::string_view path) {
     throw std::runtime_error(fmt::format("Cannot open file: {}", path));
   }
 
-  wpi::json json = wpi::json::parse(fileBuffer->GetCharBuffer());
-
-  for (const auto& tag : json.at("tags").get<std::vector<AprilTag>>()) {
-    m_apriltags[tag.ID] = tag;
-  }
-  m_fieldWidth = units::meter_t{json.at("field").at("width").get<double>()};
-  m_fieldLength = units::meter_t{json.at("field").at("length").get<double>()};
+  auto contents = fileBuffer->GetCharBuffer();
+  *this = Parse({contents.data(), contents.size()});
 }
 
 AprilTagFieldLayout::AprilTagFieldLayout(std::vector<AprilTag> apriltags,
@@ -39,6 +193,21 @@ AprilTagFieldLayout::AprilTagFieldLayout(std::vector<AprilTag> apriltags,
   for (const auto& tag : apriltags) {
     m_apriltags[tag.ID] = tag;
   }
+  UpdateCache();
+}
+
+AprilTagFieldLayout AprilTagFieldLayout::Parse(std::string_view json) {
+  LayoutSaxParser parser;
+  if (!wpi::json::sax_parse(json, &parser)) {
+    throw std::runtime_error(
+        fmt::format("Cannot parse AprilTag layout: {}", parser.error));
+  }
+  if (parser.fieldMask != 3) {
+    throw std::runtime_error(
+        "Cannot parse AprilTag layout: missing field length or width");
+  }
+  return {std::move(parser.tags), units::meter_t{parser.fieldLength},
+          units::meter_t{parser.fieldWidth}};
 }
 
 units::meter_t AprilTagFieldLayout::GetFieldLength() const {
@@ -74,6 +243,7 @@ void AprilTagFieldLayout::SetOrigin(OriginPosition origin) {
 
 void AprilTagFieldLayout::SetOrigin(const Pose3d& origin) {
   m_origin = origin;
+  UpdateCache();
 }
 
 Pose3d AprilTagFieldLayout::GetOrigin() const {
@@ -81,11 +251,97 @@ Pose3d AprilTagFieldLayout::GetOrigin() const {
 }
 
 std::optional<frc::Pose3d> AprilTagFieldLayout::GetTagPose(int ID) const {
-  const auto& it = m_apriltags.find(ID);
-  if (it == m_apriltags.end()) {
-    return std::nullopt;
+  if (auto tag = FindCachedTag(ID)) {
+    return tag->pose;
+  }
+  return std::nullopt;
+}
+
+void AprilTagFieldLayout::SetTagSize(units::meter_t tagSize) {
+  m_tagSize = tagSize;
+  UpdateCache();
+}
+
+std::optional<std::array<Translation3d, 4>>
+AprilTagFieldLayout::GetTagCorners(int ID) const {
+  if (auto tag = FindCachedTag(ID)) {
+    return tag->corners;
+  }
+  return std::nullopt;
+}
+
+std::vector<int> AprilTagFieldLayout::GetVisibleTags(
+    const Pose3d& cameraPose, units::radian_t horizontalFov,
+    units::radian_t verticalFov, units::meter_t maxDistance) const {
+  double tanHorizontal = std::tan(horizontalFov.value() / 2);
+  double tanVertical = std::tan(verticalFov.value() / 2);
+  Rotation3d toCamera = -cameraPose.Rotation();
+
+  std::vector<std::pair<double, int>> candidates;
+  for (auto&& tag : m_cache) {
+    auto offset = cameraPose.Translation() - tag.pose.Translation();
+    double distance = offset.Norm().value();
+    if (distance > maxDistance.value()) {
+      continue;
+    }
+    // the tag faces along its X axis
+    auto facing = Translation3d{1_m, 0_m, 0_m}.RotateBy(tag.pose.Rotation());
+    if (facing.X().value() * offset.X().value() +
+            facing.Y().value() * offset.Y().value() +
+            facing.Z().value() * offset.Z().value() <=
+        0) {
+      continue;
+    }
+    for (auto&& corner : tag.corners) {
+      auto p = (corner - cameraPose.Translation()).RotateBy(toCamera);
+      double x = p.X().value();
+      if (x > 0 && std::abs(p.Y().value()) <= x * tanHorizontal &&
+          std::abs(p.Z().value()) <= x * tanVertical) {
+        candidates.emplace_back(distance, tag.ID);
+        break;
+      }
+    }
+  }
+  std::sort(candidates.begin(), candidates.end());
+
+  std::vector<int> ids;
+  ids.reserve(candidates.size());
+  for (auto&& candidate : candidates) {
+    ids.push_back(candidate.second);
+  }
+  return ids;
+}
+
+void AprilTagFieldLayout::UpdateCache() {
+  m_cache.clear();
+  m_cache.reserve(m_apriltags.size());
+  auto half = m_tagSize / 2;
+  // same order as the detector reports corners when facing the tag
+  const Translation3d offsets[4] = {{0_m, -half, -half},
+                                    {0_m, half, -half},
+                                    {0_m, half, half},
+                                    {0_m, -half, half}};
+  for (auto&& [id, tag] : m_apriltags) {
+    auto& cached =
+        m_cache.emplace_back(CachedTag{id, tag.pose.RelativeTo(m_origin), {}});
+    for (int i = 0; i < 4; ++i) {
+      cached.corners[i] = cached.pose.Translation() +
+                          offsets[i].RotateBy(cached.pose.Rotation());
+    }
+  }
+  std::sort(m_cache.begin(), m_cache.end(),
+            [](const auto& a, const auto& b) { return a.ID < b.ID; });
+}
+
+const AprilTagFieldLayout::CachedTag* AprilTagFieldLayout::FindCachedTag(
+    int ID) const {
+  auto it = std::lower_bound(
+      m_cache.begin(), m_cache.end(), ID,
+      [](const CachedTag& tag, int id) { return tag.ID < id; });
+  if (it == m_cache.end() || it->ID != ID) {
+    return nullptr;
   }
-  return it->second.pose.RelativeTo(m_origin);
+  return &*it;
 }
 
 void AprilTagFieldLayout::Serialize(std::string_view path) {
@@ -124,4 +380,5 @@ void frc::from_json(const wpi::json& json, AprilTagFieldLayout& layout) {
       units::meter_t{json.at("field").at("length").get<double>()};
   layout.m_fieldWidth =
       units::meter_t{json.at("field").at("width").get<double>()};
+  layout.UpdateCache();
 }
@@ -4,8 +4,6 @@
 
 #include "frc/apriltag/AprilTagFields.h"
 
-#include <wpi/json.h>
-
 namespace frc {
 
 // C++ generated from resource files
@@ -25,8 +23,7 @@ AprilTagFieldLayout LoadAprilTagLayoutField(AprilTagField field) {
       throw std::invalid_argument("Invalid Field");
   }
 
-  wpi::json json = wpi::json::parse(fieldString);
-  return json.get<AprilTagFieldLayout>();
+  return AprilTagFieldLayout::Parse(fieldString);
 }
 
 }  // namespace frc
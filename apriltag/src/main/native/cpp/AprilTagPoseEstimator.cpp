@@ -4,9 +4,17 @@
 
 #include "frc/apriltag/AprilTagPoseEstimator.h"
 
+#include <array>
+#include <cmath>
+#include <limits>
+#include <optional>
+
+#include <Eigen/Cholesky>
+#include <Eigen/LU>
 #include <Eigen/QR>
 
 #include "frc/apriltag/AprilTagDetection.h"
+#include "frc/apriltag/AprilTagFieldLayout.h"
 
 #ifdef _WIN32
 #pragma warning(disable : 4200)
@@ -152,3 +160,259 @@ Transform3d AprilTagPoseEstimator::Estimate(
   matd_destroy(detection.H);
   return rv;
 }
+
+namespace {
+// Corresponding field and image points of all the tags in a multi-tag solve
+struct MultiTagPoints {
+  std::array<Eigen::Vector3d, 4 * AprilTagPoseEstimator::kMaxMultiTags> field;
+  std::array<Eigen::Vector2d, 4 * AprilTagPoseEstimator::kMaxMultiTags> image;
+  int numPoints = 0;
+  int numTags = 0;
+};
+}  // namespace
+
+// Maps camera vectors from WPILib axes (X forward, Y left, Z up) to the
+// detector's camera axes (X right, Y down, Z forward)
+static const Eigen::Matrix3d kNwuToEdn{{0, -1, 0}, {0, 0, -1}, {1, 0, 0}};
+
+// Maps tag vectors from WPILib axes (X out of the tag face, Y left, Z up when
+// facing the tag from behind) to the detector's tag axes (X right, Y down,
+// Z into the tag when facing it)
+static const Eigen::Matrix3d kTagNwuToDetector{
+    {0, 1, 0}, {0, 0, -1}, {-1, 0, 0}};
+
+static Eigen::Matrix3d ToMatrix(const Rotation3d& rotation) {
+  const auto& q = rotation.GetQuaternion();
+  double w = q.W();
+  double x = q.X();
+  double y = q.Y();
+  double z = q.Z();
+  return Eigen::Matrix3d{
+      {1 - 2 * (y * y + z * z), 2 * (x * y - z * w), 2 * (x * z + y * w)},
+      {2 * (x * y + z * w), 1 - 2 * (x * x + z * z), 2 * (y * z - x * w)},
+      {2 * (x * z - y * w), 2 * (y * z + x * w), 1 - 2 * (x * x + y * y)}};
+}
+
+static Eigen::Vector3d ToVector(const Translation3d& translation) {
+  return {translation.X().value(), translation.Y().value(),
+          translation.Z().value()};
+}
+
+static Eigen::Matrix3d Skew(const Eigen::Vector3d& v) {
+  return Eigen::Matrix3d{{0, -v.z(), v.y()}, {v.z(), 0, -v.x()},
+                         {-v.y(), v.x(), 0}};
+}
+
+static void AddTag(MultiTagPoints* points, const AprilTagFieldLayout& layout,
+                   int id, const Pose3d& tagPose, units::meter_t tagSize,
+                   std::span<const double, 8> corners) {
+  for (int i = 0; i < 4; ++i) {
+    points->image[points->numPoints + i] = {corners[i * 2],
+                                            corners[i * 2 + 1]};
+  }
+  // use the layout's precomputed corners when they are for the same tag size
+  std::optional<std::array<Translation3d, 4>> fieldCorners;
+  if (layout.GetTagSize() == tagSize) {
+    fieldCorners = layout.GetTagCorners(id);
+  }
+  if (fieldCorners) {
+    for (int i = 0; i < 4; ++i) {
+      points->field[points->numPoints + i] = ToVector((*fieldCorners)[i]);
+    }
+  } else {
+    // tag corners in the order the detector reports them
+    double half = tagSize.value() / 2;
+    const Eigen::Vector3d tagCorners[4] = {{0, -half, -half},
+                                           {0, half, -half},
+                                           {0, half, half},
+                                           {0, -half, half}};
+    Eigen::Matrix3d rotation = ToMatrix(tagPose.Rotation());
+    Eigen::Vector3d translation = ToVector(tagPose.Translation());
+    for (int i = 0; i < 4; ++i) {
+      points->field[points->numPoints + i] =
+          rotation * tagCorners[i] + translation;
+    }
+  }
+  points->numPoints += 4;
+  ++points->numTags;
+}
+
+// Sum of squared reprojection errors for the camera with world-to-camera
+// rotation rcw at field position c.  If JtJ and Jtr are given, they are set to
+// the Gauss-Newton normal equations for the camera position and a rotation
+// about the field axes.  Returns infinity if any point is behind the camera.
+static double ReprojectionCost(const MultiTagPoints& points,
+                               const AprilTagPoseEstimator::Config& config,
+                               const Eigen::Matrix3d& rcw,
+                               const Eigen::Vector3d& c,
+                               Eigen::Matrix<double, 6, 6>* JtJ,
+                               Eigen::Vector<double, 6>* Jtr) {
+  if (JtJ) {
+    JtJ->setZero();
+    Jtr->setZero();
+  }
+  double cost = 0;
+  for (int i = 0; i < points.numPoints; ++i) {
+    Eigen::Vector3d d = points.field[i] - c;
+    Eigen::Vector3d P = rcw * d;
+    if (P.z() <= 1e-6) {
+      return std::numeric_limits<double>::infinity();
+    }
+    double iz = 1.0 / P.z();
+    Eigen::Vector2d r{config.fx * P.x() * iz + config.cx - points.image[i].x(),
+                      config.fy * P.y() * iz + config.cy - points.image[i].y()};
+    cost += r.squaredNorm();
+    if (JtJ) {
+      Eigen::Matrix<double, 2, 3> dProj{
+          {config.fx * iz, 0, -config.fx * P.x() * iz * iz},
+          {0, config.fy * iz, -config.fy * P.y() * iz * iz}};
+      Eigen::Matrix<double, 3, 6> dP;
+      dP.leftCols<3>() = -rcw;
+      dP.rightCols<3>() = rcw * Skew(d);
+      Eigen::Matrix<double, 2, 6> J = dProj * dP;
+      *JtJ += J.transpose() * J;
+      *Jtr += J.transpose() * r;
+    }
+  }
+  return cost;
+}
+
+static std::optional<AprilTagMultiTagPoseEstimate> SolveMultiTag(
+    const MultiTagPoints& points, const AprilTagPoseEstimator::Config& config,
+    const Pose3d& initialGuess, int nIters) {
+  // camera-to-field rotation of the detector camera axes, and the camera
+  // position in the field
+  Rotation3d rotation = Rotation3d{Eigen::Matrix3d{kNwuToEdn.transpose()}}
+                            .RotateBy(initialGuess.Rotation());
+  Eigen::Matrix3d rfc = ToMatrix(rotation);
+  Eigen::Vector3d c = ToVector(initialGuess.Translation());
+
+  Eigen::Matrix<double, 6, 6> JtJ;
+  Eigen::Vector<double, 6> Jtr;
+  double cost =
+      ReprojectionCost(points, config, rfc.transpose(), c, &JtJ, &Jtr);
+  if (!std::isfinite(cost)) {
+    return {};
+  }
+
+  double lambda = 1e-3;
+  for (int iter = 0; iter < nIters; ++iter) {
+    bool improved = false;
+    bool converged = false;
+    while (lambda < 1e10) {
+      Eigen::Matrix<double, 6, 6> A = JtJ;
+      A.diagonal() *= 1 + lambda;
+      Eigen::Vector<double, 6> delta = A.ldlt().solve(-Jtr);
+
+      Eigen::Vector3d newC = c + delta.head<3>();
+      Rotation3d newRotation =
+          rotation.RotateBy(Rotation3d{Eigen::Vector3d{delta.tail<3>()}});
+      Eigen::Matrix3d newRfc = ToMatrix(newRotation);
+
+      double newCost = ReprojectionCost(points, config, newRfc.transpose(),
+                                        newC, nullptr, nullptr);
+      if (newCost < cost) {
+        converged = delta.norm() < 1e-10 || cost - newCost < 1e-12 * cost;
+        rotation = newRotation;
+        rfc = newRfc;
+        c = newC;
+        cost = newCost;
+        lambda = std::max(lambda / 10, 1e-12);
+        improved = true;
+        break;
+      }
+      lambda *= 10;
+    }
+    if (!improved) {
+      break;
+    }
+    ReprojectionCost(points, config, rfc.transpose(), c, &JtJ, &Jtr);
+    if (converged) {
+      break;
+    }
+  }
+
+  // scale the inverse information matrix by the residual variance
+  int dof = 2 * points.numPoints - 6;
+  double variance = cost / dof;
+  return AprilTagMultiTagPoseEstimate{
+      Pose3d{Translation3d{units::meter_t{c.x()}, units::meter_t{c.y()},
+                           units::meter_t{c.z()}},
+             Rotation3d{Eigen::Matrix3d{rfc * kNwuToEdn}}},
+      variance * JtJ.inverse(), std::sqrt(cost / points.numPoints),
+      points.numTags};
+}
+
+std::optional<AprilTagMultiTagPoseEstimate>
+AprilTagPoseEstimator::EstimateMultiTag(
+    std::span<const AprilTagDetection* const> detections,
+    const AprilTagFieldLayout& layout, int nIters) const {
+  MultiTagPoints points;
+  const AprilTagDetection* largest = nullptr;
+  Pose3d largestPose;
+  double largestArea = 0;
+  for (auto&& detection : detections) {
+    if (points.numTags >= kMaxMultiTags) {
+      break;
+    }
+    auto tagPose = layout.GetTagPose(detection->GetId());
+    if (!tagPose) {
+      continue;
+    }
+    double buf[8];
+    auto corners = detection->GetCorners(buf);
+    AddTag(&points, layout, detection->GetId(), *tagPose, m_config.tagSize,
+           corners);
+
+    double area = 0;
+    for (int i = 0; i < 4; ++i) {
+      int j = (i + 1) % 4;
+      area += corners[i * 2] * corners[j * 2 + 1] -
+              corners[j * 2] * corners[i * 2 + 1];
+    }
+    if (!largest || std::abs(area) > largestArea) {
+      largest = detection;
+      largestPose = *tagPose;
+      largestArea = std::abs(area);
+    }
+  }
+  if (!largest) {
+    return {};
+  }
+
+  // initial guess from the single tag estimate of the largest tag
+  Transform3d cameraToTag = Estimate(*largest);
+  Eigen::Matrix3d rcw = ToMatrix(cameraToTag.Rotation()) * kTagNwuToDetector *
+                        ToMatrix(largestPose.Rotation()).transpose();
+  Eigen::Vector3d tcw = ToVector(cameraToTag.Translation()) -
+                        rcw * ToVector(largestPose.Translation());
+  Eigen::Vector3d c = -rcw.transpose() * tcw;
+  Pose3d initialGuess{
+      Translation3d{units::meter_t{c.x()}, units::meter_t{c.y()},
+                    units::meter_t{c.z()}},
+      Rotation3d{Eigen::Matrix3d{rcw.transpose() * kNwuToEdn}}};
+
+  return SolveMultiTag(points, m_config, initialGuess, nIters);
+}
+
+std::optional<AprilTagMultiTagPoseEstimate>
+AprilTagPoseEstimator::EstimateMultiTag(std::span<const int> ids,
+                                        std::span<const double> corners,
+                                        const AprilTagFieldLayout& layout,
+                                        const Pose3d& initialGuess,
+                                        int nIters) const {
+  MultiTagPoints points;
+  for (size_t i = 0; i < ids.size() && (i + 1) * 8 <= corners.size(); ++i) {
+    if (points.numTags >= kMaxMultiTags) {
+      break;
+    }
+    if (auto tagPose = layout.GetTagPose(ids[i])) {
+      AddTag(&points, layout, ids[i], *tagPose, m_config.tagSize,
+             corners.subspan(i * 8).first<8>());
+    }
+  }
+  if (points.numTags == 0) {
+    return {};
+  }
+  return SolveMultiTag(points, m_config, initialGuess, nIters);
+}
@@ -10,6 +10,7 @@
 #include <span>
 #include <string_view>
 #include <utility>
+#include <vector>
 
 #include <units/angle.h>
 #include <wpi/StringMap.h>
@@ -124,6 +125,41 @@ class WPILIB_DLLEXPORT AprilTagDetector {
     bool deglitch = false;
   };
 
+  /**
+   * Tracking configuration. When tracking is enabled, tags found in the
+   * previous frame are first searched for at full resolution in a padded
+   * region around their last position, and the (decimated) full-frame search
+   * is only run periodically or when a tracked tag is lost.
+   */
+  struct TrackingConfig {
+    bool operator==(const TrackingConfig&) const = default;
+
+    /**
+     * Whether tracking is enabled. Default is disabled (false).
+     */
+    bool enabled = false;
+
+    /**
+     * Number of frames between full-frame searches while all tracked tags
+     * are still being found. Tags that were not previously detected are only
+     * found by a full-frame search. Default is 10.
+     */
+    int fullFrameInterval = 10;
+
+    /**
+     * Padding added on each side of a tracked tag's bounding box, as a
+     * fraction of the box size. This bounds how far a tag can move between
+     * frames and still be tracked. Default is 0.5.
+     */
+    double roiPadding = 0.5;
+
+    /**
+     * Minimum padding added on each side of a tracked tag's bounding box, in
+     * pixels. Default is 16 pixels.
+     */
+    int minRoiPadding = 16;
+  };
+
   /**
    * Array of detection results. Each array element is a pointer to an
    * AprilTagDetection.
@@ -146,6 +182,7 @@ class WPILIB_DLLEXPORT AprilTagDetector {
 
    private:
     void Destroy();
+    void Reset(void* impl);
     void* m_impl = nullptr;
   };
 
@@ -156,7 +193,10 @@ class WPILIB_DLLEXPORT AprilTagDetector {
   AprilTagDetector(AprilTagDetector&& rhs)
       : m_impl{rhs.m_impl},
         m_families{std::move(rhs.m_families)},
-        m_qtpCriticalAngle{rhs.m_qtpCriticalAngle} {
+        m_qtpCriticalAngle{rhs.m_qtpCriticalAngle},
+        m_tracking{rhs.m_tracking},
+        m_tracks{std::move(rhs.m_tracks)},
+        m_framesSinceSearch{rhs.m_framesSinceSearch} {
     rhs.m_impl = nullptr;
   }
   AprilTagDetector& operator=(AprilTagDetector&& rhs);
@@ -194,6 +234,27 @@ class WPILIB_DLLEXPORT AprilTagDetector {
    */
   QuadThresholdParameters GetQuadThresholdParameters() const;
 
+  /**
+   * Sets tracking configuration. This also discards any current tracks.
+   *
+   * @param config Configuration
+   */
+  void SetTrackingConfig(const TrackingConfig& config);
+
+  /**
+   * Gets tracking configuration.
+   *
+   * @return Configuration
+   */
+  TrackingConfig GetTrackingConfig() const { return m_tracking; }
+
+  /**
+   * Discards the tags tracked from previous frames, so the next call to
+   * Detect() searches the full frame. This should be called when switching
+   * between image sources.
+   */
+  void ResetTracking();
+
   /** @} */
 
   /**
@@ -228,6 +289,9 @@ class WPILIB_DLLEXPORT AprilTagDetector {
    * Detect tags from an 8-bit image.
    * The image must be grayscale.
    *
+   * If tracking is enabled, successive calls are assumed to be successive
+   * frames of the same image source.
+   *
    * @param width width of the image
    * @param height height of the image
    * @param stride number of bytes between image rows (often the same as width)
@@ -249,14 +313,54 @@ class WPILIB_DLLEXPORT AprilTagDetector {
     return Detect(width, height, width, buf);
   }
 
+  /**
+   * Detect tags from an 8-bit image into existing results.
+   * The image must be grayscale.
+   *
+   * The detections previously held by the results are released and the
+   * results' storage is reused, so a caller that keeps one Results object
+   * avoids allocating a new array for each frame.
+   *
+   * @param width width of the image
+   * @param height height of the image
+   * @param stride number of bytes between image rows (often the same as width)
+   * @param buf image buffer
+   * @param results Results (array of AprilTagDetection pointers) to replace
+   */
+  void Detect(int width, int height, int stride, uint8_t* buf,
+              Results* results);
+
  private:
+  struct Roi {
+    int x0;
+    int y0;
+    int x1;
+    int y1;
+  };
+
+  struct Track {
+    const void* family;
+    int id;
+    double minX;
+    double minY;
+    double maxX;
+    double maxY;
+  };
+
   void Destroy();
   void DestroyFamilies();
   void DestroyFamily(std::string_view name, void* data);
+  bool DetectTracked(int width, int height, int stride, uint8_t* buf,
+                     void* detections);
+  void UpdateTracks(void* detections);
 
   void* m_impl;
   wpi::StringMap<void*> m_families;
   units::radian_t m_qtpCriticalAngle = 10_deg;
+  TrackingConfig m_tracking;
+  std::vector<Track> m_tracks;
+  std::vector<Roi> m_rois;  // scratch space for DetectTracked()
+  int m_framesSinceSearch = 0;
 };
 
 }  // namespace frc
@@ -4,11 +4,13 @@
 
 #pragma once
 
+#include <array>
 #include <optional>
 #include <string_view>
 #include <unordered_map>
 #include <vector>
 
+#include <units/angle.h>
 #include <units/length.h>
 #include <wpi/SymbolExports.h>
 #include <wpi/json_fwd.h>
@@ -67,6 +69,17 @@ class WPILIB_DLLEXPORT AprilTagFieldLayout {
   AprilTagFieldLayout(std::vector<AprilTag> apriltags,
                       units::meter_t fieldLength, units::meter_t fieldWidth);
 
+  /**
+   * Parses an AprilTagFieldLayout from the contents of a JSON file. This reads
+   * the layout directly from the text, without building an intermediate JSON
+   * document, so it is faster than converting from wpi::json.
+   *
+   * @param json JSON text.
+   * @return The parsed layout.
+   * @throws std::runtime_error if the text is not a valid layout
+   */
+  static AprilTagFieldLayout Parse(std::string_view json);
+
   /**
    * Returns the length of the field the layout is representing.
    * @return length
@@ -121,6 +134,50 @@ class WPILIB_DLLEXPORT AprilTagFieldLayout {
    */
   std::optional<Pose3d> GetTagPose(int ID) const;
 
+  /**
+   * Sets the tag size used for GetTagCorners() and GetVisibleTags(). This is
+   * the side length of the black square of the tag. Default is 6.5 inches.
+   *
+   * @param tagSize The tag size
+   */
+  void SetTagSize(units::meter_t tagSize);
+
+  /**
+   * Returns the tag size used for GetTagCorners() and GetVisibleTags().
+   * @return the tag size
+   */
+  units::meter_t GetTagSize() const { return m_tagSize; }
+
+  /**
+   * Gets the corners of an AprilTag by its ID. The corners are returned in
+   * the same order as AprilTagDetection::GetCorner() and relative to the
+   * origin, like GetTagPose(int). These are precomputed, so this is cheap to
+   * call every frame.
+   *
+   * @param ID The ID of the tag.
+   * @return The corners of the tag or an empty optional if a tag with that ID
+   * is not found.
+   */
+  std::optional<std::array<Translation3d, 4>> GetTagCorners(int ID) const;
+
+  /**
+   * Returns the IDs of the tags that may be visible from a camera, nearest
+   * first. A tag is a candidate if it faces the camera, is no further than
+   * maxDistance, and at least one of its corners is inside the field of view.
+   * Occlusion is not considered.
+   *
+   * @param cameraPose Pose of the camera, relative to the origin, with X
+   *                   forward along the optical axis.
+   * @param horizontalFov Horizontal field of view of the camera.
+   * @param verticalFov Vertical field of view of the camera.
+   * @param maxDistance Maximum distance from the camera to a tag.
+   * @return IDs of the candidate tags
+   */
+  std::vector<int> GetVisibleTags(
+      const Pose3d& cameraPose, units::radian_t horizontalFov,
+      units::radian_t verticalFov,
+      units::meter_t maxDistance = units::meter_t{1e9}) const;
+
   /**
    * Serializes an AprilTagFieldLayout to a JSON file.
    *
@@ -130,14 +187,32 @@ class WPILIB_DLLEXPORT AprilTagFieldLayout {
 
   /*
    * Checks equality between this AprilTagFieldLayout and another object.
+   * The tag size is not compared, as it is not part of the JSON layout.
    */
-  bool operator==(const AprilTagFieldLayout&) const = default;
+  bool operator==(const AprilTagFieldLayout& rhs) const {
+    return m_apriltags == rhs.m_apriltags &&
+           m_fieldLength == rhs.m_fieldLength &&
+           m_fieldWidth == rhs.m_fieldWidth && m_origin == rhs.m_origin;
+  }
 
  private:
+  // tag geometry relative to the origin
+  struct CachedTag {
+    int ID;
+    Pose3d pose;
+    std::array<Translation3d, 4> corners;
+  };
+
+  void UpdateCache();
+  const CachedTag* FindCachedTag(int ID) const;
+
   std::unordered_map<int, AprilTag> m_apriltags;
   units::meter_t m_fieldLength;
   units::meter_t m_fieldWidth;
   Pose3d m_origin;
+  units::meter_t m_tagSize = 6.5_in;
+  // sorted by ID
+  std::vector<CachedTag> m_cache;
 
   friend WPILIB_DLLEXPORT void to_json(wpi::json& json,
                                        const AprilTagFieldLayout& layout);
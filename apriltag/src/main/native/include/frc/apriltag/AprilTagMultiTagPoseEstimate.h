@@ -0,0 +1,36 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#pragma once
+
+#include <Eigen/Core>
+#include <wpi/SymbolExports.h>
+
+#include "frc/geometry/Pose3d.h"
+
+namespace frc {
+
+/** A camera pose estimated jointly from several AprilTags. */
+struct WPILIB_DLLEXPORT AprilTagMultiTagPoseEstimate {
+  /**
+   * Pose of the camera in the field, with X forward, Y left and Z up relative
+   * to the camera.
+   */
+  Pose3d fieldToCamera;
+
+  /**
+   * Covariance of the estimate. The state is the camera position in the field
+   * (x, y, z, in meters) followed by a small rotation of the camera about the
+   * field axes (rotation vector, in radians).
+   */
+  Eigen::Matrix<double, 6, 6> covariance;
+
+  /** RMS reprojection error of the tag corners, in pixels. */
+  double reprojectionError;
+
+  /** Number of tags used in the estimate. */
+  int numTags;
+};
+
+}  // namespace frc
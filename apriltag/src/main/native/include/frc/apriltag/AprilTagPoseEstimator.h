@@ -4,21 +4,28 @@
 
 #pragma once
 
+#include <optional>
 #include <span>
 
 #include <units/length.h>
 #include <wpi/SymbolExports.h>
 
+#include "frc/apriltag/AprilTagMultiTagPoseEstimate.h"
 #include "frc/apriltag/AprilTagPoseEstimate.h"
+#include "frc/geometry/Pose3d.h"
 #include "frc/geometry/Transform3d.h"
 
 namespace frc {
 
 class AprilTagDetection;
+class AprilTagFieldLayout;
 
 /** Pose estimators for AprilTag tags. */
 class WPILIB_DLLEXPORT AprilTagPoseEstimator {
  public:
+  /** Maximum number of tags used by EstimateMultiTag(). */
+  static constexpr int kMaxMultiTags = 16;
+
   /** Configuration for the pose estimator. */
   struct Config {
     bool operator==(const Config&) const = default;
@@ -138,6 +145,48 @@ class WPILIB_DLLEXPORT AprilTagPoseEstimator {
   Transform3d Estimate(std::span<const double, 9> homography,
                        std::span<const double, 8> corners) const;
 
+  /**
+   * Estimates the camera pose in the field from all detected tags at once.
+   *
+   * The corners of every tag with a known pose in the layout are used
+   * together, and the camera pose is found by Levenberg-Marquardt
+   * minimization of the reprojection error of all the corners. The initial
+   * estimate comes from Estimate() on the tag with the largest image area.
+   *
+   * At most kMaxMultiTags tags are used. The initial estimate allocates
+   * memory in the apriltag library; to avoid that, use the overload taking an
+   * initial guess.
+   *
+   * @param detections Tag detections
+   * @param layout Field layout providing the tag poses
+   * @param nIters Maximum number of iterations
+   * @return Pose estimate, or empty if no tags are in the layout or the
+   *         solve fails
+   */
+  std::optional<AprilTagMultiTagPoseEstimate> EstimateMultiTag(
+      std::span<const AprilTagDetection* const> detections,
+      const AprilTagFieldLayout& layout, int nIters = 20) const;
+
+  /**
+   * Estimates the camera pose in the field from all detected tags at once,
+   * starting from a known approximate pose (e.g. the previous estimate).
+   *
+   * At most kMaxMultiTags tags are used; this does not allocate memory.
+   *
+   * @param ids Tag IDs
+   * @param corners Corner point array (X and Y for each corner in order, 8
+   *                values for each tag ID)
+   * @param layout Field layout providing the tag poses
+   * @param initialGuess Approximate camera pose in the field
+   * @param nIters Maximum number of iterations
+   * @return Pose estimate, or empty if no tags are in the layout or the
+   *         solve fails
+   */
+  std::optional<AprilTagMultiTagPoseEstimate> EstimateMultiTag(
+      std::span<const int> ids, std::span<const double> corners,
+      const AprilTagFieldLayout& layout, const Pose3d& initialGuess,
+      int nIters = 20) const;
+
  private:
   Config m_config;
 };
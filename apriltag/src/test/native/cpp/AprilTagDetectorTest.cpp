@@ -2,8 +2,12 @@
 // Open Source Software; you can modify and/or share it under the terms of
 // the WPILib BSD license file in the root directory of this project.
 
+#include <vector>
+
 #include <gtest/gtest.h>
+#include <wpi/RawFrame.h>
 
+#include "frc/apriltag/AprilTag.h"
 #include "frc/apriltag/AprilTagDetector.h"
 
 using namespace frc;
@@ -34,6 +38,21 @@ TEST(AprilTagDetectorTest, QtpMinClusterPixels) {
   ASSERT_EQ(params.minClusterPixels, 8);
 }
 
+TEST(AprilTagDetectorTest, TrackingDefaults) {
+  AprilTagDetector detector;
+  auto config = detector.GetTrackingConfig();
+  ASSERT_EQ(config, AprilTagDetector::TrackingConfig{});
+  ASSERT_FALSE(config.enabled);
+}
+
+TEST(AprilTagDetectorTest, SetTrackingConfig) {
+  AprilTagDetector detector;
+  detector.SetTrackingConfig({.enabled = true, .fullFrameInterval = 5});
+  auto config = detector.GetTrackingConfig();
+  ASSERT_TRUE(config.enabled);
+  ASSERT_EQ(config.fullFrameInterval, 5);
+}
+
 TEST(AprilTagDetectorTest, Add16h5) {
   AprilTagDetector detector;
   ASSERT_TRUE(detector.AddFamily("tag16h5"));
@@ -66,3 +85,59 @@ TEST(AprilTagDetectorTest, RemoveFamily) {
   detector.AddFamily("tag16h5");
   detector.RemoveFamily("tag16h5");
 }
+
+namespace {
+constexpr int kSize = 400;
+constexpr int kScale = 20;
+constexpr int kOffset = 100;
+
+// A white image with tag 3 of the 36h11 family at (kOffset, kOffset).
+std::vector<uint8_t> MakeTagImage(const wpi::RawFrame& tag) {
+  std::vector<uint8_t> image(kSize * kSize, 255);
+  for (int y = 0; y < tag.height * kScale; ++y) {
+    for (int x = 0; x < tag.width * kScale; ++x) {
+      image[(y + kOffset) * kSize + x + kOffset] =
+          tag.data[(y / kScale) * tag.stride + x / kScale];
+    }
+  }
+  return image;
+}
+
+void CheckReusesResults(AprilTagDetector& detector) {
+  wpi::RawFrame tag;
+  AprilTag::Generate36h11AprilTagImage(&tag, 3);
+  auto image = MakeTagImage(tag);
+
+  AprilTagDetector::Results results;
+  const AprilTagDetection* const* storage = nullptr;
+  for (int i = 0; i < 3; ++i) {
+    detector.Detect(kSize, kSize, kSize, image.data(), &results);
+    ASSERT_EQ(results.size(), 1u);
+    EXPECT_EQ(results[0]->GetId(), 3);
+    EXPECT_NEAR(results[0]->GetCenter().x,
+                kOffset + tag.width * kScale / 2, 1.0);
+    EXPECT_NEAR(results[0]->GetCenter().y,
+                kOffset + tag.height * kScale / 2, 1.0);
+    // the first call allocates the array, later calls refill it
+    if (i == 0) {
+      storage = results.data();
+    } else {
+      EXPECT_EQ(results.data(), storage);
+    }
+  }
+}
+}  // namespace
+
+TEST(AprilTagDetectorTest, ReusesResults) {
+  AprilTagDetector detector;
+  detector.AddFamily("tag36h11");
+  CheckReusesResults(detector);
+}
+
+TEST(AprilTagDetectorTest, TrackingReusesResults) {
+  AprilTagDetector detector;
+  detector.AddFamily("tag36h11");
+  // a full frame search, then searches around the tag
+  detector.SetTrackingConfig({.enabled = true, .fullFrameInterval = 3});
+  CheckReusesResults(detector);
+}
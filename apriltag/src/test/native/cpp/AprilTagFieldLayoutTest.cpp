@@ -0,0 +1,81 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "frc/apriltag/AprilTag.h"
+#include "frc/apriltag/AprilTagFieldLayout.h"
+#include "frc/geometry/Pose3d.h"
+
+using namespace frc;
+
+namespace {
+// tag 1 on the blue wall facing the field, tag 2 on the red wall facing back
+AprilTagFieldLayout MakeLayout() {
+  return AprilTagFieldLayout{
+      std::vector{
+          AprilTag{1, Pose3d{0_m, 4_m, 1_m, Rotation3d{}}},
+          AprilTag{2,
+                   Pose3d{16_m, 4_m, 1_m, Rotation3d{0_deg, 0_deg, 180_deg}}},
+          AprilTag{3, Pose3d{0_m, 6_m, 1_m, Rotation3d{}}}},
+      16_m, 8_m};
+}
+}  // namespace
+
+TEST(AprilTagFieldLayoutTest, TagCorners) {
+  auto layout = MakeLayout();
+  layout.SetTagSize(2_m);
+
+  auto corners = layout.GetTagCorners(1);
+  ASSERT_TRUE(corners);
+  // bottom left, bottom right, top right, top left as seen from the field
+  EXPECT_EQ(Translation3d(0_m, 3_m, 0_m), (*corners)[0]);
+  EXPECT_EQ(Translation3d(0_m, 5_m, 0_m), (*corners)[1]);
+  EXPECT_EQ(Translation3d(0_m, 5_m, 2_m), (*corners)[2]);
+  EXPECT_EQ(Translation3d(0_m, 3_m, 2_m), (*corners)[3]);
+
+  corners = layout.GetTagCorners(2);
+  ASSERT_TRUE(corners);
+  EXPECT_EQ(Translation3d(16_m, 5_m, 0_m), (*corners)[0]);
+
+  EXPECT_FALSE(layout.GetTagCorners(4));
+}
+
+TEST(AprilTagFieldLayoutTest, TagCornersFollowOrigin) {
+  auto layout = MakeLayout();
+  layout.SetTagSize(2_m);
+  layout.SetOrigin(
+      AprilTagFieldLayout::OriginPosition::kRedAllianceWallRightSide);
+
+  auto pose = layout.GetTagPose(2);
+  ASSERT_TRUE(pose);
+  EXPECT_EQ(Pose3d(0_m, 4_m, 1_m, Rotation3d{}), *pose);
+
+  auto corners = layout.GetTagCorners(2);
+  ASSERT_TRUE(corners);
+  EXPECT_EQ(Translation3d(0_m, 3_m, 0_m), (*corners)[0]);
+}
+
+TEST(AprilTagFieldLayoutTest, VisibleTags) {
+  auto layout = MakeLayout();
+
+  // looking at the blue wall from the field
+  Pose3d camera{3_m, 4_m, 1_m, Rotation3d{0_deg, 0_deg, 180_deg}};
+  EXPECT_EQ((std::vector<int>{1, 3}),
+            layout.GetVisibleTags(camera, 90_deg, 60_deg));
+  EXPECT_EQ(std::vector<int>{1},
+            layout.GetVisibleTags(camera, 30_deg, 60_deg));
+  EXPECT_EQ(std::vector<int>{1},
+            layout.GetVisibleTags(camera, 90_deg, 60_deg, 3.1_m));
+
+  // looking at the red wall
+  camera = Pose3d{3_m, 4_m, 1_m, Rotation3d{}};
+  EXPECT_EQ(std::vector<int>{2}, layout.GetVisibleTags(camera, 90_deg, 60_deg));
+
+  // behind the blue wall, the nearby tags face away
+  camera = Pose3d{-1_m, 4_m, 1_m, Rotation3d{}};
+  EXPECT_TRUE(layout.GetVisibleTags(camera, 90_deg, 60_deg, 5_m).empty());
+}
@@ -25,3 +25,38 @@ TEST(AprilTagJsonTest, DeserializeMatches) {
   EXPECT_NO_THROW(deserialized = json.get<AprilTagFieldLayout>());
   EXPECT_EQ(layout, deserialized);
 }
+
+TEST(AprilTagJsonTest, DeserializeMatchesWithTagSize) {
+  auto layout = AprilTagFieldLayout{
+      std::vector{AprilTag{1, Pose3d{0_m, 1_m, 0_m, Rotation3d{}}}}, 54_ft,
+      27_ft};
+  // the tag size is not serialized
+  layout.SetTagSize(1_m);
+
+  wpi::json json = layout;
+  auto deserialized = json.get<AprilTagFieldLayout>();
+  EXPECT_EQ(layout, deserialized);
+}
+
+TEST(AprilTagJsonTest, ParseMatches) {
+  auto layout = AprilTagFieldLayout{
+      std::vector{
+          AprilTag{1, Pose3d{}},
+          AprilTag{3, Pose3d{0_m, 1_m, 0_m, Rotation3d{0_deg, 0_deg, 90_deg}}}},
+      54_ft, 27_ft};
+
+  wpi::json json = layout;
+  AprilTagFieldLayout parsed;
+  EXPECT_NO_THROW(parsed = AprilTagFieldLayout::Parse(json.dump()));
+  EXPECT_EQ(layout, parsed);
+}
+
+TEST(AprilTagJsonTest, ParseErrors) {
+  EXPECT_THROW(AprilTagFieldLayout::Parse("{\"tags\": ["), std::runtime_error);
+  EXPECT_THROW(AprilTagFieldLayout::Parse("{\"tags\": []}"),
+               std::runtime_error);
+  EXPECT_THROW(AprilTagFieldLayout::Parse(
+                   "{\"tags\": [{\"ID\": 1}], "
+                   "\"field\": {\"length\": 1, \"width\": 1}}"),
+               std::runtime_error);
+}
@@ -0,0 +1,103 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "frc/apriltag/AprilTag.h"
+#include "frc/apriltag/AprilTagFieldLayout.h"
+#include "frc/apriltag/AprilTagPoseEstimator.h"
+#include "frc/geometry/Pose3d.h"
+
+using namespace frc;
+
+namespace {
+
+constexpr AprilTagPoseEstimator::Config kConfig{
+    0.1651_m, 600.0, 600.0, 320.0, 240.0};
+
+// Projects the corners of a tag into an ideal camera at cameraPose.
+void ProjectTag(const Pose3d& tagPose, const Pose3d& cameraPose,
+                std::vector<double>* corners) {
+  double half = kConfig.tagSize.value() / 2;
+  const double offsets[4][2] = {
+      {-half, -half}, {half, -half}, {half, half}, {-half, half}};
+  for (auto&& [y, z] : offsets) {
+    auto corner = tagPose.TransformBy(Transform3d{
+        Translation3d{0_m, units::meter_t{y}, units::meter_t{z}},
+        Rotation3d{}});
+    auto point = corner.RelativeTo(cameraPose).Translation();
+    corners->push_back(kConfig.cx - kConfig.fx * point.Y().value() /
+                                         point.X().value());
+    corners->push_back(kConfig.cy - kConfig.fy * point.Z().value() /
+                                         point.X().value());
+  }
+}
+
+}  // namespace
+
+TEST(AprilTagMultiTagPoseTest, RecoversCameraPose) {
+  // two tags on the same wall, facing the camera
+  AprilTagFieldLayout layout{
+      std::vector<AprilTag>{
+          AprilTag{1, Pose3d{5_m, 1_m, 1_m, Rotation3d{0_deg, 0_deg, 180_deg}}},
+          AprilTag{2,
+                   Pose3d{5_m, 3_m, 1.2_m, Rotation3d{0_deg, 0_deg, 180_deg}}}},
+      16_m, 8_m};
+  Pose3d cameraPose{1_m, 2_m, 0.5_m, Rotation3d{0_deg, -5_deg, 10_deg}};
+
+  std::vector<int> ids{1, 2, 7};
+  std::vector<double> corners;
+  ProjectTag(*layout.GetTagPose(1), cameraPose, &corners);
+  ProjectTag(*layout.GetTagPose(2), cameraPose, &corners);
+  // tag 7 is not in the layout and is ignored
+  corners.insert(corners.end(), 8, 0.0);
+
+  Pose3d initialGuess{1.3_m, 1.8_m, 0.6_m, Rotation3d{0_deg, 0_deg, 0_deg}};
+  AprilTagPoseEstimator estimator{kConfig};
+  auto estimate =
+      estimator.EstimateMultiTag(ids, corners, layout, initialGuess, 50);
+  ASSERT_TRUE(estimate);
+  EXPECT_EQ(estimate->numTags, 2);
+  EXPECT_NEAR(estimate->reprojectionError, 0.0, 1e-6);
+
+  auto error = estimate->fieldToCamera.RelativeTo(cameraPose);
+  EXPECT_NEAR(error.Translation().Norm().value(), 0.0, 1e-6);
+  EXPECT_NEAR(error.Rotation().Angle().value(), 0.0, 1e-6);
+}
+
+TEST(AprilTagMultiTagPoseTest, Covariance) {
+  AprilTagFieldLayout layout{
+      std::vector<AprilTag>{AprilTag{
+          1, Pose3d{5_m, 1_m, 1_m, Rotation3d{0_deg, 0_deg, 180_deg}}}},
+      16_m, 8_m};
+  Pose3d cameraPose{1_m, 1_m, 1_m, Rotation3d{}};
+
+  std::vector<int> ids{1};
+  std::vector<double> corners;
+  ProjectTag(*layout.GetTagPose(1), cameraPose, &corners);
+  // one pixel of noise
+  corners[0] += 1.0;
+  corners[5] -= 1.0;
+
+  AprilTagPoseEstimator estimator{kConfig};
+  auto estimate =
+      estimator.EstimateMultiTag(ids, corners, layout, cameraPose, 50);
+  ASSERT_TRUE(estimate);
+  EXPECT_GT(estimate->reprojectionError, 0.0);
+  for (int i = 0; i < 6; ++i) {
+    EXPECT_GT(estimate->covariance(i, i), 0.0);
+  }
+  EXPECT_TRUE(estimate->covariance.isApprox(estimate->covariance.transpose()));
+}
+
+TEST(AprilTagMultiTagPoseTest, NoKnownTags) {
+  AprilTagFieldLayout layout{std::vector<AprilTag>{}, 16_m, 8_m};
+  std::vector<int> ids{3};
+  std::vector<double> corners(8);
+  AprilTagPoseEstimator estimator{kConfig};
+  EXPECT_FALSE(
+      estimator.EstimateMultiTag(ids, corners, layout, Pose3d{}, 10));
+}
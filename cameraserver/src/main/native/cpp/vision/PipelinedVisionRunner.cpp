@@ -0,0 +1,305 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include "vision/PipelinedVisionRunner.h"
+
+#include <algorithm>
+#include <deque>
+#include <utility>
+
+#include <fmt/format.h>
+#include <networktables/DoubleArrayTopic.h>
+#include <networktables/DoubleTopic.h>
+#include <networktables/IntegerArrayTopic.h>
+#include <networktables/IntegerTopic.h>
+#include <networktables/NetworkTable.h>
+#include <networktables/NetworkTableInstance.h>
+#include <opencv2/imgproc/imgproc.hpp>
+#include <wpi/condition_variable.h>
+#include <wpi/timestamp.h>
+
+#include "cameraserver/CameraServerShared.h"
+
+using namespace frc;
+
+static constexpr uint64_t kPublishPeriod = 1000000;  // us
+
+struct PipelinedVisionRunnerBase::LatencyStats {
+  explicit LatencyStats(std::string_view name) : name{name} {}
+
+  void Add(int64_t us) {
+    double ms = us / 1000.0;
+    size_t bucket = std::lower_bound(kLatencyBucketsMs.begin(),
+                                     kLatencyBucketsMs.end(), ms) -
+                    kLatencyBucketsMs.begin();
+    ++counts[bucket];
+    totalUs += us;
+  }
+
+  void StartPublishing(nt::NetworkTable& table) {
+    auto sub = table.GetSubTable(name);
+    histogramPublisher =
+        sub->GetIntegerArrayTopic("latencyHistogram").Publish();
+    meanPublisher = sub->GetDoubleTopic("meanLatencyMs").Publish();
+  }
+
+  void Publish() {
+    int64_t values[kLatencyBucketsMs.size() + 1];
+    int64_t total = 0;
+    for (size_t i = 0; i < counts.size(); ++i) {
+      values[i] = counts[i];
+      total += values[i];
+    }
+    histogramPublisher.Set(values);
+    if (total != 0) {
+      meanPublisher.Set(totalUs / 1000.0 / total);
+    }
+  }
+
+  std::string name;
+  std::array<std::atomic<int64_t>, kLatencyBucketsMs.size() + 1> counts{};
+  std::atomic<int64_t> totalUs{0};
+  nt::IntegerArrayPublisher histogramPublisher;
+  nt::DoublePublisher meanPublisher;
+};
+
+struct PipelinedVisionRunnerBase::Stage {
+  Stage(std::string_view name, std::function<void(VisionFrameBase&)> process)
+      : process{std::move(process)}, stats{name} {}
+
+  std::function<void(VisionFrameBase&)> process;
+  LatencyStats stats;
+
+  // frames waiting for this stage, and frames being processed by the
+  // previous stage that will be added to the queue
+  std::deque<std::unique_ptr<VisionFrameBase>> queue;
+  size_t incoming = 0;
+  // true while a worker is processing a frame for this stage
+  bool busy = false;
+};
+
+struct PipelinedVisionRunnerBase::Statistics {
+  // how stale frames are when grabbed, and capture to result
+  LatencyStats capture{"capture"};
+  LatencyStats total{"total"};
+  std::atomic<int64_t> droppedFrames{0};
+  nt::IntegerPublisher droppedPublisher;
+  nt::DoubleArrayPublisher bucketsPublisher;
+  uint64_t lastPublish = 0;
+};
+
+PipelinedVisionRunnerBase::PipelinedVisionRunnerBase(
+    std::string_view name, cs::VideoSource videoSource, int queueDepth,
+    int numThreads)
+    : m_name{name},
+      m_cvSink{fmt::format("{} CvSink", name)},
+      m_queueDepth{static_cast<size_t>(std::max(queueDepth, 1))},
+      m_numThreads{numThreads},
+      m_stats{std::make_unique<Statistics>()} {
+  m_cvSink.SetSource(videoSource);
+  m_stages.emplace_back(
+      std::make_unique<Stage>("gray", [](VisionFrameBase& frame) {
+        if (frame.image.channels() == 1) {
+          frame.gray = frame.image;
+        } else {
+          cv::cvtColor(frame.image, frame.gray, cv::COLOR_BGR2GRAY);
+        }
+      }));
+}
+
+// Located here and not in header due to incomplete types.
+PipelinedVisionRunnerBase::~PipelinedVisionRunnerBase() {
+  Stop();
+}
+
+void PipelinedVisionRunnerBase::AddStageBase(
+    std::string_view name, std::function<void(VisionFrameBase&)> process) {
+  if (m_active) {
+    frc::GetCameraServerShared()->SetVisionRunnerError(
+        "PipelinedVisionRunner::AddStage() cannot be called while running");
+    return;
+  }
+  m_stages.emplace_back(std::make_unique<Stage>(name, std::move(process)));
+}
+
+void PipelinedVisionRunnerBase::Start() {
+  if (m_active.exchange(true)) {
+    return;
+  }
+
+  auto table = nt::NetworkTableInstance::GetDefault()
+                   .GetTable("VisionRunner")
+                   ->GetSubTable(m_name);
+  m_stats->bucketsPublisher =
+      table->GetDoubleArrayTopic("latencyBucketsMs").Publish();
+  m_stats->bucketsPublisher.Set(kLatencyBucketsMs);
+  m_stats->droppedPublisher =
+      table->GetIntegerTopic("droppedFrames").Publish();
+  m_stats->capture.StartPublishing(*table);
+  m_stats->total.StartPublishing(*table);
+  for (auto&& stage : m_stages) {
+    stage->stats.StartPublishing(*table);
+  }
+
+  // a stage only runs on one thread at a time, so more threads than stages
+  // would sit idle
+  size_t numThreads = m_numThreads;
+  if (numThreads == 0) {
+    numThreads = std::max(std::thread::hardware_concurrency(), 1u);
+  }
+  numThreads = std::min(numThreads, m_stages.size());
+  for (size_t i = 0; i < numThreads; ++i) {
+    m_workers.emplace_back([this] { WorkerMain(); });
+  }
+  m_captureThread = std::thread([this] { CaptureMain(); });
+}
+
+void PipelinedVisionRunnerBase::Stop() {
+  m_active = false;
+  if (m_captureThread.joinable()) {
+    m_captureThread.join();
+  }
+  {
+    std::scoped_lock lock{m_mutex};
+    m_cond.notify_all();
+  }
+  for (auto&& worker : m_workers) {
+    worker.join();
+  }
+  m_workers.clear();
+  for (auto&& stage : m_stages) {
+    while (!stage->queue.empty()) {
+      ReleaseFrame(std::move(stage->queue.front()));
+      stage->queue.pop_front();
+    }
+  }
+}
+
+std::unique_ptr<VisionFrameBase> PipelinedVisionRunnerBase::GetFreeFrame() {
+  {
+    std::scoped_lock lock{m_freeMutex};
+    if (!m_freeFrames.empty()) {
+      auto frame = std::move(m_freeFrames.back());
+      m_freeFrames.pop_back();
+      return frame;
+    }
+  }
+  return MakeFrame();
+}
+
+void PipelinedVisionRunnerBase::ReleaseFrame(
+    std::unique_ptr<VisionFrameBase> frame) {
+  std::scoped_lock lock{m_freeMutex};
+  m_freeFrames.emplace_back(std::move(frame));
+}
+
+void PipelinedVisionRunnerBase::CaptureMain() {
+  auto& first = *m_stages.front();
+  uint64_t sequence = 0;
+  while (m_active) {
+    auto frame = GetFreeFrame();
+    frame->time = m_cvSink.GrabFrame(frame->image);
+    if (frame->time == 0) {
+      ReleaseFrame(std::move(frame));
+      if (m_active) {
+        auto error = m_cvSink.GetError();
+        frc::GetCameraServerShared()->ReportDriverStationError(error.c_str());
+      }
+      continue;
+    }
+    frame->sequence = ++sequence;
+    m_stats->capture.Add(wpi::Now() - frame->time);
+
+    // keep the newest frames if the pipeline is falling behind
+    std::unique_ptr<VisionFrameBase> dropped;
+    {
+      std::scoped_lock lock{m_mutex};
+      if (first.queue.size() >= m_queueDepth) {
+        dropped = std::move(first.queue.front());
+        first.queue.pop_front();
+      }
+      first.queue.emplace_back(std::move(frame));
+      m_cond.notify_all();
+    }
+    if (dropped) {
+      ++m_stats->droppedFrames;
+      ReleaseFrame(std::move(dropped));
+    }
+  }
+}
+
+// Returns the index of a stage that has a frame to process and room for the
+// result, preferring later stages so frames leave the pipeline as soon as
+// possible, or the number of stages if there is none.  Must be called with
+// m_mutex held.
+size_t PipelinedVisionRunnerBase::FindRunnableStage() const {
+  for (size_t i = m_stages.size(); i-- > 0;) {
+    auto& stage = *m_stages[i];
+    if (stage.busy || stage.queue.empty()) {
+      continue;
+    }
+    // apply back pressure; the capture stage drops frames instead
+    if (i + 1 < m_stages.size()) {
+      auto& next = *m_stages[i + 1];
+      if (next.queue.size() + next.incoming >= m_queueDepth) {
+        continue;
+      }
+    }
+    return i;
+  }
+  return m_stages.size();
+}
+
+void PipelinedVisionRunnerBase::WorkerMain() {
+  std::unique_lock lock{m_mutex};
+  while (m_active) {
+    size_t index = 0;
+    m_cond.wait(lock, [&] {
+      return !m_active || (index = FindRunnableStage()) < m_stages.size();
+    });
+    if (!m_active) {
+      break;
+    }
+    auto& stage = *m_stages[index];
+    Stage* next =
+        index + 1 < m_stages.size() ? m_stages[index + 1].get() : nullptr;
+    auto frame = std::move(stage.queue.front());
+    stage.queue.pop_front();
+    stage.busy = true;
+    if (next) {
+      ++next->incoming;
+    }
+    lock.unlock();
+
+    uint64_t start = wpi::Now();
+    stage.process(*frame);
+    stage.stats.Add(wpi::Now() - start);
+
+    if (!next) {
+      DoResult(*frame);
+      uint64_t now = wpi::Now();
+      m_stats->total.Add(now - frame->time);
+      ReleaseFrame(std::move(frame));
+
+      // the last stage is busy, so no other thread publishes
+      if (now - m_stats->lastPublish >= kPublishPeriod) {
+        m_stats->lastPublish = now;
+        m_stats->droppedPublisher.Set(m_stats->droppedFrames);
+        m_stats->capture.Publish();
+        for (auto&& s : m_stages) {
+          s->stats.Publish();
+        }
+        m_stats->total.Publish();
+      }
+    }
+
+    lock.lock();
+    stage.busy = false;
+    if (next) {
+      --next->incoming;
+      next->queue.emplace_back(std::move(frame));
+    }
+    m_cond.notify_all();
+  }
+}
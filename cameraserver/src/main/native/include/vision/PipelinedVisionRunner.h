@@ -0,0 +1,188 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#pragma once
+
+#include <stdint.h>
+
+#include <array>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <opencv2/core/mat.hpp>
+#include <wpi/condition_variable.h>
+#include <wpi/mutex.h>
+
+#include "cscore.h"
+#include "cscore_cv.h"
+
+namespace frc {
+
+/**
+ * Per-frame state passed between the stages of a PipelinedVisionRunner.
+ */
+struct VisionFrameBase {
+  virtual ~VisionFrameBase() = default;
+
+  /** Frame sequence number, counting captured frames from 1. */
+  uint64_t sequence = 0;
+
+  /**
+   * Capture time of the frame in microseconds, as returned by
+   * cs::CvSink::GrabFrame(). This uses the same time base as wpi::Now().
+   */
+  uint64_t time = 0;
+
+  /** Captured color (BGR) image. */
+  cv::Mat image;
+
+  /** Grayscale version of the captured image. */
+  cv::Mat gray;
+};
+
+/**
+ * Per-frame state with user data.
+ *
+ * Frame objects are reused, so stages should overwrite (not accumulate into)
+ * the data of each frame.
+ */
+template <typename T>
+struct VisionFrame : public VisionFrameBase {
+  /** User data set by the pipeline stages. */
+  T data;
+};
+
+/**
+ * Non-template base class for PipelinedVisionRunner.
+ */
+class PipelinedVisionRunnerBase {
+ public:
+  /**
+   * Upper bounds of the latency histogram buckets, in milliseconds. The last
+   * histogram bucket counts everything above the last bound.
+   */
+  static constexpr std::array<double, 9> kLatencyBucketsMs = {
+      1, 2, 5, 10, 20, 50, 100, 200, 500};
+
+  /**
+   * Creates a new pipelined vision runner.
+   *
+   * @param name name used for the CvSink and the NetworkTables statistics
+   * @param videoSource the video source to use to supply images for the
+   *                    pipeline
+   * @param queueDepth maximum number of frames waiting between two stages
+   * @param numThreads number of threads running the stages, or 0 for one
+   *                   per stage up to the number of hardware threads
+   */
+  PipelinedVisionRunnerBase(std::string_view name, cs::VideoSource videoSource,
+                            int queueDepth, int numThreads);
+
+  virtual ~PipelinedVisionRunnerBase();
+
+  PipelinedVisionRunnerBase(const PipelinedVisionRunnerBase&) = delete;
+  PipelinedVisionRunnerBase& operator=(const PipelinedVisionRunnerBase&) =
+      delete;
+
+  /**
+   * Starts the capture and worker threads. Stages must be added before this
+   * is called.
+   */
+  void Start();
+
+  /**
+   * Stops and joins the capture and worker threads. Frames still in the
+   * pipeline are discarded.
+   */
+  void Stop();
+
+ protected:
+  void AddStageBase(std::string_view name,
+                    std::function<void(VisionFrameBase&)> process);
+
+  virtual std::unique_ptr<VisionFrameBase> MakeFrame() = 0;
+  virtual void DoResult(VisionFrameBase& frame) = 0;
+
+ private:
+  struct LatencyStats;
+  struct Stage;
+  struct Statistics;
+
+  void CaptureMain();
+  void WorkerMain();
+  size_t FindRunnableStage() const;
+  std::unique_ptr<VisionFrameBase> GetFreeFrame();
+  void ReleaseFrame(std::unique_ptr<VisionFrameBase> frame);
+
+  std::string m_name;
+  cs::CvSink m_cvSink;
+  size_t m_queueDepth;
+  int m_numThreads;
+  std::atomic_bool m_active{false};
+
+  // the built-in grayscale conversion stage is first; the stage queues are
+  // protected by m_mutex
+  std::vector<std::unique_ptr<Stage>> m_stages;
+  std::unique_ptr<Statistics> m_stats;
+  std::thread m_captureThread;
+  std::vector<std::thread> m_workers;
+  wpi::mutex m_mutex;
+  wpi::condition_variable m_cond;
+
+  wpi::mutex m_freeMutex;
+  std::vector<std::unique_ptr<VisionFrameBase>> m_freeFrames;
+};
+
+/**
+ * A vision runner that overlaps the steps of a vision pipeline across
+ * threads. Capture runs on its own thread. Grayscale conversion and each
+ * stage added with AddStage() (e.g. tag detection, then pose estimation) run
+ * on a fixed pool of worker threads, so a new frame can be captured and
+ * processed while the previous one is still in a later stage. Each stage
+ * processes one frame at a time, in capture order, so stages need not be
+ * thread safe. Stages are connected by bounded queues; when the first queue
+ * is full, the oldest waiting frame is dropped so the pipeline always works
+ * on recent frames.
+ *
+ * After the last stage, the listener is called with the frame, which carries
+ * its capture time and the data set by the stages.
+ *
+ * Per-stage latency histograms are published to NetworkTables under
+ * /VisionRunner/{name}/{stage}.
+ *
+ * @see VisionRunner
+ */
+template <typename T>
+class PipelinedVisionRunner : public PipelinedVisionRunnerBase {
+ public:
+  using Frame = VisionFrame<T>;
+
+  PipelinedVisionRunner(std::string_view name, cs::VideoSource videoSource,
+                        std::function<void(Frame&)> listener,
+                        int queueDepth = 1, int numThreads = 0);
+  ~PipelinedVisionRunner() override;
+
+  /**
+   * Adds a stage to the end of the pipeline. Must be called before Start().
+   *
+   * @param name stage name, used for the NetworkTables statistics
+   * @param process function to run on each frame
+   */
+  void AddStage(std::string_view name, std::function<void(Frame&)> process);
+
+ protected:
+  std::unique_ptr<VisionFrameBase> MakeFrame() override;
+  void DoResult(VisionFrameBase& frame) override;
+
+ private:
+  std::function<void(Frame&)> m_listener;
+};
+
+}  // namespace frc
+
+#include "PipelinedVisionRunner.inc"
@@ -0,0 +1,85 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <opencv2/core/core.hpp>
+#include <wpi/condition_variable.h>
+#include <wpi/mutex.h>
+
+#include "cscore_cv.h"
+#include "vision/PipelinedVisionRunner.h"
+
+namespace {
+struct Result {
+  uint64_t sequence;
+  int value;
+  int grayChannels;
+};
+}  // namespace
+
+TEST(PipelinedVisionRunnerTest, TwoStages) {
+  {
+    cs::CvSource source{"source", cs::VideoMode::kBGR, 32, 24, 30};
+
+    wpi::mutex mutex;
+    wpi::condition_variable cond;
+    std::vector<Result> results;
+    std::atomic_int running{0};
+    std::atomic_int maxRunning{0};
+
+    // each stage may only run on one thread at a time
+    auto enter = [&] {
+      int n = ++running;
+      int prev = maxRunning;
+      while (n > prev && !maxRunning.compare_exchange_weak(prev, n)) {
+      }
+    };
+
+    frc::PipelinedVisionRunner<int> runner{
+        "test", source,
+        [&](auto& frame) {
+          std::scoped_lock lock{mutex};
+          results.push_back(
+              {frame.sequence, frame.data, frame.gray.channels()});
+          cond.notify_all();
+        },
+        1, 2};
+    runner.AddStage("double", [&](auto& frame) {
+      enter();
+      frame.data = static_cast<int>(frame.sequence) * 2;
+      std::this_thread::sleep_for(std::chrono::milliseconds(2));
+      --running;
+    });
+    runner.AddStage("increment", [&](auto& frame) { ++frame.data; });
+    runner.Start();
+
+    // feed frames until enough have made it through the pipeline
+    cv::Mat image{24, 32, CV_8UC3, cv::Scalar{10, 20, 30}};
+    std::unique_lock lock{mutex};
+    for (int i = 0; i < 500 && results.size() < 10; ++i) {
+      lock.unlock();
+      source.PutFrame(image);
+      lock.lock();
+      cond.wait_for(lock, std::chrono::milliseconds(10));
+    }
+    lock.unlock();
+    runner.Stop();
+
+    ASSERT_GE(results.size(), 10u);
+    uint64_t prev = 0;
+    for (auto&& result : results) {
+      EXPECT_GT(result.sequence, prev);
+      EXPECT_EQ(result.value, static_cast<int>(result.sequence) * 2 + 1);
+      EXPECT_EQ(result.grayChannels, 1);
+      prev = result.sequence;
+    }
+    EXPECT_EQ(maxRunning, 1);
+  }
+  cs::Shutdown();
+}
@@ -279,6 +279,9 @@ public class CameraServerJNI {
 
   public static native void setSinkEnabled(int sink, boolean enabled);
 
+  public static native void setSinkRegion(
+      int sink, int x, int y, int width, int height, int decimation);
+
   //
   // Listener Functions
   //
@@ -307,7 +310,27 @@ public class CameraServerJNI {
     /** kSourceBytesReceived. */
     kSourceBytesReceived(1),
     /** kSourceFramesReceived. */
-    kSourceFramesReceived(2);
+    kSourceFramesReceived(2),
+    /** kSourceConversionHits. */
+    kSourceConversionHits(3),
+    /** kSourceConversionMisses. */
+    kSourceConversionMisses(4),
+    /** kSourceConversionTime (microseconds). */
+    kSourceConversionTime(5),
+    /** kSourcePoolHits. */
+    kSourcePoolHits(6),
+    /** kSourcePoolMisses. */
+    kSourcePoolMisses(7),
+    /** kSourcePoolPeakBytes. */
+    kSourcePoolPeakBytes(8),
+    /** kSourceFramesDropped. */
+    kSourceFramesDropped(9),
+    /** kSourceEncodeTime (microseconds). */
+    kSourceEncodeTime(10),
+    /** kSinkFramesReceived. */
+    kSinkFramesReceived(11),
+    /** kSinkLatencyTime (microseconds). */
+    kSinkLatencyTime(12);
 
     private final int value;
 
@@ -336,6 +359,22 @@ public class CameraServerJNI {
     return getTelemetryAverageValue(handle, kind.getValue());
   }
 
+  /**
+   * Upper bounds of the sink latency histogram buckets, in milliseconds. The last histogram bucket
+   * counts everything above the last bound.
+   */
+  public static final double[] kLatencyHistogramBucketsMs = {1, 2, 5, 10, 20, 50, 100, 200, 500};
+
+  /**
+   * Get the histogram of latencies from frame capture to a sink.
+   *
+   * @param sink Sink handle
+   * @return Frame counts over the telemetry period, one per bucket of {@link
+   *     #kLatencyHistogramBucketsMs} plus one for longer latencies. All counts are 0 if no frames
+   *     were received.
+   */
+  public static native long[] getTelemetryLatencyHistogram(int sink);
+
   //
   // Logging Functions
   //
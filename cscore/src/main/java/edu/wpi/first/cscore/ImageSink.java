@@ -37,4 +37,23 @@ public abstract class ImageSink extends VideoSink {
   public void setEnabled(boolean enabled) {
     CameraServerJNI.setSinkEnabled(m_handle, enabled);
   }
+
+  /**
+   * Set the region of interest of grabbed frames. Frames are cropped to the rectangle (in source
+   * frame coordinates), then reduced by averaging decimation x decimation blocks of pixels. The
+   * crop and decimation are done in the first conversion pass, so later processing only touches
+   * the region. If every sink enabled on a USB camera requests the same rectangle and the camera
+   * supports it, the camera crops in hardware. Regions are not supported for the MJPEG, YUYV, and
+   * UYVY pixel formats: on a CvSink with one of those formats this throws, as does a RawSink grab
+   * requesting one.
+   *
+   * @param x Left edge.
+   * @param y Top edge.
+   * @param width Width, or 0 to extend to the right edge.
+   * @param height Height, or 0 to extend to the bottom edge.
+   * @param decimation Binning factor (1 for none).
+   */
+  public void setRegion(int x, int y, int width, int height, int decimation) {
+    CameraServerJNI.setSinkRegion(m_handle, x, y, width, height, decimation);
+  }
 }
@@ -96,4 +96,17 @@ public class MjpegServer extends VideoSink {
     CameraServerJNI.setProperty(
         CameraServerJNI.getSinkProperty(m_handle, "default_compression"), quality);
   }
+
+  /**
+   * Serve newly connected stream clients from the shared event loop instead of a thread per client.
+   * Each frame is then compressed once per distinct client setting (at most four; further clients
+   * share the closest one), and clients that fall behind skip frames rather than delaying others.
+   * Has no effect on Windows.
+   *
+   * @param enabled true to enable
+   */
+  public void setEventLoop(boolean enabled) {
+    CameraServerJNI.setProperty(
+        CameraServerJNI.getSinkProperty(m_handle, "event_loop"), enabled ? 1 : 0);
+  }
 }
@@ -18,7 +18,9 @@ public class VideoSink implements AutoCloseable {
     /** CV video sink. */
     kCv(4),
     /** Raw video sink. */
-    kRaw(8);
+    kRaw(8),
+    /** Shared memory video sink. */
+    kShm(16);
 
     private final int value;
 
@@ -43,6 +45,8 @@ public class VideoSink implements AutoCloseable {
         return Kind.kMjpeg;
       case 4:
         return Kind.kCv;
+      case 16:
+        return Kind.kShm;
       default:
         return Kind.kUnknown;
     }
@@ -116,6 +120,44 @@ public class VideoSink implements AutoCloseable {
     return CameraServerJNI.getSinkDescription(m_handle);
   }
 
+  /**
+   * Get the average latency from frame capture to this sink.
+   *
+   * <p>CameraServerJNI#setTelemetryPeriod() must be called for this to be valid.
+   *
+   * @return Latency in seconds averaged over the telemetry period, or 0 if no frames were
+   *     received.
+   */
+  public double getAverageLatency() {
+    // the frame counters are not set (CS_EMPTY_VALUE) if no frames were received
+    long received = 0;
+    for (long count : CameraServerJNI.getTelemetryLatencyHistogram(m_handle)) {
+      received += count;
+    }
+    if (received == 0) {
+      return 0.0;
+    }
+    long frames =
+        CameraServerJNI.getTelemetryValue(
+            m_handle, CameraServerJNI.TelemetryKind.kSinkFramesReceived);
+    return CameraServerJNI.getTelemetryValue(
+            m_handle, CameraServerJNI.TelemetryKind.kSinkLatencyTime)
+        / (frames * 1.0e6);
+  }
+
+  /**
+   * Get the histogram of latencies from frame capture to this sink.
+   *
+   * <p>CameraServerJNI#setTelemetryPeriod() must be called for this to be valid.
+   *
+   * @return Frame counts over the telemetry period, one per bucket of {@link
+   *     CameraServerJNI#kLatencyHistogramBucketsMs} plus one for longer latencies. All counts are 0
+   *     if no frames were received.
+   */
+  public long[] getLatencyHistogram() {
+    return CameraServerJNI.getTelemetryLatencyHistogram(m_handle);
+  }
+
   /**
    * Get a property of the sink.
    *
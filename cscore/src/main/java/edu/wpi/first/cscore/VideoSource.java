@@ -21,7 +21,9 @@ public class VideoSource implements AutoCloseable {
     /** CV video source. */
     kCv(4),
     /** Raw video source. */
-    kRaw(8);
+    kRaw(8),
+    /** Shared memory video source. */
+    kShm(16);
 
     private final int value;
 
@@ -75,6 +77,8 @@ public class VideoSource implements AutoCloseable {
         return Kind.kHttp;
       case 4:
         return Kind.kCv;
+      case 16:
+        return Kind.kShm;
       default:
         return Kind.kUnknown;
     }
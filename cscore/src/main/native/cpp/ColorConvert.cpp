@@ -0,0 +1,196 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include "ColorConvert.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CS_CVT_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define CS_CVT_NEON 1
+#include <arm_neon.h>
+#endif
+
+using namespace cs;
+
+// Extracts every other byte starting at offset (0 for YUYV, 1 for UYVY)
+template <int offset>
+static void PackedToGray(const uint8_t* src, uint8_t* dst, size_t pixels) {
+  size_t i = 0;
+#if defined(CS_CVT_SSE2)
+  const __m128i mask = _mm_set1_epi16(0x00ff);
+  for (; i + 16 <= pixels; i += 16) {
+    __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 2));
+    __m128i b =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 2 + 16));
+    if constexpr (offset == 0) {
+      a = _mm_and_si128(a, mask);
+      b = _mm_and_si128(b, mask);
+    } else {
+      a = _mm_srli_epi16(a, 8);
+      b = _mm_srli_epi16(b, 8);
+    }
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i),
+                     _mm_packus_epi16(a, b));
+  }
+#elif defined(CS_CVT_NEON)
+  for (; i + 16 <= pixels; i += 16) {
+    uint8x16x2_t v = vld2q_u8(src + i * 2);
+    vst1q_u8(dst + i, v.val[offset]);
+  }
+#endif
+  for (; i < pixels; ++i) {
+    dst[i] = src[i * 2 + offset];
+  }
+}
+
+void cvt::YUYVToGray(const uint8_t* src, uint8_t* dst, size_t pixels) {
+  PackedToGray<0>(src, dst, pixels);
+}
+
+void cvt::UYVYToGray(const uint8_t* src, uint8_t* dst, size_t pixels) {
+  PackedToGray<1>(src, dst, pixels);
+}
+
+void cvt::GrayToY16(const uint8_t* src, uint16_t* dst, size_t pixels) {
+  size_t i = 0;
+#if defined(CS_CVT_SSE2)
+  const __m128i zero = _mm_setzero_si128();
+  for (; i + 16 <= pixels; i += 16) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    // interleaving zero as the low byte multiplies by 256
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i),
+                     _mm_unpacklo_epi8(zero, v));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 8),
+                     _mm_unpackhi_epi8(zero, v));
+  }
+#elif defined(CS_CVT_NEON)
+  for (; i + 16 <= pixels; i += 16) {
+    uint8x16_t v = vld1q_u8(src + i);
+    vst1q_u16(dst + i, vshll_n_u8(vget_low_u8(v), 8));
+    vst1q_u16(dst + i + 8, vshll_n_u8(vget_high_u8(v), 8));
+  }
+#endif
+  for (; i < pixels; ++i) {
+    dst[i] = static_cast<uint16_t>(src[i] << 8);
+  }
+}
+
+namespace {
+// Source sample index and interpolation weight along one axis
+struct ResizeTap {
+  int index;
+  int weight;  // weight of index + 1, out of kResizeOne
+};
+}  // namespace
+
+static constexpr int kResizeBits = 11;
+static constexpr int kResizeOne = 1 << kResizeBits;
+
+// Uses the pixel center mapping of cv::resize() with INTER_LINEAR
+static std::vector<ResizeTap> ComputeTaps(int srcSize, int dstSize) {
+  std::vector<ResizeTap> taps(dstSize);
+  double scale = static_cast<double>(srcSize) / dstSize;
+  for (int i = 0; i < dstSize; ++i) {
+    double f = (i + 0.5) * scale - 0.5;
+    int index = static_cast<int>(std::floor(f));
+    f -= index;
+    if (index < 0) {
+      index = 0;
+      f = 0;
+    }
+    if (index >= srcSize - 1) {
+      index = srcSize - 1;
+      f = 0;
+    }
+    taps[i] = {index, static_cast<int>(std::lround(f * kResizeOne))};
+  }
+  return taps;
+}
+
+void cvt::ResizeGray(const uint8_t* src, int srcWidth, int srcHeight,
+                     int srcStep, size_t srcStride, uint8_t* dst, int width,
+                     int height) {
+  auto xtaps = ComputeTaps(srcWidth, width);
+  auto ytaps = ComputeTaps(srcHeight, height);
+
+  // horizontally interpolated source rows; consecutive output rows usually
+  // share a source row, so keep the last two around
+  std::vector<int> rows[2] = {std::vector<int>(width),
+                              std::vector<int>(width)};
+  int rowIndex[2] = {-1, -1};
+  auto interpolateRow = [&](int sy, std::vector<int>& out) {
+    const uint8_t* row = src + sy * srcStride;
+    for (int x = 0; x < width; ++x) {
+      const ResizeTap& tap = xtaps[x];
+      int next = std::min(tap.index + 1, srcWidth - 1);
+      out[x] = row[tap.index * srcStep] * (kResizeOne - tap.weight) +
+               row[next * srcStep] * tap.weight;
+    }
+  };
+
+  for (int y = 0; y < height; ++y) {
+    const ResizeTap& tap = ytaps[y];
+    int sy[2] = {tap.index, std::min(tap.index + 1, srcHeight - 1)};
+    if (rowIndex[0] != sy[0] && rowIndex[1] == sy[0]) {
+      std::swap(rows[0], rows[1]);
+      std::swap(rowIndex[0], rowIndex[1]);
+    }
+    for (int j = 0; j < 2; ++j) {
+      if (rowIndex[j] != sy[j]) {
+        if (j == 1 && sy[1] == sy[0]) {
+          rows[1] = rows[0];
+        } else {
+          interpolateRow(sy[j], rows[j]);
+        }
+        rowIndex[j] = sy[j];
+      }
+    }
+
+    const int* r0 = rows[0].data();
+    const int* r1 = rows[1].data();
+    int w0 = kResizeOne - tap.weight;
+    int w1 = tap.weight;
+    uint8_t* out = dst + static_cast<size_t>(y) * width;
+    for (int x = 0; x < width; ++x) {
+      out[x] = static_cast<uint8_t>(
+          (r0[x] * w0 + r1[x] * w1 + (1 << (2 * kResizeBits - 1))) >>
+          (2 * kResizeBits));
+    }
+  }
+}
+
+void cvt::Bin(const uint8_t* src, size_t srcStride, int srcStep, int channels,
+              uint8_t* dst, int width, int height, int factor) {
+  int rowSize = width * channels;
+  int area = factor * factor;
+  // per channel block sums for one row of output
+  std::vector<int> sums(rowSize);
+  for (int y = 0; y < height; ++y) {
+    std::fill(sums.begin(), sums.end(), 0);
+    for (int dy = 0; dy < factor; ++dy) {
+      const uint8_t* row = src + (static_cast<size_t>(y) * factor + dy) *
+                                     srcStride;
+      for (int x = 0; x < width; ++x) {
+        const uint8_t* pixel = row + static_cast<size_t>(x) * factor * srcStep;
+        int* sum = &sums[x * channels];
+        for (int dx = 0; dx < factor; ++dx, pixel += srcStep) {
+          for (int c = 0; c < channels; ++c) {
+            sum[c] += pixel[c];
+          }
+        }
+      }
+    }
+    uint8_t* out = dst + static_cast<size_t>(y) * rowSize;
+    for (int i = 0; i < rowSize; ++i) {
+      out[i] = static_cast<uint8_t>((sums[i] + area / 2) / area);
+    }
+  }
+}
@@ -0,0 +1,70 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#ifndef CSCORE_COLORCONVERT_H_
+#define CSCORE_COLORCONVERT_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Pixel format conversion kernels used by Frame.
+ *
+ * These operate on tightly packed images of the given number of pixels and
+ * produce the same results as the equivalent OpenCV conversions (to within
+ * rounding), without allocating intermediate matrices.  Only luma
+ * extraction, widening to Y16, and resizing or binning luma straight from
+ * packed YUV are done here; other conversions use cv::cvtColor(), which is
+ * already vectorized.  The ColorConvertTest benchmark compares these kernels
+ * against OpenCV.  The byte shuffling conversions use SSE2 or NEON where
+ * available.
+ */
+namespace cs::cvt {
+
+void YUYVToGray(const uint8_t* src, uint8_t* dst, size_t pixels);
+void UYVYToGray(const uint8_t* src, uint8_t* dst, size_t pixels);
+
+void GrayToY16(const uint8_t* src, uint16_t* dst, size_t pixels);
+
+/**
+ * Bilinear resize of a single 8-bit channel into a grayscale image.
+ *
+ * The source channel may be interleaved with others (e.g. the luma of a YUYV
+ * image), so YUYV and UYVY images can be resized to grayscale in one pass.
+ *
+ * @param src first source sample
+ * @param srcWidth source width in pixels
+ * @param srcHeight source height in pixels
+ * @param srcStep bytes between horizontally adjacent samples
+ * @param srcStride bytes between vertically adjacent samples
+ * @param dst destination image (width * height bytes)
+ * @param width destination width
+ * @param height destination height
+ */
+void ResizeGray(const uint8_t* src, int srcWidth, int srcHeight, int srcStep,
+                size_t srcStride, uint8_t* dst, int width, int height);
+
+/**
+ * Box filter downscale by an integer factor: each destination pixel is the
+ * rounded average of a factor x factor block of source pixels, per channel.
+ *
+ * As with ResizeGray(), source pixels may be interleaved with other data, so
+ * the luma of a YUYV or UYVY region can be binned in one pass.
+ *
+ * @param src first channel of the first source pixel
+ * @param srcStride bytes between vertically adjacent pixels
+ * @param srcStep bytes between horizontally adjacent pixels
+ * @param channels 8-bit channels per pixel (adjacent bytes)
+ * @param dst destination image (width * height * channels bytes)
+ * @param width destination width
+ * @param height destination height
+ * @param factor binning factor; the source region is width * factor by
+ *               height * factor pixels
+ */
+void Bin(const uint8_t* src, size_t srcStride, int srcStep, int channels,
+         uint8_t* dst, int width, int height, int factor);
+
+}  // namespace cs::cvt
+
+#endif  // CSCORE_COLORCONVERT_H_
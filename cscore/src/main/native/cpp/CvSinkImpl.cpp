@@ -4,10 +4,17 @@
 
 #include "CvSinkImpl.h"
 
+#include <memory>
+#include <vector>
+
 #include <opencv2/core/core.hpp>
 #include <opencv2/highgui/highgui.hpp>
 #include <opencv2/imgproc/imgproc.hpp>
 #include <wpi/SmallString.h>
+#include <wpi/SmallVector.h>
+#include <wpi/Synchronization.h>
+#include <wpi/scope>
+#include <wpi/timestamp.h>
 
 #include "Handle.h"
 #include "Instance.h"
@@ -67,11 +74,12 @@ uint64_t CvSinkImpl::GrabFrame(cv::Mat& image) {
     return 0;  // signal error
   }
 
-  if (!frame.GetCv(image, m_pixelFormat)) {
+  if (!frame.GetCv(image, GetRegion(), m_pixelFormat)) {
     // Shouldn't happen, but just in case...
     std::this_thread::sleep_for(std::chrono::milliseconds(20));
     return 0;
   }
+  RecordFrameLatency(frame);
 
   return frame.GetTime();
 }
@@ -93,15 +101,132 @@ uint64_t CvSinkImpl::GrabFrame(cv::Mat& image, double timeout) {
     return 0;  // signal error
   }
 
-  if (!frame.GetCv(image, m_pixelFormat)) {
+  if (!frame.GetCv(image, GetRegion(), m_pixelFormat)) {
     // Shouldn't happen, but just in case...
     std::this_thread::sleep_for(std::chrono::milliseconds(20));
     return 0;
   }
+  RecordFrameLatency(frame);
 
   return frame.GetTime();
 }
 
+// Number of recent frames per sink considered when synchronizing
+static constexpr size_t kSyncHistory = 4;
+
+using SyncHistory = wpi::SmallVector<Frame, kSyncHistory>;
+
+// Finds the newest set of frames, one per sink, whose times all fall within
+// tolerance of the oldest frame in the set.  Sets match[i] to the index of
+// the chosen frame in history[i].
+static bool FindSyncMatch(std::span<SyncHistory> history, uint64_t tolerance,
+                          std::span<size_t> match) {
+  bool found = false;
+  uint64_t bestStart = 0;
+  wpi::SmallVector<size_t, 4> candidate(history.size());
+  for (auto&& anchors : history) {
+    for (auto&& anchor : anchors) {
+      uint64_t start = anchor.GetTime();
+      if (found && start <= bestStart) {
+        continue;
+      }
+      // every sink needs a frame in [start, start + tolerance]; prefer the
+      // newest
+      bool ok = true;
+      for (size_t i = 0; ok && i < history.size(); ++i) {
+        ok = false;
+        for (size_t j = 0; j < history[i].size(); ++j) {
+          uint64_t time = history[i][j].GetTime();
+          if (time >= start && time - start <= tolerance) {
+            candidate[i] = j;
+            ok = true;
+          }
+        }
+      }
+      if (ok) {
+        found = true;
+        bestStart = start;
+        std::copy(candidate.begin(), candidate.end(), match.begin());
+      }
+    }
+  }
+  return found;
+}
+
+uint64_t CvSinkImpl::GrabFramesSynchronized(
+    std::span<CvSinkImpl* const> sinks, std::span<cv::Mat> images,
+    double tolerance, double timeout) {
+  // Queue every new frame from every source
+  wpi::Event event;
+  std::vector<FrameQueue> queues(
+      sinks.size(), FrameQueue{event.GetHandle(), kSyncHistory, {}});
+  std::vector<std::shared_ptr<SourceImpl>> sources;
+  sources.reserve(sinks.size());
+  wpi::scope_exit unregister{[&] {
+    for (size_t i = 0; i < sources.size(); ++i) {
+      sources[i]->RemoveFrameQueue(&queues[i]);
+    }
+  }};
+  for (size_t i = 0; i < sinks.size(); ++i) {
+    sinks[i]->SetEnabled(true);
+    auto source = sinks[i]->GetSource();
+    if (!source) {
+      // Source disconnected; sleep for one second
+      std::this_thread::sleep_for(std::chrono::seconds(1));
+      return 0;
+    }
+    source->AddFrameQueue(&queues[i]);
+    sources.emplace_back(std::move(source));
+  }
+
+  auto toleranceUs = static_cast<uint64_t>(tolerance * 1e6);
+  auto deadline = wpi::Now() + static_cast<uint64_t>(timeout * 1e6);
+  std::vector<SyncHistory> history(sinks.size());
+  wpi::SmallVector<size_t, 4> match(sinks.size());
+  SyncHistory received;
+  for (;;) {
+    // Collect new frames; the oldest unmatched frames are dropped once a
+    // sink's history is full
+    for (size_t i = 0; i < sinks.size(); ++i) {
+      received.clear();
+      sources[i]->TakeFrames(&queues[i], received);
+      auto& frames = history[i];
+      for (auto&& frame : received) {
+        if (!frame || frame.GetTime() <= sinks[i]->m_syncTime ||
+            (!frames.empty() && frame.GetTime() <= frames.back().GetTime())) {
+          continue;
+        }
+        if (frames.size() == kSyncHistory) {
+          frames.erase(frames.begin());
+        }
+        frames.emplace_back(std::move(frame));
+      }
+    }
+
+    if (FindSyncMatch(history, toleranceUs, match)) {
+      for (size_t i = 0; i < sinks.size(); ++i) {
+        Frame& frame = history[i][match[i]];
+        if (!frame.GetCv(images[i], sinks[i]->GetRegion(),
+                         sinks[i]->m_pixelFormat)) {
+          return 0;
+        }
+        sinks[i]->m_syncTime = frame.GetTime();
+        sinks[i]->RecordFrameLatency(frame);
+      }
+      return history[0][match[0]].GetTime();
+    }
+
+    // Wait for any source to produce a frame
+    uint64_t now = wpi::Now();
+    if (now >= deadline) {
+      return 0;
+    }
+    bool timedOut;
+    wpi::WaitForObject(event.GetHandle(), (deadline - now) * 1.0e-6,
+                       &timedOut);
+  }
+}
+
 // Send HTTP response and a stream of JPG-frames
 void CvSinkImpl::ThreadMain() {
   Enable();
@@ -179,6 +304,29 @@ uint64_t GrabSinkFrameTimeout(CS_Sink sink, cv::Mat& image, double timeout,
   return static_cast<CvSinkImpl&>(*data->sink).GrabFrame(image, timeout);
 }
 
+uint64_t GrabSinkFramesSynchronized(std::span<const CS_Sink> sinks,
+                                    std::span<cv::Mat> images,
+                                    double tolerance, double timeout,
+                                    CS_Status* status) {
+  if (sinks.empty() || images.size() < sinks.size()) {
+    *status = CS_INVALID_HANDLE;
+    return 0;
+  }
+  // keep the sinks alive while waiting
+  wpi::SmallVector<std::shared_ptr<SinkImpl>, 4> refs;
+  wpi::SmallVector<CvSinkImpl*, 4> impls;
+  for (auto sink : sinks) {
+    auto data = Instance::GetInstance().GetSink(sink);
+    if (!data || data->kind != CS_SINK_CV) {
+      *status = CS_INVALID_HANDLE;
+      return 0;
+    }
+    impls.emplace_back(static_cast<CvSinkImpl*>(data->sink.get()));
+    refs.emplace_back(data->sink);
+  }
+  return CvSinkImpl::GrabFramesSynchronized(impls, images, tolerance, timeout);
+}
+
 std::string GetSinkError(CS_Sink sink, CS_Status* status) {
   auto data = Instance::GetInstance().GetSink(sink);
   if (!data || (data->kind & SinkMask) == 0) {
@@ -207,6 +355,28 @@ void SetSinkEnabled(CS_Sink sink, bool enabled, CS_Status* status) {
   static_cast<CvSinkImpl&>(*data->sink).SetEnabled(enabled);
 }
 
+void SetSinkRegion(CS_Sink sink, int x, int y, int width, int height,
+                   int decimation, CS_Status* status) {
+  auto data = Instance::GetInstance().GetSink(sink);
+  if (!data || (data->kind & SinkMask) == 0) {
+    *status = CS_INVALID_HANDLE;
+    return;
+  }
+  if (x < 0 || y < 0 || width < 0 || height < 0 || decimation < 1) {
+    *status = CS_UNSUPPORTED_MODE;
+    return;
+  }
+  ImageRegion region{x, y, width, height, decimation};
+  // a raw sink picks its format per grab, so that is checked in GrabFrame
+  if (data->kind == CS_SINK_CV && !region.IsFull() &&
+      !ImageRegion::SupportsPixelFormat(
+          static_cast<CvSinkImpl&>(*data->sink).GetPixelFormat())) {
+    *status = CS_UNSUPPORTED_MODE;
+    return;
+  }
+  data->sink->SetRegion(region);
+}
+
 }  // namespace cs
 
 extern "C" {
@@ -267,4 +437,9 @@ void CS_SetSinkEnabled(CS_Sink sink, CS_Bool enabled, CS_Status* status) {
   return cs::SetSinkEnabled(sink, enabled, status);
 }
 
+void CS_SetSinkRegion(CS_Sink sink, int x, int y, int width, int height,
+                      int decimation, CS_Status* status) {
+  return cs::SetSinkRegion(sink, x, y, width, height, decimation, status);
+}
+
 }  // extern "C"
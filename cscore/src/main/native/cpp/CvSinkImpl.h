@@ -9,6 +9,7 @@
 
 #include <atomic>
 #include <functional>
+#include <span>
 #include <string_view>
 #include <thread>
 
@@ -33,9 +34,18 @@ class CvSinkImpl : public SinkImpl {
 
   void Stop();
 
+  VideoMode::PixelFormat GetPixelFormat() const { return m_pixelFormat; }
+
   uint64_t GrabFrame(cv::Mat& image);
   uint64_t GrabFrame(cv::Mat& image, double timeout);
 
+  // Waits for one frame from each sink with all frame times within tolerance
+  // seconds of each other.  Returns the first sink's frame time, or 0 on
+  // timeout or error.
+  static uint64_t GrabFramesSynchronized(std::span<CvSinkImpl* const> sinks,
+                                         std::span<cv::Mat> images,
+                                         double tolerance, double timeout);
+
  private:
   void ThreadMain();
 
@@ -43,6 +53,8 @@ class CvSinkImpl : public SinkImpl {
   std::thread m_thread;
   std::function<void(uint64_t time)> m_processFrame;
   VideoMode::PixelFormat m_pixelFormat;
+  // time of the last frame returned by GrabFramesSynchronized()
+  uint64_t m_syncTime{0};
 };
 
 }  // namespace cs
@@ -4,30 +4,108 @@
 
 #include "Frame.h"
 
+#include <algorithm>
 #include <cstdlib>
+#include <vector>
 
 #include <opencv2/core/core.hpp>
 #include <opencv2/highgui/highgui.hpp>
 #include <opencv2/imgproc/imgproc.hpp>
+#include <wpi/timestamp.h>
 
+#include "ColorConvert.h"
 #include "Instance.h"
 #include "Log.h"
 #include "SourceImpl.h"
+#include "Telemetry.h"
 
 using namespace cs;
 
+// Views of image data for the cvt kernels
+static uint8_t* Bytes(Image& image) {
+  return reinterpret_cast<uint8_t*>(image.data());
+}
+
+static uint16_t* Words(Image& image) {
+  return reinterpret_cast<uint16_t*>(image.data());
+}
+
+static size_t Pixels(const Image& image) {
+  return static_cast<size_t>(image.width) * image.height;
+}
+
+// Size of one dimension of a JPEG decoded with the given DCT scaling
+// denominator (libjpeg rounds up)
+static int JpegScaledSize(int size, int scale) {
+  return (size + scale - 1) / scale;
+}
+
+// Returns the largest JPEG DCT scaling denominator that still decodes to at
+// least width x height
+static int GetJpegScale(int srcWidth, int srcHeight, int width, int height) {
+  for (int scale = 8; scale > 1; scale /= 2) {
+    if (JpegScaledSize(srcWidth, scale) >= width &&
+        JpegScaledSize(srcHeight, scale) >= height) {
+      return scale;
+    }
+  }
+  return 1;
+}
+
+// Nesting depth of conversions on this thread.  MJPEG decodes and region
+// conversions recurse into GetImageImpl(); only the outermost conversion adds
+// to the frame's conversion time and to the conversion telemetry so nested
+// work (and nested cache hits) is not counted twice.
+static thread_local int gConversionDepth = 0;
+
+// Bins a region of an image with 8-bit channels into dst.  Only the luma of
+// YUYV and UYVY images is used.
+static void BinRegion(Image& src, const ImageRegion& region, Image& dst) {
+  int channels = src.pixelFormat == VideoMode::kBGR ? 3 : 1;
+  int step = src.GetStride() / src.width;
+  int offset = src.pixelFormat == VideoMode::kUYVY ? 1 : 0;
+  size_t stride = src.GetStride();
+  cvt::Bin(Bytes(src) + region.y * stride + region.x * step + offset, stride,
+           step, channels, Bytes(dst), dst.width, dst.height,
+           region.decimation);
+}
+
+// Packs a GetImage() request into a conversion cache key.  Only the low 48
+// bits are used, which keeps keys clear of the DenseMap sentinel values.
+static uint64_t MakeConversionKey(int width, int height,
+                                  VideoMode::PixelFormat pixelFormat,
+                                  int jpegQuality) {
+  return (static_cast<uint64_t>(width & 0xffff) << 32) |
+         (static_cast<uint64_t>(height & 0xffff) << 16) |
+         (static_cast<uint64_t>(pixelFormat & 0xff) << 8) |
+         static_cast<uint64_t>((jpegQuality + 1) & 0xff);
+}
+
 Frame::Frame(SourceImpl& source, std::string_view error, Time time)
     : m_impl{source.AllocFrameImpl().release()} {
   m_impl->refcount = 1;
   m_impl->error = error;
   m_impl->time = time;
+  m_impl->captureTime = time;
+  m_impl->timeSource = CS_TIMESRC_UNKNOWN;
+  m_impl->conversionTime = 0;
+  m_impl->encodeTime = 0;
+  m_impl->originX = 0;
+  m_impl->originY = 0;
 }
 
-Frame::Frame(SourceImpl& source, std::unique_ptr<Image> image, Time time)
+Frame::Frame(SourceImpl& source, std::unique_ptr<Image> image, Time time,
+             Time captureTime, CS_TimestampSource timeSource)
     : m_impl{source.AllocFrameImpl().release()} {
   m_impl->refcount = 1;
   m_impl->error.resize(0);
   m_impl->time = time;
+  m_impl->captureTime = captureTime;
+  m_impl->timeSource = timeSource;
+  m_impl->conversionTime = 0;
+  m_impl->encodeTime = 0;
+  m_impl->originX = 0;
+  m_impl->originY = 0;
   m_impl->images.push_back(image.release());
 }
 
@@ -328,42 +406,55 @@ Image* Frame::ConvertImpl(Image* image, VideoMode::PixelFormat pixelFormat,
   return cur;
 }
 
-Image* Frame::ConvertMJPEGToBGR(Image* image) {
-  if (!image || image->pixelFormat != VideoMode::kMJPEG) {
-    return nullptr;
-  }
-
-  // Allocate an BGR image
-  auto newImage =
-      m_impl->source.AllocImage(VideoMode::kBGR, image->width, image->height,
-                                image->width * image->height * 3);
-
-  // Decode
-  cv::Mat newMat = newImage->AsMat();
-  cv::imdecode(image->AsInputArray(), cv::IMREAD_COLOR, &newMat);
+Image* Frame::ConvertMJPEGToBGR(Image* image, int scale) {
+  return DecodeMJPEG(image, VideoMode::kBGR, scale);
+}
 
-  // Save the result
-  Image* rv = newImage.release();
-  if (m_impl) {
-    std::scoped_lock lock(m_impl->mutex);
-    m_impl->images.push_back(rv);
-  }
-  return rv;
+Image* Frame::ConvertMJPEGToGray(Image* image, int scale) {
+  return DecodeMJPEG(image, VideoMode::kGray, scale);
 }
 
-Image* Frame::ConvertMJPEGToGray(Image* image) {
+Image* Frame::DecodeMJPEG(Image* image, VideoMode::PixelFormat pixelFormat,
+                          int scale) {
   if (!image || image->pixelFormat != VideoMode::kMJPEG) {
     return nullptr;
   }
 
-  // Allocate an grayscale image
-  auto newImage =
-      m_impl->source.AllocImage(VideoMode::kGray, image->width, image->height,
-                                image->width * image->height);
-
-  // Decode
+  // Allocate an image of the size the decoder will produce
+  int width = JpegScaledSize(image->width, scale);
+  int height = JpegScaledSize(image->height, scale);
+  int channels = pixelFormat == VideoMode::kGray ? 1 : 3;
+  auto newImage = m_impl->source.AllocImage(pixelFormat, width, height,
+                                            width * height * channels);
+
+  // Decode; the reduced modes scale in the DCT domain, which skips most of
+  // the work of a full size decode
+  int flags;
+  switch (scale) {
+    case 2:
+      flags = channels == 1 ? cv::IMREAD_REDUCED_GRAYSCALE_2
+                            : cv::IMREAD_REDUCED_COLOR_2;
+      break;
+    case 4:
+      flags = channels == 1 ? cv::IMREAD_REDUCED_GRAYSCALE_4
+                            : cv::IMREAD_REDUCED_COLOR_4;
+      break;
+    case 8:
+      flags = channels == 1 ? cv::IMREAD_REDUCED_GRAYSCALE_8
+                            : cv::IMREAD_REDUCED_COLOR_8;
+      break;
+    default:
+      flags = channels == 1 ? cv::IMREAD_GRAYSCALE : cv::IMREAD_COLOR;
+      break;
+  }
   cv::Mat newMat = newImage->AsMat();
-  cv::imdecode(image->AsInputArray(), cv::IMREAD_GRAYSCALE, &newMat);
+  cv::Mat encoded{1, static_cast<int>(image->size()), CV_8UC1, Bytes(*image)};
+  cv::imdecode(encoded, flags, &newMat);
+  if (!newMat.empty() && newMat.data != Bytes(*newImage)) {
+    // the decoder reallocated because the size was not what we expected
+    cv::Mat dst = newImage->AsMat();
+    cv::resize(newMat, dst, dst.size(), 0, 0);
+  }
 
   // Save the result
   Image* rv = newImage.release();
@@ -407,7 +498,7 @@ Image* Frame::ConvertYUYVToGray(Image* image) {
                                 image->width * image->height);
 
   // Convert
-  cv::cvtColor(image->AsMat(), newImage->AsMat(), cv::COLOR_YUV2GRAY_YUYV);
+  cvt::YUYVToGray(Bytes(*image), Bytes(*newImage), Pixels(*image));
 
   // Save the result
   Image* rv = newImage.release();
@@ -451,7 +542,7 @@ Image* Frame::ConvertUYVYToGray(Image* image) {
                                 image->width * image->height);
 
   // Convert
-  cv::cvtColor(image->AsMat(), newImage->AsMat(), cv::COLOR_YUV2GRAY_UYVY);
+  cvt::UYVYToGray(Bytes(*image), Bytes(*newImage), Pixels(*image));
 
   // Save the result
   Image* rv = newImage.release();
@@ -557,7 +648,6 @@ Image* Frame::ConvertBGRToMJPEG(Image* image, int quality) {
   if (!m_impl) {
     return nullptr;
   }
-  std::scoped_lock lock(m_impl->mutex);
 
   // Allocate a JPEG image.  We don't actually know what the resulting size
   // will be; while the destination will automatically grow, doing so will
@@ -569,18 +659,18 @@ Image* Frame::ConvertBGRToMJPEG(Image* image, int quality) {
       m_impl->source.AllocImage(VideoMode::kMJPEG, image->width, image->height,
                                 image->width * image->height * 1.5);
 
-  // Compress
-  if (m_impl->compressionParams.empty()) {
-    m_impl->compressionParams.push_back(cv::IMWRITE_JPEG_QUALITY);
-    m_impl->compressionParams.push_back(quality);
-  } else {
-    m_impl->compressionParams[1] = quality;
-  }
-  cv::imencode(".jpg", image->AsMat(), newImage->vec(),
-               m_impl->compressionParams);
+  // Compress; the frame lock is not held so that other conversions of this
+  // frame can proceed in parallel
+  thread_local std::vector<int> compressionParams{cv::IMWRITE_JPEG_QUALITY,
+                                                  0};
+  compressionParams[1] = quality;
+  auto start = wpi::Now();
+  cv::imencode(".jpg", image->AsMat(), newImage->vec(), compressionParams);
+  RecordEncode(wpi::Now() - start);
 
   // Save the result
   Image* rv = newImage.release();
+  std::scoped_lock lock(m_impl->mutex);
   m_impl->images.push_back(rv);
   return rv;
 }
@@ -592,7 +682,6 @@ Image* Frame::ConvertGrayToMJPEG(Image* image, int quality) {
   if (!m_impl) {
     return nullptr;
   }
-  std::scoped_lock lock(m_impl->mutex);
 
   // Allocate a JPEG image.  We don't actually know what the resulting size
   // will be; while the destination will automatically grow, doing so will
@@ -604,18 +693,18 @@ Image* Frame::ConvertGrayToMJPEG(Image* image, int quality) {
       m_impl->source.AllocImage(VideoMode::kMJPEG, image->width, image->height,
                                 image->width * image->height * 0.75);
 
-  // Compress
-  if (m_impl->compressionParams.empty()) {
-    m_impl->compressionParams.push_back(cv::IMWRITE_JPEG_QUALITY);
-    m_impl->compressionParams.push_back(quality);
-  } else {
-    m_impl->compressionParams[1] = quality;
-  }
-  cv::imencode(".jpg", image->AsMat(), newImage->vec(),
-               m_impl->compressionParams);
+  // Compress; the frame lock is not held so that other conversions of this
+  // frame can proceed in parallel
+  thread_local std::vector<int> compressionParams{cv::IMWRITE_JPEG_QUALITY,
+                                                  0};
+  compressionParams[1] = quality;
+  auto start = wpi::Now();
+  cv::imencode(".jpg", image->AsMat(), newImage->vec(), compressionParams);
+  RecordEncode(wpi::Now() - start);
 
   // Save the result
   Image* rv = newImage.release();
+  std::scoped_lock lock(m_impl->mutex);
   m_impl->images.push_back(rv);
   return rv;
 }
@@ -631,7 +720,7 @@ Image* Frame::ConvertGrayToY16(Image* image) {
                                 image->width * image->height * 2);
 
   // Convert with linear scaling
-  image->AsMat().convertTo(newImage->AsMat(), CV_16U, 256);
+  cvt::GrayToY16(Bytes(*image), Words(*newImage), Pixels(*image));
 
   // Save the result
   Image* rv = newImage.release();
@@ -670,12 +759,54 @@ Image* Frame::GetImageImpl(int width, int height,
   if (!m_impl) {
     return nullptr;
   }
-  std::scoped_lock lock(m_impl->mutex);
+  auto& telemetry = Instance::GetInstance().telemetry;
+  uint64_t key =
+      MakeConversionKey(width, height, pixelFormat, requiredJpegQuality);
+
+  // Look up the request; if another thread is already converting it, wait for
+  // that result rather than converting it again.  Otherwise claim it.
+  {
+    std::unique_lock lock(m_impl->convertMutex);
+    auto [it, inserted] = m_impl->conversions.try_emplace(key);
+    if (!inserted) {
+      m_impl->convertCond.wait(
+          lock, [&] { return m_impl->conversions[key].done; });
+      Image* image = m_impl->conversions[key].image;
+      lock.unlock();
+      if (gConversionDepth == 0) {
+        telemetry.RecordSourceConversion(m_impl->source, true, 0);
+      }
+      return image;
+    }
+  }
+
   Image* cur = GetNearestImage(width, height, pixelFormat, requiredJpegQuality);
-  if (!cur || cur->Is(width, height, pixelFormat, requiredJpegQuality)) {
-    return cur;
+  if (cur && !cur->Is(width, height, pixelFormat, requiredJpegQuality)) {
+    ++gConversionDepth;
+    auto start = wpi::Now();
+    cur = ResizeAndConvertImpl(cur, width, height, pixelFormat,
+                               requiredJpegQuality, defaultJpegQuality);
+    int64_t elapsed = wpi::Now() - start;
+    if (--gConversionDepth == 0) {
+      m_impl->conversionTime += elapsed;
+      telemetry.RecordSourceConversion(m_impl->source, false, elapsed);
+    }
+  } else if (gConversionDepth == 0) {
+    telemetry.RecordSourceConversion(m_impl->source, true, 0);
   }
 
+  {
+    std::scoped_lock lock(m_impl->convertMutex);
+    m_impl->conversions[key] = {cur, true};
+  }
+  m_impl->convertCond.notify_all();
+  return cur;
+}
+
+Image* Frame::ResizeAndConvertImpl(Image* cur, int width, int height,
+                                   VideoMode::PixelFormat pixelFormat,
+                                   int requiredJpegQuality,
+                                   int defaultJpegQuality) {
   WPI_DEBUG4(Instance::GetInstance().logger,
              "converting image from {}x{} type {} to {}x{} type {}", cur->width,
              cur->height, static_cast<int>(cur->pixelFormat), width, height,
@@ -684,9 +815,45 @@ Image* Frame::GetImageImpl(int width, int height,
   // If the source image is a JPEG, we need to decode it before we can do
   // anything else with it.  Note that if the destination format is JPEG, we
   // still need to do this (unless the width/height/compression were the same,
-  // in which case we already returned the existing JPEG above).
+  // in which case we already returned the existing JPEG above).  Smaller
+  // targets use a scaled decode, and grayscale targets decode only luma.  The
+  // decode goes through GetImageImpl() so that sinks wanting different sizes
+  // share a single decode.
   if (cur->pixelFormat == VideoMode::kMJPEG) {
-    cur = ConvertMJPEGToBGR(cur);
+    int scale = GetJpegScale(cur->width, cur->height, width, height);
+    int decodeWidth = JpegScaledSize(cur->width, scale);
+    int decodeHeight = JpegScaledSize(cur->height, scale);
+    auto decodeFormat =
+        pixelFormat == VideoMode::kGray ? VideoMode::kGray : VideoMode::kBGR;
+    if (pixelFormat == decodeFormat && width == decodeWidth &&
+        height == decodeHeight) {
+      return DecodeMJPEG(cur, decodeFormat, scale);
+    }
+    cur = GetImageImpl(decodeWidth, decodeHeight, decodeFormat, -1, 80);
+    if (!cur) {
+      return nullptr;
+    }
+  }
+
+  // Luma can be sampled directly from packed YUV, so grayscale output is
+  // resized and converted in a single pass
+  if (pixelFormat == VideoMode::kGray && !cur->Is(width, height) &&
+      (cur->pixelFormat == VideoMode::kGray ||
+       cur->pixelFormat == VideoMode::kYUYV ||
+       cur->pixelFormat == VideoMode::kUYVY)) {
+    auto newImage = m_impl->source.AllocImage(VideoMode::kGray, width, height,
+                                              width * height);
+    int step = cur->pixelFormat == VideoMode::kGray ? 1 : 2;
+    int offset = cur->pixelFormat == VideoMode::kUYVY ? 1 : 0;
+    cvt::ResizeGray(Bytes(*cur) + offset, cur->width, cur->height, step,
+                    static_cast<size_t>(cur->width) * step, Bytes(*newImage),
+                    width, height);
+
+    // Save the result
+    Image* rv = newImage.release();
+    std::scoped_lock lock(m_impl->mutex);
+    m_impl->images.push_back(rv);
+    return rv;
   }
 
   // Resize
@@ -702,6 +869,7 @@ Image* Frame::GetImageImpl(int width, int height,
 
     // Save the result
     cur = newImage.release();
+    std::scoped_lock lock(m_impl->mutex);
     m_impl->images.push_back(cur);
   }
 
@@ -709,6 +877,217 @@ Image* Frame::GetImageImpl(int width, int height,
   return ConvertImpl(cur, pixelFormat, requiredJpegQuality, defaultJpegQuality);
 }
 
+Image* Frame::GetImage(const ImageRegion& region,
+                       VideoMode::PixelFormat pixelFormat) {
+  Image* orig = GetExistingImage(0);
+  if (!orig) {
+    return nullptr;
+  }
+
+  // Translate the region into the original image and clip it
+  int decimation = std::max(region.decimation, 1);
+  int x = std::clamp(region.x - m_impl->originX, 0, orig->width);
+  int y = std::clamp(region.y - m_impl->originY, 0, orig->height);
+  int right = orig->width;
+  if (region.width > 0) {
+    right = std::clamp(region.x + region.width - m_impl->originX, x, right);
+  }
+  int bottom = orig->height;
+  if (region.height > 0) {
+    bottom = std::clamp(region.y + region.height - m_impl->originY, y, bottom);
+  }
+  ImageRegion clipped{x, y, (right - x) / decimation * decimation,
+                      (bottom - y) / decimation * decimation, decimation};
+  if (clipped.width == 0 || clipped.height == 0) {
+    return nullptr;
+  }
+  if (clipped.width == orig->width && clipped.height == orig->height &&
+      decimation == 1) {
+    return GetImage(orig->width, orig->height, pixelFormat);
+  }
+
+  // As in GetImageImpl(), wait for another thread converting the same region
+  // rather than converting it again.  Entries are only appended while the
+  // frame is alive, so indexes are stable.
+  auto& telemetry = Instance::GetInstance().telemetry;
+  size_t index;
+  {
+    std::unique_lock lock(m_impl->convertMutex);
+    auto& conversions = m_impl->regionConversions;
+    auto it = std::find_if(
+        conversions.begin(), conversions.end(), [&](const auto& conversion) {
+          return conversion.region == clipped &&
+                 conversion.pixelFormat == pixelFormat;
+        });
+    index = it - conversions.begin();
+    if (it != conversions.end()) {
+      m_impl->convertCond.wait(lock,
+                               [&] { return conversions[index].done; });
+      Image* image = conversions[index].image;
+      lock.unlock();
+      if (gConversionDepth == 0) {
+        telemetry.RecordSourceConversion(m_impl->source, true, 0);
+      }
+      return image;
+    }
+    conversions.push_back({clipped, pixelFormat});
+  }
+
+  ++gConversionDepth;
+  auto start = wpi::Now();
+  Image* image = ConvertRegionImpl(orig, clipped, pixelFormat);
+  int64_t elapsed = wpi::Now() - start;
+  if (--gConversionDepth == 0) {
+    m_impl->conversionTime += elapsed;
+    telemetry.RecordSourceConversion(m_impl->source, false, elapsed);
+  }
+
+  {
+    std::scoped_lock lock(m_impl->convertMutex);
+    m_impl->regionConversions[index].image = image;
+    m_impl->regionConversions[index].done = true;
+  }
+  m_impl->convertCond.notify_all();
+  return image;
+}
+
+// Crops and bins in the first pass over the source data wherever possible,
+// so later conversions of the region only touch its pixels.  The result (but
+// not any full frame conversions it needed) is stored in regionConversions.
+Image* Frame::ConvertRegionImpl(Image* cur, ImageRegion region,
+                                VideoMode::PixelFormat pixelFormat) {
+  WPI_DEBUG4(Instance::GetInstance().logger,
+             "converting region {}x{}+{}+{}/{} of type {} to type {}",
+             region.width, region.height, region.x, region.y,
+             region.decimation, static_cast<int>(cur->pixelFormat),
+             static_cast<int>(pixelFormat));
+
+  if (!ImageRegion::SupportsPixelFormat(pixelFormat)) {
+    return nullptr;  // Unsupported
+  }
+
+  // Decode JPEGs with the largest DCT scale that the decimation absorbs
+  // exactly; the decode is a full frame, so it is shared as usual
+  if (cur->pixelFormat == VideoMode::kMJPEG) {
+    int scale = 8;
+    while (scale > 1 && (region.decimation % scale != 0 ||
+                         region.x % scale != 0 || region.y % scale != 0)) {
+      scale /= 2;
+    }
+    auto decodeFormat =
+        pixelFormat == VideoMode::kGray ? VideoMode::kGray : VideoMode::kBGR;
+    cur = GetImageImpl(JpegScaledSize(cur->width, scale),
+                       JpegScaledSize(cur->height, scale), decodeFormat, -1,
+                       80);
+    if (!cur) {
+      return nullptr;
+    }
+    region = {region.x / scale, region.y / scale, region.width / scale,
+              region.height / scale, region.decimation / scale};
+  }
+
+  int width = region.width / region.decimation;
+  int height = region.height / region.decimation;
+  auto& source = m_impl->source;
+  int pixelSize = pixelFormat == VideoMode::kBGR    ? 3
+                  : pixelFormat == VideoMode::kGray ? 1
+                                                    : 2;
+  auto newImage = source.AllocImage(pixelFormat, width, height,
+                                    width * height * pixelSize);
+  bool done = false;
+  if (pixelFormat == VideoMode::kGray) {
+    if (cur->pixelFormat == VideoMode::kGray ||
+        cur->pixelFormat == VideoMode::kYUYV ||
+        cur->pixelFormat == VideoMode::kUYVY) {
+      BinRegion(*cur, region, *newImage);
+      done = true;
+    } else if (cur->pixelFormat == VideoMode::kBGR) {
+      auto binned =
+          source.AllocImage(VideoMode::kBGR, width, height, width * height * 3);
+      BinRegion(*cur, region, *binned);
+      cv::cvtColor(binned->AsMat(), newImage->AsMat(), cv::COLOR_BGR2GRAY);
+      source.ReleaseImage(std::move(binned));
+      done = true;
+    }
+  } else if (pixelFormat == VideoMode::kBGR) {
+    if (cur->pixelFormat == VideoMode::kBGR) {
+      BinRegion(*cur, region, *newImage);
+      done = true;
+    } else if (cur->pixelFormat == VideoMode::kGray) {
+      auto binned =
+          source.AllocImage(VideoMode::kGray, width, height, width * height);
+      BinRegion(*cur, region, *binned);
+      cv::cvtColor(binned->AsMat(), newImage->AsMat(), cv::COLOR_GRAY2BGR);
+      source.ReleaseImage(std::move(binned));
+      done = true;
+    } else if (cur->pixelFormat == VideoMode::kYUYV ||
+               cur->pixelFormat == VideoMode::kUYVY) {
+      // Convert only the cropped rows; the conversion works on pixel pairs,
+      // so each row is converted from the pair containing its first pixel
+      Image* cropped = newImage.get();
+      std::unique_ptr<Image> unbinned;
+      if (region.decimation != 1) {
+        unbinned = source.AllocImage(VideoMode::kBGR, region.width,
+                                     region.height,
+                                     region.width * region.height * 3);
+        cropped = unbinned.get();
+      }
+      int x0 = region.x & ~1;
+      int pairWidth = ((region.x + region.width + 1) & ~1) - x0;
+      thread_local std::vector<uint8_t> row;
+      row.resize(pairWidth * 3);
+      int code = cur->pixelFormat == VideoMode::kYUYV ? cv::COLOR_YUV2BGR_YUYV
+                                                       : cv::COLOR_YUV2BGR_UYVY;
+      cv::Mat rowMat{1, pairWidth, CV_8UC3, row.data()};
+      size_t rowSize = region.width * 3;
+      for (int y = 0; y < region.height; ++y) {
+        cv::cvtColor(
+            cv::Mat{1, pairWidth, CV_8UC2,
+                    Bytes(*cur) + (region.y + y) * cur->GetStride() + x0 * 2},
+            rowMat, code);
+        std::copy_n(row.data() + (region.x - x0) * 3, rowSize,
+                    Bytes(*cropped) + y * rowSize);
+      }
+      if (unbinned) {
+        BinRegion(*unbinned,
+                  {0, 0, region.width, region.height, region.decimation},
+                  *newImage);
+        source.ReleaseImage(std::move(unbinned));
+      }
+      done = true;
+    }
+  }
+
+  // Anything else converts the full frame first, then crops that
+  if (!done) {
+    Image* full = GetImageImpl(cur->width, cur->height, pixelFormat, -1, 80);
+    if (!full) {
+      source.ReleaseImage(std::move(newImage));
+      return nullptr;
+    }
+    if (pixelFormat == VideoMode::kGray || pixelFormat == VideoMode::kBGR) {
+      BinRegion(*full, region, *newImage);
+    } else {
+      cv::Mat newMat = newImage->AsMat();
+      cv::resize(full->AsMat()(cv::Rect{region.x, region.y, region.width,
+                                        region.height}),
+                 newMat, newMat.size(), 0, 0, cv::INTER_NEAREST);
+    }
+  }
+
+  return newImage.release();
+}
+
+bool Frame::GetCv(cv::Mat& image, const ImageRegion& region,
+                  VideoMode::PixelFormat pixelFormat) {
+  Image* rawImage = GetImage(region, pixelFormat);
+  if (!rawImage) {
+    return false;
+  }
+  rawImage->AsMat().copyTo(image);
+  return true;
+}
+
 bool Frame::GetCv(cv::Mat& image, int width, int height,
                   VideoMode::PixelFormat pixelFormat) {
   Image* rawImage = GetImage(width, height, pixelFormat);
@@ -719,11 +1098,23 @@ bool Frame::GetCv(cv::Mat& image, int width, int height,
   return true;
 }
 
+void Frame::RecordEncode(int64_t time) {
+  m_impl->encodeTime += time;
+  Instance::GetInstance().telemetry.RecordSourceEncode(m_impl->source, time);
+}
+
 void Frame::ReleaseFrame() {
   for (auto image : m_impl->images) {
     m_impl->source.ReleaseImage(std::unique_ptr<Image>(image));
   }
   m_impl->images.clear();
+  m_impl->conversions.clear();
+  for (auto& conversion : m_impl->regionConversions) {
+    if (conversion.image) {
+      m_impl->source.ReleaseImage(std::unique_ptr<Image>(conversion.image));
+    }
+  }
+  m_impl->regionConversions.clear();
   m_impl->source.ReleaseFrameImpl(std::unique_ptr<Impl>(m_impl));
   m_impl = nullptr;
 }
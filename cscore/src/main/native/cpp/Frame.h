@@ -12,7 +12,9 @@
 #include <utility>
 #include <vector>
 
+#include <wpi/DenseMap.h>
 #include <wpi/SmallVector.h>
+#include <wpi/condition_variable.h>
 #include <wpi/mutex.h>
 
 #include "Image.h"
@@ -22,7 +24,34 @@ namespace cs {
 
 class SourceImpl;
 
+/**
+ * A sink's region of interest: a crop rectangle in the source's full frame
+ * coordinates, optionally binned down by an integer factor.  A zero width or
+ * height extends the region to the edge of the frame.
+ */
+struct ImageRegion {
+  int x = 0;
+  int y = 0;
+  int width = 0;
+  int height = 0;
+  int decimation = 1;
+
+  bool operator==(const ImageRegion&) const = default;
+
+  // true if the rectangle covers less than the full frame
+  bool IsCrop() const { return x != 0 || y != 0 || width != 0 || height != 0; }
+  bool IsFull() const { return !IsCrop() && decimation <= 1; }
+
+  // false for output formats a region can't be converted to (MJPEG, and the
+  // packed pair formats YUYV and UYVY)
+  static bool SupportsPixelFormat(VideoMode::PixelFormat pixelFormat) {
+    return pixelFormat != VideoMode::kMJPEG &&
+           pixelFormat != VideoMode::kYUYV && pixelFormat != VideoMode::kUYVY;
+  }
+};
+
 class Frame {
+  friend class FrameTest;
   friend class SourceImpl;
 
  public:
@@ -35,10 +64,45 @@ class Frame {
     wpi::recursive_mutex mutex;
     std::atomic_int refcount{0};
     Time time{0};
+    // best estimate of when the frame was captured, in the same time base as
+    // time, and what that estimate is based on
+    Time captureTime{0};
+    CS_TimestampSource timeSource{CS_TIMESRC_UNKNOWN};
+    // microseconds spent converting (including encoding) and encoding images
+    // of this frame
+    std::atomic<int64_t> conversionTime{0};
+    std::atomic<int64_t> encodeTime{0};
     SourceImpl& source;
     std::string error;
     wpi::SmallVector<Image*, 4> images;
-    std::vector<int> compressionParams;
+
+    // Results of GetImage() calls, keyed by the requested width, height,
+    // pixel format, and JPEG quality.  An entry which is not done is being
+    // converted by another thread; wait on convertCond for it.
+    struct Conversion {
+      Image* image = nullptr;
+      bool done = false;
+    };
+    wpi::mutex convertMutex;
+    wpi::condition_variable convertCond;
+    wpi::SmallDenseMap<uint64_t, Conversion, 4> conversions;
+
+    // Results of region GetImage() calls, keyed by the region (clipped to the
+    // original image) and pixel format.  These images are kept out of images
+    // so that a cropped image is never mistaken for a resized full frame.
+    // Protected by convertMutex.
+    struct RegionConversion {
+      ImageRegion region;
+      VideoMode::PixelFormat pixelFormat;
+      Image* image = nullptr;
+      bool done = false;
+    };
+    wpi::SmallVector<RegionConversion, 2> regionConversions;
+
+    // position of the original image in the source's full frame, if the
+    // source cropped it in hardware
+    int originX{0};
+    int originY{0};
   };
 
  public:
@@ -46,7 +110,8 @@ class Frame {
 
   Frame(SourceImpl& source, std::string_view error, Time time);
 
-  Frame(SourceImpl& source, std::unique_ptr<Image> image, Time time);
+  Frame(SourceImpl& source, std::unique_ptr<Image> image, Time time,
+        Time captureTime, CS_TimestampSource timeSource);
 
   Frame(const Frame& frame) noexcept : m_impl{frame.m_impl} {
     if (m_impl) {
@@ -72,6 +137,20 @@ class Frame {
 
   Time GetTime() const { return m_impl ? m_impl->time : 0; }
 
+  Time GetCaptureTime() const { return m_impl ? m_impl->captureTime : 0; }
+
+  CS_TimestampSource GetTimeSource() const {
+    return m_impl ? m_impl->timeSource : CS_TIMESRC_UNKNOWN;
+  }
+
+  int64_t GetConversionTime() const {
+    return m_impl ? m_impl->conversionTime.load() : 0;
+  }
+
+  int64_t GetEncodeTime() const {
+    return m_impl ? m_impl->encodeTime.load() : 0;
+  }
+
   std::string_view GetError() const {
     if (!m_impl) {
       return {};
@@ -192,8 +271,9 @@ class Frame {
     return ConvertImpl(image, VideoMode::kMJPEG, requiredQuality,
                        defaultQuality);
   }
-  Image* ConvertMJPEGToBGR(Image* image);
-  Image* ConvertMJPEGToGray(Image* image);
+  // scale is the JPEG DCT scaling denominator (1, 2, 4, or 8)
+  Image* ConvertMJPEGToBGR(Image* image, int scale = 1);
+  Image* ConvertMJPEGToGray(Image* image, int scale = 1);
   Image* ConvertYUYVToBGR(Image* image);
   Image* ConvertYUYVToGray(Image* image);
   Image* ConvertUYVYToBGR(Image* image);
@@ -213,6 +293,11 @@ class Frame {
     }
     return GetImageImpl(width, height, pixelFormat, -1, 80);
   }
+  // Gets the given region of the frame, binned by its decimation factor.
+  // The region is clipped to the frame, and its size rounded down to a
+  // multiple of the decimation.  Not supported for MJPEG, YUYV, or UYVY.
+  Image* GetImage(const ImageRegion& region,
+                  VideoMode::PixelFormat pixelFormat);
   Image* GetImageMJPEG(int width, int height, int requiredQuality,
                        int defaultQuality = 80) {
     return GetImageImpl(width, height, VideoMode::kMJPEG, requiredQuality,
@@ -224,12 +309,22 @@ class Frame {
   }
   bool GetCv(cv::Mat& image, int width, int height,
              VideoMode::PixelFormat pixelFormat);
+  bool GetCv(cv::Mat& image, const ImageRegion& region,
+             VideoMode::PixelFormat pixelFormat);
 
  private:
   Image* ConvertImpl(Image* image, VideoMode::PixelFormat pixelFormat,
                      int requiredJpegQuality, int defaultJpegQuality);
   Image* GetImageImpl(int width, int height, VideoMode::PixelFormat pixelFormat,
                       int requiredJpegQuality, int defaultJpegQuality);
+  Image* DecodeMJPEG(Image* image, VideoMode::PixelFormat pixelFormat,
+                     int scale);
+  Image* ResizeAndConvertImpl(Image* image, int width, int height,
+                              VideoMode::PixelFormat pixelFormat,
+                              int requiredJpegQuality, int defaultJpegQuality);
+  Image* ConvertRegionImpl(Image* image, ImageRegion region,
+                           VideoMode::PixelFormat pixelFormat);
+  void RecordEncode(int64_t time);
   void DecRef() {
     if (m_impl && --(m_impl->refcount) == 0) {
       ReleaseFrame();
@@ -4,7 +4,11 @@
 
 #include "HttpCameraImpl.h"
 
+#include <algorithm>
+#include <utility>
+
 #include <wpi/MemAlloc.h>
+#include <wpi/SmallVector.h>
 #include <wpi/StringExtras.h>
 #include <wpi/timestamp.h>
 #include <wpinet/TCPConnector.h>
@@ -147,8 +151,8 @@ void HttpCameraImpl::StreamThreadMain() {
 
 wpi::HttpConnection* HttpCameraImpl::DeviceStreamConnect(
     wpi::SmallVectorImpl<char>& boundary) {
-  // Build the request
-  wpi::HttpRequest req;
+  // Build a request for each location
+  std::vector<wpi::HttpRequest> requests;
   {
     std::scoped_lock lock(m_mutex);
     if (m_locations.empty()) {
@@ -156,20 +160,26 @@ wpi::HttpConnection* HttpCameraImpl::DeviceStreamConnect(
       std::this_thread::sleep_for(std::chrono::seconds(1));
       return nullptr;
     }
-    if (m_nextLocation >= m_locations.size()) {
-      m_nextLocation = 0;
+    requests.reserve(m_locations.size());
+    for (auto&& location : m_locations) {
+      requests.emplace_back(location, m_streamSettings);
     }
-    req = wpi::HttpRequest{m_locations[m_nextLocation++], m_streamSettings};
     m_streamSettingsUpdated = false;
   }
 
-  // Try to connect
+  // Try to connect to all locations at once; the first to answer wins
+  wpi::SmallVector<std::pair<const char*, int>, 4> servers;
+  for (auto&& request : requests) {
+    servers.emplace_back(request.host.c_str(), request.port);
+  }
+  size_t index = 0;
   auto stream =
-      wpi::TCPConnector::connect(req.host.c_str(), req.port, m_logger, 1);
+      wpi::TCPConnector::connect_parallel(servers, m_logger, 1, &index);
 
   if (!m_active || !stream) {
     return nullptr;
   }
+  auto& req = requests[index];
 
   auto connPtr = std::make_unique<wpi::HttpConnection>(std::move(stream), 1);
   wpi::HttpConnection* conn = connPtr.get();
@@ -179,6 +189,12 @@ wpi::HttpConnection* HttpCameraImpl::DeviceStreamConnect(
     std::scoped_lock lock(m_mutex);
     m_frameCount = 1;  // avoid a race with monitor thread
     m_streamConn = std::move(connPtr);
+    // send settings to the same location as the stream, unless the
+    // locations have changed since
+    if (!m_streamSettingsUpdated) {
+      m_prefLocation = index;
+      m_settingsCond.notify_one();
+    }
   }
 
   std::string warn;
@@ -229,8 +245,9 @@ wpi::HttpConnection* HttpCameraImpl::DeviceStreamConnect(
 
 void HttpCameraImpl::DeviceStream(wpi::raw_istream& is,
                                   std::string_view boundary) {
-  // Stored here so we reuse it from frame to frame
-  std::string imageBuf;
+  // Size of the last frame without a Content-Length, used to pick a pooled
+  // image that is likely big enough
+  size_t jpegSize = 0;
 
   // keep track of number of bad images received; if we receive 3 bad images
   // in a row, we reconnect
@@ -261,7 +278,7 @@ void HttpCameraImpl::DeviceStream(wpi::raw_istream& is,
       }
     }
 
-    if (!DeviceStreamFrame(is, imageBuf)) {
+    if (!DeviceStreamFrame(is, jpegSize)) {
       ++numErrors;
     } else {
       numErrors = 0;
@@ -270,7 +287,7 @@ void HttpCameraImpl::DeviceStream(wpi::raw_istream& is,
 }
 
 bool HttpCameraImpl::DeviceStreamFrame(wpi::raw_istream& is,
-                                       std::string& imageBuf) {
+                                       size_t& jpegSize) {
   // Read the headers
   wpi::SmallString<64> contentTypeBuf;
   wpi::SmallString<64> contentLengthBuf;
@@ -294,15 +311,20 @@ bool HttpCameraImpl::DeviceStreamFrame(wpi::raw_istream& is,
   if (auto v = wpi::parse_integer<unsigned int>(contentLengthBuf, 10)) {
     contentLength = v.value();
   } else {
-    // Ugh, no Content-Length?  Read the blocks of the JPEG file.
+    // Ugh, no Content-Length?  Read the blocks of the JPEG file directly
+    // into a frame, which grows as needed.
+    auto image = AllocImage(VideoMode::PixelFormat::kMJPEG, 0, 0, jpegSize);
     int width, height;
-    if (!ReadJpeg(is, imageBuf, &width, &height)) {
+    if (!ReadJpeg(is, image->vec(), &width, &height)) {
       SWARNING("did not receive a JPEG image");
       PutError("did not receive a JPEG image", wpi::Now());
+      ReleaseImage(std::move(image));
       return false;
     }
-    PutFrame(VideoMode::PixelFormat::kMJPEG, width, height, imageBuf,
-             wpi::Now());
+    jpegSize = image->size();
+    image->width = width;
+    image->height = height;
+    PutFrame(std::move(image), wpi::Now());
     ++m_frameCount;
     return true;
   }
@@ -312,12 +334,14 @@ bool HttpCameraImpl::DeviceStreamFrame(wpi::raw_istream& is,
   auto image = AllocImage(VideoMode::PixelFormat::kMJPEG, 0, 0, contentLength);
   is.read(image->data(), contentLength);
   if (!m_active || is.has_error()) {
+    ReleaseImage(std::move(image));
     return false;
   }
   int width, height;
   if (!GetJpegSize(image->str(), &width, &height)) {
     SWARNING("did not receive a JPEG image");
     PutError("did not receive a JPEG image", wpi::Now());
+    ReleaseImage(std::move(image));
     return false;
   }
   image->width = width;
@@ -339,8 +363,9 @@ void HttpCameraImpl::SettingsThreadMain() {
         break;
       }
 
-      // Build the request
+      // Build the request; settings are sent once
       req = wpi::HttpRequest{m_locations[m_prefLocation], m_settings};
+      m_settings.clear();
     }
 
     DeviceSendSettings(req);
@@ -350,30 +375,77 @@ void HttpCameraImpl::SettingsThreadMain() {
 }
 
 void HttpCameraImpl::DeviceSendSettings(wpi::HttpRequest& req) {
-  // Try to connect
-  auto stream =
-      wpi::TCPConnector::connect(req.host.c_str(), req.port, m_logger, 1);
-
-  if (!m_active || !stream) {
-    return;
+  // Reuse the previous connection if it is to the same server.  The server
+  // may have closed it in the meantime, so retry once on a new connection.
+  wpi::HttpConnection* conn = nullptr;
+  {
+    std::scoped_lock lock(m_mutex);
+    if (m_settingsConn && *m_settingsConn && m_settingsHost == req.host.str() &&
+        m_settingsPort == req.port) {
+      conn = m_settingsConn.get();
+    }
   }
 
-  auto connPtr = std::make_unique<wpi::HttpConnection>(std::move(stream), 1);
-  wpi::HttpConnection* conn = connPtr.get();
+  for (;;) {
+    bool reused = conn != nullptr;
+    if (!conn) {
+      // Try to connect
+      auto stream =
+          wpi::TCPConnector::connect(req.host.c_str(), req.port, m_logger, 1);
 
-  // update m_settingsConn
-  {
-    std::scoped_lock lock(m_mutex);
-    m_settingsConn = std::move(connPtr);
+      if (!m_active || !stream) {
+        return;
+      }
+
+      auto connPtr =
+          std::make_unique<wpi::HttpConnection>(std::move(stream), 1);
+      conn = connPtr.get();
+      m_settingsHost = req.host.str();
+      m_settingsPort = req.port;
+
+      // update m_settingsConn
+      std::scoped_lock lock(m_mutex);
+      m_settingsConn = std::move(connPtr);
+    }
+
+    // Just need a handshake as settings are sent via GET parameters
+    std::string warn;
+    if (conn->Handshake(req, &warn)) {
+      break;
+    }
+    CloseSettingsConnection();
+    if (!m_active || !reused) {
+      SWARNING("{}", warn);
+      return;
+    }
+    conn = nullptr;
   }
 
-  // Just need a handshake as settings are sent via GET parameters
-  std::string warn;
-  if (!conn->Handshake(req, &warn)) {
-    SWARNING("{}", warn);
+  // Discard the response body so the connection can be kept alive; without
+  // a Content-Length, the end of the body is only known when it is closed
+  auto contentLength = wpi::parse_integer<size_t>(conn->contentLength, 10);
+  if (!contentLength) {
+    CloseSettingsConnection();
+    return;
+  }
+  char buf[256];
+  for (size_t remaining = *contentLength; remaining > 0;) {
+    size_t len = (std::min)(remaining, sizeof(buf));
+    conn->is.read(buf, len);
+    if (!m_active || conn->is.has_error()) {
+      CloseSettingsConnection();
+      return;
+    }
+    remaining -= len;
   }
+}
 
-  conn->stream->close();
+void HttpCameraImpl::CloseSettingsConnection() {
+  std::scoped_lock lock(m_mutex);
+  if (m_settingsConn) {
+    m_settingsConn->stream->close();
+    m_settingsConn = nullptr;
+  }
 }
 
 CS_HttpCameraKind HttpCameraImpl::GetKind() const {
@@ -397,7 +469,7 @@ bool HttpCameraImpl::SetUrls(std::span<const std::string> urls,
 
   std::scoped_lock lock(m_mutex);
   m_locations.swap(locations);
-  m_nextLocation = 0;
+  m_prefLocation = -1;
   m_streamSettingsUpdated = true;
   return true;
 }
@@ -27,6 +27,8 @@
 namespace cs {
 
 class HttpCameraImpl : public SourceImpl {
+  friend class HttpCameraTest;
+
  public:
   HttpCameraImpl(std::string_view name, CS_HttpCameraKind kind,
                  wpi::Logger& logger, Notifier& notifier, Telemetry& telemetry);
@@ -103,11 +105,12 @@ class HttpCameraImpl : public SourceImpl {
   wpi::HttpConnection* DeviceStreamConnect(
       wpi::SmallVectorImpl<char>& boundary);
   void DeviceStream(wpi::raw_istream& is, std::string_view boundary);
-  bool DeviceStreamFrame(wpi::raw_istream& is, std::string& imageBuf);
+  bool DeviceStreamFrame(wpi::raw_istream& is, size_t& jpegSize);
 
   // The camera settings thread
   void SettingsThreadMain();
   void DeviceSendSettings(wpi::HttpRequest& req);
+  void CloseSettingsConnection();
 
   // The monitor thread
   void MonitorThreadMain();
@@ -129,8 +132,7 @@ class HttpCameraImpl : public SourceImpl {
   CS_HttpCameraKind m_kind;
 
   std::vector<wpi::HttpLocation> m_locations;
-  size_t m_nextLocation{0};
-  int m_prefLocation{-1};  // preferred location
+  int m_prefLocation{-1};  // preferred location (last connected stream)
 
   std::atomic_int m_frameCount{0};
 
@@ -139,6 +141,11 @@ class HttpCameraImpl : public SourceImpl {
   wpi::StringMap<wpi::SmallString<16>> m_settings;
   wpi::condition_variable m_settingsCond;
 
+  // Server of m_settingsConn, which is kept alive between requests; only
+  // accessed by the settings thread
+  std::string m_settingsHost;
+  int m_settingsPort{0};
+
   wpi::StringMap<wpi::SmallString<16>> m_streamSettings;
   std::atomic_bool m_streamSettingsUpdated{false};
 
@@ -5,7 +5,9 @@
 #ifndef CSCORE_IMAGE_H_
 #define CSCORE_IMAGE_H_
 
+#include <memory>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 #include <opencv2/core/core.hpp>
@@ -16,9 +18,11 @@
 namespace cs {
 
 class Frame;
+class SourceImpl;
 
 class Image {
   friend class Frame;
+  friend class SourceImpl;
 
  public:
 #ifndef __linux__
@@ -40,14 +44,37 @@ class Image {
   std::string_view str() const { return {data(), size()}; }
   size_t capacity() const { return m_data.capacity(); }
   const char* data() const {
+    if (m_external) {
+      return static_cast<const char*>(m_external.get());
+    }
     return reinterpret_cast<const char*>(m_data.data());
   }
-  char* data() { return reinterpret_cast<char*>(m_data.data()); }
-  size_t size() const { return m_data.size(); }
+  char* data() {
+    if (m_external) {
+      return static_cast<char*>(m_external.get());
+    }
+    return reinterpret_cast<char*>(m_data.data());
+  }
+  size_t size() const { return m_external ? m_externalSize : m_data.size(); }
 
+  // Only valid for images that own their data
   const std::vector<uchar>& vec() const { return m_data; }
   std::vector<uchar>& vec() { return m_data; }
 
+  /**
+   * Points the image at data owned by someone else (e.g. a mapped capture
+   * buffer) instead of its own storage.  The owner is released when the image
+   * is released; external images are never returned to the source's pool.
+   *
+   * @param data image data; the deleter is called when the image is released
+   * @param size size of the data in bytes
+   */
+  void SetExternal(std::shared_ptr<void> data, size_t size) {
+    m_external = std::move(data);
+    m_externalSize = size;
+  }
+  bool IsExternal() const { return m_external != nullptr; }
+
   void resize(size_t size) { m_data.resize(size); }
   void SetSize(size_t size) { m_data.resize(size); }
 
@@ -69,7 +96,7 @@ class Image {
         type = CV_8UC1;
         break;
     }
-    return cv::Mat{height, width, type, m_data.data()};
+    return cv::Mat{height, width, type, data()};
   }
 
   int GetStride() const {
@@ -89,8 +116,6 @@ class Image {
     }
   }
 
-  cv::_InputArray AsInputArray() { return cv::_InputArray{m_data}; }
-
   bool Is(int width_, int height_) {
     return width == width_ && height == height_;
   }
@@ -116,6 +141,10 @@ class Image {
 
  private:
   std::vector<uchar> m_data;
+  std::shared_ptr<void> m_external;
+  size_t m_externalSize{0};
+  // capacity last accounted for by the source's pool
+  size_t m_poolBytes{0};
 
  public:
   VideoMode::PixelFormat pixelFormat{VideoMode::kUnknown};
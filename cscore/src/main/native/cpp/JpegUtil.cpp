@@ -137,21 +137,22 @@ std::string_view JpegGetDHT() {
   return {reinterpret_cast<const char*>(dhtData), sizeof(dhtData)};
 }
 
-static inline void ReadInto(wpi::raw_istream& is, std::string& buf,
-                            size_t len) {
+static inline void ReadInto(wpi::raw_istream& is,
+                            std::vector<unsigned char>& buf, size_t len) {
   size_t oldSize = buf.size();
   buf.resize(oldSize + len);
-  is.read(&(*buf.begin()) + oldSize, len);
+  is.read(buf.data() + oldSize, len);
 }
 
-bool ReadJpeg(wpi::raw_istream& is, std::string& buf, int* width, int* height) {
+bool ReadJpeg(wpi::raw_istream& is, std::vector<unsigned char>& buf,
+              int* width, int* height) {
   // in case we don't get a SOF
   *width = 0;
   *height = 0;
 
   // read SOI and first marker
   buf.resize(4);
-  is.read(&(*buf.begin()), 4);
+  is.read(buf.data(), 4);
   if (is.has_error()) {
     return false;
   }
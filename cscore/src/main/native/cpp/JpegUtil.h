@@ -7,6 +7,7 @@
 
 #include <string>
 #include <string_view>
+#include <vector>
 
 namespace wpi {
 class raw_istream;
@@ -22,7 +23,8 @@ bool JpegNeedsDHT(const char* data, size_t* size, size_t* locSOF);
 
 std::string_view JpegGetDHT();
 
-bool ReadJpeg(wpi::raw_istream& is, std::string& buf, int* width, int* height);
+bool ReadJpeg(wpi::raw_istream& is, std::vector<unsigned char>& buf,
+              int* width, int* height);
 
 }  // namespace cs
 
@@ -19,6 +19,7 @@
 #include "Instance.h"
 #include "JpegUtil.h"
 #include "Log.h"
+#include "MjpegStreamHub.h"
 #include "Notifier.h"
 #include "SourceImpl.h"
 #include "c_util.h"
@@ -26,10 +27,6 @@
 
 using namespace cs;
 
-// The boundary used for the M-JPEG stream.
-// It separates the multipart stream of pictures
-#define BOUNDARY "boundarydonotcross"
-
 // A bare-bones HTML webpage for user friendliness.
 static const char* emptyRootPage =
     "</head><body>"
@@ -90,6 +87,9 @@ class MjpegServerImpl::ConnThread : public wpi::SafeThread {
 
   std::unique_ptr<wpi::NetworkStream> m_stream;
   std::shared_ptr<SourceImpl> m_source;
+  std::shared_ptr<MjpegStreamHub> m_hub;  // null unless event loop enabled
+  SinkImpl* m_sink = nullptr;             // owning server, for telemetry
+  bool m_handoff = false;
   bool m_streaming = false;
   bool m_noStreaming = false;
   int m_width = 0;
@@ -597,7 +597,8 @@ void MjpegServerImpl::ConnThread::SendJSON(wpi::raw_ostream& os,
 MjpegServerImpl::MjpegServerImpl(std::string_view name, wpi::Logger& logger,
                                  Notifier& notifier, Telemetry& telemetry,
                                  std::string_view listenAddress, int port,
-                                 std::unique_ptr<wpi::NetworkAcceptor> acceptor)
+                                 std::unique_ptr<wpi::NetworkAcceptor> acceptor,
+                                 wpi::EventLoopRunner& eventLoop)
     : SinkImpl{name, logger, notifier, telemetry},
       m_listenAddress(listenAddress),
       m_port(port),
@@ -624,6 +625,14 @@ MjpegServerImpl::MjpegServerImpl(std::string_view name, wpi::Logger& logger,
   m_fpsProp = CreateProperty("fps", [] {
     return std::make_unique<PropertyImpl>("fps", CS_PROP_INTEGER, 1, 0, 0);
   });
+  m_eventLoopProp = CreateProperty("event_loop", [] {
+    return std::make_unique<PropertyImpl>("event_loop", CS_PROP_BOOLEAN, 0, 1,
+                                          1, 0, 0);
+  });
+
+  if (MjpegStreamHub::IsSupported()) {
+    m_hub = std::make_shared<MjpegStreamHub>(name, logger, eventLoop, *this);
+  }
 
   m_serverThread = std::thread(&MjpegServerImpl::ServerThreadMain, this);
 }
@@ -653,6 +662,10 @@ void MjpegServerImpl::Stop() {
     connThread.Stop();
   }
 
+  if (m_hub) {
+    m_hub->Stop();
+  }
+
   // wake up connection threads by forcing an empty frame to be sent
   if (auto source = GetSource()) {
     source->Wakeup();
@@ -675,6 +688,13 @@ void MjpegServerImpl::ConnThread::SendStream(wpi::raw_socket_ostream& os) {
   SendHeader(oss, 200, "OK", "multipart/x-mixed-replace;boundary=" BOUNDARY);
   os << oss.str();
 
+  // the connection thread is freed once the event loop takes the stream
+  if (m_hub && m_hub->IsRunning()) {
+    SDEBUG("Headers send, handing stream to event loop");
+    m_handoff = true;
+    return;
+  }
+
   SDEBUG("Headers send, sending stream now");
 
   Frame::Time lastFrameTime = 0;
@@ -741,6 +761,9 @@ void MjpegServerImpl::ConnThread::SendStream(wpi::raw_socket_ostream& os) {
       std::this_thread::sleep_for(std::chrono::milliseconds(20));
       continue;
     }
+    if (m_sink) {
+      m_sink->RecordFrameLatency(frame);
+    }
 
     const char* data = image->data();
     size_t size = image->size();
@@ -791,7 +814,8 @@ void MjpegServerImpl::ConnThread::SendStream(wpi::raw_socket_ostream& os) {
 
 void MjpegServerImpl::ConnThread::ProcessRequest() {
   wpi::raw_socket_istream is{*m_stream};
-  wpi::raw_socket_ostream os{*m_stream, true};
+  // the stream is closed by Main() unless it was handed off
+  wpi::raw_socket_ostream os{*m_stream, false};
 
   // Read the request string from the stream
   wpi::SmallString<128> reqBuf;
@@ -930,6 +954,12 @@ void MjpegServerImpl::ConnThread::Main() {
     lock.unlock();
     ProcessRequest();
     lock.lock();
+    if (m_handoff) {
+      m_handoff = false;
+      m_hub->AddClient(std::move(m_stream),
+                       {m_width, m_height, m_compression, m_defaultCompression,
+                        m_fps});
+    }
     m_stream = nullptr;
   }
 }
@@ -971,23 +1001,29 @@ void MjpegServerImpl::ServerThreadMain() {
     // Start it if not already started
     it->Start(GetName(), m_logger);
 
-    auto nstreams =
+    // streams served by the event loop count against the same limit
+    size_t nstreams =
         std::count_if(m_connThreads.begin(), m_connThreads.end(),
                       [](const wpi::SafeThreadOwner<ConnThread>& owner) {
                         auto thr = owner.GetThread();
                         return thr && thr->m_streaming;
                       });
+    if (m_hub) {
+      nstreams += m_hub->GetNumClients();
+    }
 
     // Hand off connection to it
     auto thr = it->GetThread();
     thr->m_stream = std::move(stream);
     thr->m_source = source;
+    thr->m_sink = this;
     thr->m_noStreaming = nstreams >= 10;
     thr->m_width = GetProperty(m_widthProp)->value;
     thr->m_height = GetProperty(m_heightProp)->value;
     thr->m_compression = GetProperty(m_compressionProp)->value;
     thr->m_defaultCompression = GetProperty(m_defaultCompressionProp)->value;
     thr->m_fps = GetProperty(m_fpsProp)->value;
+    thr->m_hub = GetProperty(m_eventLoopProp)->value ? m_hub : nullptr;
     thr->m_cond.notify_one();
   }
 
@@ -995,6 +1031,9 @@ void MjpegServerImpl::ServerThreadMain() {
 }
 
 void MjpegServerImpl::SetSourceImpl(std::shared_ptr<SourceImpl> source) {
+  if (m_hub) {
+    m_hub->SetSource(source);
+  }
   std::scoped_lock lock(m_mutex);
   for (auto& connThread : m_connThreads) {
     if (auto thr = connThread.GetThread()) {
@@ -1022,7 +1061,8 @@ CS_Sink CreateMjpegServer(std::string_view name, std::string_view listenAddress,
       std::make_shared<MjpegServerImpl>(
           name, inst.logger, inst.notifier, inst.telemetry, listenAddress, port,
           std::unique_ptr<wpi::NetworkAcceptor>(
-              new wpi::TCPAcceptor(port, listenAddress, inst.logger))));
+              new wpi::TCPAcceptor(port, listenAddress, inst.logger)),
+          inst.eventLoop));
 }
 
 std::string GetMjpegServerListenAddress(CS_Sink sink, CS_Status* status) {
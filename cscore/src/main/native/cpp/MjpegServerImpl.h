@@ -22,8 +22,13 @@
 
 #include "SinkImpl.h"
 
+namespace wpi {
+class EventLoopRunner;
+}  // namespace wpi
+
 namespace cs {
 
+class MjpegStreamHub;
 class SourceImpl;
 
 class MjpegServerImpl : public SinkImpl {
@@ -31,7 +36,8 @@ class MjpegServerImpl : public SinkImpl {
   MjpegServerImpl(std::string_view name, wpi::Logger& logger,
                   Notifier& notifier, Telemetry& telemetry,
                   std::string_view listenAddress, int port,
-                  std::unique_ptr<wpi::NetworkAcceptor> acceptor);
+                  std::unique_ptr<wpi::NetworkAcceptor> acceptor,
+                  wpi::EventLoopRunner& eventLoop);
   ~MjpegServerImpl() override;
 
   void Stop();
@@ -55,12 +61,16 @@ class MjpegServerImpl : public SinkImpl {
 
   std::vector<wpi::SafeThreadOwner<ConnThread>> m_connThreads;
 
+  // streams handed off to the event loop; null if unsupported
+  std::shared_ptr<MjpegStreamHub> m_hub;
+
   // property indices
   int m_widthProp;
   int m_heightProp;
   int m_compressionProp;
   int m_defaultCompressionProp;
   int m_fpsProp;
+  int m_eventLoopProp;
 };
 
 }  // namespace cs
@@ -0,0 +1,453 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include "MjpegStreamHub.h"
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <utility>
+
+#include <fmt/format.h>
+#include <wpi/SmallVector.h>
+#include <wpinet/EventLoopRunner.h>
+#include <wpinet/NetworkStream.h>
+#include <wpinet/uv/Buffer.h>
+#include <wpinet/uv/Tcp.h>
+
+#include "Frame.h"
+#include "JpegUtil.h"
+#include "Log.h"
+#include "SinkImpl.h"
+#include "SourceImpl.h"
+
+using namespace cs;
+
+namespace uv = wpi::uv;
+
+// One encoded frame, shared by every client with matching settings.  The
+// buffers point into the header string, the frame's image, and the static
+// DHT table, so the frame is kept alive until the last write completes.
+struct MjpegStreamHub::Packet {
+  Settings settings;
+  Frame frame;
+  Frame::Time time = 0;
+  std::string header;
+  wpi::SmallVector<uv::Buffer, 4> bufs;
+};
+
+struct MjpegStreamHub::Client {
+  Client(std::shared_ptr<uv::Tcp> tcp, const Settings& settings, int fps);
+
+  // Returns false if the frame should be skipped to honor the client's
+  // requested frame rate.
+  bool Pace(Frame::Time thisFrameTime);
+
+  std::shared_ptr<uv::Tcp> tcp;
+  // original connection; see AddClient()
+  std::shared_ptr<wpi::NetworkStream> stream;
+  // encode settings shared with other clients
+  Settings settings;
+  bool writing = false;
+  uint64_t dropped = 0;
+
+  Frame::Time lastFrameTime = 0;
+  Frame::Time timePerFrame = 0;
+  Frame::Time averageFrameTime = 0;
+  Frame::Time averagePeriod = 1000000;  // 1 second window
+};
+
+MjpegStreamHub::Client::Client(std::shared_ptr<uv::Tcp> tcp,
+                               const Settings& settings, int fps)
+    : tcp{std::move(tcp)}, settings{settings} {
+  if (fps != 0) {
+    timePerFrame = 1000000.0 / fps;
+  }
+  if (averagePeriod < timePerFrame) {
+    averagePeriod = timePerFrame * 10;
+  }
+}
+
+bool MjpegStreamHub::Client::Pace(Frame::Time thisFrameTime) {
+  if (thisFrameTime != 0 && timePerFrame != 0 && lastFrameTime != 0) {
+    Frame::Time deltaTime = thisFrameTime - lastFrameTime;
+
+    // drop frame if it is early compared to the desired frame rate AND
+    // the current average is higher than the desired average
+    if (deltaTime < timePerFrame && averageFrameTime < timePerFrame) {
+      return false;
+    }
+
+    // update average
+    if (averageFrameTime != 0) {
+      averageFrameTime =
+          averageFrameTime * (averagePeriod - timePerFrame) / averagePeriod +
+          deltaTime * timePerFrame / averagePeriod;
+    } else {
+      averageFrameTime = deltaTime;
+    }
+  }
+  lastFrameTime = thisFrameTime;
+  return true;
+}
+
+MjpegStreamHub::MjpegStreamHub(std::string_view name, wpi::Logger& logger,
+                               wpi::EventLoopRunner& loop, SinkImpl& sink)
+    : m_name{name}, m_logger{logger}, m_loop{loop}, m_sink{sink} {}
+
+MjpegStreamHub::~MjpegStreamHub() {
+  Stop();
+}
+
+bool MjpegStreamHub::IsSupported() {
+#ifdef _WIN32
+  return false;
+#else
+  return true;
+#endif
+}
+
+bool MjpegStreamHub::IsRunning() {
+  return m_active && m_loop.GetLoop();
+}
+
+MjpegStreamHub::Settings MjpegStreamHub::AcquireSettings(
+    const Settings& requested) {
+  Settings settings = requested;
+  settings.fps = 0;
+  if (settings.compression != -1) {
+    settings.compression =
+        std::clamp((settings.compression + 5) / 10 * 10, 10, 100);
+  }
+  settings.defaultCompression =
+      std::clamp((settings.defaultCompression + 5) / 10 * 10, 10, 100);
+
+  auto it = std::find_if(m_settings.begin(), m_settings.end(),
+                         [&](const auto& s) { return s.first == settings; });
+  if (it == m_settings.end() && m_settings.size() >= kMaxEncodings) {
+    // share the closest resolution, then the closest quality
+    auto distance = [&](const Settings& s) {
+      int64_t area = static_cast<int64_t>(s.width) * s.height -
+                     static_cast<int64_t>(settings.width) * settings.height;
+      return std::pair{std::abs(area),
+                       std::abs(s.compression - settings.compression)};
+    };
+    it = std::min_element(m_settings.begin(), m_settings.end(),
+                          [&](const auto& a, const auto& b) {
+                            return distance(a.first) < distance(b.first);
+                          });
+    SDEBUG("encoding limit reached, sharing stream settings {}x{} q{}",
+           it->first.width, it->first.height, it->first.compression);
+  }
+  if (it == m_settings.end()) {
+    m_settings.emplace_back(settings, 1);
+    return settings;
+  }
+  ++it->second;
+  return it->first;
+}
+
+void MjpegStreamHub::AddClient(std::unique_ptr<wpi::NetworkStream> stream,
+                               const Settings& requested) {
+#ifndef _WIN32
+  Settings settings;
+  {
+    std::scoped_lock lock(m_mutex);
+    if (!m_active) {
+      return;
+    }
+    settings = AcquireSettings(requested);
+    if (m_numClients++ == 0 && m_source) {
+      m_source->EnableSink();
+    }
+    if (!m_pumpThread.joinable()) {
+      m_pumpThread = std::thread(&MjpegStreamHub::PumpMain, this);
+    }
+  }
+  m_cond.notify_one();
+
+  m_loop.ExecAsync([weak = weak_from_this(),
+                    stream = std::shared_ptr<wpi::NetworkStream>{
+                        std::move(stream)},
+                    settings, fps = requested.fps](uv::Loop& loop) {
+    if (auto self = weak.lock()) {
+      self->OpenClient(loop, stream, settings, fps);
+    }
+  });
+#endif
+}
+
+void MjpegStreamHub::OpenClient(uv::Loop& loop,
+                                std::shared_ptr<wpi::NetworkStream> stream,
+                                const Settings& settings, int fps) {
+#ifndef _WIN32
+  if (!m_active) {
+    ReleaseSettings(settings);
+    return;
+  }
+
+  // uv gets its own descriptor; closing the stream would shut down the
+  // socket, so it is kept open until uv is done with the duplicate
+  int fd = ::dup(stream->getNativeHandle());
+  auto tcp = fd < 0 ? nullptr : uv::Tcp::Create(loop);
+  if (!tcp) {
+    SWARNING("could not hand off stream to event loop");
+    if (fd >= 0) {
+      ::close(fd);
+    }
+    ReleaseSettings(settings);
+    return;
+  }
+  tcp->Open(fd);
+
+  auto client = std::make_shared<Client>(tcp, settings, fps);
+  client->stream = std::move(stream);
+  m_clients.emplace_back(client);
+
+  // reads only serve to detect the client going away
+  tcp->end.connect([t = tcp.get()] { t->Close(); });
+  tcp->error.connect([t = tcp.get()](uv::Error) { t->Close(); });
+  tcp->closed.connect([weak = weak_from_this(), c = client.get()] {
+    if (auto self = weak.lock()) {
+      self->RemoveClient(c);
+    }
+  });
+  tcp->StartRead();
+#endif
+}
+
+void MjpegStreamHub::SetSource(std::shared_ptr<SourceImpl> source) {
+  std::scoped_lock lock(m_mutex);
+  if (m_source == source) {
+    return;
+  }
+  if (m_source && m_numClients > 0) {
+    m_source->DisableSink();
+  }
+  m_source = std::move(source);
+  if (m_source && m_numClients > 0) {
+    m_source->EnableSink();
+  }
+}
+
+void MjpegStreamHub::Stop() {
+  if (!m_active.exchange(false)) {
+    return;
+  }
+
+  // wake up pump thread by forcing an empty frame
+  std::shared_ptr<SourceImpl> source;
+  {
+    std::scoped_lock lock(m_mutex);
+    source = m_source;
+  }
+  m_cond.notify_all();
+  if (source) {
+    source->Wakeup();
+  }
+  if (m_pumpThread.joinable()) {
+    m_pumpThread.join();
+  }
+
+  // close clients
+  m_loop.ExecSync([this](uv::Loop&) {
+    for (auto&& client : m_clients) {
+      client->tcp->Close();
+    }
+    m_clients.clear();
+  });
+
+  std::scoped_lock lock(m_mutex);
+  if (m_source && m_numClients > 0) {
+    m_source->DisableSink();
+  }
+  m_numClients = 0;
+  m_settings.clear();
+}
+
+void MjpegStreamHub::PumpMain() {
+  std::vector<Settings> settings;
+  std::vector<std::shared_ptr<Packet>> packets;
+
+  std::unique_lock lock(m_mutex);
+  while (m_active) {
+    m_cond.wait(lock, [&] { return !m_active || !m_settings.empty(); });
+    if (!m_active) {
+      break;
+    }
+    auto source = m_source;
+    lock.unlock();
+
+    if (!source) {
+      // Source disconnected; sleep so we don't consume all processor time.
+      KeepAlive();
+      std::this_thread::sleep_for(std::chrono::milliseconds(200));
+      lock.lock();
+      continue;
+    }
+    SDEBUG4("waiting for frame");
+    Frame frame = source->GetNextFrame(0.225);  // blocks
+    if (!m_active) {
+      break;
+    }
+    if (!frame) {
+      // Bad frame; sleep for 20 ms so we don't consume all processor time.
+      KeepAlive();
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+      lock.lock();
+      continue;
+    }
+
+    // encode once per distinct client setting
+    lock.lock();
+    settings.clear();
+    for (auto&& s : m_settings) {
+      settings.emplace_back(s.first);
+    }
+    lock.unlock();
+
+    packets.clear();
+    for (auto&& s : settings) {
+      if (auto packet = MakePacket(frame, s)) {
+        packets.emplace_back(std::move(packet));
+      }
+    }
+
+    if (!packets.empty()) {
+      m_sink.RecordFrameLatency(frame);
+      m_loop.ExecAsync([weak = weak_from_this(), packets = std::move(packets)](
+                           uv::Loop&) {
+        if (auto self = weak.lock()) {
+          self->Distribute(packets);
+        }
+      });
+    }
+    lock.lock();
+  }
+}
+
+std::shared_ptr<MjpegStreamHub::Packet> MjpegStreamHub::MakePacket(
+    Frame& frame, const Settings& settings) {
+  int width = settings.width != 0 ? settings.width : frame.GetOriginalWidth();
+  int height =
+      settings.height != 0 ? settings.height : frame.GetOriginalHeight();
+  Image* image = frame.GetImageMJPEG(width, height, settings.compression,
+                                     settings.compression == -1
+                                         ? settings.defaultCompression
+                                         : settings.compression);
+  if (!image || image->pixelFormat != VideoMode::kMJPEG) {
+    return nullptr;
+  }
+
+  const char* data = image->data();
+  size_t size = image->size();
+  size_t locSOF = size;
+  // Determine if we need to add DHT to it
+  bool addDHT = JpegNeedsDHT(data, &size, &locSOF);
+
+  auto packet = std::make_shared<Packet>();
+  packet->settings = settings;
+  packet->frame = frame;
+  packet->time = frame.GetTime();
+
+  // sending the content-length fixes random stream disruption observed
+  // with firefox
+  packet->header = fmt::format(
+      "\r\n--" BOUNDARY
+      "\r\nContent-Type: image/jpeg\r\nContent-Length: {}\r\n"
+      "X-Timestamp: {}\r\n\r\n",
+      size, packet->time / 1000000.0);
+  packet->bufs.emplace_back(packet->header);
+  if (addDHT) {
+    // Insert DHT data immediately before SOF
+    packet->bufs.emplace_back(data, locSOF);
+    packet->bufs.emplace_back(JpegGetDHT());
+    packet->bufs.emplace_back(data + locSOF, image->size() - locSOF);
+  } else {
+    packet->bufs.emplace_back(data, size);
+  }
+  return packet;
+}
+
+void MjpegStreamHub::Distribute(
+    std::span<const std::shared_ptr<Packet>> packets) {
+  for (auto&& client : m_clients) {
+    auto it = std::find_if(packets.begin(), packets.end(), [&](auto&& p) {
+      return p->settings == client->settings;
+    });
+    if (it == packets.end()) {
+      continue;
+    }
+    // drop the frame if the client hasn't finished receiving the last one
+    if (client->writing) {
+      ++client->dropped;
+      continue;
+    }
+    if (!client->Pace((*it)->time)) {
+      continue;
+    }
+    SDEBUG4("sending frame to client ({} dropped)", client->dropped);
+    client->writing = true;
+    client->tcp->Write((*it)->bufs,
+                       [client, packet = *it](auto, uv::Error err) {
+                         client->writing = false;
+                         if (err) {
+                           client->tcp->Close();
+                         }
+                       });
+  }
+}
+
+void MjpegStreamHub::KeepAlive() {
+  static const uv::Buffer crlf{"\r\n"};
+  m_loop.ExecAsync([weak = weak_from_this()](uv::Loop&) {
+    auto self = weak.lock();
+    if (!self) {
+      return;
+    }
+    for (auto&& client : self->m_clients) {
+      if (!client->writing) {
+        client->writing = true;
+        client->tcp->Write({&crlf, 1},
+                           [client](auto, uv::Error err) {
+                             client->writing = false;
+                             if (err) {
+                               client->tcp->Close();
+                             }
+                           });
+      }
+    }
+  });
+}
+
+void MjpegStreamHub::RemoveClient(Client* client) {
+  auto it = std::find_if(m_clients.begin(), m_clients.end(),
+                         [&](auto&& c) { return c.get() == client; });
+  if (it == m_clients.end()) {
+    return;
+  }
+  SDEBUG("stream client disconnected ({} frames dropped)", client->dropped);
+  Settings settings = client->settings;
+  m_clients.erase(it);
+  ReleaseSettings(settings);
+}
+
+void MjpegStreamHub::ReleaseSettings(const Settings& settings) {
+  std::scoped_lock lock(m_mutex);
+  if (m_numClients == 0) {
+    return;
+  }
+  auto it = std::find_if(m_settings.begin(), m_settings.end(),
+                         [&](const auto& s) { return s.first == settings; });
+  if (it != m_settings.end() && --it->second == 0) {
+    m_settings.erase(it);
+  }
+  if (--m_numClients == 0 && m_source) {
+    m_source->DisableSink();
+  }
+}
@@ -0,0 +1,145 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#ifndef CSCORE_MJPEGSTREAMHUB_H_
+#define CSCORE_MJPEGSTREAMHUB_H_
+
+#include <atomic>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <wpi/Logger.h>
+#include <wpi/condition_variable.h>
+#include <wpi/mutex.h>
+
+// The boundary used for the M-JPEG stream.
+// It separates the multipart stream of pictures
+#define BOUNDARY "boundarydonotcross"
+
+namespace wpi {
+class EventLoopRunner;
+class NetworkStream;
+namespace uv {
+class Loop;
+}  // namespace uv
+}  // namespace wpi
+
+namespace cs {
+
+class Frame;
+class SinkImpl;
+class SourceImpl;
+
+/**
+ * Streams MJPEG to any number of HTTP clients from the shared event loop.
+ *
+ * A single pump thread waits on the source and encodes each frame once per
+ * distinct client setting (resolution and quality).  Requested qualities are
+ * rounded, and once kMaxEncodings settings are in use new clients share the
+ * nearest existing one, so the encode cost is bounded regardless of how many
+ * clients connect.  Frame rate is paced per client.  The event loop then
+ * writes the same buffers to every client with non-blocking writes.  A client
+ * whose previous frame is still being written skips frames instead of
+ * queueing them, so a slow viewer never delays the others.
+ */
+class MjpegStreamHub : public std::enable_shared_from_this<MjpegStreamHub> {
+  friend class MjpegStreamHubTest;
+
+ public:
+  struct Settings {
+    int width = 0;
+    int height = 0;
+    int compression = -1;
+    int defaultCompression = 80;
+    int fps = 0;
+
+    bool operator==(const Settings&) const = default;
+  };
+
+  // maximum number of distinct settings encoded per frame
+  static constexpr size_t kMaxEncodings = 4;
+
+  MjpegStreamHub(std::string_view name, wpi::Logger& logger,
+                 wpi::EventLoopRunner& loop, SinkImpl& sink);
+  ~MjpegStreamHub();
+
+  MjpegStreamHub(const MjpegStreamHub&) = delete;
+  MjpegStreamHub& operator=(const MjpegStreamHub&) = delete;
+
+  /**
+   * Returns true if clients can be handed off on this platform.
+   */
+  static bool IsSupported();
+
+  /**
+   * Returns false once the hub or its event loop has stopped; clients must
+   * then be served elsewhere.
+   */
+  bool IsRunning();
+
+  /**
+   * Hands a client connection to the hub.  The multipart HTTP response header
+   * must already have been sent.
+   *
+   * @param stream client connection
+   * @param requested stream settings requested by the client
+   */
+  void AddClient(std::unique_ptr<wpi::NetworkStream> stream,
+                 const Settings& requested);
+
+  void SetSource(std::shared_ptr<SourceImpl> source);
+
+  size_t GetNumClients() const { return m_numClients; }
+
+  /**
+   * Closes all clients and stops the pump thread.  Must not be called from
+   * the event loop thread.
+   */
+  void Stop();
+
+ private:
+  struct Packet;
+  struct Client;
+
+  std::string_view GetName() const { return m_name; }
+
+  Settings AcquireSettings(const Settings& requested);
+  void OpenClient(wpi::uv::Loop& loop,
+                  std::shared_ptr<wpi::NetworkStream> stream,
+                  const Settings& settings, int fps);
+  void PumpMain();
+  std::shared_ptr<Packet> MakePacket(Frame& frame, const Settings& settings);
+  void Distribute(std::span<const std::shared_ptr<Packet>> packets);
+  void KeepAlive();
+  void RemoveClient(Client* client);
+  void ReleaseSettings(const Settings& settings);
+
+  std::string m_name;
+  wpi::Logger& m_logger;
+  wpi::EventLoopRunner& m_loop;
+  SinkImpl& m_sink;  // owning server, for telemetry
+
+  std::atomic_bool m_active{true};
+  std::atomic<size_t> m_numClients{0};
+
+  wpi::mutex m_mutex;
+  wpi::condition_variable m_cond;
+  std::shared_ptr<SourceImpl> m_source;
+  // distinct client encode settings (with fps zeroed) and use counts;
+  // protected by m_mutex
+  std::vector<std::pair<Settings, int>> m_settings;
+  std::thread m_pumpThread;
+
+  // only accessed from the event loop thread
+  std::vector<std::shared_ptr<Client>> m_clients;
+};
+
+}  // namespace cs
+
+#endif  // CSCORE_MJPEGSTREAMHUB_H_
@@ -80,6 +80,13 @@ uint64_t RawSinkImpl::GrabFrame(WPI_RawFrame& image, double timeout) {
   return GrabFrameImpl(image, frame);
 }
 
+bool RawSinkImpl::CanGrab(const WPI_RawFrame& frame) const {
+  // an unknown format always gets the original image
+  return frame.pixelFormat == WPI_PIXFMT_UNKNOWN || GetRegion().IsFull() ||
+         ImageRegion::SupportsPixelFormat(
+             static_cast<VideoMode::PixelFormat>(frame.pixelFormat));
+}
+
 uint64_t RawSinkImpl::GrabFrameImpl(WPI_RawFrame& rawFrame,
                                     Frame& incomingFrame) {
   Image* newImage = nullptr;
@@ -87,6 +94,10 @@ uint64_t RawSinkImpl::GrabFrameImpl(WPI_RawFrame& rawFrame,
   if (rawFrame.pixelFormat == WPI_PixelFormat::WPI_PIXFMT_UNKNOWN) {
     // Always get incoming image directly on unknown
     newImage = incomingFrame.GetExistingImage(0);
+  } else if (auto region = GetRegion(); !region.IsFull()) {
+    // The region of interest determines the size
+    newImage = incomingFrame.GetImage(
+        region, static_cast<VideoMode::PixelFormat>(rawFrame.pixelFormat));
   } else {
     // Format is known, ask for it
     auto width = rawFrame.width;
@@ -113,6 +124,7 @@ uint64_t RawSinkImpl::GrabFrameImpl(WPI_RawFrame& rawFrame,
   rawFrame.pixelFormat = newImage->pixelFormat;
   rawFrame.size = newImage->size();
   std::copy(newImage->data(), newImage->data() + rawFrame.size, rawFrame.data);
+  RecordFrameLatency(incomingFrame);
 
   return incomingFrame.GetTime();
 }
@@ -165,7 +177,12 @@ uint64_t GrabSinkFrame(CS_Sink sink, WPI_RawFrame& image, CS_Status* status) {
     *status = CS_INVALID_HANDLE;
     return 0;
   }
-  return static_cast<RawSinkImpl&>(*data->sink).GrabFrame(image);
+  auto& rawSink = static_cast<RawSinkImpl&>(*data->sink);
+  if (!rawSink.CanGrab(image)) {
+    *status = CS_UNSUPPORTED_MODE;
+    return 0;
+  }
+  return rawSink.GrabFrame(image);
 }
 
 uint64_t GrabSinkFrameTimeout(CS_Sink sink, WPI_RawFrame& image, double timeout,
@@ -175,7 +192,12 @@ uint64_t GrabSinkFrameTimeout(CS_Sink sink, WPI_RawFrame& image, double timeout,
     *status = CS_INVALID_HANDLE;
     return 0;
   }
-  return static_cast<RawSinkImpl&>(*data->sink).GrabFrame(image, timeout);
+  auto& rawSink = static_cast<RawSinkImpl&>(*data->sink);
+  if (!rawSink.CanGrab(image)) {
+    *status = CS_UNSUPPORTED_MODE;
+    return 0;
+  }
+  return rawSink.GrabFrame(image, timeout);
 }
 }  // namespace cs
 
@@ -35,6 +35,10 @@ class RawSinkImpl : public SinkImpl {
   uint64_t GrabFrame(WPI_RawFrame& frame);
   uint64_t GrabFrame(WPI_RawFrame& frame, double timeout);
 
+  // false if the region of interest can't be converted to the frame's
+  // requested pixel format
+  bool CanGrab(const WPI_RawFrame& frame) const;
+
  private:
   void ThreadMain();
 
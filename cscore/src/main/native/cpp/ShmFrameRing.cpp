@@ -0,0 +1,546 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include "ShmFrameRing.h"
+
+#include <atomic>
+#include <chrono>
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+
+#include <fmt/format.h>
+#include <wpi/RawFrame.h>
+#include <wpi/timestamp.h>
+
+#include "cscore_c.h"
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+using namespace cs;
+
+static constexpr uint32_t kMagic = 0x52465343;  // "CSFR"
+static constexpr uint32_t kVersion = 2;
+static constexpr size_t kAlign = 64;
+// reader table pid while a stale entry is being freed
+static constexpr uint32_t kReclaiming = UINT32_MAX;
+
+// All of these live in the shared segment, so they must be plain data and
+// the atomics must not need a lock.
+static_assert(std::atomic<uint32_t>::is_always_lock_free);
+
+struct ShmFrameRing::Header {
+  // set last by the writer, once everything else is initialized
+  std::atomic<uint32_t> magic;
+  uint32_t version;
+  uint32_t numSlots;
+  int32_t fps;
+  uint64_t slotSize;
+  // sequence number of the newest frame; readers wait on this
+  std::atomic<uint32_t> sequence;
+  // slot holding the newest frame; numSlots if there is none
+  std::atomic<uint32_t> latestSlot;
+  // number of readers waiting on sequence
+  std::atomic<uint32_t> waiters;
+  // set by the writer when it closes the ring
+  std::atomic<uint32_t> closed;
+};
+
+struct ShmFrameRing::Reader {
+  // process that opened the ring; 0 if the entry is free
+  std::atomic<uint32_t> pid;
+  // start time of that process, so a reused pid is not mistaken for it; 0
+  // while the entry is being claimed
+  std::atomic<uint32_t> startTime;
+  // slots pinned by the reader, one bit per slot
+  std::atomic<uint32_t> pinned;
+};
+
+struct ShmFrameRing::Slot {
+  // sequence number of the frame in the slot; 0 while empty or being written
+  std::atomic<uint32_t> sequence;
+  int32_t pixelFormat;
+  int32_t width;
+  int32_t height;
+  int32_t timeSource;
+  uint64_t time;
+  uint64_t size;
+};
+
+static constexpr size_t RoundUp(size_t size) {
+  return (size + kAlign - 1) / kAlign * kAlign;
+}
+
+size_t ShmFrameRing::ReadersOffset() {
+  return RoundUp(sizeof(Header));
+}
+
+size_t ShmFrameRing::SlotsOffset() {
+  return ReadersOffset() + RoundUp(kMaxReaders * sizeof(Reader));
+}
+
+size_t ShmFrameRing::DataOffset(size_t numSlots) {
+  return SlotsOffset() + RoundUp(numSlots * sizeof(Slot));
+}
+
+size_t ShmFrameRing::SegmentSize(size_t numSlots, size_t slotSize) {
+  return DataOffset(numSlots) + numSlots * RoundUp(slotSize);
+}
+
+static std::string NormalizeName(std::string_view name) {
+  if (name.starts_with('/')) {
+    return std::string{name};
+  }
+  return fmt::format("/{}", name);
+}
+
+#ifdef __linux__
+static void FutexWait(std::atomic<uint32_t>* addr, uint32_t value,
+                      std::chrono::nanoseconds timeout) {
+  struct timespec ts;
+  ts.tv_sec = timeout.count() / 1000000000;
+  ts.tv_nsec = timeout.count() % 1000000000;
+  // not FUTEX_PRIVATE_FLAG, as the waker is in another process
+  syscall(SYS_futex, reinterpret_cast<uint32_t*>(addr), FUTEX_WAIT, value,
+          &ts, nullptr, 0);
+}
+
+static void FutexWake(std::atomic<uint32_t>* addr) {
+  syscall(SYS_futex, reinterpret_cast<uint32_t*>(addr), FUTEX_WAKE, INT_MAX,
+          nullptr, nullptr, 0);
+}
+
+// Returns the inode of the named segment, or 0 if it does not exist.
+static uint64_t GetInode(const std::string& name) {
+  int fd = shm_open(name.c_str(), O_RDONLY, 0);
+  if (fd < 0) {
+    return 0;
+  }
+  struct stat st;
+  uint64_t inode = fstat(fd, &st) == 0 ? st.st_ino : 0;
+  close(fd);
+  return inode;
+}
+
+// Returns the start time of a process (truncated to 32 bits), or 0 if it does
+// not exist.
+static uint32_t GetProcessStartTime(uint32_t pid) {
+  int fd = open(fmt::format("/proc/{}/stat", pid).c_str(), O_RDONLY);
+  if (fd < 0) {
+    return 0;
+  }
+  char buf[512];
+  ssize_t len = read(fd, buf, sizeof(buf) - 1);
+  close(fd);
+  if (len <= 0) {
+    return 0;
+  }
+  buf[len] = '\0';
+  // the command name may contain spaces, so skip past it; the start time is
+  // then the 20th field
+  const char* p = std::strrchr(buf, ')');
+  if (!p) {
+    return 0;
+  }
+  ++p;
+  for (int i = 0; i < 19 && p; ++i) {
+    p = std::strchr(p + 1, ' ');
+  }
+  if (!p) {
+    return 0;
+  }
+  auto startTime = static_cast<uint32_t>(std::strtoull(p, nullptr, 10));
+  return startTime == 0 ? 1 : startTime;
+}
+#endif
+
+std::shared_ptr<ShmFrameRing> ShmFrameRing::Create(std::string_view name,
+                                                   int numSlots,
+                                                   size_t slotSize, int fps,
+                                                   std::string* error) {
+#ifdef __linux__
+  if (numSlots < 2 || numSlots > kMaxSlots) {
+    *error = fmt::format("between 2 and {} slots are required", kMaxSlots);
+    return nullptr;
+  }
+  auto shmName = NormalizeName(name);
+  size_t size = SegmentSize(numSlots, slotSize);
+
+  // a previous writer may have exited without removing its segment
+  shm_unlink(shmName.c_str());
+  // only readers running as the same user may open it
+  int fd = shm_open(shmName.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+  if (fd < 0) {
+    *error = fmt::format("could not create '{}': {}", shmName,
+                         std::strerror(errno));
+    return nullptr;
+  }
+  struct stat st;
+  void* base = MAP_FAILED;
+  if (ftruncate(fd, size) == 0 && fstat(fd, &st) == 0) {
+    base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  }
+  if (base == MAP_FAILED) {
+    *error = fmt::format("could not map '{}': {}", shmName,
+                         std::strerror(errno));
+    close(fd);
+    shm_unlink(shmName.c_str());
+    return nullptr;
+  }
+  close(fd);
+
+  // the segment starts zeroed, so only nonzero fields need to be set
+  auto header = static_cast<Header*>(base);
+  header->version = kVersion;
+  header->numSlots = numSlots;
+  header->fps = fps;
+  header->slotSize = slotSize;
+  header->latestSlot = numSlots;
+  header->magic.store(kMagic, std::memory_order_release);
+
+  return std::make_shared<ShmFrameRing>(shmName, base, size, st.st_ino, true,
+                                        private_init{});
+#else
+  *error = "shared memory frames are only supported on Linux";
+  return nullptr;
+#endif
+}
+
+std::shared_ptr<ShmFrameRing> ShmFrameRing::Open(std::string_view name,
+                                                 std::string* error) {
+#ifdef __linux__
+  auto shmName = NormalizeName(name);
+  // readers need write access to pin slots
+  int fd = shm_open(shmName.c_str(), O_RDWR, 0);
+  if (fd < 0) {
+    *error = fmt::format("could not open '{}': {}", shmName,
+                         std::strerror(errno));
+    return nullptr;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 ||
+      static_cast<size_t>(st.st_size) < sizeof(Header)) {
+    *error = fmt::format("'{}' is not initialized", shmName);
+    close(fd);
+    return nullptr;
+  }
+  size_t size = st.st_size;
+  void* base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (base == MAP_FAILED) {
+    *error = fmt::format("could not map '{}': {}", shmName,
+                         std::strerror(errno));
+    return nullptr;
+  }
+
+  auto header = static_cast<Header*>(base);
+  if (header->magic.load(std::memory_order_acquire) != kMagic ||
+      header->version != kVersion || header->numSlots < 2 ||
+      header->numSlots > kMaxSlots ||
+      SegmentSize(header->numSlots, header->slotSize) > size) {
+    *error = fmt::format("'{}' is not initialized or not a frame ring",
+                         shmName);
+    munmap(base, size);
+    return nullptr;
+  }
+
+  auto ring = std::make_shared<ShmFrameRing>(shmName, base, size, st.st_ino,
+                                             false, private_init{});
+  ring->m_reader = ring->ClaimReader();
+  if (!ring->m_reader) {
+    ring->ReclaimStaleReaders();
+    ring->m_reader = ring->ClaimReader();
+  }
+  if (!ring->m_reader) {
+    *error = fmt::format("'{}' has too many readers", shmName);
+    return nullptr;
+  }
+  return ring;
+#else
+  *error = "shared memory frames are only supported on Linux";
+  return nullptr;
+#endif
+}
+
+ShmFrameRing::ShmFrameRing(const std::string& name, void* base, size_t size,
+                           uint64_t inode, bool owner, const private_init&)
+    : m_name{name},
+      m_base{base},
+      m_size{size},
+      m_inode{inode},
+      m_owner{owner},
+      m_header{static_cast<Header*>(base)},
+      m_numSlots{static_cast<int>(m_header->numSlots)},
+      m_slotSize{m_header->slotSize} {}
+
+ShmFrameRing::~ShmFrameRing() {
+#ifdef __linux__
+  if (m_reader) {
+    m_reader->pinned = 0;
+    m_reader->startTime = 0;
+    m_reader->pid = 0;
+  }
+  if (m_owner) {
+    m_header->closed = 1;
+    FutexWake(&m_header->sequence);
+    // leave a segment created by a newer writer alone
+    if (!IsReplaced()) {
+      shm_unlink(m_name.c_str());
+    }
+  }
+  munmap(m_base, m_size);
+#endif
+}
+
+int ShmFrameRing::GetNumSlots() const {
+  return m_numSlots;
+}
+
+size_t ShmFrameRing::GetSlotSize() const {
+  return m_slotSize;
+}
+
+int ShmFrameRing::GetFps() const {
+  return m_header->fps;
+}
+
+ShmFrameRing::Reader& ShmFrameRing::GetReader(int reader) const {
+  return reinterpret_cast<Reader*>(static_cast<char*>(m_base) +
+                                   ReadersOffset())[reader];
+}
+
+ShmFrameRing::Slot& ShmFrameRing::GetSlot(int slot) const {
+  return reinterpret_cast<Slot*>(static_cast<char*>(m_base) +
+                                 SlotsOffset())[slot];
+}
+
+void* ShmFrameRing::GetSlotData(int slot) {
+  return static_cast<char*>(m_base) + DataOffset(m_numSlots) +
+         slot * RoundUp(m_slotSize);
+}
+
+ShmFrameRing::Reader* ShmFrameRing::ClaimReader() {
+#ifdef __linux__
+  uint32_t pid = getpid();
+  uint32_t startTime = GetProcessStartTime(pid);
+  for (int i = 0; i < kMaxReaders; ++i) {
+    Reader& reader = GetReader(i);
+    uint32_t free = 0;
+    if (reader.pid.compare_exchange_strong(free, pid)) {
+      reader.startTime = startTime;
+      return &reader;
+    }
+  }
+#endif
+  return nullptr;
+}
+
+void ShmFrameRing::ReclaimStaleReaders() {
+#ifdef __linux__
+  for (int i = 0; i < kMaxReaders; ++i) {
+    Reader& reader = GetReader(i);
+    uint32_t pid = reader.pid;
+    uint32_t startTime = reader.startTime;
+    if (pid == 0 || pid == kReclaiming || startTime == 0 ||
+        GetProcessStartTime(pid) == startTime) {
+      continue;
+    }
+    // the reader and writer may both be reclaiming; only one frees the entry
+    if (reader.pid.compare_exchange_strong(pid, kReclaiming)) {
+      reader.pinned = 0;
+      reader.startTime = 0;
+      reader.pid = 0;
+    }
+  }
+#endif
+}
+
+uint32_t ShmFrameRing::GetPinnedSlots() const {
+  uint32_t pinned = 0;
+  for (int i = 0; i < kMaxReaders; ++i) {
+    pinned |= GetReader(i).pinned;
+  }
+  return pinned;
+}
+
+int ShmFrameRing::ClaimFreeSlot() {
+  int latest = m_header->latestSlot.load(std::memory_order_relaxed);
+  for (int i = 0; i < m_numSlots; ++i) {
+    int index = (m_nextSlot + i) % m_numSlots;
+    // keep the newest frame available to readers
+    if (index == latest) {
+      continue;
+    }
+    uint32_t bit = 1u << index;
+    if ((GetPinnedSlots() & bit) != 0) {
+      continue;
+    }
+    // Mark the slot as being written, then check again for a reader that
+    // pinned it in the meantime.  A reader pins before checking the slot
+    // sequence, so one of the two always sees the other.
+    Slot& slot = GetSlot(index);
+    uint32_t prev = slot.sequence.exchange(0);
+    if ((GetPinnedSlots() & bit) != 0) {
+      slot.sequence = prev;
+      continue;
+    }
+    return index;
+  }
+  return -1;
+}
+
+bool ShmFrameRing::Write(const FrameInfo& info, const void* data) {
+  if (info.size > m_slotSize) {
+    return false;
+  }
+  int index = ClaimFreeSlot();
+  if (index < 0) {
+    // a reader may have exited while holding pins
+    ReclaimStaleReaders();
+    index = ClaimFreeSlot();
+    if (index < 0) {
+      return false;
+    }
+  }
+
+  Slot& slot = GetSlot(index);
+  std::memcpy(GetSlotData(index), data, info.size);
+  slot.pixelFormat = info.pixelFormat;
+  slot.width = info.width;
+  slot.height = info.height;
+  slot.time = info.time;
+  slot.timeSource = info.timeSource;
+  slot.size = info.size;
+
+  uint32_t sequence = m_header->sequence.load(std::memory_order_relaxed);
+  if (++sequence == 0) {
+    sequence = 1;  // 0 means no frame
+  }
+  slot.sequence.store(sequence, std::memory_order_release);
+  m_header->latestSlot = index;
+  m_header->sequence = sequence;
+#ifdef __linux__
+  if (m_header->waiters != 0) {
+    FutexWake(&m_header->sequence);
+  }
+#endif
+  m_nextSlot = (index + 1) % m_numSlots;
+  return true;
+}
+
+int ShmFrameRing::Acquire(uint32_t* lastSequence, double timeout,
+                          FrameInfo* info) {
+  auto deadline = std::chrono::steady_clock::now() +
+                  std::chrono::duration_cast<std::chrono::nanoseconds>(
+                      std::chrono::duration<double>(timeout));
+  for (;;) {
+    uint32_t sequence = m_header->sequence;
+    if (sequence != 0 && sequence != *lastSequence) {
+      uint32_t index = m_header->latestSlot;
+      if (index >= static_cast<uint32_t>(m_numSlots)) {
+        return -1;  // corrupt header
+      }
+      Slot& slot = GetSlot(index);
+      uint32_t bit = 1u << index;
+      m_reader->pinned |= bit;
+      uint32_t slotSequence = slot.sequence.load(std::memory_order_acquire);
+      if (slotSequence != 0 && slotSequence != *lastSequence) {
+        FrameInfo frame{.time = slot.time,
+                        .timeSource = slot.timeSource,
+                        .pixelFormat = slot.pixelFormat,
+                        .width = slot.width,
+                        .height = slot.height,
+                        .size = slot.size};
+        *lastSequence = slotSequence;
+        if (IsValidFrame(frame)) {
+          *info = frame;
+          return index;
+        }
+      }
+      m_reader->pinned &= ~bit;
+      // the writer moved on while we were pinning, or the frame was invalid;
+      // try the newer frame
+      continue;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    if (m_header->closed != 0 || now >= deadline) {
+      return -1;
+    }
+#ifdef __linux__
+    ++m_header->waiters;
+    FutexWait(&m_header->sequence, sequence, deadline - now);
+    --m_header->waiters;
+#endif
+    if (m_header->sequence == sequence) {
+      return -1;  // timed out or woken for another reason
+    }
+  }
+}
+
+void ShmFrameRing::Release(int slot) {
+  m_reader->pinned &= ~(1u << slot);
+}
+
+bool ShmFrameRing::IsValidFrame(const FrameInfo& info) const {
+  if (info.size > m_slotSize || info.width < 0 || info.height < 0 ||
+      info.timeSource < CS_TIMESRC_UNKNOWN ||
+      info.timeSource > CS_TIMESRC_V4L_SOE) {
+    return false;
+  }
+  // raw images must hold every pixel
+  uint64_t pixels = static_cast<uint64_t>(info.width) * info.height;
+  switch (info.pixelFormat) {
+    case WPI_PIXFMT_UNKNOWN:
+    case WPI_PIXFMT_MJPEG:
+      return true;
+    case WPI_PIXFMT_GRAY:
+      return info.size >= pixels;
+    case WPI_PIXFMT_YUYV:
+    case WPI_PIXFMT_UYVY:
+    case WPI_PIXFMT_RGB565:
+    case WPI_PIXFMT_Y16:
+      return info.size >= pixels * 2;
+    case WPI_PIXFMT_BGR:
+      return info.size >= pixels * 3;
+    default:
+      return false;
+  }
+}
+
+bool ShmFrameRing::IsStale() const {
+  return m_header->closed != 0 || IsReplaced();
+}
+
+bool ShmFrameRing::IsReplaced() const {
+#ifdef __linux__
+  return GetInode(m_name) != m_inode;
+#else
+  return false;
+#endif
+}
+
+// wpi::Now() has a per-process offset, while the steady clock (the monotonic
+// clock on Linux) is the same in every process.
+uint64_t ShmFrameRing::ToSharedTime(uint64_t time) {
+  uint64_t steady = std::chrono::duration_cast<std::chrono::microseconds>(
+                        std::chrono::steady_clock::now().time_since_epoch())
+                        .count();
+  return steady - (wpi::Now() - time);
+}
+
+uint64_t ShmFrameRing::FromSharedTime(uint64_t time) {
+  uint64_t steady = std::chrono::duration_cast<std::chrono::microseconds>(
+                        std::chrono::steady_clock::now().time_since_epoch())
+                        .count();
+  return wpi::Now() - (steady - time);
+}
@@ -0,0 +1,177 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#ifndef CSCORE_SHMFRAMERING_H_
+#define CSCORE_SHMFRAMERING_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace cs {
+
+/**
+ * A ring of frame slots in a named shared memory segment, used to pass raw
+ * frames between processes on the same machine.
+ *
+ * One process creates the ring and writes frames into it; up to kMaxReaders
+ * rings opened by processes of the same user read frames in place.  Readers
+ * pin the slot they are reading, and the writer never reuses a pinned slot, so
+ * a reader can hold a frame for as long as it needs without copying it.  If
+ * every slot other than the newest is pinned, the writer drops frames until
+ * one is released.  Pins are recorded per reader along with its process, so
+ * the pins of a reader that exited without releasing them are dropped once
+ * the writer runs out of slots.  This requires readers to be in the same PID
+ * namespace as the writer.  Readers block on a futex in the segment, so
+ * waiting costs no CPU time and the writer only makes a wake system call when
+ * someone is waiting.
+ *
+ * Only supported on Linux; elsewhere Create() and Open() always fail.
+ */
+class ShmFrameRing {
+  struct private_init {};
+
+ public:
+  static constexpr int kMaxSlots = 32;
+  static constexpr int kMaxReaders = 32;
+
+  struct FrameInfo {
+    // capture time in the shared time base; see ToSharedTime()
+    uint64_t time = 0;
+    // CS_TimestampSource of time
+    int timeSource = 0;
+    int pixelFormat = 0;
+    int width = 0;
+    int height = 0;
+    size_t size = 0;
+  };
+
+  /**
+   * Creates a new ring, replacing any existing segment with the same name.
+   *
+   * @param name segment name
+   * @param numSlots number of frame slots; 2 to kMaxSlots
+   * @param slotSize maximum frame size in bytes
+   * @param fps nominal frame rate, for readers
+   * @param error set to the failure reason if nullptr is returned
+   */
+  static std::shared_ptr<ShmFrameRing> Create(std::string_view name,
+                                              int numSlots, size_t slotSize,
+                                              int fps, std::string* error);
+
+  /**
+   * Opens an existing ring for reading.  Fails if kMaxReaders rings are
+   * already open.
+   *
+   * @param name segment name
+   * @param error set to the failure reason if nullptr is returned
+   */
+  static std::shared_ptr<ShmFrameRing> Open(std::string_view name,
+                                            std::string* error);
+
+  ShmFrameRing(const std::string& name, void* base, size_t size,
+               uint64_t inode, bool owner, const private_init&);
+  ~ShmFrameRing();
+
+  ShmFrameRing(const ShmFrameRing&) = delete;
+  ShmFrameRing& operator=(const ShmFrameRing&) = delete;
+
+  int GetNumSlots() const;
+  size_t GetSlotSize() const;
+  int GetFps() const;
+
+  /**
+   * Copies a frame into a free slot and wakes waiting readers.
+   *
+   * @param info frame information; size must be at most the slot size
+   * @param data frame data
+   * @return False if the frame is too large or no slot is free
+   */
+  bool Write(const FrameInfo& info, const void* data);
+
+  /**
+   * Waits for a frame newer than the last one read and pins its slot.  The
+   * slot must be released with Release() once the data is no longer used.
+   *
+   * @param lastSequence sequence number of the last frame read (0 for none);
+   *                     updated to the sequence number of the returned frame
+   * @param timeout maximum time to wait, in seconds
+   * @param info set to the frame information
+   * @return Slot index, or -1 on timeout; may also return -1 early.  Frames
+   *         with invalid information are skipped.
+   */
+  int Acquire(uint32_t* lastSequence, double timeout, FrameInfo* info);
+
+  /**
+   * Gets the data of a slot pinned with Acquire().
+   */
+  void* GetSlotData(int slot);
+
+  /**
+   * Releases a slot pinned with Acquire().
+   */
+  void Release(int slot);
+
+  /**
+   * Returns true if the writer has closed the ring, or the name now refers to
+   * a different segment (e.g. because the writing process restarted).
+   * Readers should then open the ring again.
+   */
+  bool IsStale() const;
+
+  /**
+   * Converts a wpi::Now() time into a time base shared by all processes on
+   * the machine, and back.
+   */
+  static uint64_t ToSharedTime(uint64_t time);
+  static uint64_t FromSharedTime(uint64_t time);
+
+ private:
+  struct Header;
+  struct Reader;
+  struct Slot;
+
+  // segment layout: header, reader table, slot headers, then slot data
+  static size_t ReadersOffset();
+  static size_t SlotsOffset();
+  static size_t DataOffset(size_t numSlots);
+  static size_t SegmentSize(size_t numSlots, size_t slotSize);
+
+  Reader& GetReader(int reader) const;
+  Slot& GetSlot(int slot) const;
+  bool IsReplaced() const;
+  bool IsValidFrame(const FrameInfo& info) const;
+
+  // claims a free reader table entry for this process
+  Reader* ClaimReader();
+  // frees the entries (and pins) of readers whose process has exited
+  void ReclaimStaleReaders();
+  // slots pinned by any reader, one bit per slot
+  uint32_t GetPinnedSlots() const;
+  // finds a slot the writer may use and marks it as being written
+  int ClaimFreeSlot();
+
+  std::string m_name;
+  void* m_base;
+  size_t m_size;
+  // identifies the segment, in case the name is reused
+  uint64_t m_inode;
+  bool m_owner;
+  Header* m_header;
+  // copied from the header when the ring is created or opened, so a corrupt
+  // header cannot make us access memory outside of the segment
+  int m_numSlots;
+  size_t m_slotSize;
+  // reader table entry holding our pins; only used by readers
+  Reader* m_reader = nullptr;
+  // next slot to try writing to; only used by the writer
+  int m_nextSlot = 0;
+};
+
+}  // namespace cs
+
+#endif  // CSCORE_SHMFRAMERING_H_
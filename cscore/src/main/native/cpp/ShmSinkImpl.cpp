@@ -0,0 +1,147 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include "ShmSinkImpl.h"
+
+#include <string>
+
+#include "Instance.h"
+#include "Log.h"
+#include "ShmFrameRing.h"
+#include "SourceImpl.h"
+#include "cscore_raw.h"
+
+using namespace cs;
+
+ShmSinkImpl::ShmSinkImpl(std::string_view name, wpi::Logger& logger,
+                         Notifier& notifier, Telemetry& telemetry,
+                         std::string_view shmName, const VideoMode& mode,
+                         int numSlots)
+    : SinkImpl{name, logger, notifier, telemetry},
+      m_shmName{shmName},
+      m_mode{mode},
+      m_numSlots{numSlots} {
+  m_active = true;
+  m_thread = std::thread(&ShmSinkImpl::ThreadMain, this);
+}
+
+ShmSinkImpl::~ShmSinkImpl() {
+  Stop();
+}
+
+void ShmSinkImpl::Stop() {
+  m_active = false;
+
+  // wake up any waiters by forcing an empty frame to be sent
+  if (auto source = GetSource()) {
+    source->Wakeup();
+  }
+
+  // join thread
+  if (m_thread.joinable()) {
+    m_thread.join();
+  }
+}
+
+size_t ShmSinkImpl::GetFrameSize(const VideoMode& mode) {
+  if (mode.width <= 0 || mode.height <= 0) {
+    return 0;
+  }
+  size_t pixels = static_cast<size_t>(mode.width) * mode.height;
+  switch (mode.pixelFormat) {
+    case VideoMode::kBGR:
+      return pixels * 3;
+    case VideoMode::kYUYV:
+    case VideoMode::kRGB565:
+    case VideoMode::kY16:
+    case VideoMode::kUYVY:
+      return pixels * 2;
+    case VideoMode::kGray:
+      return pixels;
+    case VideoMode::kMJPEG:
+      // generous upper bound; larger frames are dropped
+      return pixels * 2;
+    default:
+      return 0;
+  }
+}
+
+void ShmSinkImpl::ThreadMain() {
+  std::string error;
+  auto ring = ShmFrameRing::Create(m_shmName, m_numSlots,
+                                   GetFrameSize(m_mode), m_mode.fps, &error);
+  if (!ring) {
+    SERROR("could not create shared memory '{}': {}", m_shmName, error);
+    return;
+  }
+
+  Enable();
+  while (m_active) {
+    auto source = GetSource();
+    if (!source) {
+      // Source disconnected; sleep for one second
+      std::this_thread::sleep_for(std::chrono::seconds(1));
+      continue;
+    }
+    SDEBUG4("waiting for frame");
+    Frame frame = source->GetNextFrame();  // blocks
+    if (!m_active) {
+      break;
+    }
+    if (!frame) {
+      // Bad frame; sleep for 10 ms so we don't consume all processor time.
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      continue;
+    }
+
+    Image* image =
+        m_mode.pixelFormat == VideoMode::kMJPEG
+            ? frame.GetImageMJPEG(m_mode.width, m_mode.height, -1)
+            : frame.GetImage(
+                  m_mode.width, m_mode.height,
+                  static_cast<VideoMode::PixelFormat>(m_mode.pixelFormat));
+    if (!image) {
+      continue;
+    }
+    if (!ring->Write({.time = ShmFrameRing::ToSharedTime(
+                          frame.GetCaptureTime()),
+                      .timeSource = frame.GetTimeSource(),
+                      .pixelFormat = m_mode.pixelFormat,
+                      .width = m_mode.width,
+                      .height = m_mode.height,
+                      .size = image->size()},
+                     image->data())) {
+      SDEBUG4("dropped frame; no free slot");
+      continue;
+    }
+    RecordFrameLatency(frame);
+  }
+  Disable();
+}
+
+namespace cs {
+CS_Sink CreateShmSink(std::string_view name, std::string_view shmName,
+                      const VideoMode& mode, int numSlots, CS_Status* status) {
+  if (ShmSinkImpl::GetFrameSize(mode) == 0 || numSlots < 2 ||
+      numSlots > ShmFrameRing::kMaxSlots) {
+    *status = CS_UNSUPPORTED_MODE;
+    return 0;
+  }
+  auto& inst = Instance::GetInstance();
+  return inst.CreateSink(
+      CS_SINK_SHM,
+      std::make_shared<ShmSinkImpl>(name, inst.logger, inst.notifier,
+                                    inst.telemetry, shmName, mode, numSlots));
+}
+}  // namespace cs
+
+extern "C" {
+CS_Sink CS_CreateShmSink(const char* name, const char* shmName,
+                         const CS_VideoMode* mode, int numSlots,
+                         CS_Status* status) {
+  return cs::CreateShmSink(name, shmName,
+                           static_cast<const cs::VideoMode&>(*mode), numSlots,
+                           status);
+}
+}  // extern "C"
@@ -0,0 +1,46 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#ifndef CSCORE_SHMSINKIMPL_H_
+#define CSCORE_SHMSINKIMPL_H_
+
+#include <atomic>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#include "SinkImpl.h"
+
+namespace cs {
+
+class SourceImpl;
+
+// Publishes frames converted to a fixed video mode into a shared memory
+// frame ring, for a ShmSourceImpl in another process to read.
+class ShmSinkImpl : public SinkImpl {
+ public:
+  ShmSinkImpl(std::string_view name, wpi::Logger& logger, Notifier& notifier,
+              Telemetry& telemetry, std::string_view shmName,
+              const VideoMode& mode, int numSlots);
+  ~ShmSinkImpl() override;
+
+  void Stop();
+
+  // Returns the size of a frame in the given mode, or 0 if the mode is not
+  // supported.
+  static size_t GetFrameSize(const VideoMode& mode);
+
+ private:
+  void ThreadMain();
+
+  std::atomic_bool m_active;  // set to false to terminate threads
+  std::thread m_thread;
+  std::string m_shmName;
+  VideoMode m_mode;
+  int m_numSlots;
+};
+
+}  // namespace cs
+
+#endif  // CSCORE_SHMSINKIMPL_H_
@@ -0,0 +1,126 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include "ShmSourceImpl.h"
+
+#include <memory>
+#include <string>
+
+#include <wpi/timestamp.h>
+
+#include "Instance.h"
+#include "Log.h"
+#include "Notifier.h"
+#include "ShmFrameRing.h"
+#include "cscore_raw.h"
+
+using namespace cs;
+
+ShmSourceImpl::ShmSourceImpl(std::string_view name, wpi::Logger& logger,
+                             Notifier& notifier, Telemetry& telemetry,
+                             std::string_view shmName)
+    : SourceImpl{name, logger, notifier, telemetry}, m_shmName{shmName} {
+  SetDescription(m_shmName);
+}
+
+ShmSourceImpl::~ShmSourceImpl() {
+  m_active = false;
+
+  // join thread; it wakes up at least every 250 ms
+  if (m_thread.joinable()) {
+    m_thread.join();
+  }
+}
+
+void ShmSourceImpl::Start() {
+  m_thread = std::thread(&ShmSourceImpl::ThreadMain, this);
+}
+
+bool ShmSourceImpl::SetVideoMode(const VideoMode& mode, CS_Status* status) {
+  // the mode is set by the writer
+  *status = CS_UNSUPPORTED_MODE;
+  return false;
+}
+
+void ShmSourceImpl::NumSinksChanged() {
+  // ignore
+}
+
+void ShmSourceImpl::NumSinksEnabledChanged() {
+  // ignore
+}
+
+void ShmSourceImpl::ThreadMain() {
+  std::shared_ptr<ShmFrameRing> ring;
+  uint32_t sequence = 0;
+  std::string error;
+  while (m_active) {
+    if (!ring) {
+      ring = ShmFrameRing::Open(m_shmName, &error);
+      if (!ring) {
+        SDEBUG("could not open shared memory '{}': {}", m_shmName, error);
+        std::this_thread::sleep_for(std::chrono::milliseconds(250));
+        continue;
+      }
+      sequence = 0;
+    }
+
+    ShmFrameRing::FrameInfo info;
+    int slot = ring->Acquire(&sequence, 0.25, &info);
+    if (slot < 0) {
+      if (ring->IsStale()) {
+        // the writer went away or restarted; reopen
+        ring.reset();
+        SetConnected(false);
+      }
+      continue;
+    }
+
+    VideoMode mode{static_cast<VideoMode::PixelFormat>(info.pixelFormat),
+                   info.width, info.height, ring->GetFps()};
+    bool modeChanged = false;
+    {
+      std::scoped_lock lock(m_mutex);
+      if (!(m_mode == mode)) {
+        m_mode = mode;
+        m_videoModes.assign(1, mode);
+        modeChanged = true;
+      }
+    }
+    if (modeChanged) {
+      m_notifier.NotifySource(*this, CS_SOURCE_VIDEOMODES_UPDATED);
+      m_notifier.NotifySourceVideoMode(*this, mode);
+    }
+    SetConnected(true);
+
+    // lend the slot to the frame; the deleter may run on any thread
+    std::shared_ptr<void> data{ring->GetSlotData(slot),
+                               [ring, slot](void*) { ring->Release(slot); }};
+    auto image = std::make_unique<Image>(0);
+    image->SetExternal(std::move(data), info.size);
+    image->pixelFormat = static_cast<VideoMode::PixelFormat>(info.pixelFormat);
+    image->width = info.width;
+    image->height = info.height;
+    PutFrame(std::move(image), wpi::Now(),
+             ShmFrameRing::FromSharedTime(info.time),
+             static_cast<CS_TimestampSource>(info.timeSource));
+  }
+}
+
+namespace cs {
+CS_Source CreateShmSource(std::string_view name, std::string_view shmName,
+                          CS_Status* status) {
+  auto& inst = Instance::GetInstance();
+  return inst.CreateSource(CS_SOURCE_SHM, std::make_shared<ShmSourceImpl>(
+                                              name, inst.logger, inst.notifier,
+                                              inst.telemetry, shmName));
+}
+}  // namespace cs
+
+extern "C" {
+CS_Source CS_CreateShmSource(const char* name, const char* shmName,
+                             CS_Status* status) {
+  return cs::CreateShmSource(name, shmName, status);
+}
+}  // extern "C"
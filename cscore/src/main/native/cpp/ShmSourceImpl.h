@@ -0,0 +1,43 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#ifndef CSCORE_SHMSOURCEIMPL_H_
+#define CSCORE_SHMSOURCEIMPL_H_
+
+#include <atomic>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#include "SourceImpl.h"
+
+namespace cs {
+
+// Reads frames written by a ShmSinkImpl (usually in another process) from a
+// shared memory frame ring.  Frames point directly into the ring; the slot is
+// released when the last frame reference is dropped.
+class ShmSourceImpl : public SourceImpl {
+ public:
+  ShmSourceImpl(std::string_view name, wpi::Logger& logger, Notifier& notifier,
+                Telemetry& telemetry, std::string_view shmName);
+  ~ShmSourceImpl() override;
+
+  void Start() override;
+
+  bool SetVideoMode(const VideoMode& mode, CS_Status* status) override;
+
+  void NumSinksChanged() override;
+  void NumSinksEnabledChanged() override;
+
+ private:
+  void ThreadMain();
+
+  std::atomic_bool m_active{true};  // set to false to terminate thread
+  std::thread m_thread;
+  std::string m_shmName;
+};
+
+}  // namespace cs
+
+#endif  // CSCORE_SHMSOURCEIMPL_H_
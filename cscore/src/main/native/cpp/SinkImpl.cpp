@@ -5,10 +5,12 @@
 #include "SinkImpl.h"
 
 #include <wpi/json.h>
+#include <wpi/timestamp.h>
 
 #include "Instance.h"
 #include "Notifier.h"
 #include "SourceImpl.h"
+#include "Telemetry.h"
 
 using namespace cs;
 
@@ -22,7 +24,7 @@ SinkImpl::SinkImpl(std::string_view name, wpi::Logger& logger,
 SinkImpl::~SinkImpl() {
   if (m_source) {
     if (m_enabledCount > 0) {
-      m_source->DisableSink();
+      m_source->DisableSink(&m_region);
     }
     m_source->RemoveSink();
   }
@@ -45,7 +47,7 @@ void SinkImpl::Enable() {
   ++m_enabledCount;
   if (m_enabledCount == 1) {
     if (m_source) {
-      m_source->EnableSink();
+      m_source->EnableSink(&m_region);
     }
     m_notifier.NotifySink(*this, CS_SINK_ENABLED);
   }
@@ -56,7 +58,7 @@ void SinkImpl::Disable() {
   --m_enabledCount;
   if (m_enabledCount == 0) {
     if (m_source) {
-      m_source->DisableSink();
+      m_source->DisableSink(&m_region);
     }
     m_notifier.NotifySink(*this, CS_SINK_DISABLED);
   }
@@ -66,13 +68,13 @@ void SinkImpl::SetEnabled(bool enabled) {
   std::scoped_lock lock(m_mutex);
   if (enabled && m_enabledCount == 0) {
     if (m_source) {
-      m_source->EnableSink();
+      m_source->EnableSink(&m_region);
     }
     m_enabledCount = 1;
     m_notifier.NotifySink(*this, CS_SINK_ENABLED);
   } else if (!enabled && m_enabledCount > 0) {
     if (m_source) {
-      m_source->DisableSink();
+      m_source->DisableSink(&m_region);
     }
     m_enabledCount = 0;
     m_notifier.NotifySink(*this, CS_SINK_DISABLED);
@@ -87,7 +89,7 @@ void SinkImpl::SetSource(std::shared_ptr<SourceImpl> source) {
     }
     if (m_source) {
       if (m_enabledCount > 0) {
-        m_source->DisableSink();
+        m_source->DisableSink(&m_region);
       }
       m_source->RemoveSink();
     }
@@ -95,13 +97,24 @@ void SinkImpl::SetSource(std::shared_ptr<SourceImpl> source) {
     if (m_source) {
       m_source->AddSink();
       if (m_enabledCount > 0) {
-        m_source->EnableSink();
+        m_source->EnableSink(&m_region);
       }
     }
   }
   SetSourceImpl(source);
 }
 
+void SinkImpl::SetRegion(const ImageRegion& region) {
+  std::scoped_lock lock(m_mutex);
+  if (m_region == region) {
+    return;
+  }
+  if (m_source && m_enabledCount > 0) {
+    m_source->UpdateSinkRegion(m_region, region);
+  }
+  m_region = region;
+}
+
 std::string SinkImpl::GetError() const {
   std::scoped_lock lock(m_mutex);
   if (!m_source) {
@@ -195,3 +208,12 @@ void SinkImpl::UpdatePropertyValue(int property, bool setString, int value,
 }
 
 void SinkImpl::SetSourceImpl(std::shared_ptr<SourceImpl> source) {}
+
+void SinkImpl::RecordFrameLatency(const Frame& frame) {
+  uint64_t captureTime = frame.GetCaptureTime();
+  uint64_t now = wpi::Now();
+  if (captureTime == 0 || captureTime > now) {
+    return;
+  }
+  m_telemetry.RecordSinkLatency(*this, now - captureTime);
+}
@@ -40,6 +40,15 @@ class SinkImpl : public PropertyContainer {
 
   void SetSource(std::shared_ptr<SourceImpl> source);
 
+  // Region of interest for frames grabbed by this sink.  The source may crop
+  // in hardware if all of its enabled sinks request the same region.
+  void SetRegion(const ImageRegion& region);
+
+  ImageRegion GetRegion() const {
+    std::scoped_lock lock(m_mutex);
+    return m_region;
+  }
+
   std::shared_ptr<SourceImpl> GetSource() const {
     std::scoped_lock lock(m_mutex);
     return m_source;
@@ -53,6 +62,10 @@ class SinkImpl : public PropertyContainer {
   std::string GetConfigJson(CS_Status* status);
   virtual wpi::json GetConfigJsonObject(CS_Status* status);
 
+  // Records the latency from the frame's capture to now; call once the sink
+  // has the frame in the form it needs.
+  void RecordFrameLatency(const Frame& frame);
+
  protected:
   // PropertyContainer implementation
   void NotifyPropertyCreated(int propIndex, PropertyImpl& prop) override;
@@ -71,6 +84,7 @@ class SinkImpl : public PropertyContainer {
   std::string m_description;
   std::shared_ptr<SourceImpl> m_source;
   int m_enabledCount{0};
+  ImageRegion m_region;
 };
 
 }  // namespace cs
@@ -6,6 +6,7 @@
 
 #include <algorithm>
 #include <cstring>
+#include <iterator>
 #include <memory>
 
 #include <wpi/StringExtras.h>
@@ -63,6 +64,69 @@ void SourceImpl::SetConnected(bool connected) {
   }
 }
 
+void SourceImpl::EnableSink(const ImageRegion* region) {
+  {
+    std::scoped_lock lock{m_regionMutex};
+    if (region && region->IsCrop()) {
+      m_sinkRegions.push_back(*region);
+    }
+    ++m_numSinksEnabled;
+  }
+  NumSinksEnabledChanged();
+  SinkRegionsChanged();
+}
+
+void SourceImpl::DisableSink(const ImageRegion* region) {
+  {
+    std::scoped_lock lock{m_regionMutex};
+    if (region && region->IsCrop()) {
+      auto it = std::find(m_sinkRegions.begin(), m_sinkRegions.end(), *region);
+      if (it != m_sinkRegions.end()) {
+        m_sinkRegions.erase(it);
+      }
+    }
+    --m_numSinksEnabled;
+  }
+  NumSinksEnabledChanged();
+  SinkRegionsChanged();
+}
+
+void SourceImpl::UpdateSinkRegion(const ImageRegion& oldRegion,
+                                  const ImageRegion& newRegion) {
+  {
+    std::scoped_lock lock{m_regionMutex};
+    if (oldRegion.IsCrop()) {
+      auto it =
+          std::find(m_sinkRegions.begin(), m_sinkRegions.end(), oldRegion);
+      if (it != m_sinkRegions.end()) {
+        m_sinkRegions.erase(it);
+      }
+    }
+    if (newRegion.IsCrop()) {
+      m_sinkRegions.push_back(newRegion);
+    }
+  }
+  SinkRegionsChanged();
+}
+
+bool SourceImpl::GetCommonSinkCrop(ImageRegion* crop) const {
+  std::scoped_lock lock{m_regionMutex};
+  if (m_sinkRegions.empty() ||
+      static_cast<int>(m_sinkRegions.size()) != m_numSinksEnabled) {
+    return false;
+  }
+  const auto& first = m_sinkRegions.front();
+  for (auto&& region : m_sinkRegions) {
+    if (region.x != first.x || region.y != first.y ||
+        region.width != first.width || region.height != first.height) {
+      return false;
+    }
+  }
+  *crop = first;
+  crop->decimation = 1;
+  return true;
+}
+
 uint64_t SourceImpl::GetCurFrameTime() {
   std::unique_lock lock{m_frameMutex};
   return m_frame.GetTime();
@@ -95,10 +159,47 @@ void SourceImpl::Wakeup() {
   {
     std::scoped_lock lock{m_frameMutex};
     m_frame = Frame{*this, std::string_view{}, 0};
+    SignalFrameQueues(false);
   }
   m_frameCv.notify_all();
 }
 
+void SourceImpl::AddFrameQueue(FrameQueue* queue) {
+  std::scoped_lock lock{m_frameMutex};
+  m_frameQueues.push_back(queue);
+  if (m_frame) {
+    queue->frames.push_back(m_frame);
+  }
+}
+
+void SourceImpl::RemoveFrameQueue(FrameQueue* queue) {
+  std::scoped_lock lock{m_frameMutex};
+  auto it = std::find(m_frameQueues.begin(), m_frameQueues.end(), queue);
+  if (it != m_frameQueues.end()) {
+    m_frameQueues.erase(it);
+  }
+}
+
+void SourceImpl::TakeFrames(FrameQueue* queue,
+                            wpi::SmallVectorImpl<Frame>& frames) {
+  std::scoped_lock lock{m_frameMutex};
+  frames.append(std::make_move_iterator(queue->frames.begin()),
+                std::make_move_iterator(queue->frames.end()));
+  queue->frames.clear();
+}
+
+void SourceImpl::SignalFrameQueues(bool frame) {
+  for (auto queue : m_frameQueues) {
+    if (frame) {
+      if (queue->frames.size() >= queue->limit) {
+        queue->frames.erase(queue->frames.begin());
+      }
+      queue->frames.push_back(m_frame);
+    }
+    wpi::SetEvent(queue->event);
+  }
+}
+
 void SourceImpl::SetBrightness(int brightness, CS_Status* status) {
   *status = CS_INVALID_HANDLE;
 }
@@ -327,6 +428,17 @@ bool SourceImpl::SetConfigJson(const wpi::json& config, CS_Status* status) {
     }
   }
 
+  // frame pool limit
+  if (config.count("frame pool bytes") != 0) {
+    try {
+      auto val = config.at("frame pool bytes").get<size_t>();
+      SINFO("SetConfigJson: setting frame pool limit to {} bytes", val);
+      SetFramePoolLimit(val);
+    } catch (const wpi::json::exception& e) {
+      SWARNING("SetConfigJson: could not read frame pool bytes: {}", e.what());
+    }
+  }
+
   // properties
   if (config.count("properties") != 0) {
     SetPropertiesJson(config.at("properties"), m_logger, GetName(), status);
@@ -392,6 +504,11 @@ wpi::json SourceImpl::GetConfigJsonObject(CS_Status* status) {
     j.emplace("fps", m_mode.fps);
   }
 
+  // frame pool limit
+  if (size_t limit = m_poolLimit; limit != 0) {
+    j.emplace("frame pool bytes", limit);
+  }
+
   // TODO: output brightness, white balance, and exposure?
 
   // properties
@@ -415,29 +532,61 @@ std::vector<VideoMode> SourceImpl::EnumerateVideoModes(
 std::unique_ptr<Image> SourceImpl::AllocImage(
     VideoMode::PixelFormat pixelFormat, int width, int height, size_t size) {
   std::unique_ptr<Image> image;
+  std::vector<std::unique_ptr<Image>>* found = nullptr;
+  size_t foundIndex = 0;
+  size_t imageBytes;
   {
     std::scoped_lock lock{m_poolMutex};
-    // find the smallest existing frame that is at least big enough.
-    int found = -1;
-    for (size_t i = 0; i < m_imagesAvail.size(); ++i) {
-      // is it big enough?
-      if (m_imagesAvail[i] && m_imagesAvail[i]->capacity() >= size) {
-        // is it smaller than the last found?
-        if (found < 0 ||
-            m_imagesAvail[i]->capacity() < m_imagesAvail[found]->capacity()) {
-          // yes, update
-          found = i;
+    // prefer the most recently released image of the same format and
+    // resolution that is big enough
+    for (auto&& bucket : m_imageBuckets) {
+      if (bucket.pixelFormat != pixelFormat || bucket.width != width ||
+          bucket.height != height) {
+        continue;
+      }
+      for (size_t i = bucket.images.size(); i-- > 0;) {
+        if (bucket.images[i]->capacity() >= size) {
+          found = &bucket.images;
+          foundIndex = i;
+          break;
         }
       }
+      break;
     }
 
-    // if nothing found, allocate a new buffer
-    if (found < 0) {
-      image = std::make_unique<Image>(size);
+    // otherwise find the smallest pooled image that is at least big enough
+    if (!found) {
+      for (auto&& bucket : m_imageBuckets) {
+        for (size_t i = 0; i < bucket.images.size(); ++i) {
+          size_t capacity = bucket.images[i]->capacity();
+          if (capacity >= size &&
+              (!found || capacity < (*found)[foundIndex]->capacity())) {
+            found = &bucket.images;
+            foundIndex = i;
+          }
+        }
+      }
+    }
+
+    if (found) {
+      image = std::move((*found)[foundIndex]);
+      found->erase(found->begin() + foundIndex);
+      --m_numImagesAvail;
+      m_pooledBytes -= image->m_poolBytes;
     } else {
-      image = std::move(m_imagesAvail[found]);
+      // allocate a new buffer, first freeing pooled images if needed to stay
+      // within the limit
+      size_t limit = m_poolLimit;
+      if (limit != 0) {
+        TrimPool(limit > size ? limit - size : 0);
+      }
+      image = std::make_unique<Image>(size);
+      image->m_poolBytes = image->capacity();
+      m_imageBytes += image->m_poolBytes;
     }
+    imageBytes = m_imageBytes;
   }
+  m_telemetry.RecordSourcePoolAlloc(*this, found != nullptr, imageBytes);
 
   // Initialize image
   image->SetSize(size);
@@ -449,7 +598,20 @@ std::unique_ptr<Image> SourceImpl::AllocImage(
 }
 
 void SourceImpl::PutFrame(VideoMode::PixelFormat pixelFormat, int width,
-                          int height, std::string_view data, Frame::Time time) {
+                          int height, std::string_view data, Frame::Time time,
+                          Frame::Time captureTime,
+                          CS_TimestampSource timeSource) {
+  // Drop the frame (before copying it) if sinks are holding on to too many
+  bool exhausted;
+  {
+    std::scoped_lock lock{m_poolMutex};
+    exhausted = IsPoolExhausted(data.size());
+  }
+  if (exhausted) {
+    m_telemetry.RecordSourceFramesDropped(*this, 1);
+    return;
+  }
+
   auto image = AllocImage(pixelFormat, width, height, data.size());
 
   // Copy in image data
@@ -457,10 +619,26 @@ void SourceImpl::PutFrame(VideoMode::PixelFormat pixelFormat, int width,
           fmt::ptr(data.data()), data.size());
   std::memcpy(image->data(), data.data(), data.size());
 
-  PutFrame(std::move(image), time);
+  PutFrame(std::move(image), time, captureTime, timeSource);
 }
 
-void SourceImpl::PutFrame(std::unique_ptr<Image> image, Frame::Time time) {
+void SourceImpl::PutFrame(std::unique_ptr<Image> image, Frame::Time time,
+                          Frame::Time captureTime,
+                          CS_TimestampSource timeSource) {
+  // Drop the frame if sinks are holding on to too many
+  if (!image->IsExternal()) {
+    bool exhausted;
+    {
+      std::scoped_lock lock{m_poolMutex};
+      exhausted = IsPoolExhausted(0);
+    }
+    if (exhausted) {
+      m_telemetry.RecordSourceFramesDropped(*this, 1);
+      ReleaseImage(std::move(image));
+      return;
+    }
+  }
+
   // Update telemetry
   m_telemetry.RecordSourceFrames(*this, 1);
   m_telemetry.RecordSourceBytes(*this, static_cast<int>(image->size()));
@@ -468,7 +646,13 @@ void SourceImpl::PutFrame(std::unique_ptr<Image> image, Frame::Time time) {
   // Update frame
   {
     std::scoped_lock lock{m_frameMutex};
-    m_frame = Frame{*this, std::move(image), time};
+    if (captureTime == 0) {
+      captureTime = time;
+    }
+    m_frame = Frame{*this, std::move(image), time, captureTime, timeSource};
+    m_frame.m_impl->originX = m_captureOriginX;
+    m_frame.m_impl->originY = m_captureOriginY;
+    SignalFrameQueues(true);
   }
 
   // Signal listeners
@@ -480,12 +664,32 @@ void SourceImpl::PutError(std::string_view msg, Frame::Time time) {
   {
     std::scoped_lock lock{m_frameMutex};
     m_frame = Frame{*this, msg, time};
+    SignalFrameQueues(false);
   }
 
   // Signal listeners
   m_frameCv.notify_all();
 }
 
+void SourceImpl::DetachFrame() {
+  std::scoped_lock lock{m_frameMutex};
+  Image* image = m_frame.GetExistingImage();
+  if (!image || !image->IsExternal()) {
+    return;
+  }
+
+  auto copy = AllocImage(image->pixelFormat, image->width, image->height,
+                         image->size());
+  std::memcpy(copy->data(), image->data(), image->size());
+  copy->jpegQuality = image->jpegQuality;
+
+  Frame frame{*this, std::move(copy), m_frame.GetTime(),
+              m_frame.GetCaptureTime(), m_frame.GetTimeSource()};
+  frame.m_impl->originX = m_frame.m_impl->originX;
+  frame.m_impl->originY = m_frame.m_impl->originY;
+  m_frame = std::move(frame);
+}
+
 void SourceImpl::NotifyPropertyCreated(int propIndex, PropertyImpl& prop) {
   m_notifier.NotifySourceProperty(*this, CS_SOURCE_PROPERTY_CREATED, prop.name,
                                   propIndex, prop.propKind, prop.value,
@@ -520,28 +724,66 @@ void SourceImpl::UpdatePropertyValue(int property, bool setString, int value,
 }
 
 void SourceImpl::ReleaseImage(std::unique_ptr<Image> image) {
+  if (image->IsExternal()) {
+    return;  // destroying the image releases the external data
+  }
   std::scoped_lock lock{m_poolMutex};
   if (m_destroyFrames) {
     return;
   }
-  // Return the frame to the pool.  First try to find an empty slot, otherwise
-  // add it to the end.
-  auto it = std::find(m_imagesAvail.begin(), m_imagesAvail.end(), nullptr);
-  if (it != m_imagesAvail.end()) {
-    *it = std::move(image);
-  } else if (m_imagesAvail.size() > kMaxImagesAvail) {
-    // Replace smallest buffer; don't need to check for null because the above
-    // find would have found it.
-    auto it2 = std::min_element(
-        m_imagesAvail.begin(), m_imagesAvail.end(),
-        [](const std::unique_ptr<Image>& a, const std::unique_ptr<Image>& b) {
-          return a->capacity() < b->capacity();
-        });
-    if ((*it2)->capacity() < image->capacity()) {
-      *it2 = std::move(image);
+
+  // The image may have grown while in use (e.g. JPEG encoding)
+  m_imageBytes = m_imageBytes - image->m_poolBytes + image->capacity();
+  image->m_poolBytes = image->capacity();
+
+  // Free the image if the pool is full
+  size_t limit = m_poolLimit;
+  if (m_numImagesAvail >= kMaxImagesAvail ||
+      (limit != 0 && m_imageBytes > limit)) {
+    m_imageBytes -= image->m_poolBytes;
+    return;
+  }
+
+  // Return the image to the pool, reusing an empty bucket if there is no
+  // bucket for its format and resolution.
+  ImageBucket* found = nullptr;
+  for (auto&& bucket : m_imageBuckets) {
+    if (bucket.pixelFormat == image->pixelFormat &&
+        bucket.width == image->width && bucket.height == image->height) {
+      found = &bucket;
+      break;
+    }
+    if (!found && bucket.images.empty()) {
+      found = &bucket;
+    }
+  }
+  if (!found) {
+    found = &m_imageBuckets.emplace_back();
+  }
+  if (found->images.empty()) {
+    found->pixelFormat = image->pixelFormat;
+    found->width = image->width;
+    found->height = image->height;
+  }
+  ++m_numImagesAvail;
+  m_pooledBytes += image->m_poolBytes;
+  found->images.emplace_back(std::move(image));
+}
+
+bool SourceImpl::IsPoolExhausted(size_t size) const {
+  size_t limit = m_poolLimit;
+  return limit != 0 && m_imageBytes - m_pooledBytes + size > limit;
+}
+
+void SourceImpl::TrimPool(size_t bytes) {
+  for (auto&& bucket : m_imageBuckets) {
+    while (m_imageBytes > bytes && !bucket.images.empty()) {
+      size_t freed = bucket.images.back()->m_poolBytes;
+      bucket.images.pop_back();
+      --m_numImagesAvail;
+      m_pooledBytes -= freed;
+      m_imageBytes -= freed;
     }
-  } else {
-    m_imagesAvail.emplace_back(std::move(image));
   }
 }
 
@@ -13,6 +13,7 @@
 #include <vector>
 
 #include <wpi/Logger.h>
+#include <wpi/SmallVector.h>
 #include <wpi/condition_variable.h>
 #include <wpi/json_fwd.h>
 #include <wpi/mutex.h>
@@ -28,8 +29,21 @@ namespace cs {
 class Notifier;
 class Telemetry;
 
+// Receives every frame a source produces while registered with
+// SourceImpl::AddFrameQueue(), for callers waiting on several sources at once.
+struct FrameQueue {
+  // signaled whenever a frame is queued or the source is woken up
+  WPI_EventHandle event;
+  // the oldest frames are dropped beyond this many
+  size_t limit;
+  // protected by the source's frame mutex; use SourceImpl::TakeFrames()
+  wpi::SmallVector<Frame, 4> frames;
+};
+
 class SourceImpl : public PropertyContainer {
+  friend class CvSinkTest;
   friend class Frame;
+  friend class SourcePoolTest;
 
  public:
   SourceImpl(std::string_view name, wpi::Logger& logger, Notifier& notifier,
@@ -77,15 +91,14 @@ class SourceImpl : public PropertyContainer {
   // to get source frames.
   int GetNumSinksEnabled() const { return m_numSinksEnabled; }
 
-  void EnableSink() {
-    ++m_numSinksEnabled;
-    NumSinksEnabledChanged();
-  }
+  // Sinks may also pass their region of interest, so that the source can
+  // crop in hardware when every enabled sink wants the same rectangle.
+  void EnableSink(const ImageRegion* region = nullptr);
+  void DisableSink(const ImageRegion* region = nullptr);
 
-  void DisableSink() {
-    --m_numSinksEnabled;
-    NumSinksEnabledChanged();
-  }
+  // Replaces the region of interest of an enabled sink.
+  void UpdateSinkRegion(const ImageRegion& oldRegion,
+                        const ImageRegion& newRegion);
 
   // Gets the current frame time (without waiting for a new one).
   uint64_t GetCurFrameTime();
@@ -103,6 +116,14 @@ class SourceImpl : public PropertyContainer {
   // Force a wakeup of all GetNextFrame() callers by sending an empty frame.
   void Wakeup();
 
+  // Registers a queue to receive every subsequent frame.  The current frame,
+  // if any, is queued immediately.
+  void AddFrameQueue(FrameQueue* queue);
+  void RemoveFrameQueue(FrameQueue* queue);
+
+  // Moves the frames received by a registered queue to the end of frames.
+  void TakeFrames(FrameQueue* queue, wpi::SmallVectorImpl<Frame>& frames);
+
   // Standard common camera properties
   virtual void SetBrightness(int brightness, CS_Status* status);
   virtual int GetBrightness(CS_Status* status) const;
@@ -134,20 +155,63 @@ class SourceImpl : public PropertyContainer {
   std::unique_ptr<Image> AllocImage(VideoMode::PixelFormat pixelFormat,
                                     int width, int height, size_t size);
 
+  /**
+   * Limits the memory used by this source's images (in use by frames plus
+   * pooled for reuse).  Once images held by frames reach the limit, new
+   * frames are dropped until sinks release some.
+   *
+   * @param bytes maximum bytes, or 0 for no limit
+   */
+  void SetFramePoolLimit(size_t bytes) { m_poolLimit = bytes; }
+  size_t GetFramePoolLimit() const { return m_poolLimit; }
+
  protected:
   void NotifyPropertyCreated(int propIndex, PropertyImpl& prop) override;
   void UpdatePropertyValue(int property, bool setString, int value,
                            std::string_view valueStr) override;
 
+  // time is when the frame was received; captureTime, if known, is when it
+  // was captured (in the same time base), and timeSource is what captureTime
+  // is based on
   void PutFrame(VideoMode::PixelFormat pixelFormat, int width, int height,
-                std::string_view data, Frame::Time time);
-  void PutFrame(std::unique_ptr<Image> image, Frame::Time time);
+                std::string_view data, Frame::Time time,
+                Frame::Time captureTime = 0,
+                CS_TimestampSource timeSource = CS_TIMESRC_FRAME_DEQUEUE);
+  void PutFrame(std::unique_ptr<Image> image, Frame::Time time,
+                Frame::Time captureTime = 0,
+                CS_TimestampSource timeSource = CS_TIMESRC_FRAME_DEQUEUE);
   void PutError(std::string_view msg, Frame::Time time);
 
+  // Returns an image from AllocImage() that was not passed to PutFrame() to
+  // the pool.  Images must not simply be destroyed, as they count against
+  // the pool limit until released.
+  void ReleaseImage(std::unique_ptr<Image> image);
+
+  // If the current frame's image data is external (see Image::SetExternal),
+  // replaces the frame with an identical one that owns a copy of the data,
+  // so the external data is released once sinks are done with the original.
+  // Sinks waiting for a new frame are not woken.
+  void DetachFrame();
+
   // Notification functions for corresponding atomics
   virtual void NumSinksChanged() = 0;
   virtual void NumSinksEnabledChanged() = 0;
 
+  // Called after the enabled sinks or their regions of interest change.
+  virtual void SinkRegionsChanged() {}
+
+  // Gets the crop rectangle requested by every enabled sink (decimation is
+  // not considered).  Returns false if any enabled sink wants a different
+  // rectangle or the full frame.
+  bool GetCommonSinkCrop(ImageRegion* crop) const;
+
+  // Sets the position of subsequent frames in the full frame, for sources
+  // which crop in hardware.
+  void SetCaptureOrigin(int x, int y) {
+    m_captureOriginX = x;
+    m_captureOriginY = y;
+  }
+
   std::atomic_int m_numSinks{0};
 
  protected:
@@ -161,7 +225,15 @@ class SourceImpl : public PropertyContainer {
   Telemetry& m_telemetry;
 
  private:
-  void ReleaseImage(std::unique_ptr<Image> image);
+  // true if a new frame of the given size would exceed the pool limit;
+  // must be called with m_poolMutex held
+  bool IsPoolExhausted(size_t size) const;
+  // frees pooled images until allocated bytes are at most the given value;
+  // must be called with m_poolMutex held
+  void TrimPool(size_t bytes);
+  // queues m_frame to every registered queue (if frame is set) and signals
+  // them; must be called with m_frameMutex held
+  void SignalFrameQueues(bool frame);
   std::unique_ptr<Frame::Impl> AllocFrameImpl();
   void ReleaseFrameImpl(std::unique_ptr<Frame::Impl> data);
 
@@ -171,15 +243,36 @@ class SourceImpl : public PropertyContainer {
   std::atomic_int m_strategy{CS_CONNECTION_AUTO_MANAGE};
   std::atomic_int m_numSinksEnabled{0};
 
+  // crop regions of enabled sinks; m_numSinksEnabled is also only changed
+  // with this held, so the two stay consistent
+  mutable wpi::mutex m_regionMutex;
+  wpi::SmallVector<ImageRegion, 2> m_sinkRegions;
+  std::atomic_int m_captureOriginX{0};
+  std::atomic_int m_captureOriginY{0};
+
   wpi::mutex m_frameMutex;
   wpi::condition_variable m_frameCv;
+  // protected by m_frameMutex
+  wpi::SmallVector<FrameQueue*, 2> m_frameQueues;
 
   bool m_destroyFrames{false};
 
-  // Pool of frames/images to reduce malloc traffic.
+  // Pool of frames/images to reduce malloc traffic.  Images are bucketed by
+  // format and resolution so a steady stream reuses matching buffers.
+  struct ImageBucket {
+    VideoMode::PixelFormat pixelFormat;
+    int width;
+    int height;
+    std::vector<std::unique_ptr<Image>> images;
+  };
   wpi::mutex m_poolMutex;
   std::vector<std::unique_ptr<Frame::Impl>> m_framesAvail;
-  std::vector<std::unique_ptr<Image>> m_imagesAvail;
+  std::vector<ImageBucket> m_imageBuckets;
+  size_t m_numImagesAvail{0};
+  // bytes of all images allocated by this source, and of those pooled
+  size_t m_imageBytes{0};
+  size_t m_pooledBytes{0};
+  std::atomic<size_t> m_poolLimit{0};
 
   std::atomic_bool m_connected{false};
 
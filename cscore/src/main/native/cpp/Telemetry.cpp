@@ -4,6 +4,8 @@
 
 #include "Telemetry.h"
 
+#include <algorithm>
+#include <array>
 #include <chrono>
 #include <limits>
 
@@ -13,11 +15,15 @@
 #include "Handle.h"
 #include "Instance.h"
 #include "Notifier.h"
+#include "SinkImpl.h"
 #include "SourceImpl.h"
 #include "cscore_cpp.h"
 
 using namespace cs;
 
+using LatencyHistogram =
+    std::array<int64_t, kLatencyHistogramBucketsMs.size() + 1>;
+
 class Telemetry::Thread : public wpi::SafeThread {
  public:
   explicit Thread(Notifier& notifier) : m_notifier(notifier) {}
@@ -27,6 +33,8 @@ class Telemetry::Thread : public wpi::SafeThread {
   Notifier& m_notifier;
   wpi::DenseMap<std::pair<CS_Handle, int>, int64_t> m_user;
   wpi::DenseMap<std::pair<CS_Handle, int>, int64_t> m_current;
+  wpi::DenseMap<CS_Handle, LatencyHistogram> m_userLatency;
+  wpi::DenseMap<CS_Handle, LatencyHistogram> m_currentLatency;
   double m_period = 0.0;
   double m_elapsed = 0.0;
   bool m_updated = false;
@@ -78,6 +86,8 @@ void Telemetry::Thread::Main() {
     // move to user and clear current, as we don't keep around old values
     m_user = std::move(m_current);
     m_current.clear();
+    m_userLatency = std::move(m_currentLatency);
+    m_currentLatency.clear();
     auto curTime = std::chrono::steady_clock::now();
     m_elapsed = std::chrono::duration<double>(curTime - prevTime).count();
     prevTime = curTime;
@@ -131,6 +141,21 @@ double Telemetry::GetAverageValue(CS_Handle handle, CS_TelemetryKind kind,
   return thr->GetValue(handle, kind, status) / thr->m_elapsed;
 }
 
+std::vector<int64_t> Telemetry::GetLatencyHistogram(CS_Handle handle,
+                                                    CS_Status* status) {
+  auto thr = m_owner.GetThread();
+  if (!thr) {
+    *status = CS_TELEMETRY_NOT_ENABLED;
+    return {};
+  }
+  auto it = thr->m_userLatency.find(handle);
+  if (it == thr->m_userLatency.end()) {
+    *status = CS_EMPTY_VALUE;
+    return {};
+  }
+  return {it->getSecond().begin(), it->getSecond().end()};
+}
+
 void Telemetry::RecordSourceBytes(const SourceImpl& source, int quantity) {
   auto thr = m_owner.GetThread();
   if (!thr) {
@@ -152,3 +177,88 @@ void Telemetry::RecordSourceFrames(const SourceImpl& source, int quantity) {
                                 static_cast<int>(CS_SOURCE_FRAMES_RECEIVED))] +=
       quantity;
 }
+
+void Telemetry::RecordSourceConversion(const SourceImpl& source, bool hit,
+                                       int64_t time) {
+  auto thr = m_owner.GetThread();
+  if (!thr) {
+    return;
+  }
+  auto handleData = Instance::GetInstance().FindSource(source);
+  Handle handle{handleData.first, Handle::kSource};
+  if (hit) {
+    ++thr->m_current[std::make_pair(
+        handle, static_cast<int>(CS_SOURCE_CONVERSION_HITS))];
+  } else {
+    ++thr->m_current[std::make_pair(
+        handle, static_cast<int>(CS_SOURCE_CONVERSION_MISSES))];
+    thr->m_current[std::make_pair(
+        handle, static_cast<int>(CS_SOURCE_CONVERSION_TIME))] += time;
+  }
+}
+
+void Telemetry::RecordSourcePoolAlloc(const SourceImpl& source, bool hit,
+                                      size_t bytes) {
+  auto thr = m_owner.GetThread();
+  if (!thr) {
+    return;
+  }
+  auto handleData = Instance::GetInstance().FindSource(source);
+  Handle handle{handleData.first, Handle::kSource};
+  if (hit) {
+    ++thr->m_current[std::make_pair(handle,
+                                    static_cast<int>(CS_SOURCE_POOL_HITS))];
+  } else {
+    ++thr->m_current[std::make_pair(handle,
+                                    static_cast<int>(CS_SOURCE_POOL_MISSES))];
+  }
+  auto& peak = thr->m_current[std::make_pair(
+      handle, static_cast<int>(CS_SOURCE_POOL_PEAK_BYTES))];
+  peak = std::max(peak, static_cast<int64_t>(bytes));
+}
+
+void Telemetry::RecordSourceFramesDropped(const SourceImpl& source,
+                                          int quantity) {
+  auto thr = m_owner.GetThread();
+  if (!thr) {
+    return;
+  }
+  auto handleData = Instance::GetInstance().FindSource(source);
+  thr->m_current[std::make_pair(Handle{handleData.first, Handle::kSource},
+                                static_cast<int>(CS_SOURCE_FRAMES_DROPPED))] +=
+      quantity;
+}
+
+void Telemetry::RecordSourceEncode(const SourceImpl& source, int64_t time) {
+  auto thr = m_owner.GetThread();
+  if (!thr) {
+    return;
+  }
+  auto handleData = Instance::GetInstance().FindSource(source);
+  thr->m_current[std::make_pair(Handle{handleData.first, Handle::kSource},
+                                static_cast<int>(CS_SOURCE_ENCODE_TIME))] +=
+      time;
+}
+
+void Telemetry::RecordSinkLatency(const SinkImpl& sink, int64_t time) {
+  auto thr = m_owner.GetThread();
+  if (!thr) {
+    return;
+  }
+  auto handleData = Instance::GetInstance().FindSink(sink);
+  Handle handle{handleData.first, Handle::kSink};
+  ++thr->m_current[std::make_pair(handle,
+                                  static_cast<int>(CS_SINK_FRAMES_RECEIVED))];
+  thr->m_current[std::make_pair(handle,
+                                static_cast<int>(CS_SINK_LATENCY_TIME))] +=
+      time;
+  ++thr->m_currentLatency[handle][GetLatencyBucket(time)];
+}
+
+size_t Telemetry::GetLatencyBucket(int64_t time) {
+  // each bucket includes its upper bound
+  double ms = time / 1000.0;
+  return std::lower_bound(kLatencyHistogramBucketsMs.begin(),
+                          kLatencyHistogramBucketsMs.end(), ms) -
+         kLatencyHistogramBucketsMs.begin();
+}
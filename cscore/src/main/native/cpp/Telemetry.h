@@ -5,6 +5,8 @@
 #ifndef CSCORE_TELEMETRY_H_
 #define CSCORE_TELEMETRY_H_
 
+#include <vector>
+
 #include <wpi/SafeThread.h>
 
 #include "cscore_cpp.h"
@@ -12,6 +14,7 @@
 namespace cs {
 
 class Notifier;
+class SinkImpl;
 class SourceImpl;
 
 class Telemetry {
@@ -30,10 +33,26 @@ class Telemetry {
   int64_t GetValue(CS_Handle handle, CS_TelemetryKind kind, CS_Status* status);
   double GetAverageValue(CS_Handle handle, CS_TelemetryKind kind,
                          CS_Status* status);
+  std::vector<int64_t> GetLatencyHistogram(CS_Handle handle,
+                                           CS_Status* status);
 
   // Telemetry events
   void RecordSourceBytes(const SourceImpl& source, int quantity);
   void RecordSourceFrames(const SourceImpl& source, int quantity);
+  // time is in microseconds, and should be 0 for hits
+  void RecordSourceConversion(const SourceImpl& source, bool hit,
+                              int64_t time);
+  // bytes is the total allocated by the source's frame pool after the
+  // allocation
+  void RecordSourcePoolAlloc(const SourceImpl& source, bool hit, size_t bytes);
+  void RecordSourceFramesDropped(const SourceImpl& source, int quantity);
+  // time is in microseconds
+  void RecordSourceEncode(const SourceImpl& source, int64_t time);
+  // time is in microseconds, from frame capture to the sink
+  void RecordSinkLatency(const SinkImpl& sink, int64_t time);
+
+  // Returns the latency histogram bucket of a time in microseconds.
+  static size_t GetLatencyBucket(int64_t time);
 
  private:
   Notifier& m_notifier;
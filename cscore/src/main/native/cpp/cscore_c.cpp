@@ -4,6 +4,7 @@
 
 #include "cscore_c.h"
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdlib>
 
@@ -436,6 +437,14 @@ double CS_GetTelemetryAverageValue(CS_Handle handle, CS_TelemetryKind kind,
   return cs::GetTelemetryAverageValue(handle, kind, status);
 }
 
+int CS_GetTelemetryLatencyHistogram(CS_Sink sink, int64_t* counts, int count,
+                                    CS_Status* status) {
+  auto histogram = cs::GetTelemetryLatencyHistogram(sink, status);
+  int n = std::min(count, static_cast<int>(histogram.size()));
+  std::copy_n(histogram.begin(), n, counts);
+  return histogram.size();
+}
+
 void CS_SetLogger(CS_LogFunc func, unsigned int min_level) {
   cs::SetLogger(func, min_level);
 }
@@ -839,6 +839,11 @@ double GetTelemetryAverageValue(CS_Handle handle, CS_TelemetryKind kind,
                                                            status);
 }
 
+std::vector<int64_t> GetTelemetryLatencyHistogram(CS_Sink sink,
+                                                  CS_Status* status) {
+  return Instance::GetInstance().telemetry.GetLatencyHistogram(sink, status);
+}
+
 //
 // Logging Functions
 //
@@ -1831,6 +1831,21 @@ Java_edu_wpi_first_cscore_CameraServerJNI_setSinkEnabled
   CheckStatus(env, status);
 }
 
+/*
+ * Class:     edu_wpi_first_cscore_CameraServerJNI
+ * Method:    setSinkRegion
+ * Signature: (IIIIII)V
+ */
+JNIEXPORT void JNICALL
+Java_edu_wpi_first_cscore_CameraServerJNI_setSinkRegion
+  (JNIEnv* env, jclass, jint sink, jint x, jint y, jint width, jint height,
+   jint decimation)
+{
+  CS_Status status = 0;
+  cs::SetSinkRegion(sink, x, y, width, height, decimation, &status);
+  CheckStatus(env, status);
+}
+
 /*
  * Class:     edu_wpi_first_cscore_CameraServerJNI
  * Method:    addListener
@@ -2051,6 +2066,28 @@ Java_edu_wpi_first_cscore_CameraServerJNI_getTelemetryAverageValue
   return val;
 }
 
+/*
+ * Class:     edu_wpi_first_cscore_CameraServerJNI
+ * Method:    getTelemetryLatencyHistogram
+ * Signature: (I)[J
+ */
+JNIEXPORT jlongArray JNICALL
+Java_edu_wpi_first_cscore_CameraServerJNI_getTelemetryLatencyHistogram
+  (JNIEnv* env, jclass, jint sink)
+{
+  CS_Status status = 0;
+  auto histogram = cs::GetTelemetryLatencyHistogram(sink, &status);
+  if (status == CS_EMPTY_VALUE) {
+    // no frames were received during the telemetry period
+    status = 0;
+    histogram.assign(cs::kLatencyHistogramBucketsMs.size() + 1, 0);
+  }
+  if (!CheckStatus(env, status)) {
+    return nullptr;
+  }
+  return MakeJLongArray(env, histogram);
+}
+
 /*
  * Class:     edu_wpi_first_cscore_CameraServerJNI
  * Method:    enumerateUsbCameras
@@ -116,6 +116,7 @@ enum CS_SourceKind {
   CS_SOURCE_HTTP = 2,
   CS_SOURCE_CV = 4,
   CS_SOURCE_RAW = 8,
+  CS_SOURCE_SHM = 16,
 };
 
 /**
@@ -135,7 +136,8 @@ enum CS_SinkKind {
   CS_SINK_UNKNOWN = 0,
   CS_SINK_MJPEG = 2,
   CS_SINK_CV = 4,
-  CS_SINK_RAW = 8
+  CS_SINK_RAW = 8,
+  CS_SINK_SHM = 16
 };
 
 /**
@@ -169,7 +171,43 @@ enum CS_EventKind {
  */
 enum CS_TelemetryKind {
   CS_SOURCE_BYTES_RECEIVED = 1,
-  CS_SOURCE_FRAMES_RECEIVED = 2
+  CS_SOURCE_FRAMES_RECEIVED = 2,
+  /** Sink image requests served from a cached or in-progress conversion */
+  CS_SOURCE_CONVERSION_HITS = 3,
+  /** Sink image requests that required a resize, color convert, or encode */
+  CS_SOURCE_CONVERSION_MISSES = 4,
+  /** Time spent on conversions (microseconds) */
+  CS_SOURCE_CONVERSION_TIME = 5,
+  /** Image allocations served from the source's frame pool */
+  CS_SOURCE_POOL_HITS = 6,
+  /** Image allocations that required a new buffer */
+  CS_SOURCE_POOL_MISSES = 7,
+  /** Peak bytes of image buffers allocated by the source */
+  CS_SOURCE_POOL_PEAK_BYTES = 8,
+  /** Frames dropped because the frame pool limit was reached */
+  CS_SOURCE_FRAMES_DROPPED = 9,
+  /** Time spent on JPEG encoding, included in conversion time (microseconds) */
+  CS_SOURCE_ENCODE_TIME = 10,
+  /** Frames received by a sink */
+  CS_SINK_FRAMES_RECEIVED = 11,
+  /** Total time from frame capture to sink (microseconds) */
+  CS_SINK_LATENCY_TIME = 12
+};
+
+/**
+ * Frame timestamp sources.  All frame times are in the wpi::Now() time base;
+ * this indicates what point in the capture pipeline the capture time refers
+ * to.
+ */
+enum CS_TimestampSource {
+  /** Unknown */
+  CS_TIMESRC_UNKNOWN = 0,
+  /** When cscore received the frame from the device or network */
+  CS_TIMESRC_FRAME_DEQUEUE = 1,
+  /** V4L2 buffer timestamp, taken at the end of the frame */
+  CS_TIMESRC_V4L_EOF = 2,
+  /** V4L2 buffer timestamp, taken at the start of exposure */
+  CS_TIMESRC_V4L_SOE = 3
 };
 
 /** Connection strategy */
@@ -416,6 +454,8 @@ void CS_SetSinkDescription(CS_Sink sink, const char* description,
                            CS_Status* status);
 char* CS_GetSinkError(CS_Sink sink, CS_Status* status);
 void CS_SetSinkEnabled(CS_Sink sink, CS_Bool enabled, CS_Status* status);
+void CS_SetSinkRegion(CS_Sink sink, int x, int y, int width, int height,
+                      int decimation, CS_Status* status);
 /** @} */
 
 /**
@@ -453,6 +493,13 @@ int64_t CS_GetTelemetryValue(CS_Handle handle, enum CS_TelemetryKind kind,
                              CS_Status* status);
 double CS_GetTelemetryAverageValue(CS_Handle handle, enum CS_TelemetryKind kind,
                                    CS_Status* status);
+/**
+ * Copies up to count entries of a sink's latency histogram (see
+ * cs::kLatencyHistogramBucketsMs) into counts, and returns the number of
+ * histogram entries.
+ */
+int CS_GetTelemetryLatencyHistogram(CS_Sink sink, int64_t* counts, int count,
+                                    CS_Status* status);
 /** @} */
 
 /**
@@ -7,6 +7,7 @@
 
 #include <stdint.h>
 
+#include <array>
 #include <functional>
 #include <span>
 #include <string>
@@ -374,6 +375,8 @@ std::string GetSinkError(CS_Sink sink, CS_Status* status);
 std::string_view GetSinkError(CS_Sink sink, wpi::SmallVectorImpl<char>& buf,
                               CS_Status* status);
 void SetSinkEnabled(CS_Sink sink, bool enabled, CS_Status* status);
+void SetSinkRegion(CS_Sink sink, int x, int y, int width, int height,
+                   int decimation, CS_Status* status);
 /** @} */
 
 /**
@@ -410,6 +413,20 @@ int64_t GetTelemetryValue(CS_Handle handle, CS_TelemetryKind kind,
                           CS_Status* status);
 double GetTelemetryAverageValue(CS_Handle handle, CS_TelemetryKind kind,
                                 CS_Status* status);
+
+/**
+ * Upper bounds of the sink latency histogram buckets, in milliseconds.  The
+ * last histogram bucket counts everything above the last bound.
+ */
+inline constexpr std::array<double, 9> kLatencyHistogramBucketsMs = {
+    1, 2, 5, 10, 20, 50, 100, 200, 500};
+
+/**
+ * Gets the histogram of frame capture to sink latencies over the last
+ * telemetry period, with one more entry than kLatencyHistogramBucketsMs.
+ */
+std::vector<int64_t> GetTelemetryLatencyHistogram(CS_Sink sink,
+                                                  CS_Status* status);
 /** @} */
 
 /**
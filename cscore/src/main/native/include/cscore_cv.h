@@ -67,6 +67,10 @@ void PutSourceFrame(CS_Source source, cv::Mat& image, CS_Status* status);
 uint64_t GrabSinkFrame(CS_Sink sink, cv::Mat& image, CS_Status* status);
 uint64_t GrabSinkFrameTimeout(CS_Sink sink, cv::Mat& image, double timeout,
                               CS_Status* status);
+uint64_t GrabSinkFramesSynchronized(std::span<const CS_Sink> sinks,
+                                    std::span<cv::Mat> images,
+                                    double tolerance, double timeout,
+                                    CS_Status* status);
 
 /**
  * A source for user code to provide OpenCV images as video frames.
@@ -170,6 +174,25 @@ class CvSink : public ImageSink {
    */
   [[nodiscard]]
   uint64_t GrabFrameNoTimeout(cv::Mat& image) const;
+
+  /**
+   * Wait for a set of frames, one from each sink, that were captured at
+   * nearly the same time (e.g. from a stereo pair).  Frames that cannot be
+   * matched are dropped.  Times out (returning 0) after timeout seconds.
+   *
+   * @param sinks sinks to grab from (each connected to a different source)
+   * @param images output images, one per sink
+   * @param tolerance maximum difference between frame times, in seconds
+   * @param timeout timeout in seconds
+   * @return Frame time of the first sink's image, or 0 on error; the frame
+   *         time is in the same time base as wpi::Now(), and is in 1 us
+   *         increments.
+   */
+  [[nodiscard]]
+  static uint64_t GrabFramesSynchronized(std::span<const CvSink> sinks,
+                                         std::span<cv::Mat> images,
+                                         double tolerance,
+                                         double timeout = 0.225);
 };
 
 inline CvSource::CvSource(std::string_view name, const VideoMode& mode) {
@@ -208,6 +231,23 @@ inline uint64_t CvSink::GrabFrameNoTimeout(cv::Mat& image) const {
   return GrabSinkFrame(m_handle, image, &m_status);
 }
 
+inline uint64_t CvSink::GrabFramesSynchronized(std::span<const CvSink> sinks,
+                                               std::span<cv::Mat> images,
+                                               double tolerance,
+                                               double timeout) {
+  wpi::SmallVector<CS_Sink, 4> handles;
+  for (auto&& sink : sinks) {
+    handles.emplace_back(sink.m_handle);
+  }
+  CS_Status status = 0;
+  uint64_t rv =
+      GrabSinkFramesSynchronized(handles, images, tolerance, timeout, &status);
+  for (auto&& sink : sinks) {
+    sink.m_status = status;
+  }
+  return rv;
+}
+
 }  // namespace cs
 
 #endif
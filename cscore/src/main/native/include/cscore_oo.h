@@ -112,7 +112,9 @@ class VideoSource {
     /// HTTP video source.
     kHttp = CS_SOURCE_HTTP,
     /// CV video source.
-    kCv = CS_SOURCE_CV
+    kCv = CS_SOURCE_CV,
+    /// Shared memory video source.
+    kShm = CS_SOURCE_SHM
   };
 
   /** Connection strategy.  Used for SetConnectionStrategy(). */
@@ -734,7 +736,9 @@ class VideoSink {
     /// MJPEG video sink.
     kMjpeg = CS_SINK_MJPEG,
     /// CV video sink.
-    kCv = CS_SINK_CV
+    kCv = CS_SINK_CV,
+    /// Shared memory video sink.
+    kShm = CS_SINK_SHM
   };
 
   VideoSink() noexcept = default;
@@ -767,6 +771,27 @@ class VideoSink {
    */
   std::string GetDescription() const;
 
+  /**
+   * Get the average latency from frame capture to this sink (in seconds).
+   *
+   * <p>SetTelemetryPeriod() must be called for this to be valid.
+   *
+   * @return Latency averaged over the telemetry period, or 0 if no frames
+   *         were received.
+   */
+  double GetAverageLatency() const;
+
+  /**
+   * Get the histogram of latencies from frame capture to this sink.
+   *
+   * <p>SetTelemetryPeriod() must be called for this to be valid.
+   *
+   * @return Frame counts over the telemetry period, one per bucket of
+   *         kLatencyHistogramBucketsMs plus one for longer latencies.  All
+   *         counts are 0 if no frames were received.
+   */
+  std::vector<int64_t> GetLatencyHistogram() const;
+
   /**
    * Get a property of the sink.
    *
@@ -949,6 +974,17 @@ class MjpegServer : public VideoSink {
    * @param quality JPEG compression quality (0-100)
    */
   void SetDefaultCompression(int quality);
+
+  /**
+   * Serve newly connected stream clients from the shared event loop instead
+   * of a thread per client.  Each frame is then compressed once per distinct
+   * client setting (at most four; further clients share the closest one),
+   * and clients that fall behind skip frames rather than delaying others.
+   * Has no effect on Windows.
+   *
+   * @param enabled true to enable
+   */
+  void SetEventLoop(bool enabled);
 };
 
 /**
@@ -980,6 +1016,26 @@ class ImageSink : public VideoSink {
    * processor resources when frames are not needed.
    */
   void SetEnabled(bool enabled);
+
+  /**
+   * Set the region of interest of grabbed frames.
+   *
+   * <p>Frames are cropped to the rectangle (in source frame coordinates),
+   * then reduced by averaging decimation x decimation blocks of pixels.  The
+   * crop and decimation are done in the first conversion pass, so later
+   * processing only touches the region.  If every sink enabled on a USB
+   * camera requests the same rectangle and the camera supports it, the
+   * camera crops in hardware.  Regions are not supported for the MJPEG,
+   * YUYV, and UYVY pixel formats: on a CvSink with one of those formats this
+   * fails with CS_UNSUPPORTED_MODE, as does a RawSink grab requesting one.
+   *
+   * @param x left edge
+   * @param y top edge
+   * @param width width, or 0 to extend to the right edge
+   * @param height height, or 0 to extend to the bottom edge
+   * @param decimation binning factor (1 for none)
+   */
+  void SetRegion(int x, int y, int width, int height, int decimation = 1);
 };
 
 /**
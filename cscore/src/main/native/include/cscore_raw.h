@@ -40,6 +40,13 @@ void CS_PutRawSourceFrame(CS_Source source, const struct WPI_RawFrame* image,
 
 CS_Source CS_CreateRawSource(const char* name, const CS_VideoMode* mode,
                              CS_Status* status);
+
+CS_Sink CS_CreateShmSink(const char* name, const char* shmName,
+                         const CS_VideoMode* mode, int numSlots,
+                         CS_Status* status);
+
+CS_Source CS_CreateShmSource(const char* name, const char* shmName,
+                             CS_Status* status);
 /** @} */
 
 #ifdef __cplusplus
@@ -68,6 +75,11 @@ uint64_t GrabSinkFrame(CS_Sink sink, WPI_RawFrame& image, CS_Status* status);
 uint64_t GrabSinkFrameTimeout(CS_Sink sink, WPI_RawFrame& image, double timeout,
                               CS_Status* status);
 
+CS_Sink CreateShmSink(std::string_view name, std::string_view shmName,
+                      const VideoMode& mode, int numSlots, CS_Status* status);
+CS_Source CreateShmSource(std::string_view name, std::string_view shmName,
+                          CS_Status* status);
+
 /**
  * A source for user code to provide video frames as raw bytes.
  *
@@ -165,6 +177,51 @@ class RawSink : public ImageSink {
   uint64_t GrabFrameNoTimeout(wpi::RawFrame& image) const;
 };
 
+/**
+ * A sink that publishes frames to other processes on the same machine through
+ * a named shared memory segment, without encoding them.  A ShmSource with the
+ * same shared memory name, running as the same user, reads the frames.
+ *
+ * Frames are converted to a fixed video mode.  Only supported on Linux.
+ */
+class ShmSink : public VideoSink {
+ public:
+  ShmSink() = default;
+
+  /**
+   * Create a shared memory sink.
+   *
+   * @param name Sink name (arbitrary unique identifier)
+   * @param shmName Shared memory name; any existing segment with this name is
+   *                replaced
+   * @param mode Video mode frames are converted to; the frame rate is only
+   *             informational
+   * @param numSlots Number of frames buffered (2 to 32); readers holding
+   *                 frames keep their slots from being reused
+   */
+  ShmSink(std::string_view name, std::string_view shmName,
+          const VideoMode& mode, int numSlots = 4);
+};
+
+/**
+ * A source that reads frames published by a ShmSink, usually in another
+ * process.  Frames are not copied; the shared memory slot is held until the
+ * last sink releases the frame.  Only supported on Linux.
+ */
+class ShmSource : public VideoSource {
+ public:
+  ShmSource() = default;
+
+  /**
+   * Create a shared memory source.  The source connects once the ShmSink
+   * creates the shared memory, and reconnects if it is restarted.
+   *
+   * @param name Source name (arbitrary unique identifier)
+   * @param shmName Shared memory name
+   */
+  ShmSource(std::string_view name, std::string_view shmName);
+};
+
 inline RawSource::RawSource(std::string_view name, const VideoMode& mode) {
   m_handle = CreateRawSource(name, mode, &m_status);
 }
@@ -200,6 +257,15 @@ inline uint64_t RawSink::GrabFrameNoTimeout(wpi::RawFrame& image) const {
   return GrabSinkFrame(m_handle, image, &m_status);
 }
 
+inline ShmSink::ShmSink(std::string_view name, std::string_view shmName,
+                        const VideoMode& mode, int numSlots) {
+  m_handle = CreateShmSink(name, shmName, mode, numSlots, &m_status);
+}
+
+inline ShmSource::ShmSource(std::string_view name, std::string_view shmName) {
+  m_handle = CreateShmSource(name, shmName, &m_status);
+}
+
 }  // namespace cs
 
 /** @} */
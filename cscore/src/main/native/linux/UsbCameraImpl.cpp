@@ -27,6 +27,7 @@
 #include <wpi/SmallString.h>
 #include <wpi/StringExtras.h>
 #include <wpi/fs.h>
+#include <wpi/json.h>
 #include <wpi/raw_ostream.h>
 #include <wpi/timestamp.h>
 
@@ -69,6 +70,35 @@ static inline struct v4l2_fract FPSToFract(int fps) {
   return timeperframe;
 }
 
+// Converts the timestamp of a dequeued buffer to the wpi::Now() time base,
+// given the current wpi::Now() time.  Falls back to now if the driver does not
+// timestamp buffers with the monotonic clock.
+static Frame::Time GetCaptureTime(const struct v4l2_buffer& buf,
+                                  Frame::Time now,
+                                  CS_TimestampSource* timeSource) {
+  *timeSource = CS_TIMESRC_FRAME_DEQUEUE;
+  if ((buf.flags & V4L2_BUF_FLAG_TIMESTAMP_MASK) !=
+      V4L2_BUF_FLAG_TIMESTAMP_MONOTONIC) {
+    return now;
+  }
+  struct timespec ts;
+  if (clock_gettime(CLOCK_MONOTONIC, &ts) != 0) {
+    return now;
+  }
+  uint64_t monoNow = ts.tv_sec * 1000000ull + ts.tv_nsec / 1000;
+  uint64_t stamp = buf.timestamp.tv_sec * 1000000ull + buf.timestamp.tv_usec;
+  if (stamp == 0 || stamp > monoNow || monoNow - stamp > now) {
+    return now;
+  }
+  if ((buf.flags & V4L2_BUF_FLAG_TSTAMP_SRC_MASK) ==
+      V4L2_BUF_FLAG_TSTAMP_SRC_SOE) {
+    *timeSource = CS_TIMESRC_V4L_SOE;
+  } else {
+    *timeSource = CS_TIMESRC_V4L_EOF;
+  }
+  return now - (monoNow - stamp);
+}
+
 // Conversion from v4l2_format pixelformat to VideoMode::PixelFormat
 static VideoMode::PixelFormat ToPixelFormat(__u32 pixelFormat) {
   switch (pixelFormat) {
@@ -426,6 +456,21 @@ void UsbCameraImpl::CameraThreadMain() {
       break;
     }
 
+    // Give buffers released by frames back to the driver
+    if (fd >= 0 && !DeviceRequeueBuffers(fd)) {
+      SWARNING("could not requeue buffer");
+      wasStreaming = m_streaming;
+      DeviceStreamOff();
+      DeviceDisconnect();
+      notified = true;  // device wasn't deleted, just error'ed
+      continue;         // will reconnect
+    }
+
+    // Apply a changed sink crop
+    if (fd >= 0 && m_cropPending && DeviceApplyCrop()) {
+      continue;
+    }
+
     // Reset notified flag and restart streaming if necessary
     if (fd >= 0) {
       notified = (notify_fd < 0);
@@ -447,6 +492,9 @@ void UsbCameraImpl::CameraThreadMain() {
     if (fd < 0 && notified) {
       tv.tv_sec = 0;
       tv.tv_usec = 300000;
+    } else if (m_cropPending) {
+      tv.tv_sec = 0;
+      tv.tv_usec = std::chrono::microseconds(kCropPollTime).count();
     } else {
       tv.tv_sec = 2;
       tv.tv_usec = 0;
@@ -532,16 +580,17 @@ void UsbCameraImpl::CameraThreadMain() {
       if ((buf.flags & V4L2_BUF_FLAG_ERROR) == 0) {
         SDEBUG4("got image size={} index={}", buf.bytesused, buf.index);
 
-        if (buf.index >= kNumBuffers || !m_buffers[buf.index].m_data) {
+        if (buf.index >= kNumBuffers || !m_buffers ||
+            !m_buffers->buffers[buf.index].m_data) {
           SWARNING("invalid buffer {}", buf.index);
           continue;
         }
 
         std::string_view image{
-            static_cast<const char*>(m_buffers[buf.index].m_data),
+            static_cast<const char*>(m_buffers->buffers[buf.index].m_data),
             static_cast<size_t>(buf.bytesused)};
-        int width = m_mode.width;
-        int height = m_mode.height;
+        int width = m_crop.IsCrop() ? m_crop.width : m_mode.width;
+        int height = m_crop.IsCrop() ? m_crop.height : m_mode.height;
         bool good = true;
         if (m_mode.pixelFormat == VideoMode::kMJPEG &&
             !GetJpegSize(image, &width, &height)) {
@@ -549,8 +598,17 @@ void UsbCameraImpl::CameraThreadMain() {
           good = false;
         }
         if (good) {
-          PutFrame(static_cast<VideoMode::PixelFormat>(m_mode.pixelFormat),
-                   width, height, image, wpi::Now());  // TODO: time
+          auto pixelFormat =
+              static_cast<VideoMode::PixelFormat>(m_mode.pixelFormat);
+          Frame::Time now = wpi::Now();
+          CS_TimestampSource timeSource;
+          Frame::Time captureTime = GetCaptureTime(buf, now, &timeSource);
+          if (DeviceLendBuffer(buf.index, pixelFormat, width, height,
+                               image.size(), now, captureTime, timeSource)) {
+            continue;  // requeued once the frame is released
+          }
+          PutFrame(pixelFormat, width, height, image, now, captureTime,
+                   timeSource);
         }
       }
 
@@ -578,9 +636,8 @@ void UsbCameraImpl::DeviceDisconnect() {
   }
 
   // Unmap buffers
-  for (int i = 0; i < kNumBuffers; ++i) {
-    m_buffers[i] = UsbCameraBuffer{};
-  }
+  DeviceReclaimBuffers();
+  m_buffers.reset();
 
   // Close device
   close(fd);
@@ -648,6 +705,9 @@ void UsbCameraImpl::DeviceConnect() {
     }
   }
 
+  // Crop (this may change the format, so it must precede buffer allocation)
+  DeviceSetCrop();
+
   // Request buffers
   SDEBUG3("allocating buffers");
   struct v4l2_requestbuffers rb;
@@ -664,6 +724,8 @@ void UsbCameraImpl::DeviceConnect() {
 
   // Map buffers
   SDEBUG3("mapping buffers");
+  auto buffers = std::make_shared<BufferSet>();
+  buffers->returned.reserve(kNumBuffers);
   for (int i = 0; i < kNumBuffers; ++i) {
     struct v4l2_buffer buf;
     std::memset(&buf, 0, sizeof(buf));
@@ -678,20 +740,17 @@ void UsbCameraImpl::DeviceConnect() {
     }
     SDEBUG4("buf {} length={} offset={}", i, buf.length, buf.m.offset);
 
-    m_buffers[i] = UsbCameraBuffer(fd, buf.length, buf.m.offset);
-    if (!m_buffers[i].m_data) {
+    buffers->buffers[i] = UsbCameraBuffer(fd, buf.length, buf.m.offset);
+    if (!buffers->buffers[i].m_data) {
       SWARNING("could not map buffer {}", i);
-      // release other buffers
-      for (int j = 0; j < i; ++j) {
-        m_buffers[j] = UsbCameraBuffer{};
-      }
       close(fd);
       m_fd = -1;
       return;
     }
 
-    SDEBUG4("buf {} address={}", i, m_buffers[i].m_data);
+    SDEBUG4("buf {} address={}", i, buffers->buffers[i].m_data);
   }
+  m_buffers = std::move(buffers);
 
   // Update description (as it may have changed)
   SetDescription(GetDescriptionImpl(m_path.c_str()));
@@ -712,15 +771,15 @@ bool UsbCameraImpl::DeviceStreamOn() {
     return false;
   }
 
-  // Queue buffers
+  // Queue buffers; buffers still referenced by frames are queued when the
+  // frames are released
   SDEBUG3("queuing buffers");
+  DeviceRequeueBuffers(-1);
   for (int i = 0; i < kNumBuffers; ++i) {
-    struct v4l2_buffer buf;
-    std::memset(&buf, 0, sizeof(buf));
-    buf.index = i;
-    buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-    buf.memory = V4L2_MEMORY_MMAP;
-    if (DoIoctl(fd, VIDIOC_QBUF, &buf) != 0) {
+    if (m_buffers && m_buffers->lent[i]) {
+      continue;
+    }
+    if (!DeviceQueueBuffer(fd, i)) {
       SWARNING("could not queue buffer {}", i);
       return false;
     }
@@ -763,6 +822,95 @@ bool UsbCameraImpl::DeviceStreamOff() {
   return true;
 }
 
+bool UsbCameraImpl::DeviceQueueBuffer(int fd, int index) {
+  struct v4l2_buffer buf;
+  std::memset(&buf, 0, sizeof(buf));
+  buf.index = index;
+  buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+  buf.memory = V4L2_MEMORY_MMAP;
+  return DoIoctl(fd, VIDIOC_QBUF, &buf) == 0;
+}
+
+bool UsbCameraImpl::DeviceLendBuffer(int index,
+                                     VideoMode::PixelFormat pixelFormat,
+                                     int width, int height, size_t size,
+                                     Frame::Time time, Frame::Time captureTime,
+                                     CS_TimestampSource timeSource) {
+  // Always leave the driver enough buffers to keep capturing; if sinks are
+  // holding on to frames, fall back to copying until they let go.  Copy too
+  // while waiting for lent buffers to come back to change the crop.
+  if (!m_zeroCopy || !m_buffers || m_cropPending ||
+      kNumBuffers - m_buffers->numLent - 1 < kMinQueuedBuffers) {
+    return false;
+  }
+
+  // The deleter runs on whichever thread releases the last frame reference,
+  // so only record the buffer here; the camera thread requeues it.
+  std::shared_ptr<void> data{
+      m_buffers->buffers[index].m_data, [set = m_buffers, index](void*) {
+        {
+          std::scoped_lock lock{set->mutex};
+          set->returned.push_back(index);
+        }
+        set->returnedCv.notify_all();
+      }};
+  m_buffers->lent[index] = true;
+  ++m_buffers->numLent;
+
+  auto image = std::make_unique<Image>(0);
+  image->SetExternal(std::move(data), size);
+  image->pixelFormat = pixelFormat;
+  image->width = width;
+  image->height = height;
+  PutFrame(std::move(image), time, captureTime, timeSource);
+  return true;
+}
+
+bool UsbCameraImpl::DeviceRequeueBuffers(int fd) {
+  if (!m_buffers) {
+    return true;
+  }
+  wpi::SmallVector<int, kNumBuffers> returned;
+  {
+    std::scoped_lock lock{m_buffers->mutex};
+    returned.append(m_buffers->returned.begin(), m_buffers->returned.end());
+    m_buffers->returned.clear();
+  }
+  bool ok = true;
+  for (int index : returned) {
+    m_buffers->lent[index] = false;
+    --m_buffers->numLent;
+    if (fd >= 0 && m_streaming && ok) {
+      ok = DeviceQueueBuffer(fd, index);
+    }
+  }
+  return ok;
+}
+
+void UsbCameraImpl::DeviceReclaimBuffers() {
+  if (!m_buffers || m_buffers->numLent == 0) {
+    return;
+  }
+
+  // The current frame is kept until the next one arrives, which won't happen
+  // until we reconnect, so give it a copy of the data instead
+  DetachFrame();
+
+  // Wait for sinks to finish with any other frames.  If they don't in time,
+  // the buffers stay mapped until they do, and reconnecting fails (and is
+  // retried) until then.
+  std::unique_lock lock{m_buffers->mutex};
+  if (!m_buffers->returnedCv.wait_for(lock, kReclaimTimeout, [&] {
+        return static_cast<int>(m_buffers->returned.size()) ==
+               m_buffers->numLent;
+      })) {
+    SWARNING("{} capture buffers still in use by frames",
+             m_buffers->numLent - m_buffers->returned.size());
+  }
+  lock.unlock();
+  DeviceRequeueBuffers(-1);
+}
+
 CS_StatusValue UsbCameraImpl::DeviceCmdSetMode(
     std::unique_lock<wpi::mutex>& lock, const Message& msg) {
   VideoMode newMode;
@@ -910,6 +1058,54 @@ CS_StatusValue UsbCameraImpl::DeviceCmdSetPath(
   return CS_OK;
 }
 
+CS_StatusValue UsbCameraImpl::DeviceCmdSetCrop(
+    std::unique_lock<wpi::mutex>& lock) {
+  ImageRegion crop;
+  if (!GetCommonSinkCrop(&crop)) {
+    crop = {};
+  }
+  if (crop == m_cropRequest) {
+    m_cropPending.reset();
+    return CS_OK;
+  }
+
+  // Reconnecting is disruptive, so wait for the crop to settle; the main
+  // loop applies it with DeviceApplyCrop()
+  if (m_cropPending != crop) {
+    m_cropPending = crop;
+    m_cropPendingTime = std::chrono::steady_clock::now();
+  }
+  return CS_OK;
+}
+
+bool UsbCameraImpl::DeviceApplyCrop() {
+  if (std::chrono::steady_clock::now() - m_cropPendingTime < kCropSettleTime) {
+    return false;
+  }
+
+  // Buffers aren't lent while a crop is pending, so only frames that were
+  // already out hold any.  Give the current frame a copy and retry until
+  // sinks release the rest, rather than reconnecting out from under them.
+  if (m_buffers && m_buffers->numLent > 0) {
+    DetachFrame();
+    return false;
+  }
+
+  // Changing the crop may change the frame size, so reconnect as for a
+  // resolution change; DeviceConnect() applies the crop
+  m_cropPending.reset();
+  bool wasStreaming = m_streaming;
+  if (wasStreaming) {
+    DeviceStreamOff();
+  }
+  DeviceDisconnect();
+  DeviceConnect();
+  if (wasStreaming) {
+    DeviceStreamOn();
+  }
+  return true;
+}
+
 CS_StatusValue UsbCameraImpl::DeviceProcessCommand(
     std::unique_lock<wpi::mutex>& lock, const Message& msg) {
   if (msg.kind == Message::kCmdSetMode ||
@@ -923,6 +1119,8 @@ CS_StatusValue UsbCameraImpl::DeviceProcessCommand(
   } else if (msg.kind == Message::kNumSinksChanged ||
              msg.kind == Message::kNumSinksEnabledChanged) {
     return CS_OK;
+  } else if (msg.kind == Message::kSinkRegionsChanged) {
+    return DeviceCmdSetCrop(lock);
   } else if (msg.kind == Message::kCmdSetPath) {
     return DeviceCmdSetPath(lock, msg);
   } else {
@@ -941,7 +1139,8 @@ void UsbCameraImpl::DeviceProcessCommands() {
 
     CS_StatusValue status = DeviceProcessCommand(lock, msg);
     if (msg.kind != Message::kNumSinksChanged &&
-        msg.kind != Message::kNumSinksEnabledChanged) {
+        msg.kind != Message::kNumSinksEnabledChanged &&
+        msg.kind != Message::kSinkRegionsChanged) {
       m_responses.emplace_back(msg.from, status);
     }
   }
@@ -982,6 +1181,110 @@ void UsbCameraImpl::DeviceSetMode() {
   }
 }
 
+void UsbCameraImpl::DeviceSetCrop() {
+  int fd = m_fd.load();
+  if (fd < 0) {
+    return;
+  }
+
+  ImageRegion crop;
+  if (!GetCommonSinkCrop(&crop)) {
+    crop = {};
+  }
+  m_cropRequest = crop;
+  m_cropPending.reset();
+  m_crop = {};
+  SetCaptureOrigin(0, 0);
+
+  // Many cameras (including most UVC cameras) do not support cropping; sinks
+  // then crop in software
+  struct v4l2_selection sel;
+  std::memset(&sel, 0, sizeof(sel));
+  sel.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+  sel.target = V4L2_SEL_TGT_CROP_DEFAULT;
+  if (TryIoctl(fd, VIDIOC_G_SELECTION, &sel) != 0) {
+    if (crop.IsCrop()) {
+      SDEBUG("camera does not support cropping");
+    }
+    return;
+  }
+  struct v4l2_rect full = sel.r;
+  sel.target = V4L2_SEL_TGT_CROP;
+  if (TryIoctl(fd, VIDIOC_G_SELECTION, &sel) != 0) {
+    return;
+  }
+  struct v4l2_rect current = sel.r;
+  auto sameRect = [](const v4l2_rect& a, const v4l2_rect& b) {
+    return a.left == b.left && a.top == b.top && a.width == b.width &&
+           a.height == b.height;
+  };
+
+  // Crop rectangles are in sensor coordinates, which only match sink
+  // coordinates if the default crop is not scaled
+  int width;
+  int height;
+  {
+    std::scoped_lock lock(m_mutex);
+    width = m_mode.width;
+    height = m_mode.height;
+  }
+  struct v4l2_rect rect = full;
+  if (crop.IsCrop() && full.left == 0 && full.top == 0 &&
+      static_cast<int>(full.width) == width &&
+      static_cast<int>(full.height) == height) {
+    rect.left = std::min(crop.x, width);
+    rect.top = std::min(crop.y, height);
+    rect.width = crop.width > 0 ? std::min(crop.width, width - rect.left)
+                                : width - rect.left;
+    rect.height = crop.height > 0
+                      ? std::min(crop.height, height - rect.top)
+                      : height - rect.top;
+    if (rect.width == 0 || rect.height == 0) {
+      rect = full;
+    }
+  }
+  if (sameRect(rect, current)) {
+    if (!sameRect(rect, full)) {
+      m_crop = {rect.left, rect.top, static_cast<int>(rect.width),
+                static_cast<int>(rect.height)};
+      SetCaptureOrigin(rect.left, rect.top);
+    }
+    return;
+  }
+
+  // Use the crop only if the camera applied it exactly, without scaling
+  sel.target = V4L2_SEL_TGT_CROP;
+  sel.r = rect;
+  bool cropped = false;
+  if (DoIoctl(fd, VIDIOC_S_SELECTION, &sel) == 0 && sameRect(sel.r, rect) &&
+      !sameRect(rect, full)) {
+    struct v4l2_format vfmt;
+    std::memset(&vfmt, 0, sizeof(vfmt));
+    vfmt.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    cropped = DoIoctl(fd, VIDIOC_G_FMT, &vfmt) == 0 &&
+              vfmt.fmt.pix.width == rect.width &&
+              vfmt.fmt.pix.height == rect.height;
+  }
+  if (cropped) {
+    SINFO("cropping to {}x{} at {},{}", rect.width, rect.height, rect.left,
+          rect.top);
+    m_crop = {rect.left, rect.top, static_cast<int>(rect.width),
+              static_cast<int>(rect.height)};
+    SetCaptureOrigin(rect.left, rect.top);
+    return;
+  }
+
+  // Restore the full frame and the format
+  if (!sameRect(rect, full)) {
+    SINFO("camera could not crop to {}x{} at {},{}; cropping in software",
+          rect.width, rect.height, rect.left, rect.top);
+  }
+  sel.target = V4L2_SEL_TGT_CROP;
+  sel.r = full;
+  DoIoctl(fd, VIDIOC_S_SELECTION, &sel);
+  DeviceSetMode();
+}
+
 void UsbCameraImpl::DeviceSetFPS() {
   int fd = m_fd.load();
   if (fd < 0) {
@@ -1551,12 +1854,36 @@ void UsbCameraImpl::NumSinksEnabledChanged() {
   Send(Message{Message::kNumSinksEnabledChanged});
 }
 
+void UsbCameraImpl::SinkRegionsChanged() {
+  Send(Message{Message::kSinkRegionsChanged});
+}
+
 void UsbCameraImpl::SetPath(std::string_view path, CS_Status* status) {
   Message msg{Message::kCmdSetPath};
   msg.dataStr = path;
   *status = SendAndWait(std::move(msg));
 }
 
+bool UsbCameraImpl::SetConfigJson(const wpi::json& config,
+                                  CS_Status* status) {
+  if (config.count("zero copy") != 0) {
+    try {
+      m_zeroCopy = config.at("zero copy").get<bool>();
+    } catch (const wpi::json::exception& e) {
+      SWARNING("SetConfigJson: could not read zero copy: {}", e.what());
+    }
+  }
+  return SourceImpl::SetConfigJson(config, status);
+}
+
+wpi::json UsbCameraImpl::GetConfigJsonObject(CS_Status* status) {
+  wpi::json j = SourceImpl::GetConfigJsonObject(status);
+  if (j.is_object()) {
+    j.emplace("zero copy", m_zeroCopy.load());
+  }
+  return j;
+}
+
 std::string UsbCameraImpl::GetPath() const {
   std::scoped_lock lock(m_mutex);
   return m_path;
@@ -8,7 +8,9 @@
 #include <linux/videodev2.h>
 
 #include <atomic>
+#include <chrono>
 #include <memory>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <thread>
@@ -31,6 +33,8 @@ class Notifier;
 class Telemetry;
 
 class UsbCameraImpl : public SourceImpl {
+  friend class UsbCameraCropTest;
+
  public:
   UsbCameraImpl(std::string_view name, wpi::Logger& logger, Notifier& notifier,
                 Telemetry& telemetry, std::string_view path);
@@ -61,6 +65,10 @@ class UsbCameraImpl : public SourceImpl {
 
   void NumSinksChanged() override;
   void NumSinksEnabledChanged() override;
+  void SinkRegionsChanged() override;
+
+  bool SetConfigJson(const wpi::json& config, CS_Status* status) override;
+  wpi::json GetConfigJsonObject(CS_Status* status) override;
 
   void SetPath(std::string_view path, CS_Status* status);
   std::string GetPath() const;
@@ -78,6 +86,7 @@ class UsbCameraImpl : public SourceImpl {
       kCmdSetPropertyStr,
       kNumSinksChanged,         // no response
       kNumSinksEnabledChanged,  // no response
+      kSinkRegionsChanged,      // no response
       // Responses
       kOk,
       kError
@@ -118,10 +127,26 @@ class UsbCameraImpl : public SourceImpl {
   void DeviceProcessCommands();
   void DeviceSetMode();
   void DeviceSetFPS();
+  // Crops in hardware to the rectangle shared by all enabled sinks, if the
+  // camera supports it, and otherwise restores the full frame
+  void DeviceSetCrop();
+  // Reconnects to apply a pending crop change once it has settled and every
+  // lent buffer is back.  Returns true if it reconnected.
+  bool DeviceApplyCrop();
   void DeviceCacheMode();
   void DeviceCacheProperty(std::unique_ptr<UsbCameraProperty> rawProp);
   void DeviceCacheProperties();
   void DeviceCacheVideoModes();
+  bool DeviceQueueBuffer(int fd, int index);
+  // Lends a dequeued buffer to a new frame rather than copying it.  Returns
+  // false if the caller should copy the data and requeue the buffer instead.
+  bool DeviceLendBuffer(int index, VideoMode::PixelFormat pixelFormat,
+                        int width, int height, size_t size, Frame::Time time,
+                        Frame::Time captureTime,
+                        CS_TimestampSource timeSource);
+  // Requeues buffers released by frames since the last call
+  bool DeviceRequeueBuffers(int fd);
+  void DeviceReclaimBuffers();
 
   // Command helper functions
   CS_StatusValue DeviceProcessCommand(std::unique_lock<wpi::mutex>& lock,
@@ -132,6 +157,7 @@ class UsbCameraImpl : public SourceImpl {
                                       const Message& msg);
   CS_StatusValue DeviceCmdSetPath(std::unique_lock<wpi::mutex>& lock,
                                   const Message& msg);
+  CS_StatusValue DeviceCmdSetCrop(std::unique_lock<wpi::mutex>& lock);
 
   // Property helper functions
   int RawToPercentage(const UsbCameraProperty& rawProp, int rawValue);
@@ -148,14 +174,50 @@ class UsbCameraImpl : public SourceImpl {
   bool m_modeSetFPS{false};
   int m_connectVerbose{1};
   unsigned m_capabilities = 0;
+  // crop requested by sinks when last applied, and the hardware crop in
+  // effect (which is the full frame if the camera could not crop)
+  ImageRegion m_cropRequest;
+  ImageRegion m_crop;
+  // crop requested by sinks since then, and when it last changed
+  std::optional<ImageRegion> m_cropPending;
+  std::chrono::steady_clock::time_point m_cropPendingTime;
   // Number of buffers to ask OS for
-  static constexpr int kNumBuffers = 4;
-  std::array<UsbCameraBuffer, kNumBuffers> m_buffers;
+  static constexpr int kNumBuffers = 6;
+  // Number of buffers kept queued to the driver when lending buffers to
+  // frames; below this, frames are copied instead
+  static constexpr int kMinQueuedBuffers = 2;
+
+  // Maximum time to wait on disconnect for sinks to release lent buffers
+  static constexpr auto kReclaimTimeout = std::chrono::seconds(1);
+
+  // Time the common sink crop must stay unchanged before reconnecting to
+  // apply it, so sinks coming and going (such as MJPEG stream viewers)
+  // don't each restart the stream
+  static constexpr auto kCropSettleTime = std::chrono::seconds(1);
+  // Select timeout while a crop change is pending
+  static constexpr auto kCropPollTime = std::chrono::milliseconds(100);
+
+  // Mapped capture buffers.  In zero copy mode, frames reference these
+  // directly and keep the set (and thus the mappings) alive, so a frame may
+  // outlive the device connection.  The driver can't reallocate buffers while
+  // any are still mapped, so DeviceDisconnect() reclaims them first.
+  struct BufferSet {
+    std::array<UsbCameraBuffer, kNumBuffers> buffers;
+    // buffers currently referenced by frames (camera thread only)
+    std::array<bool, kNumBuffers> lent{};
+    int numLent = 0;
+    // buffers released by frames but not yet requeued
+    wpi::mutex mutex;
+    wpi::condition_variable returnedCv;
+    std::vector<int> returned;
+  };
+  std::shared_ptr<BufferSet> m_buffers;
 
   std::atomic_int m_fd;
   std::atomic_int m_command_fd;  // for command eventfd
 
   std::atomic_bool m_active;  // set to false to terminate thread
+  std::atomic_bool m_zeroCopy{true};  // lend capture buffers to frames
   std::thread m_cameraThread;
 
   // Quirks
@@ -0,0 +1,220 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include "ColorConvert.h"  // NOLINT(build/include_order)
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#include <fmt/core.h>
+#include <gtest/gtest.h>
+#include <opencv2/core/core.hpp>
+#include <opencv2/imgproc/imgproc.hpp>
+
+namespace cs {
+
+namespace {
+
+template <typename T>
+std::vector<T> MakeData(size_t size) {
+  std::vector<T> data(size);
+  unsigned int seed = 12345;
+  for (auto& v : data) {
+    seed = seed * 1103515245 + 12345;
+    v = static_cast<T>(seed >> 8);
+  }
+  return data;
+}
+
+// odd sizes exercise the scalar tails
+constexpr size_t kSizes[] = {1, 2, 15, 16, 17, 63, 640 * 3 + 5};
+
+}  // namespace
+
+TEST(ColorConvertTest, PackedToGray) {
+  for (size_t pixels : kSizes) {
+    auto src = MakeData<uint8_t>(pixels * 2);
+    std::vector<uint8_t> yuyv(pixels);
+    std::vector<uint8_t> uyvy(pixels);
+    cvt::YUYVToGray(src.data(), yuyv.data(), pixels);
+    cvt::UYVYToGray(src.data(), uyvy.data(), pixels);
+    for (size_t i = 0; i < pixels; ++i) {
+      ASSERT_EQ(yuyv[i], src[i * 2]) << pixels << ' ' << i;
+      ASSERT_EQ(uyvy[i], src[i * 2 + 1]) << pixels << ' ' << i;
+    }
+  }
+}
+
+TEST(ColorConvertTest, GrayToY16) {
+  for (size_t pixels : kSizes) {
+    auto src = MakeData<uint8_t>(pixels);
+    std::vector<uint16_t> y16(pixels);
+    cvt::GrayToY16(src.data(), y16.data(), pixels);
+    for (size_t i = 0; i < pixels; ++i) {
+      ASSERT_EQ(y16[i], src[i] * 256);
+    }
+  }
+}
+
+TEST(ColorConvertTest, ResizeGray) {
+  const int w = 37;
+  const int h = 23;
+  auto src = MakeData<uint8_t>(w * h);
+
+  // same size is a copy
+  std::vector<uint8_t> same(w * h);
+  cvt::ResizeGray(src.data(), w, h, 1, w, same.data(), w, h);
+  EXPECT_EQ(same, src);
+
+  // compare against floating point bilinear with the same pixel mapping
+  for (auto [dw, dh] : {std::pair{18, 11}, std::pair{80, 50}}) {
+    std::vector<uint8_t> dst(dw * dh);
+    cvt::ResizeGray(src.data(), w, h, 1, w, dst.data(), dw, dh);
+    auto coord = [](int i, int srcSize, int dstSize, int* index) {
+      double f = (i + 0.5) * srcSize / dstSize - 0.5;
+      f = std::clamp(f, 0.0, srcSize - 1.0);
+      *index = std::min(static_cast<int>(f), srcSize - 1);
+      return f - *index;
+    };
+    for (int y = 0; y < dh; ++y) {
+      int sy;
+      double fy = coord(y, h, dh, &sy);
+      int sy1 = std::min(sy + 1, h - 1);
+      for (int x = 0; x < dw; ++x) {
+        int sx;
+        double fx = coord(x, w, dw, &sx);
+        int sx1 = std::min(sx + 1, w - 1);
+        double top = src[sy * w + sx] * (1 - fx) + src[sy * w + sx1] * fx;
+        double bot = src[sy1 * w + sx] * (1 - fx) + src[sy1 * w + sx1] * fx;
+        ASSERT_NEAR(dst[y * dw + x], top * (1 - fy) + bot * fy, 1.0)
+            << dw << 'x' << dh << " at " << x << ',' << y;
+      }
+    }
+  }
+
+  // fused luma resize matches converting first
+  auto yuyv = MakeData<uint8_t>(w * 2 * h);
+  std::vector<uint8_t> gray(w * h);
+  cvt::YUYVToGray(yuyv.data(), gray.data(), w * h);
+  std::vector<uint8_t> twoPass(20 * 10);
+  std::vector<uint8_t> fused(20 * 10);
+  cvt::ResizeGray(gray.data(), w, h, 1, w, twoPass.data(), 20, 10);
+  cvt::ResizeGray(yuyv.data(), w, h, 2, w * 2, fused.data(), 20, 10);
+  EXPECT_EQ(fused, twoPass);
+}
+
+TEST(ColorConvertTest, Bin) {
+  const int w = 12;
+  const int h = 8;
+  auto src = MakeData<uint8_t>(w * 3 * h);
+
+  // factor 1 is a copy of the region
+  std::vector<uint8_t> region(5 * 3 * 4);
+  cvt::Bin(src.data() + (2 * w + 3) * 3, w * 3, 3, 3, region.data(), 5, 4, 1);
+  for (int y = 0; y < 4; ++y) {
+    for (int i = 0; i < 5 * 3; ++i) {
+      ASSERT_EQ(region[y * 5 * 3 + i], src[((y + 2) * w + 3) * 3 + i]);
+    }
+  }
+
+  // each output is the rounded average of its block
+  for (int factor : {2, 4}) {
+    int dw = w / factor;
+    int dh = h / factor;
+    std::vector<uint8_t> dst(dw * dh * 3);
+    cvt::Bin(src.data(), w * 3, 3, 3, dst.data(), dw, dh, factor);
+    for (int y = 0; y < dh; ++y) {
+      for (int x = 0; x < dw; ++x) {
+        for (int c = 0; c < 3; ++c) {
+          int sum = 0;
+          for (int dy = 0; dy < factor; ++dy) {
+            for (int dx = 0; dx < factor; ++dx) {
+              sum += src[((y * factor + dy) * w + x * factor + dx) * 3 + c];
+            }
+          }
+          ASSERT_NEAR(dst[(y * dw + x) * 3 + c],
+                      static_cast<double>(sum) / (factor * factor), 0.5)
+              << factor << " at " << x << ',' << y;
+        }
+      }
+    }
+  }
+
+  // binning luma in place matches converting first
+  auto yuyv = MakeData<uint8_t>(w * 2 * h);
+  std::vector<uint8_t> gray(w * h);
+  cvt::YUYVToGray(yuyv.data(), gray.data(), w * h);
+  std::vector<uint8_t> twoPass(6 * 4);
+  std::vector<uint8_t> fused(6 * 4);
+  cvt::Bin(gray.data(), w, 1, 1, twoPass.data(), 6, 4, 2);
+  cvt::Bin(yuyv.data(), w * 2, 2, 1, fused.data(), 6, 4, 2);
+  EXPECT_EQ(fused, twoPass);
+}
+
+// Each kernel is timed next to the OpenCV call it replaces
+TEST(ColorConvertTest, Benchmark) {
+  using std::chrono::duration_cast;
+  using std::chrono::high_resolution_clock;
+  using std::chrono::nanoseconds;
+
+  constexpr int kWidth = 640;
+  constexpr int kHeight = 480;
+  constexpr size_t kPixels = kWidth * kHeight;
+  constexpr int kIters = 100;
+
+  auto packed = MakeData<uint8_t>(kPixels * 2);
+  std::vector<uint8_t> gray(kPixels);
+  std::vector<uint16_t> wide(kPixels);
+  std::vector<uint8_t> small(kPixels / 4);
+
+  cv::Mat packedMat{kHeight, kWidth, CV_8UC2, packed.data()};
+  cv::Mat grayMat{kHeight, kWidth, CV_8UC1, gray.data()};
+  cv::Mat wideMat{kHeight, kWidth, CV_16UC1, wide.data()};
+  cv::Mat smallMat{kHeight / 2, kWidth / 2, CV_8UC1, small.data()};
+  cv::Mat tmpMat;
+
+  auto bench = [&](const char* name, auto&& fn) {
+    fn();  // warmup
+    auto start = high_resolution_clock::now();
+    for (int i = 0; i < kIters; ++i) {
+      fn();
+    }
+    auto stop = high_resolution_clock::now();
+    double ns = duration_cast<nanoseconds>(stop - start).count();
+    fmt::print("{:<28} {:8.1f} us/frame {:8.1f} Mpixel/s\n", name,
+               ns / kIters / 1000, kPixels * kIters * 1000.0 / ns);
+  };
+
+  bench("YUYVToGray",
+        [&] { cvt::YUYVToGray(packed.data(), gray.data(), kPixels); });
+  bench("  cv::cvtColor", [&] {
+    cv::cvtColor(packedMat, grayMat, cv::COLOR_YUV2GRAY_YUYV);
+  });
+  bench("UYVYToGray",
+        [&] { cvt::UYVYToGray(packed.data(), gray.data(), kPixels); });
+  bench("  cv::cvtColor", [&] {
+    cv::cvtColor(packedMat, grayMat, cv::COLOR_YUV2GRAY_UYVY);
+  });
+  bench("GrayToY16",
+        [&] { cvt::GrayToY16(gray.data(), wide.data(), kPixels); });
+  bench("  Mat::convertTo",
+        [&] { grayMat.convertTo(wideMat, CV_16U, 256); });
+  bench("YUYV->Gray fused resize", [&] {
+    cvt::ResizeGray(packed.data(), kWidth, kHeight, 2, kWidth * 2,
+                    small.data(), kWidth / 2, kHeight / 2);
+  });
+  bench("  cv::resize, cv::cvtColor", [&] {
+    cv::resize(packedMat, tmpMat, smallMat.size(), 0, 0);
+    cv::cvtColor(tmpMat, smallMat, cv::COLOR_YUV2GRAY_YUYV);
+  });
+  bench("  cv::cvtColor, cv::resize", [&] {
+    cv::cvtColor(packedMat, grayMat, cv::COLOR_YUV2GRAY_YUYV);
+    cv::resize(grayMat, smallMat, smallMat.size(), 0, 0);
+  });
+}
+
+}  // namespace cs
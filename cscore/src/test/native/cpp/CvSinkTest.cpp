@@ -0,0 +1,140 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include <atomic>
+#include <cstdint>
+#include <future>
+#include <mutex>
+#include <thread>
+
+#include <gtest/gtest.h>
+#include <opencv2/core/core.hpp>
+#include <wpi/timestamp.h>
+
+#include "Instance.h"
+#include "SourceImpl.h"
+#include "cscore.h"
+#include "cscore_cv.h"
+
+namespace cs {
+
+namespace {
+// frame times are taken from this clock
+std::atomic<uint64_t> gNow{0};
+
+// Two sources, each with a sink, standing in for a stereo pair
+struct SyncPair {
+  CvSource source1{"source1", VideoMode::kGray, 4, 4, 30};
+  CvSource source2{"source2", VideoMode::kGray, 4, 4, 30};
+  CvSink sinks[2] = {CvSink{"sink1", VideoMode::kGray},
+                     CvSink{"sink2", VideoMode::kGray}};
+  cv::Mat images[2];
+
+  SyncPair() {
+    sinks[0].SetSource(source1);
+    sinks[1].SetSource(source2);
+  }
+
+  // Puts a frame with the given time, in microseconds
+  static void PutFrame(CvSource& source, uint64_t time) {
+    gNow = time;
+    cv::Mat image{4, 4, CV_8UC1, cv::Scalar(time / 1000 % 256)};
+    source.PutFrame(image);
+  }
+};
+}  // namespace
+
+class CvSinkTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    gNow = 1000000;
+    wpi::SetNowImpl([] { return gNow.load(); });
+  }
+
+  void TearDown() override { wpi::SetNowImpl(nullptr); }
+
+  // Starts GrabFramesSynchronized() on another thread, returning once it is
+  // receiving frames from both sources
+  static std::future<uint64_t> Grab(SyncPair& pair, double tolerance,
+                                    double timeout) {
+    auto rv = std::async(std::launch::async, [&pair, tolerance, timeout] {
+      return CvSink::GrabFramesSynchronized(pair.sinks, pair.images, tolerance,
+                                            timeout);
+    });
+    while (!IsQueued(pair.source1) || !IsQueued(pair.source2)) {
+      std::this_thread::yield();
+    }
+    return rv;
+  }
+
+  static bool IsQueued(const CvSource& source) {
+    auto& impl = *Instance::GetInstance().GetSource(source.GetHandle())->source;
+    std::scoped_lock lock{impl.m_frameMutex};
+    return !impl.m_frameQueues.empty();
+  }
+};
+
+TEST_F(CvSinkTest, SynchronizedMatch) {
+  {
+    SyncPair pair;
+    auto grab = Grab(pair, 0.005, 1.0);
+    // source1's first frame is replaced before source2's arrives, but is
+    // still the one that matches
+    SyncPair::PutFrame(pair.source1, 1000000);
+    SyncPair::PutFrame(pair.source1, 1033000);
+    SyncPair::PutFrame(pair.source2, 1002000);
+    EXPECT_EQ(1000000u, grab.get());
+    EXPECT_EQ(CS_OK, pair.sinks[0].GetLastStatus());
+    ASSERT_EQ(4, pair.images[0].cols);
+    EXPECT_EQ(1000 % 256, pair.images[0].at<uint8_t>(0, 0));
+    EXPECT_EQ(1002 % 256, pair.images[1].at<uint8_t>(0, 0));
+
+    // the next grab starts from each source's current frame, but frames at
+    // or before the last match are not used again
+    grab = Grab(pair, 0.005, 1.0);
+    SyncPair::PutFrame(pair.source2, 1035000);
+    EXPECT_EQ(1033000u, grab.get());
+    EXPECT_EQ(1033 % 256, pair.images[0].at<uint8_t>(0, 0));
+    EXPECT_EQ(1035 % 256, pair.images[1].at<uint8_t>(0, 0));
+  }
+  Shutdown();
+}
+
+TEST_F(CvSinkTest, SynchronizedTolerance) {
+  {
+    SyncPair pair;
+    auto grab = Grab(pair, 0.005, 1.0);
+    // 6 ms apart is outside the tolerance
+    SyncPair::PutFrame(pair.source1, 1000000);
+    SyncPair::PutFrame(pair.source2, 1006000);
+    ASSERT_EQ(std::future_status::timeout,
+              grab.wait_for(std::chrono::milliseconds(50)));
+    // 5 ms is within it
+    SyncPair::PutFrame(pair.source1, 1011000);
+    SyncPair::PutFrame(pair.source2, 1016000);
+    EXPECT_EQ(1011000u, grab.get());
+  }
+  Shutdown();
+}
+
+TEST_F(CvSinkTest, SynchronizedDrop) {
+  {
+    SyncPair pair;
+    auto grab = Grab(pair, 0.005, 1.0);
+    // only the newest 4 frames from a source are kept, so source1's first
+    // frame is dropped before source2's matching frame arrives
+    for (uint64_t time = 1000000; time < 1150000; time += 33000) {
+      SyncPair::PutFrame(pair.source1, time);
+    }
+    SyncPair::PutFrame(pair.source2, 1001000);
+    ASSERT_EQ(std::future_status::timeout,
+              grab.wait_for(std::chrono::milliseconds(50)));
+    // times out once the clock passes the deadline and a frame wakes it
+    SyncPair::PutFrame(pair.source2, 2100000);
+    EXPECT_EQ(0u, grab.get());
+  }
+  Shutdown();
+}
+
+}  // namespace cs
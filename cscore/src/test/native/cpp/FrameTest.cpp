@@ -0,0 +1,359 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "ConfigurableSourceImpl.h"
+#include "Frame.h"
+#include "Instance.h"
+
+namespace cs {
+
+namespace {
+// A source whose frames are put directly by the test.
+class TestSource : public ConfigurableSourceImpl {
+ public:
+  explicit TestSource(const VideoMode& mode)
+      : ConfigurableSourceImpl{"test", Instance::GetInstance().logger,
+                               Instance::GetInstance().notifier,
+                               Instance::GetInstance().telemetry, mode} {}
+
+  void PutTestFrame(std::unique_ptr<Image> image, Frame::Time time,
+                    Frame::Time captureTime, CS_TimestampSource timeSource) {
+    PutFrame(std::move(image), time, captureTime, timeSource);
+  }
+
+  std::unique_ptr<Image> AllocTestImage(VideoMode::PixelFormat pixelFormat,
+                                        int width, int height, size_t size) {
+    return AllocImage(pixelFormat, width, height, size);
+  }
+
+  void SetTestOrigin(int x, int y) { SetCaptureOrigin(x, y); }
+};
+
+uint8_t At(Image* image, int x, int y, int channel = 0) {
+  int channels = image->pixelFormat == VideoMode::kBGR ? 3 : 1;
+  return reinterpret_cast<uint8_t*>(
+      image->data())[y * image->GetStride() + x * channels + channel];
+}
+}  // namespace
+
+class FrameTest : public ::testing::Test {
+ protected:
+  std::shared_ptr<TestSource> source = std::make_shared<TestSource>(
+      VideoMode{VideoMode::kGray, 4, 4, 30});
+
+  void PutGrayFrame(Frame::Time time, Frame::Time captureTime,
+                    CS_TimestampSource timeSource) {
+    source->PutTestFrame(source->AllocTestImage(VideoMode::kGray, 4, 4, 16),
+                         time, captureTime, timeSource);
+  }
+
+  Frame PutImage(VideoMode::PixelFormat pixelFormat, int width, int height,
+                 const std::vector<uint8_t>& data) {
+    auto image =
+        source->AllocTestImage(pixelFormat, width, height, data.size());
+    std::copy(data.begin(), data.end(),
+              reinterpret_cast<uint8_t*>(image->data()));
+    source->PutTestFrame(std::move(image), 1000, 1000, CS_TIMESRC_UNKNOWN);
+    return source->GetCurFrame();
+  }
+
+  // A gray frame whose pixel values are x + y * width
+  Frame PutGradient(int width, int height) {
+    std::vector<uint8_t> data(width * height);
+    for (size_t i = 0; i < data.size(); ++i) {
+      data[i] = i;
+    }
+    return PutImage(VideoMode::kGray, width, height, data);
+  }
+
+  // An MJPEG frame of a gradient
+  Frame PutJpeg(int width, int height) {
+    Frame gradient = PutGradient(width, height);
+    Image* jpeg = gradient.GetImageMJPEG(width, height, 90);
+    if (!jpeg) {
+      return {};
+    }
+    std::vector<uint8_t> data(
+        reinterpret_cast<const uint8_t*>(jpeg->data()),
+        reinterpret_cast<const uint8_t*>(jpeg->data()) + jpeg->size());
+    return PutImage(VideoMode::kMJPEG, width, height, data);
+  }
+
+  // Holding the frame's image list stalls a conversion after it has claimed
+  // its request.
+  static std::unique_lock<wpi::recursive_mutex> LockImages(Frame& frame) {
+    return std::unique_lock{frame.m_impl->mutex};
+  }
+
+  static bool IsConverting(Frame& frame) {
+    std::scoped_lock lock(frame.m_impl->convertMutex);
+    return std::any_of(
+        frame.m_impl->conversions.begin(), frame.m_impl->conversions.end(),
+        [](const auto& conversion) { return !conversion.second.done; });
+  }
+};
+
+TEST_F(FrameTest, CaptureTime) {
+  PutGrayFrame(1000, 400, CS_TIMESRC_V4L_SOE);
+  Frame frame = source->GetCurFrame();
+  EXPECT_EQ(1000u, frame.GetTime());
+  EXPECT_EQ(400u, frame.GetCaptureTime());
+  EXPECT_EQ(CS_TIMESRC_V4L_SOE, frame.GetTimeSource());
+}
+
+TEST_F(FrameTest, CaptureTimeDefaultsToReceiveTime) {
+  PutGrayFrame(2000, 0, CS_TIMESRC_FRAME_DEQUEUE);
+  Frame frame = source->GetCurFrame();
+  EXPECT_EQ(2000u, frame.GetCaptureTime());
+  EXPECT_EQ(CS_TIMESRC_FRAME_DEQUEUE, frame.GetTimeSource());
+}
+
+TEST_F(FrameTest, EmptyFrameHasNoCaptureTime) {
+  Frame frame;
+  EXPECT_EQ(0u, frame.GetCaptureTime());
+  EXPECT_EQ(CS_TIMESRC_UNKNOWN, frame.GetTimeSource());
+}
+
+TEST_F(FrameTest, ConversionWaitsForOtherThread) {
+  Frame frame = PutGradient(8, 8);
+  Image* first = nullptr;
+  Image* second = nullptr;
+  std::atomic_bool secondDone{false};
+  std::thread converter;
+  std::thread waiter;
+  {
+    auto lock = LockImages(frame);
+    converter = std::thread{
+        [&] { first = frame.GetImage(4, 4, VideoMode::kGray); }};
+    while (!IsConverting(frame)) {
+      std::this_thread::yield();
+    }
+    waiter = std::thread{[&] {
+      second = frame.GetImage(4, 4, VideoMode::kGray);
+      secondDone = true;
+    }};
+    // the second request waits for the first rather than converting again
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_FALSE(secondDone);
+  }
+  converter.join();
+  waiter.join();
+  ASSERT_NE(nullptr, first);
+  EXPECT_EQ(first, second);
+  EXPECT_EQ(4, first->width);
+}
+
+// Each decode below uses a new frame, as a frame resizes existing images of
+// the requested format in preference to decoding again.
+TEST_F(FrameTest, JpegScaledDecode) {
+  // a quarter size target is decoded directly at 1/4 scale
+  Frame frame = PutJpeg(64, 64);
+  ASSERT_TRUE(frame);
+  Image* image = frame.GetImage(16, 16, VideoMode::kGray);
+  ASSERT_NE(nullptr, image);
+  EXPECT_EQ(16, image->width);
+  EXPECT_EQ(16, image->height);
+  EXPECT_EQ(nullptr, frame.GetExistingImage(64, 64, VideoMode::kGray));
+  EXPECT_EQ(nullptr, frame.GetExistingImage(32, 32, VideoMode::kGray));
+
+  // a smaller target is decoded at 1/8 scale, never below the target size
+  frame = PutJpeg(64, 64);
+  ASSERT_TRUE(frame);
+  image = frame.GetImage(8, 8, VideoMode::kBGR);
+  ASSERT_NE(nullptr, image);
+  EXPECT_EQ(8, image->width);
+  EXPECT_EQ(nullptr, frame.GetExistingImage(16, 16, VideoMode::kBGR));
+
+  // targets between scales are decoded at the next larger scale and resized
+  frame = PutJpeg(64, 64);
+  ASSERT_TRUE(frame);
+  image = frame.GetImage(20, 20, VideoMode::kBGR);
+  ASSERT_NE(nullptr, image);
+  EXPECT_EQ(20, image->width);
+  EXPECT_EQ(20, image->height);
+  EXPECT_NE(nullptr, frame.GetExistingImage(32, 32, VideoMode::kBGR));
+  EXPECT_EQ(nullptr, frame.GetExistingImage(64, 64, VideoMode::kBGR));
+}
+
+TEST_F(FrameTest, JpegFullDecode) {
+  // an odd target just under full size needs a full decode
+  Frame frame = PutJpeg(64, 64);
+  ASSERT_TRUE(frame);
+  Image* image = frame.GetImage(63, 63, VideoMode::kGray);
+  ASSERT_NE(nullptr, image);
+  EXPECT_EQ(63, image->width);
+  EXPECT_EQ(63, image->height);
+  EXPECT_NE(nullptr, frame.GetExistingImage(64, 64, VideoMode::kGray));
+
+  // as does a target wider than half size in only one dimension
+  frame = PutJpeg(64, 64);
+  ASSERT_TRUE(frame);
+  image = frame.GetImage(40, 16, VideoMode::kBGR);
+  ASSERT_NE(nullptr, image);
+  EXPECT_EQ(40, image->width);
+  EXPECT_EQ(16, image->height);
+  EXPECT_NE(nullptr, frame.GetExistingImage(64, 64, VideoMode::kBGR));
+}
+
+TEST_F(FrameTest, JpegScaledDecodeRoundsUp) {
+  // the decoder rounds scaled sizes up, so a 66 pixel image is 17 pixels at
+  // 1/4 scale
+  Frame frame = PutJpeg(66, 66);
+  ASSERT_TRUE(frame);
+  Image* image = frame.GetImage(17, 17, VideoMode::kGray);
+  ASSERT_NE(nullptr, image);
+  EXPECT_EQ(17, image->width);
+  EXPECT_EQ(17, image->height);
+  EXPECT_EQ(nullptr, frame.GetExistingImage(66, 66, VideoMode::kGray));
+  EXPECT_EQ(nullptr, frame.GetExistingImage(33, 33, VideoMode::kGray));
+
+  // one more pixel needs the next larger scale
+  frame = PutJpeg(66, 66);
+  ASSERT_TRUE(frame);
+  image = frame.GetImage(18, 18, VideoMode::kGray);
+  ASSERT_NE(nullptr, image);
+  EXPECT_EQ(18, image->width);
+  EXPECT_NE(nullptr, frame.GetExistingImage(33, 33, VideoMode::kGray));
+  EXPECT_EQ(nullptr, frame.GetExistingImage(66, 66, VideoMode::kGray));
+}
+
+TEST_F(FrameTest, RegionClipsToOrigin) {
+  // the camera cropped to the frame rectangle starting at (2, 2)
+  source->SetTestOrigin(2, 2);
+  Frame frame = PutGradient(8, 8);
+
+  // only the part overlapping the frame is returned
+  Image* image = frame.GetImage({0, 0, 4, 4}, VideoMode::kGray);
+  ASSERT_NE(nullptr, image);
+  EXPECT_EQ(2, image->width);
+  EXPECT_EQ(2, image->height);
+  EXPECT_EQ(0, At(image, 0, 0));
+  EXPECT_EQ(9, At(image, 1, 1));
+
+  // zero size extends to the frame edges
+  image = frame.GetImage({4, 3, 0, 0}, VideoMode::kGray);
+  ASSERT_NE(nullptr, image);
+  EXPECT_EQ(6, image->width);
+  EXPECT_EQ(7, image->height);
+  EXPECT_EQ(2 + 1 * 8, At(image, 0, 0));
+
+  // entirely outside the frame
+  EXPECT_EQ(nullptr, frame.GetImage({0, 0, 2, 2}, VideoMode::kGray));
+}
+
+TEST_F(FrameTest, RegionDecimation) {
+  Frame frame = PutGradient(8, 8);
+
+  // the size is rounded down to a multiple of the decimation
+  Image* image = frame.GetImage({1, 0, 5, 4, 2}, VideoMode::kGray);
+  ASSERT_NE(nullptr, image);
+  EXPECT_EQ(2, image->width);
+  EXPECT_EQ(2, image->height);
+  // rounded average of 1, 2, 9, 10
+  EXPECT_EQ(6, At(image, 0, 0));
+}
+
+TEST_F(FrameTest, RegionUnsupportedFormat) {
+  Frame frame = PutGradient(8, 8);
+  EXPECT_EQ(nullptr, frame.GetImage({0, 0, 4, 4}, VideoMode::kMJPEG));
+  EXPECT_EQ(nullptr, frame.GetImage({0, 0, 4, 4}, VideoMode::kYUYV));
+  EXPECT_EQ(nullptr, frame.GetImage({0, 0, 4, 4}, VideoMode::kUYVY));
+}
+
+TEST_F(FrameTest, RegionCache) {
+  Frame frame = PutGradient(8, 8);
+  Image* image = frame.GetImage({2, 2, 4, 4}, VideoMode::kGray);
+  ASSERT_NE(nullptr, image);
+  EXPECT_EQ(image, frame.GetImage({2, 2, 4, 4}, VideoMode::kGray));
+  // keyed on the region after clipping
+  Frame clipped = PutGradient(6, 6);
+  Image* edge = clipped.GetImage({2, 2, 4, 4}, VideoMode::kGray);
+  EXPECT_EQ(edge, clipped.GetImage({2, 2, 10, 10}, VideoMode::kGray));
+
+  Image* bgr = frame.GetImage({2, 2, 4, 4}, VideoMode::kBGR);
+  ASSERT_NE(nullptr, bgr);
+  EXPECT_NE(image, bgr);
+  EXPECT_EQ(VideoMode::kBGR, bgr->pixelFormat);
+  EXPECT_NE(image, frame.GetImage({2, 2, 4, 2}, VideoMode::kGray));
+  EXPECT_NE(image, frame.GetImage({2, 2, 4, 4, 2}, VideoMode::kGray));
+
+  // a cropped image must not be mistaken for a resized full frame
+  EXPECT_EQ(nullptr, frame.GetExistingImage(4, 4));
+}
+
+TEST_F(FrameTest, RegionYUYV) {
+  // 8x2 YUYV with a distinct chroma per pixel pair, so a misaligned pair
+  // changes the color
+  std::vector<uint8_t> data;
+  for (int y = 0; y < 2; ++y) {
+    for (int pair = 0; pair < 4; ++pair) {
+      uint8_t u = 40 + pair * 50;
+      uint8_t v = 200 - pair * 50;
+      data.insert(data.end(), {static_cast<uint8_t>(20 + y * 100 + pair * 20),
+                               u,
+                               static_cast<uint8_t>(30 + y * 100 + pair * 20),
+                               v});
+    }
+  }
+  Frame frame = PutImage(VideoMode::kYUYV, 8, 2, data);
+
+  // an odd left edge starts in the middle of a pair
+  Image* bgr = frame.GetImage({1, 0, 4, 2}, VideoMode::kBGR);
+  ASSERT_NE(nullptr, bgr);
+  EXPECT_EQ(4, bgr->width);
+  EXPECT_EQ(2, bgr->height);
+  Image* full = frame.GetImage(8, 2, VideoMode::kBGR);
+  ASSERT_NE(nullptr, full);
+  for (int y = 0; y < 2; ++y) {
+    for (int x = 0; x < 4; ++x) {
+      for (int c = 0; c < 3; ++c) {
+        EXPECT_EQ(At(full, x + 1, y, c), At(bgr, x, y, c))
+            << x << "," << y << "," << c;
+      }
+    }
+  }
+
+  // gray is sampled directly from the luma
+  Image* gray = frame.GetImage({1, 1, 3, 1}, VideoMode::kGray);
+  ASSERT_NE(nullptr, gray);
+  EXPECT_EQ(3, gray->width);
+  EXPECT_EQ(130, At(gray, 0, 0));
+  EXPECT_EQ(140, At(gray, 1, 0));
+  EXPECT_EQ(150, At(gray, 2, 0));
+}
+
+TEST_F(FrameTest, RegionMJPEGScale) {
+  Frame frame = PutJpeg(64, 64);
+  ASSERT_TRUE(frame);
+
+  // decimation by 4 is done by the decoder
+  Image* image = frame.GetImage({0, 0, 0, 0, 4}, VideoMode::kGray);
+  ASSERT_NE(nullptr, image);
+  EXPECT_EQ(16, image->width);
+  EXPECT_EQ(16, image->height);
+  EXPECT_NE(nullptr, frame.GetExistingImage(16, 16, VideoMode::kGray));
+  EXPECT_EQ(nullptr, frame.GetExistingImage(64, 64, VideoMode::kGray));
+
+  // an edge at 2 limits the decoder to half size
+  image = frame.GetImage({2, 2, 32, 32, 4}, VideoMode::kBGR);
+  ASSERT_NE(nullptr, image);
+  EXPECT_EQ(8, image->width);
+  EXPECT_EQ(8, image->height);
+  EXPECT_NE(nullptr, frame.GetExistingImage(32, 32, VideoMode::kBGR));
+  EXPECT_EQ(nullptr, frame.GetExistingImage(64, 64, VideoMode::kBGR));
+}
+
+}  // namespace cs
@@ -0,0 +1,204 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <wpi/Logger.h>
+#include <wpi/SmallString.h>
+#include <wpi/StringExtras.h>
+#include <wpi/condition_variable.h>
+#include <wpi/mutex.h>
+#include <wpinet/NetworkStream.h>
+#include <wpinet/TCPAcceptor.h>
+#include <wpinet/raw_socket_istream.h>
+
+#include "HttpCameraImpl.h"
+#include "Instance.h"
+
+namespace cs {
+
+namespace {
+// A settings request received by FakeCamera
+struct SettingsRequest {
+  int connection;
+  std::string path;
+};
+
+// A camera on localhost that accepts a stream (which never sends a frame)
+// and records settings requests, which are any requests with parameters
+class FakeCamera {
+ public:
+  explicit FakeCamera(int port) : m_acceptor{port, "127.0.0.1", m_logger} {
+    m_acceptor.start();
+    m_thread = std::thread([this] {
+      while (auto stream = m_acceptor.accept()) {
+        std::scoped_lock lock(m_mutex);
+        m_connThreads.emplace_back(&FakeCamera::ConnectionMain, this,
+                                   std::move(stream), m_numConnections++);
+      }
+    });
+  }
+
+  ~FakeCamera() {
+    m_acceptor.shutdown();
+    m_thread.join();
+    for (auto&& thr : m_connThreads) {
+      thr.join();
+    }
+  }
+
+  // Waits for the given number of settings requests, returning all of them
+  std::vector<SettingsRequest> WaitForSettings(size_t count) {
+    std::unique_lock lock(m_mutex);
+    m_cond.wait_for(lock, std::chrono::seconds(3),
+                    [&] { return m_settings.size() >= count; });
+    return m_settings;
+  }
+
+  // If set, settings connections are closed after each response
+  std::atomic_bool closeSettings{false};
+
+ private:
+  void ConnectionMain(std::unique_ptr<wpi::NetworkStream> stream,
+                      int connection) {
+    wpi::raw_socket_istream is{*stream};
+    wpi::NetworkStream::Error err;
+    for (;;) {
+      wpi::SmallString<128> lineBuf;
+      auto [method, rest] = wpi::split(is.getline(lineBuf, 1024), ' ');
+      auto path = wpi::split(rest, ' ').first;
+      std::string pathStr{path};
+      // skip the headers
+      for (;;) {
+        wpi::SmallString<128> headerBuf;
+        if (is.has_error() ||
+            wpi::rtrim(is.getline(headerBuf, 1024)).empty()) {
+          break;
+        }
+      }
+      if (is.has_error()) {
+        return;
+      }
+
+      if (pathStr.find('?') == std::string::npos) {
+        // stream; hold the connection until the camera closes it
+        std::string_view response =
+            "HTTP/1.0 200 OK\r\n"
+            "Content-Type: multipart/x-mixed-replace;boundary=frame\r\n\r\n";
+        stream->send(response.data(), response.size(), &err);
+        char c;
+        while (!is.has_error()) {
+          is.read(&c, 1);
+        }
+        return;
+      }
+
+      {
+        std::scoped_lock lock(m_mutex);
+        m_settings.emplace_back(SettingsRequest{connection, pathStr});
+      }
+      m_cond.notify_all();
+      std::string_view response =
+          "HTTP/1.1 200 OK\r\nContent-Length: 2\r\n\r\nOK";
+      stream->send(response.data(), response.size(), &err);
+      if (closeSettings) {
+        stream->close();
+        return;
+      }
+    }
+  }
+
+  wpi::Logger m_logger;
+  wpi::TCPAcceptor m_acceptor;
+  std::thread m_thread;
+  wpi::mutex m_mutex;
+  wpi::condition_variable m_cond;
+  std::vector<std::thread> m_connThreads;
+  int m_numConnections = 0;
+  std::vector<SettingsRequest> m_settings;
+};
+
+std::shared_ptr<HttpCameraImpl> MakeCamera(
+    std::span<const std::string> urls) {
+  auto& inst = Instance::GetInstance();
+  auto camera = std::make_shared<HttpCameraImpl>(
+      "http", CS_HTTP_UNKNOWN, inst.logger, inst.notifier, inst.telemetry);
+  CS_Status status = 0;
+  camera->SetUrls(urls, &status);
+  camera->Start();
+  camera->EnableSink();
+  return camera;
+}
+}  // namespace
+
+class HttpCameraTest : public ::testing::Test {
+ protected:
+  // Queues a setting for the settings thread to send
+  static void PutSetting(HttpCameraImpl& camera, std::string_view name,
+                         std::string_view value) {
+    std::scoped_lock lock(camera.m_mutex);
+    camera.m_settings[name] = value;
+    camera.m_settingsCond.notify_one();
+  }
+};
+
+TEST_F(HttpCameraTest, SettingsKeepAlive) {
+  FakeCamera server{11840};
+  {
+    // nothing listens on the first URL, so the stream, and then the
+    // settings, go to the second
+    std::string urls[] = {"http://127.0.0.1:11841/stream.mjpg",
+                          "http://127.0.0.1:11840/stream.mjpg"};
+    auto camera = MakeCamera(urls);
+    PutSetting(*camera, "brightness", "50");
+    auto settings = server.WaitForSettings(1);
+    ASSERT_EQ(1u, settings.size());
+    EXPECT_EQ("/stream.mjpg?brightness=50", settings[0].path);
+
+    // the next request reuses the connection
+    PutSetting(*camera, "brightness", "60");
+    settings = server.WaitForSettings(2);
+    ASSERT_EQ(2u, settings.size());
+    EXPECT_EQ("/stream.mjpg?brightness=60", settings[1].path);
+    EXPECT_EQ(settings[0].connection, settings[1].connection);
+
+    // each setting is sent only once
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    EXPECT_EQ(2u, server.WaitForSettings(0).size());
+  }
+}
+
+TEST_F(HttpCameraTest, SettingsReconnect) {
+  FakeCamera server{11842};
+  server.closeSettings = true;
+  {
+    std::string urls[] = {"http://127.0.0.1:11842/stream.mjpg"};
+    auto camera = MakeCamera(urls);
+    PutSetting(*camera, "brightness", "50");
+    ASSERT_EQ(1u, server.WaitForSettings(1).size());
+
+    // the server closed the kept-alive connection, so the request is
+    // retried on a new one
+    PutSetting(*camera, "brightness", "60");
+    auto settings = server.WaitForSettings(2);
+    ASSERT_EQ(2u, settings.size());
+    EXPECT_EQ("/stream.mjpg?brightness=60", settings[1].path);
+    EXPECT_NE(settings[0].connection, settings[1].connection);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    EXPECT_EQ(2u, server.WaitForSettings(0).size());
+  }
+}
+
+}  // namespace cs
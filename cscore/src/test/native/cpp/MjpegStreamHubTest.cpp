@@ -0,0 +1,357 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <fmt/format.h>
+#include <gtest/gtest.h>
+#include <opencv2/core/core.hpp>
+#include <wpi/StringExtras.h>
+#include <wpinet/EventLoopRunner.h>
+#include <wpinet/NetworkStream.h>
+#include <wpinet/TCPAcceptor.h>
+#include <wpinet/TCPConnector.h>
+
+#include "CvSinkImpl.h"
+#include "Instance.h"
+#include "MjpegServerImpl.h"
+#include "MjpegStreamHub.h"
+#include "cscore.h"
+#include "cscore_cv.h"
+
+namespace cs {
+
+namespace {
+// A client of an MJPEG server on localhost
+class StreamClient {
+ public:
+  StreamClient(int port, std::string_view params) {
+    // the server starts listening asynchronously
+    wpi::Logger logger;
+    for (int i = 0; i < 50 && !m_stream; ++i) {
+      m_stream = wpi::TCPConnector::connect("127.0.0.1", port, logger, 1);
+      if (!m_stream) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+      }
+    }
+    if (!m_stream) {
+      return;
+    }
+    auto request = fmt::format("GET /stream.mjpg{} HTTP/1.0\r\n\r\n", params);
+    wpi::NetworkStream::Error err;
+    m_stream->send(request.data(), request.size(), &err);
+  }
+
+  // Returns the HTTP status code, or 0 on error
+  int ReadStatus() {
+    auto header = ReadUntil("\r\n\r\n");
+    if (!header) {
+      return 0;
+    }
+    auto [version, rest] = wpi::split(*header, ' ');
+    return wpi::parse_integer<int>(wpi::split(rest, ' ').first, 10)
+        .value_or(0);
+  }
+
+  // Reads the next frame, returning its time in seconds, or a negative
+  // value on error
+  double ReadFrame() {
+    if (!ReadUntil("Content-Length: ")) {
+      return -1;
+    }
+    auto length = ReadUntil("\r\n");
+    if (!ReadUntil("X-Timestamp: ")) {
+      return -1;
+    }
+    auto time = ReadUntil("\r\n\r\n");
+    if (!length || !time) {
+      return -1;
+    }
+    auto size = wpi::parse_integer<size_t>(*length, 10);
+    auto seconds = wpi::parse_float<double>(*time);
+    if (!size || !seconds) {
+      return -1;
+    }
+    while (m_buf.size() < *size) {
+      if (!Fill()) {
+        return -1;
+      }
+    }
+    m_buf.erase(0, *size);
+    return *seconds;
+  }
+
+  void Close() { m_stream.reset(); }
+
+ private:
+  bool Fill() {
+    if (!m_stream) {
+      return false;
+    }
+    char buf[65536];
+    wpi::NetworkStream::Error err;
+    size_t count = m_stream->receive(buf, sizeof(buf), &err, 5);
+    if (count == 0) {
+      return false;
+    }
+    m_buf.append(buf, count);
+    return true;
+  }
+
+  // Consumes data through the next delim, returning the data before it
+  std::optional<std::string> ReadUntil(std::string_view delim) {
+    size_t pos;
+    while ((pos = m_buf.find(delim)) == std::string::npos) {
+      if (!Fill()) {
+        return std::nullopt;
+      }
+    }
+    std::string rv = m_buf.substr(0, pos);
+    m_buf.erase(0, pos + delim.size());
+    return rv;
+  }
+
+  std::unique_ptr<wpi::NetworkStream> m_stream;
+  std::string m_buf;
+};
+
+// A source producing noisy (so poorly compressible) frames at about 30 fps
+class NoiseSource {
+ public:
+  NoiseSource(int width, int height)
+      : source{"source", VideoMode::kBGR, width, height, 30},
+        m_image{height, width, CV_8UC3} {
+    uint32_t state = 1;
+    for (int y = 0; y < height; ++y) {
+      auto row = m_image.ptr(y);
+      for (int x = 0; x < width * 3; ++x) {
+        state = state * 1664525 + 1013904223;
+        row[x] = state >> 24;
+      }
+    }
+    m_thread = std::thread([this] {
+      while (m_active) {
+        source.PutFrame(m_image);
+        std::this_thread::sleep_for(std::chrono::milliseconds(33));
+      }
+    });
+  }
+
+  ~NoiseSource() {
+    m_active = false;
+    m_thread.join();
+  }
+
+  CvSource source;
+
+ private:
+  cv::Mat m_image;
+  std::atomic_bool m_active{true};
+  std::thread m_thread;
+};
+
+// An MJPEG server streaming from its own event loop, which (unlike the
+// instance's) is not stopped by Shutdown()
+struct HubServer {
+  HubServer(int port, int width, int height)
+      : port{port}, noise{width, height} {
+    auto& inst = Instance::GetInstance();
+    server = std::make_shared<MjpegServerImpl>(
+        "server", inst.logger, inst.notifier, inst.telemetry, "", port,
+        std::make_unique<wpi::TCPAcceptor>(port, "", inst.logger), eventLoop);
+    CS_Status status = 0;
+    server->SetProperty(server->GetPropertyIndex("event_loop"), 1, &status);
+    server->SetSource(inst.GetSource(noise.source.GetHandle())->source);
+  }
+
+  ~HubServer() { server->Stop(); }
+
+  int port;
+  wpi::EventLoopRunner eventLoop;
+  NoiseSource noise;
+  std::shared_ptr<MjpegServerImpl> server;
+};
+}  // namespace
+
+class MjpegStreamHubTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    if (!MjpegStreamHub::IsSupported()) {
+      GTEST_SKIP() << "event loop streaming not supported";
+    }
+  }
+
+  std::shared_ptr<MjpegStreamHub> MakeHub() {
+    auto& inst = Instance::GetInstance();
+    return std::make_shared<MjpegStreamHub>("hub", inst.logger, inst.eventLoop,
+                                            m_sink);
+  }
+
+  // Acquires settings as adding a client does
+  static MjpegStreamHub::Settings Acquire(MjpegStreamHub& hub,
+                                          MjpegStreamHub::Settings settings) {
+    std::scoped_lock lock(hub.m_mutex);
+    ++hub.m_numClients;
+    return hub.AcquireSettings(settings);
+  }
+
+  static void Release(MjpegStreamHub& hub,
+                      const MjpegStreamHub::Settings& settings) {
+    hub.ReleaseSettings(settings);
+  }
+
+  static size_t NumEncodings(MjpegStreamHub& hub) {
+    std::scoped_lock lock(hub.m_mutex);
+    return hub.m_settings.size();
+  }
+
+ private:
+  CvSinkImpl m_sink{"sink", Instance::GetInstance().logger,
+                    Instance::GetInstance().notifier,
+                    Instance::GetInstance().telemetry, VideoMode::kBGR};
+};
+
+TEST_F(MjpegStreamHubTest, SettingsShared) {
+  auto hub = MakeHub();
+  // qualities are rounded, and the frame rate is paced per client rather
+  // than encoded separately
+  auto settings = Acquire(*hub, {320, 240, 47, 80, 10});
+  EXPECT_EQ(50, settings.compression);
+  EXPECT_EQ(0, settings.fps);
+  EXPECT_EQ(settings, Acquire(*hub, {320, 240, 53, 80, 30}));
+  EXPECT_EQ(1u, NumEncodings(*hub));
+  EXPECT_EQ(10, Acquire(*hub, {320, 240, 2, 78, 0}).compression);
+  EXPECT_EQ(2u, NumEncodings(*hub));
+
+  // an encoding is kept until its last client is released
+  Release(*hub, settings);
+  EXPECT_EQ(2u, NumEncodings(*hub));
+  Release(*hub, settings);
+  EXPECT_EQ(1u, NumEncodings(*hub));
+  EXPECT_EQ(1u, hub->GetNumClients());
+}
+
+TEST_F(MjpegStreamHubTest, SettingsLimit) {
+  auto hub = MakeHub();
+  for (int i = 1; i <= static_cast<int>(MjpegStreamHub::kMaxEncodings); ++i) {
+    Acquire(*hub, {160 * i, 120 * i, 80, 80, 0});
+  }
+  EXPECT_EQ(MjpegStreamHub::kMaxEncodings, NumEncodings(*hub));
+
+  // beyond the limit, the closest resolution is shared
+  auto settings = Acquire(*hub, {300, 220, 30, 80, 0});
+  EXPECT_EQ(MjpegStreamHub::kMaxEncodings, NumEncodings(*hub));
+  EXPECT_EQ(320, settings.width);
+  EXPECT_EQ(240, settings.height);
+  EXPECT_EQ(80, settings.compression);
+
+  // once one is released, new settings get their own encoding
+  Release(*hub, {160, 120, 80, 80, 0});
+  Acquire(*hub, {300, 220, 30, 80, 0});
+  EXPECT_EQ(MjpegStreamHub::kMaxEncodings, NumEncodings(*hub));
+  EXPECT_EQ(MjpegStreamHub::kMaxEncodings + 1, hub->GetNumClients());
+}
+
+TEST_F(MjpegStreamHubTest, FpsPacing) {
+  {
+    HubServer server{11811, 64, 48};
+    StreamClient paced{server.port, "?fps=5"};
+    StreamClient unpaced{server.port, ""};
+    ASSERT_EQ(200, paced.ReadStatus());
+    ASSERT_EQ(200, unpaced.ReadStatus());
+
+    // count the frames sent during two seconds of stream time
+    auto count = [](StreamClient& client) {
+      int frames = 0;
+      double start = client.ReadFrame();
+      for (double time = start; time >= 0 && time < start + 2.0;
+           time = client.ReadFrame()) {
+        ++frames;
+      }
+      return frames;
+    };
+    int pacedFrames = count(paced);
+    int unpacedFrames = count(unpaced);
+    EXPECT_GE(pacedFrames, 6);
+    EXPECT_LE(pacedFrames, 14);
+    EXPECT_GT(unpacedFrames, 2 * pacedFrames);
+  }
+  Shutdown();
+}
+
+TEST_F(MjpegStreamHubTest, SlowClientSkipsFrames) {
+  {
+    HubServer server{11812, 640, 480};
+    StreamClient slow{server.port, ""};
+    StreamClient fast{server.port, ""};
+    ASSERT_EQ(200, slow.ReadStatus());
+    ASSERT_EQ(200, fast.ReadStatus());
+    ASSERT_GT(slow.ReadFrame(), 0);
+
+    // the fast client keeps receiving frames while the slow one reads none
+    int frames = 0;
+    double start = fast.ReadFrame();
+    for (double time = start; time >= 0 && time < start + 2.0;
+         time = fast.ReadFrame()) {
+      ++frames;
+    }
+    EXPECT_GE(frames, 15);
+
+    // once the slow client's connection backed up, it skipped frames rather
+    // than queueing them; after the buffered frames, there is a gap
+    double maxGap = 0;
+    double last = slow.ReadFrame();
+    for (int i = 0; i < 60 && last >= 0 && maxGap < 0.5; ++i) {
+      double time = slow.ReadFrame();
+      if (time < 0) {
+        break;
+      }
+      maxGap = std::max(maxGap, time - last);
+      last = time;
+    }
+    EXPECT_GE(maxGap, 0.5);
+  }
+  Shutdown();
+}
+
+TEST_F(MjpegStreamHubTest, ClientLimit) {
+  {
+    HubServer server{11813, 64, 48};
+    std::vector<std::unique_ptr<StreamClient>> clients;
+    for (int i = 0; i < 10; ++i) {
+      auto& client = clients.emplace_back(
+          std::make_unique<StreamClient>(server.port, ""));
+      ASSERT_EQ(200, client->ReadStatus());
+      // streaming from the event loop once frames arrive
+      ASSERT_GT(client->ReadFrame(), 0);
+    }
+
+    // event loop clients count against the server's limit
+    StreamClient rejected{server.port, ""};
+    EXPECT_EQ(503, rejected.ReadStatus());
+
+    // and free their slot when they disconnect
+    clients.back()->Close();
+    int status = 0;
+    for (int i = 0; i < 50 && status != 200; ++i) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+      StreamClient client{server.port, ""};
+      status = client.ReadStatus();
+    }
+    EXPECT_EQ(200, status);
+  }
+  Shutdown();
+}
+
+}  // namespace cs
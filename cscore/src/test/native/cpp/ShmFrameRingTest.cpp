@@ -0,0 +1,218 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include "ShmFrameRing.h"  // NOLINT(build/include_order)
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <string>
+#include <thread>
+
+#include <fmt/format.h>
+#include <gtest/gtest.h>
+#include <wpi/RawFrame.h>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace cs {
+
+#ifdef __linux__
+
+class ShmFrameRingTest : public ::testing::Test {
+ protected:
+  std::string name = fmt::format("cscore_test_{}", getpid());
+
+  bool Write(ShmFrameRing& ring, char value) {
+    char data[16];
+    std::fill(std::begin(data), std::end(data), value);
+    return ring.Write({.time = 1, .pixelFormat = WPI_PIXFMT_GRAY, .width = 4,
+                       .height = 4, .size = sizeof(data)},
+                      data);
+  }
+
+  // returns the first byte of the frame, or 0 on timeout
+  char Read(ShmFrameRing& ring, uint32_t* sequence, int* slot) {
+    ShmFrameRing::FrameInfo info;
+    *slot = ring.Acquire(sequence, 0.01, &info);
+    if (*slot < 0) {
+      return 0;
+    }
+    EXPECT_EQ(16u, info.size);
+    EXPECT_EQ(4, info.width);
+    return *static_cast<char*>(ring.GetSlotData(*slot));
+  }
+};
+
+TEST_F(ShmFrameRingTest, WriteRead) {
+  std::string error;
+  auto writer = ShmFrameRing::Create(name, 3, 16, 30, &error);
+  ASSERT_TRUE(writer) << error;
+  auto reader = ShmFrameRing::Open(name, &error);
+  ASSERT_TRUE(reader) << error;
+  EXPECT_EQ(3, reader->GetNumSlots());
+  EXPECT_EQ(16u, reader->GetSlotSize());
+  EXPECT_EQ(30, reader->GetFps());
+
+  uint32_t sequence = 0;
+  int slot;
+  EXPECT_EQ(0, Read(*reader, &sequence, &slot));
+
+  ASSERT_TRUE(Write(*writer, 'a'));
+  EXPECT_EQ('a', Read(*reader, &sequence, &slot));
+  reader->Release(slot);
+  // the same frame is not returned twice
+  EXPECT_EQ(0, Read(*reader, &sequence, &slot));
+
+  // only the newest frame is returned
+  ASSERT_TRUE(Write(*writer, 'b'));
+  ASSERT_TRUE(Write(*writer, 'c'));
+  EXPECT_EQ('c', Read(*reader, &sequence, &slot));
+  reader->Release(slot);
+
+  EXPECT_FALSE(writer->Write({.size = 17}, "too big"));
+}
+
+TEST_F(ShmFrameRingTest, PinnedSlotsAreKept) {
+  std::string error;
+  auto writer = ShmFrameRing::Create(name, 2, 16, 30, &error);
+  ASSERT_TRUE(writer) << error;
+  auto reader = ShmFrameRing::Open(name, &error);
+  ASSERT_TRUE(reader) << error;
+
+  uint32_t sequence = 0;
+  int slot;
+  ASSERT_TRUE(Write(*writer, 'a'));
+  ASSERT_EQ('a', Read(*reader, &sequence, &slot));
+
+  // one slot is pinned and the other holds the newest frame
+  ASSERT_TRUE(Write(*writer, 'b'));
+  EXPECT_FALSE(Write(*writer, 'c'));
+  EXPECT_EQ('a', *static_cast<char*>(reader->GetSlotData(slot)));
+
+  reader->Release(slot);
+  EXPECT_TRUE(Write(*writer, 'c'));
+  EXPECT_EQ('c', Read(*reader, &sequence, &slot));
+  reader->Release(slot);
+}
+
+TEST_F(ShmFrameRingTest, WakesWaitingReader) {
+  std::string error;
+  auto writer = ShmFrameRing::Create(name, 3, 16, 30, &error);
+  ASSERT_TRUE(writer) << error;
+  auto reader = ShmFrameRing::Open(name, &error);
+  ASSERT_TRUE(reader) << error;
+
+  std::thread thr{[&] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    Write(*writer, 'a');
+  }};
+  uint32_t sequence = 0;
+  ShmFrameRing::FrameInfo info;
+  int slot = reader->Acquire(&sequence, 5.0, &info);
+  thr.join();
+  ASSERT_GE(slot, 0);
+  EXPECT_EQ('a', *static_cast<char*>(reader->GetSlotData(slot)));
+  reader->Release(slot);
+}
+
+TEST_F(ShmFrameRingTest, StaleAfterWriterCloses) {
+  std::string error;
+  auto writer = ShmFrameRing::Create(name, 3, 16, 30, &error);
+  ASSERT_TRUE(writer) << error;
+  auto reader = ShmFrameRing::Open(name, &error);
+  ASSERT_TRUE(reader) << error;
+  EXPECT_FALSE(reader->IsStale());
+
+  // a restarted writer replaces the segment
+  auto writer2 = ShmFrameRing::Create(name, 3, 16, 30, &error);
+  ASSERT_TRUE(writer2) << error;
+  EXPECT_TRUE(reader->IsStale());
+  writer.reset();
+  reader = ShmFrameRing::Open(name, &error);
+  ASSERT_TRUE(reader) << error;
+  EXPECT_FALSE(reader->IsStale());
+
+  writer2.reset();
+  EXPECT_TRUE(reader->IsStale());
+  EXPECT_FALSE(ShmFrameRing::Open(name, &error));
+}
+
+TEST_F(ShmFrameRingTest, OnlyOwnerHasAccess) {
+  std::string error;
+  auto writer = ShmFrameRing::Create(name, 3, 16, 30, &error);
+  ASSERT_TRUE(writer) << error;
+  int fd = shm_open(fmt::format("/{}", name).c_str(), O_RDONLY, 0);
+  ASSERT_GE(fd, 0);
+  struct stat st;
+  ASSERT_EQ(0, fstat(fd, &st));
+  close(fd);
+  EXPECT_EQ(0600u, st.st_mode & 0777);
+}
+
+TEST_F(ShmFrameRingTest, SkipsInvalidFrames) {
+  std::string error;
+  auto writer = ShmFrameRing::Create(name, 3, 16, 30, &error);
+  ASSERT_TRUE(writer) << error;
+  auto reader = ShmFrameRing::Open(name, &error);
+  ASSERT_TRUE(reader) << error;
+
+  // too small for a 4x4 BGR image, and an unknown pixel format
+  char data[16] = {'a'};
+  ASSERT_TRUE(writer->Write(
+      {.pixelFormat = WPI_PIXFMT_BGR, .width = 4, .height = 4, .size = 16},
+      data));
+  uint32_t sequence = 0;
+  int slot;
+  EXPECT_EQ(0, Read(*reader, &sequence, &slot));
+  ASSERT_TRUE(writer->Write({.pixelFormat = 100, .size = 16}, data));
+  EXPECT_EQ(0, Read(*reader, &sequence, &slot));
+
+  ASSERT_TRUE(Write(*writer, 'b'));
+  EXPECT_EQ('b', Read(*reader, &sequence, &slot));
+  reader->Release(slot);
+}
+
+TEST_F(ShmFrameRingTest, ReclaimsPinsOfExitedReader) {
+  std::string error;
+  auto writer = ShmFrameRing::Create(name, 2, 16, 30, &error);
+  ASSERT_TRUE(writer) << error;
+  ASSERT_TRUE(Write(*writer, 'a'));
+
+  // a reader that exits without releasing its slot
+  pid_t pid = fork();
+  ASSERT_GE(pid, 0);
+  if (pid == 0) {
+    std::string childError;
+    auto reader = ShmFrameRing::Open(name, &childError);
+    uint32_t sequence = 0;
+    ShmFrameRing::FrameInfo info;
+    _exit(reader && reader->Acquire(&sequence, 1.0, &info) >= 0 ? 0 : 1);
+  }
+  int status;
+  ASSERT_EQ(pid, waitpid(pid, &status, 0));
+  ASSERT_TRUE(WIFEXITED(status));
+  ASSERT_EQ(0, WEXITSTATUS(status));
+
+  // the other slot holds the newest frame, so the pinned one must be reused
+  ASSERT_TRUE(Write(*writer, 'b'));
+  EXPECT_TRUE(Write(*writer, 'c'));
+}
+
+#endif
+
+TEST(ShmFrameRingTimeTest, SharedTimeRoundTrip) {
+  uint64_t time = 123456789;
+  uint64_t shared = ShmFrameRing::ToSharedTime(time);
+  int64_t diff = ShmFrameRing::FromSharedTime(shared) - time;
+  EXPECT_LE(std::abs(diff), 1000);
+}
+
+}  // namespace cs
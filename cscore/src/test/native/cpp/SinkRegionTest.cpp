@@ -0,0 +1,48 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include <gtest/gtest.h>
+#include <wpi/RawFrame.h>
+
+#include "cscore.h"
+#include "cscore_cv.h"
+#include "cscore_raw.h"
+
+namespace cs {
+
+TEST(SinkRegionTest, CvSinkUnsupportedFormat) {
+  {
+    CvSink sink{"sink", VideoMode::kYUYV};
+    sink.SetRegion(0, 0, 16, 16);
+    EXPECT_EQ(CS_UNSUPPORTED_MODE, sink.GetLastStatus());
+    sink.SetRegion(0, 0, 0, 0, 2);
+    EXPECT_EQ(CS_UNSUPPORTED_MODE, sink.GetLastStatus());
+    // the full frame is always supported
+    sink.SetRegion(0, 0, 0, 0);
+    EXPECT_EQ(CS_OK, sink.GetLastStatus());
+
+    CvSink gray{"gray", VideoMode::kGray};
+    gray.SetRegion(0, 0, 16, 16);
+    EXPECT_EQ(CS_OK, gray.GetLastStatus());
+  }
+  Shutdown();
+}
+
+TEST(SinkRegionTest, RawSinkUnsupportedFormat) {
+  {
+    RawSink sink{"sink"};
+    sink.SetRegion(0, 0, 16, 16);
+    ASSERT_EQ(CS_OK, sink.GetLastStatus());
+
+    // fails immediately rather than waiting for a frame
+    wpi::RawFrame frame;
+    frame.pixelFormat = WPI_PIXFMT_MJPEG;
+    CS_Status status = 0;
+    EXPECT_EQ(0u, GrabSinkFrame(sink.GetHandle(), frame, &status));
+    EXPECT_EQ(CS_UNSUPPORTED_MODE, status);
+  }
+  Shutdown();
+}
+
+}  // namespace cs
@@ -0,0 +1,201 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+
+#include <gtest/gtest.h>
+#include <wpi/json.h>
+
+#include "ConfigurableSourceImpl.h"
+#include "Frame.h"
+#include "Instance.h"
+
+namespace cs {
+
+namespace {
+// A source whose frames are put directly by the test.
+class TestSource : public ConfigurableSourceImpl {
+ public:
+  TestSource()
+      : ConfigurableSourceImpl{"test", Instance::GetInstance().logger,
+                               Instance::GetInstance().notifier,
+                               Instance::GetInstance().telemetry,
+                               VideoMode{VideoMode::kGray, 4, 4, 30}} {}
+
+  // Puts a 4x4 gray frame with every pixel set to value
+  void PutGray(char value, Frame::Time time) {
+    std::string data(16, value);
+    PutFrame(VideoMode::kGray, 4, 4, data, time);
+  }
+
+  void ReleaseTestImage(std::unique_ptr<Image> image) {
+    ReleaseImage(std::move(image));
+  }
+};
+}  // namespace
+
+class SourcePoolTest : public ::testing::Test {
+ protected:
+  std::shared_ptr<TestSource> source = std::make_shared<TestSource>();
+
+  // bytes of images allocated by the source, and of those pooled
+  size_t ImageBytes() {
+    std::scoped_lock lock{source->m_poolMutex};
+    return source->m_imageBytes;
+  }
+
+  size_t PooledBytes() {
+    std::scoped_lock lock{source->m_poolMutex};
+    return source->m_pooledBytes;
+  }
+
+  size_t NumPooled() {
+    std::scoped_lock lock{source->m_poolMutex};
+    return source->m_numImagesAvail;
+  }
+
+  bool IsPoolExhausted(size_t size) {
+    std::scoped_lock lock{source->m_poolMutex};
+    return source->IsPoolExhausted(size);
+  }
+
+  void TrimPool(size_t bytes) {
+    std::scoped_lock lock{source->m_poolMutex};
+    source->TrimPool(bytes);
+  }
+};
+
+TEST_F(SourcePoolTest, Buckets) {
+  auto gray = source->AllocImage(VideoMode::kGray, 4, 4, 16);
+  auto bgr = source->AllocImage(VideoMode::kBGR, 4, 4, 48);
+  auto grayData = gray->data();
+  auto bgrData = bgr->data();
+  source->ReleaseTestImage(std::move(gray));
+  source->ReleaseTestImage(std::move(bgr));
+  EXPECT_EQ(2u, NumPooled());
+
+  // the same format and resolution is reused
+  gray = source->AllocImage(VideoMode::kGray, 4, 4, 16);
+  EXPECT_EQ(grayData, gray->data());
+  bgr = source->AllocImage(VideoMode::kBGR, 4, 4, 48);
+  EXPECT_EQ(bgrData, bgr->data());
+  source->ReleaseTestImage(std::move(gray));
+  source->ReleaseTestImage(std::move(bgr));
+
+  // otherwise the smallest image that is big enough
+  auto yuyv = source->AllocImage(VideoMode::kYUYV, 2, 2, 8);
+  EXPECT_EQ(grayData, yuyv->data());
+  EXPECT_EQ(VideoMode::kYUYV, yuyv->pixelFormat);
+  EXPECT_EQ(8u, yuyv->size());
+
+  // or a new image if none is
+  size_t bytes = ImageBytes();
+  auto large = source->AllocImage(VideoMode::kGray, 8, 8, 64);
+  EXPECT_NE(bgrData, large->data());
+  EXPECT_EQ(bytes + large->capacity(), ImageBytes());
+  EXPECT_EQ(1u, NumPooled());
+
+  source->ReleaseTestImage(std::move(yuyv));
+  source->ReleaseTestImage(std::move(large));
+  EXPECT_EQ(3u, NumPooled());
+  EXPECT_EQ(ImageBytes(), PooledBytes());
+}
+
+TEST_F(SourcePoolTest, Accounting) {
+  EXPECT_EQ(0u, ImageBytes());
+  auto image = source->AllocImage(VideoMode::kGray, 4, 4, 16);
+  size_t capacity = image->capacity();
+  EXPECT_EQ(capacity, ImageBytes());
+  EXPECT_EQ(0u, PooledBytes());
+  source->ReleaseTestImage(std::move(image));
+  EXPECT_EQ(capacity, ImageBytes());
+  EXPECT_EQ(capacity, PooledBytes());
+
+  // a steady stream of frames alternates between two images
+  for (int i = 0; i < 10; ++i) {
+    source->PutGray(i, 1000 + i);
+  }
+  EXPECT_EQ(2 * capacity, ImageBytes());
+  EXPECT_EQ(capacity, PooledBytes());
+
+  // every image is returned to the pool once no frame holds it
+  source->Wakeup();
+  EXPECT_EQ(2 * capacity, ImageBytes());
+  EXPECT_EQ(ImageBytes(), PooledBytes());
+  EXPECT_EQ(2u, NumPooled());
+}
+
+TEST_F(SourcePoolTest, ByteLimit) {
+  source->SetFramePoolLimit(48);
+  source->PutGray(1, 1001);
+  Frame frame1 = source->GetCurFrame();
+  source->PutGray(2, 1002);
+  Frame frame2 = source->GetCurFrame();
+  source->PutGray(3, 1003);
+  Frame frame3 = source->GetCurFrame();
+  EXPECT_EQ(48u, ImageBytes());
+  EXPECT_FALSE(IsPoolExhausted(0));
+  EXPECT_TRUE(IsPoolExhausted(1));
+
+  // frames are dropped while sinks hold on to the limit
+  source->PutGray(4, 1004);
+  EXPECT_EQ(1003u, source->GetCurFrameTime());
+  EXPECT_EQ(48u, ImageBytes());
+
+  // and accepted again once one is released
+  frame1 = Frame{};
+  EXPECT_FALSE(IsPoolExhausted(16));
+  source->PutGray(5, 1005);
+  EXPECT_EQ(1005u, source->GetCurFrameTime());
+  EXPECT_EQ(48u, ImageBytes());
+}
+
+TEST_F(SourcePoolTest, TrimPool) {
+  std::unique_ptr<Image> images[4];
+  for (auto&& image : images) {
+    image = source->AllocImage(VideoMode::kGray, 4, 4, 16);
+  }
+  for (auto&& image : images) {
+    source->ReleaseTestImage(std::move(image));
+  }
+  EXPECT_EQ(64u, PooledBytes());
+
+  TrimPool(32);
+  EXPECT_EQ(32u, ImageBytes());
+  EXPECT_EQ(32u, PooledBytes());
+  EXPECT_EQ(2u, NumPooled());
+
+  // allocating a new image frees pooled ones to stay within the limit
+  source->SetFramePoolLimit(40);
+  auto large = source->AllocImage(VideoMode::kGray, 8, 8, 64);
+  EXPECT_EQ(0u, NumPooled());
+  EXPECT_EQ(64u, ImageBytes());
+
+  // and an image released over the limit is freed rather than pooled
+  source->ReleaseTestImage(std::move(large));
+  EXPECT_EQ(0u, NumPooled());
+  EXPECT_EQ(0u, ImageBytes());
+}
+
+TEST_F(SourcePoolTest, ConfigJson) {
+  CS_Status status = 0;
+  EXPECT_TRUE(
+      source->SetConfigJson(wpi::json{{"frame pool bytes", 1000}}, &status));
+  EXPECT_EQ(1000u, source->GetFramePoolLimit());
+  auto config = source->GetConfigJsonObject(&status);
+  EXPECT_EQ(1000u, config.at("frame pool bytes").get<size_t>());
+
+  // an invalid value leaves the limit unchanged
+  source->SetConfigJson(wpi::json{{"frame pool bytes", "many"}}, &status);
+  EXPECT_EQ(1000u, source->GetFramePoolLimit());
+
+  source->SetFramePoolLimit(0);
+  config = source->GetConfigJsonObject(&status);
+  EXPECT_EQ(0u, config.count("frame pool bytes"));
+}
+
+}  // namespace cs
@@ -0,0 +1,44 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include <gtest/gtest.h>
+
+#include "Telemetry.h"
+#include "cscore.h"
+#include "cscore_raw.h"
+
+namespace cs {
+
+TEST(TelemetryTest, LatencyBuckets) {
+  // buckets include their upper bound
+  EXPECT_EQ(0u, Telemetry::GetLatencyBucket(0));
+  EXPECT_EQ(0u, Telemetry::GetLatencyBucket(1000));
+  EXPECT_EQ(1u, Telemetry::GetLatencyBucket(1001));
+  EXPECT_EQ(2u, Telemetry::GetLatencyBucket(3000));
+  EXPECT_EQ(5u, Telemetry::GetLatencyBucket(30000));
+  EXPECT_EQ(8u, Telemetry::GetLatencyBucket(500000));
+  // longer than the last bucket
+  EXPECT_EQ(kLatencyHistogramBucketsMs.size(),
+            Telemetry::GetLatencyBucket(500001));
+  EXPECT_EQ(kLatencyHistogramBucketsMs.size(),
+            Telemetry::GetLatencyBucket(10000000));
+}
+
+TEST(TelemetryTest, LatencyWithoutFrames) {
+  {
+    SetTelemetryPeriod(0.01);
+    RawSink sink{"sink"};
+    EXPECT_EQ(0.0, sink.GetAverageLatency());
+    EXPECT_EQ(0, sink.GetLastStatus());
+    auto histogram = sink.GetLatencyHistogram();
+    EXPECT_EQ(0, sink.GetLastStatus());
+    ASSERT_EQ(kLatencyHistogramBucketsMs.size() + 1, histogram.size());
+    for (auto count : histogram) {
+      EXPECT_EQ(0, count);
+    }
+  }
+  Shutdown();
+}
+
+}  // namespace cs
@@ -0,0 +1,132 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <opencv2/core/core.hpp>
+#include <wpi/fs.h>
+
+#include "Instance.h"
+#include "cscore.h"
+#include "cscore_cv.h"
+
+#ifdef __linux__
+#include "UsbCameraImpl.h"
+#endif
+
+namespace cs {
+
+#ifdef __linux__
+// Needs a camera at /dev/video0 with at least two resolutions in the same
+// pixel format; skipped otherwise.
+TEST(UsbCameraTest, ModeChangeWithHeldFrame) {
+  if (!fs::exists("/dev/video0")) {
+    GTEST_SKIP() << "no camera";
+  }
+  {
+    UsbCamera camera{"usbcam", "/dev/video0"};
+    auto modes = camera.EnumerateVideoModes();
+    const VideoMode* first = nullptr;
+    const VideoMode* second = nullptr;
+    for (auto&& mode : modes) {
+      if (!first) {
+        first = &mode;
+      } else if (mode.pixelFormat == first->pixelFormat &&
+                 (mode.width != first->width ||
+                  mode.height != first->height)) {
+        second = &mode;
+        break;
+      }
+    }
+    if (!second) {
+      GTEST_SKIP() << "camera has only one resolution";
+    }
+
+    CvSink sink{"sink"};
+    sink.SetSource(camera);
+    cv::Mat image;
+
+    // the source keeps the most recent frame, which references a capture
+    // buffer, across the mode change
+    for (const VideoMode* mode : {first, second, first}) {
+      ASSERT_TRUE(camera.SetVideoMode(*mode));
+      uint64_t time = 0;
+      for (int i = 0; i < 10 && image.cols != mode->width; ++i) {
+        time = sink.GrabFrame(image, 2.0);
+        ASSERT_NE(time, 0u) << sink.GetError();
+      }
+      EXPECT_EQ(image.cols, mode->width);
+      EXPECT_EQ(image.rows, mode->height);
+    }
+  }
+  Shutdown();
+}
+
+// Sink crop changes are handled by the camera thread even with no device
+// connected, so the debounce can be checked without a camera (applying the
+// crop needs one)
+class UsbCameraCropTest : public ::testing::Test {
+ protected:
+  using PendingCrop =
+      std::pair<std::optional<ImageRegion>,
+                std::chrono::steady_clock::time_point>;
+
+  static PendingCrop GetPendingCrop(UsbCameraImpl& camera) {
+    std::scoped_lock lock(camera.m_mutex);
+    return {camera.m_cropPending, camera.m_cropPendingTime};
+  }
+
+  // Waits for the camera thread to settle on the given pending crop
+  static PendingCrop WaitForPendingCrop(
+      UsbCameraImpl& camera, const std::optional<ImageRegion>& crop) {
+    auto pending = GetPendingCrop(camera);
+    for (int i = 0; i < 100 && pending.first != crop; ++i) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      pending = GetPendingCrop(camera);
+    }
+    return pending;
+  }
+};
+
+TEST_F(UsbCameraCropTest, Debounce) {
+  auto& inst = Instance::GetInstance();
+  auto camera = std::make_shared<UsbCameraImpl>(
+      "usbcam", inst.logger, inst.notifier, inst.telemetry,
+      "/dev/cscore-test-no-camera");
+  camera->Start();
+  ImageRegion region{10, 20, 320, 240};
+  ImageRegion crop = region;
+  crop.decimation = 1;
+
+  // a single sink's region is the common crop
+  camera->EnableSink(&region);
+  auto pending = WaitForPendingCrop(*camera, crop);
+  ASSERT_EQ(crop, pending.first);
+
+  // a viewer without a region cancels the change, rather than reconnecting
+  // twice
+  camera->EnableSink();
+  ASSERT_EQ(std::nullopt, WaitForPendingCrop(*camera, std::nullopt).first);
+
+  // when it leaves, the settle time starts over
+  camera->DisableSink();
+  auto restarted = WaitForPendingCrop(*camera, crop);
+  ASSERT_EQ(crop, restarted.first);
+  EXPECT_GT(restarted.second, pending.second);
+
+  // an unchanged crop doesn't restart it
+  camera->UpdateSinkRegion(region, region);
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_EQ(restarted, GetPendingCrop(*camera));
+}
+#endif
+
+}  // namespace cs
@@ -8,6 +8,7 @@
 
 #include <algorithm>
 #include <concepts>
+#include <memory>
 #include <numeric>
 #include <optional>
 #include <span>
@@ -95,7 +96,9 @@ class NetworkOutgoingQueue {
  private:
   using ValueMsg = typename MessageType::ValueMsg;
 
+  int64_t GetWireTime(const Value& value) const;
   void EncodeValue(wpi::raw_ostream& os, NT_Handle handle, const Value& value);
+  int WriteValue(NT_Handle handle, const Value& value);
 
   struct Message {
     Message() = default;
@@ -134,6 +137,8 @@ class NetworkOutgoingQueue {
 
   // maximum total size of outgoing queues in bytes (approximate)
   static constexpr size_t kOutgoingLimit = 1024 * 1024;
+  // string and raw payloads at least this large are sent by reference
+  static constexpr size_t kSharedPayloadMin = 4096;
 };
 
 template <NetworkMessage MessageType>
@@ -270,8 +275,7 @@ void NetworkOutgoingQueue<MessageType>::SendOutgoing(uint64_t curTimeMs,
     int unsent = 0;
     for (; it != end && unsent == 0; ++it) {
       if (auto m = std::get_if<ValueMsg>(&it->msg.contents)) {
-        unsent = m_wire.WriteBinary(
-            [&](auto& os) { EncodeValue(os, it->handle, m->value); });
+        unsent = WriteValue(it->handle, m->value);
       } else {
         unsent = m_wire.WriteText([&](auto& os) {
           if (!WireEncodeText(os, it->msg)) {
@@ -323,9 +327,8 @@ void NetworkOutgoingQueue<MessageType>::SendOutgoing(uint64_t curTimeMs,
 }
 
 template <NetworkMessage MessageType>
-void NetworkOutgoingQueue<MessageType>::EncodeValue(wpi::raw_ostream& os,
-                                                    NT_Handle handle,
-                                                    const Value& value) {
+int64_t NetworkOutgoingQueue<MessageType>::GetWireTime(
+    const Value& value) const {
   int64_t time = value.time();
   if constexpr (std::same_as<ValueMsg, ClientValueMsg>) {
     if (time != 0) {
@@ -336,7 +339,32 @@ void NetworkOutgoingQueue<MessageType>::EncodeValue(wpi::raw_ostream& os,
       }
     }
   }
-  WireEncodeBinary(os, Handle{handle}.GetIndex(), time, value);
+  return time;
+}
+
+template <NetworkMessage MessageType>
+void NetworkOutgoingQueue<MessageType>::EncodeValue(wpi::raw_ostream& os,
+                                                    NT_Handle handle,
+                                                    const Value& value) {
+  WireEncodeBinary(os, Handle{handle}.GetIndex(), GetWireTime(value), value);
+}
+
+template <NetworkMessage MessageType>
+int NetworkOutgoingQueue<MessageType>::WriteValue(NT_Handle handle,
+                                                  const Value& value) {
+  auto payload = WireBinaryPayload(value);
+  if (payload.size() < kSharedPayloadMin) {
+    return m_wire.WriteBinary(
+        [&](auto& os) { EncodeValue(os, handle, value); });
+  }
+  // the copy shares the value's storage, keeping the payload alive until it
+  // has been sent even if the queued message is replaced
+  return m_wire.WriteBinaryShared(
+      [&](auto& os) {
+        WireEncodeBinaryHeader(os, Handle{handle}.GetIndex(),
+                               GetWireTime(value), value);
+      },
+      payload, std::make_shared<Value>(value));
 }
 
 }  // namespace nt::net
@@ -106,7 +106,9 @@ WebSocketConnection::WebSocketConnection(wpi::WebSocket& ws,
 
 WebSocketConnection::~WebSocketConnection() {
   for (auto&& buf : m_bufs) {
-    buf.Deallocate();
+    if (!IsShared(m_shared_bufs, buf)) {
+      buf.Deallocate();
+    }
   }
   for (auto&& buf : m_buf_pool) {
     buf.Deallocate();
@@ -155,7 +157,8 @@ void WebSocketConnection::FinishText() {
 }
 
 int WebSocketConnection::Write(
-    State kind, wpi::function_ref<void(wpi::raw_ostream& os)> writer) {
+    State kind, wpi::function_ref<void(wpi::raw_ostream& os)> writer,
+    std::span<const uint8_t> payload, std::shared_ptr<void> owner) {
   bool first = false;
   if (m_state != kind ||
       (m_state == kind && m_framePos >= kNewFrameThresholdBytes)) {
@@ -179,6 +182,17 @@ int WebSocketConnection::Write(
     }
     writer(os);
   }
+  if (!payload.empty()) {
+    // send the payload in place: it becomes its own buffer in the frame,
+    // followed by a fresh buffer for subsequent writes
+    m_bufs.emplace_back(payload);
+    m_shared_bufs.push_back({m_bufs.back().base, std::move(owner)});
+    m_bufs.emplace_back(AllocBuf());
+    m_bufs.back().len = 0;
+    m_frames.back().end += 2;
+    m_framePos += payload.size();
+    m_written += payload.size();
+  }
   ++m_frames.back().count;
   if (m_frames.size() > kFlushThresholdFrames ||
       m_written >= kFlushThresholdBytes) {
@@ -213,16 +227,23 @@ int WebSocketConnection::Flush() {
   }
 
   auto unsentFrames = m_ws.TrySendFrames(
-      m_ws_frames, [selfweak = weak_from_this()](auto bufs, auto err) {
+      m_ws_frames,
+      [selfweak = weak_from_this(), shared = std::move(m_shared_bufs)](
+          auto bufs, auto err) mutable {
         if (auto self = selfweak.lock()) {
           self->m_err = err;
-          self->ReleaseBufs(bufs);
+          self->ReleaseBufs(bufs, shared);
         } else {
           for (auto&& buf : bufs) {
-            buf.Deallocate();
+            if (!IsShared(shared, buf)) {
+              buf.Deallocate();
+            }
           }
         }
+        // the payloads have been sent; let go of them
+        shared.clear();
       });
+  m_shared_bufs.clear();
   m_ws_frames.clear();
   if (m_err) {
     m_frames.clear();
@@ -277,14 +298,24 @@ wpi::uv::Buffer WebSocketConnection::AllocBuf() {
   return wpi::uv::Buffer::Allocate(kAllocSize + 1);  // leave space for ']'
 }
 
-void WebSocketConnection::ReleaseBufs(std::span<wpi::uv::Buffer> bufs) {
-#ifdef __SANITIZE_ADDRESS__
-  size_t numToPool = 0;
-#else
-  size_t numToPool = (std::min)(bufs.size(), kMaxPoolSize - m_buf_pool.size());
-  m_buf_pool.insert(m_buf_pool.end(), bufs.begin(), bufs.begin() + numToPool);
+bool WebSocketConnection::IsShared(std::span<const SharedBuf> shared,
+                                   const wpi::uv::Buffer& buf) {
+  return std::any_of(shared.begin(), shared.end(),
+                     [&](auto&& s) { return s.base == buf.base; });
+}
+
+void WebSocketConnection::ReleaseBufs(std::span<wpi::uv::Buffer> bufs,
+                                      std::span<const SharedBuf> shared) {
+  for (auto&& buf : bufs) {
+    if (!shared.empty() && IsShared(shared, buf)) {
+      continue;
+    }
+#ifndef __SANITIZE_ADDRESS__
+    if (m_buf_pool.size() < kMaxPoolSize) {
+      m_buf_pool.emplace_back(buf);
+      continue;
+    }
 #endif
-  for (auto&& buf : bufs.subspan(numToPool)) {
     buf.Deallocate();
   }
 }
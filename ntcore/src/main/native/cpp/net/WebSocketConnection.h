@@ -5,6 +5,7 @@
 #pragma once
 
 #include <memory>
+#include <span>
 #include <string>
 #include <string_view>
 #include <vector>
@@ -40,6 +41,11 @@ class WebSocketConnection final
   int WriteBinary(wpi::function_ref<void(wpi::raw_ostream& os)> writer) final {
     return Write(kBinary, writer);
   }
+  int WriteBinaryShared(wpi::function_ref<void(wpi::raw_ostream& os)> writer,
+                        std::span<const uint8_t> payload,
+                        std::shared_ptr<void> owner) final {
+    return Write(kBinary, writer, payload, std::move(owner));
+  }
   int Flush() final;
 
   void SendText(wpi::function_ref<void(wpi::raw_ostream& os)> writer) final {
@@ -60,14 +66,26 @@ class WebSocketConnection final
  private:
   enum State { kEmpty, kText, kBinary };
 
-  int Write(State kind, wpi::function_ref<void(wpi::raw_ostream& os)> writer);
+  int Write(State kind, wpi::function_ref<void(wpi::raw_ostream& os)> writer,
+            std::span<const uint8_t> payload = {},
+            std::shared_ptr<void> owner = nullptr);
   void Send(uint8_t opcode,
             wpi::function_ref<void(wpi::raw_ostream& os)> writer);
 
   void StartFrame(uint8_t opcode);
   void FinishText();
   wpi::uv::Buffer AllocBuf();
-  void ReleaseBufs(std::span<wpi::uv::Buffer> bufs);
+
+  // A payload buffer owned by someone else; these are sent from in place
+  // and must not be returned to the pool
+  struct SharedBuf {
+    const char* base;
+    std::shared_ptr<void> owner;
+  };
+  static bool IsShared(std::span<const SharedBuf> shared,
+                       const wpi::uv::Buffer& buf);
+  void ReleaseBufs(std::span<wpi::uv::Buffer> bufs,
+                   std::span<const SharedBuf> shared = {});
 
   wpi::WebSocket& m_ws;
 
@@ -86,6 +104,7 @@ class WebSocketConnection final
   std::vector<Frame> m_frames;
   std::vector<wpi::uv::Buffer> m_bufs;
   std::vector<wpi::uv::Buffer> m_buf_pool;
+  std::vector<SharedBuf> m_shared_bufs;
   size_t m_framePos = 0;
   size_t m_written = 0;
   wpi::uv::Error m_err;
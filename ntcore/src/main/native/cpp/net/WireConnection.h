@@ -6,13 +6,12 @@
 
 #include <stdint.h>
 
+#include <memory>
+#include <span>
 #include <string_view>
 
 #include <wpi/function_ref.h>
-
-namespace wpi {
-class raw_ostream;
-}  // namespace wpi
+#include <wpi/raw_ostream.h>
 
 namespace nt::net {
 
@@ -38,6 +37,19 @@ class WireConnection {
   virtual int WriteBinary(
       wpi::function_ref<void(wpi::raw_ostream& os)> writer) = 0;
 
+  // Equivalent to WriteBinary() with writer followed by payload, but payload
+  // may be sent by reference instead of copied. owner must keep payload alive;
+  // it is released once the payload has been sent.
+  [[nodiscard]]
+  virtual int WriteBinaryShared(
+      wpi::function_ref<void(wpi::raw_ostream& os)> writer,
+      std::span<const uint8_t> payload, std::shared_ptr<void> owner) {
+    return WriteBinary([&](wpi::raw_ostream& os) {
+      writer(os);
+      os << payload;
+    });
+  }
+
   // Flushes any pending buffers. Return value equivalent to
   // WriteText/WriteBinary (e.g. 1 means the last WriteX call was not sent).
   [[nodiscard]]
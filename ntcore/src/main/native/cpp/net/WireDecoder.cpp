@@ -11,13 +11,12 @@
 #include <wpi/Logger.h>
 #include <wpi/SpanExtras.h>
 #include <wpi/json.h>
-#include <wpi/mpack.h>
 
 #include "Message.h"
+#include "WireMsgPack.h"
 
 using namespace nt;
 using namespace nt::net;
-using namespace mpack;
 
 static bool GetNumber(wpi::json& val, double* num) {
   if (auto v = val.get_ptr<const int64_t*>()) {
@@ -430,144 +429,26 @@ void nt::net::WireDecodeText(std::string_view in, ServerMessageHandler& out,
 bool nt::net::WireDecodeBinary(std::span<const uint8_t>* in, int64_t* outId,
                                Value* outValue, std::string* error,
                                int64_t localTimeOffset) {
-  mpack_reader_t reader;
-  mpack_reader_init_data(&reader, reinterpret_cast<const char*>(in->data()),
-                         in->size());
-  mpack_expect_array_match(&reader, 4);
-  *outId = mpack_expect_i64(&reader);
-  auto time = mpack_expect_i64(&reader);
-  int type = mpack_expect_int(&reader);
-  switch (type) {
-    case 0:  // boolean
-      *outValue = Value::MakeBoolean(mpack_expect_bool(&reader), 1);
-      break;
-    case 2:  // integer
-      *outValue = Value::MakeInteger(mpack_expect_i64(&reader), 1);
-      break;
-    case 3:  // float
-      *outValue = Value::MakeFloat(mpack_expect_float(&reader), 1);
-      break;
-    case 1:  // double
-      *outValue = Value::MakeDouble(mpack_expect_double(&reader), 1);
-      break;
-    case 4: {  // string
-      auto length = mpack_expect_str(&reader);
-      auto data = mpack_read_bytes_inplace(&reader, length);
-      if (mpack_reader_error(&reader) == mpack_ok) {
-        *outValue = Value::MakeString({data, length}, 1);
-      }
-      mpack_done_str(&reader);
-      break;
-    }
-    case 5: {  // raw
-      auto length = mpack_expect_bin(&reader);
-      auto data = mpack_read_bytes_inplace(&reader, length);
-      if (mpack_reader_error(&reader) == mpack_ok) {
-        *outValue =
-            Value::MakeRaw({reinterpret_cast<const uint8_t*>(data), length}, 1);
-      }
-      mpack_done_bin(&reader);
-      break;
-    }
-    case 16: {  // boolean array
-      auto length = mpack_expect_array(&reader);
-      std::vector<int> arr;
-      arr.reserve((std::min)(length, 1000u));
-      for (uint32_t i = 0; i < length; ++i) {
-        arr.emplace_back(mpack_expect_bool(&reader));
-        if (mpack_reader_error(&reader) != mpack_ok) {
-          break;
-        }
-      }
-      if (mpack_reader_error(&reader) == mpack_ok) {
-        *outValue = Value::MakeBooleanArray(std::move(arr), 1);
-      }
-      mpack_done_array(&reader);
-      break;
-    }
-    case 18: {  // integer array
-      auto length = mpack_expect_array(&reader);
-      std::vector<int64_t> arr;
-      arr.reserve((std::min)(length, 1000u));
-      for (uint32_t i = 0; i < length; ++i) {
-        arr.emplace_back(mpack_expect_i64(&reader));
-        if (mpack_reader_error(&reader) != mpack_ok) {
-          break;
-        }
-      }
-      if (mpack_reader_error(&reader) == mpack_ok) {
-        *outValue = Value::MakeIntegerArray(std::move(arr), 1);
-      }
-      mpack_done_array(&reader);
-      break;
-    }
-    case 19: {  // float array
-      auto length = mpack_expect_array(&reader);
-      std::vector<float> arr;
-      arr.reserve((std::min)(length, 1000u));
-      for (uint32_t i = 0; i < length; ++i) {
-        arr.emplace_back(mpack_expect_float(&reader));
-        if (mpack_reader_error(&reader) != mpack_ok) {
-          break;
-        }
-      }
-      if (mpack_reader_error(&reader) == mpack_ok) {
-        *outValue = Value::MakeFloatArray(std::move(arr), 1);
-      }
-      mpack_done_array(&reader);
-      break;
-    }
-    case 17: {  // double array
-      auto length = mpack_expect_array(&reader);
-      std::vector<double> arr;
-      arr.reserve((std::min)(length, 1000u));
-      for (uint32_t i = 0; i < length; ++i) {
-        arr.emplace_back(mpack_expect_double(&reader));
-        if (mpack_reader_error(&reader) != mpack_ok) {
-          break;
-        }
-      }
-      if (mpack_reader_error(&reader) == mpack_ok) {
-        *outValue = Value::MakeDoubleArray(std::move(arr), 1);
-      }
-      mpack_done_array(&reader);
-      break;
-    }
-    case 20: {  // string array
-      auto length = mpack_expect_array(&reader);
-      std::vector<std::string> arr;
-      arr.reserve((std::min)(length, 1000u));
-      for (uint32_t i = 0; i < length; ++i) {
-        auto length = mpack_expect_str(&reader);
-        auto data = mpack_read_bytes_inplace(&reader, length);
-        if (mpack_reader_error(&reader) == mpack_ok) {
-          arr.emplace_back(std::string{data, length});
-        } else {
-          break;
-        }
-        mpack_done_str(&reader);
-      }
-      if (mpack_reader_error(&reader) == mpack_ok) {
-        *outValue = Value::MakeStringArray(std::move(arr), 1);
-      }
-      mpack_done_array(&reader);
-      break;
-    }
-    default:
-      *error = fmt::format("unrecognized type {}", type);
-      return false;
+  MsgPackReader reader{*in};
+  if (reader.ReadArray() != 4) {
+    reader.SetError(MsgPackReader::kType);
+  }
+  *outId = reader.ReadInt();
+  auto time = reader.ReadInt();
+  int type = reader.ReadInt32();
+  if (reader.GetError() == MsgPackReader::kOk &&
+      !ReadBinaryValue(reader, type, outValue)) {
+    *error = fmt::format("unrecognized type {}", type);
+    return false;
   }
-  mpack_done_array(&reader);
-  auto err = mpack_reader_destroy(&reader);
-  if (err != mpack_ok) {
-    *error = mpack_error_to_string(err);
+  if (auto err = reader.GetError()) {
+    *error = MsgPackReader::GetErrorString(err);
     return false;
   }
   // set time
   outValue->SetServerTime(time);
   outValue->SetTime(time == 0 ? 0 : time + localTimeOffset);
   // update input range
-  *in = wpi::drop_front(*in,
-                        in->size() - mpack_reader_remaining(&reader, nullptr));
+  *in = wpi::take_back(*in, reader.GetRemaining());
   return true;
 }
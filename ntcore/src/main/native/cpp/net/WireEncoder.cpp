@@ -7,17 +7,16 @@
 #include <optional>
 
 #include <wpi/json.h>
-#include <wpi/mpack.h>
 #include <wpi/raw_ostream.h>
 
 #include "Handle.h"
 #include "Message.h"
 #include "PubSubOptions.h"
+#include "WireMsgPack.h"
 #include "networktables/NetworkTableValue.h"
 
 using namespace nt;
 using namespace nt::net;
-using namespace mpack;
 
 void nt::net::WireEncodePublish(wpi::raw_ostream& os, int64_t pubuid,
                                 std::string_view name, std::string_view typeStr,
@@ -215,101 +214,58 @@ bool nt::net::WireEncodeText(wpi::raw_ostream& os, const ServerMessage& msg) {
 
 bool nt::net::WireEncodeBinary(wpi::raw_ostream& os, int64_t id, int64_t time,
                                const Value& value) {
-  char buf[128];
-  mpack_writer_t writer;
-  mpack_writer_init(&writer, buf, sizeof(buf));
-  mpack_writer_set_context(&writer, &os);
-  mpack_writer_set_flush(
-      &writer, [](mpack_writer_t* writer, const char* buffer, size_t count) {
-        static_cast<wpi::raw_ostream*>(writer->context)->write(buffer, count);
-      });
-  mpack_start_array(&writer, 4);
-  mpack_write_int(&writer, id);
-  mpack_write_int(&writer, time);
+  MsgPackWriter writer{os};
+  writer.WriteArray(4);
+  writer.WriteInt(id);
+  writer.WriteInt(time);
+  if (!WriteBinaryValue(writer, value)) {
+    return false;
+  }
+  writer.Flush();
+  return true;
+}
+
+std::span<const uint8_t> nt::net::WireBinaryPayload(const Value& value) {
   switch (value.type()) {
-    case NT_BOOLEAN:
-      mpack_write_u8(&writer, 0);
-      mpack_write_bool(&writer, value.GetBoolean());
-      break;
-    case NT_INTEGER:
-      mpack_write_u8(&writer, 2);
-      mpack_write_int(&writer, value.GetInteger());
-      break;
-    case NT_FLOAT:
-      mpack_write_u8(&writer, 3);
-      mpack_write_float(&writer, value.GetFloat());
-      break;
-    case NT_DOUBLE:
-      mpack_write_u8(&writer, 1);
-      mpack_write_double(&writer, value.GetDouble());
-      break;
     case NT_STRING: {
-      auto v = value.GetString();
-      mpack_write_u8(&writer, 4);
-      mpack_write_str(&writer, v.data(), v.size());
-      break;
+      auto str = value.GetString();
+      return {reinterpret_cast<const uint8_t*>(str.data()), str.size()};
     }
     case NT_RPC:
-    case NT_RAW: {
-      auto v = value.GetRaw();
-      mpack_write_u8(&writer, 5);
-      mpack_write_bin(&writer, reinterpret_cast<const char*>(v.data()),
-                      v.size());
-      break;
-    }
-    case NT_BOOLEAN_ARRAY: {
-      auto v = value.GetBooleanArray();
-      mpack_write_u8(&writer, 16);
-      mpack_start_array(&writer, v.size());
-      for (auto val : v) {
-        mpack_write_bool(&writer, val);
-      }
-      mpack_finish_array(&writer);
-      break;
-    }
-    case NT_INTEGER_ARRAY: {
-      auto v = value.GetIntegerArray();
-      mpack_write_u8(&writer, 18);
-      mpack_start_array(&writer, v.size());
-      for (auto val : v) {
-        mpack_write_int(&writer, val);
-      }
-      mpack_finish_array(&writer);
-      break;
-    }
-    case NT_FLOAT_ARRAY: {
-      auto v = value.GetFloatArray();
-      mpack_write_u8(&writer, 19);
-      mpack_start_array(&writer, v.size());
-      for (auto val : v) {
-        mpack_write_float(&writer, val);
+    case NT_RAW:
+      return value.GetRaw();
+    default:
+      return {};
+  }
+}
+
+bool nt::net::WireEncodeBinaryHeader(wpi::raw_ostream& os, int64_t id,
+                                     int64_t time, const Value& value) {
+  MsgPackWriter writer{os};
+  writer.WriteArray(4);
+  writer.WriteInt(id);
+  writer.WriteInt(time);
+  switch (value.type()) {
+    case NT_STRING:
+      writer.WriteInt(4);
+      if (!writer.WriteStrHeader(value.GetString().size())) {
+        return false;
       }
-      mpack_finish_array(&writer);
       break;
-    }
-    case NT_DOUBLE_ARRAY: {
-      auto v = value.GetDoubleArray();
-      mpack_write_u8(&writer, 17);
-      mpack_start_array(&writer, v.size());
-      for (auto val : v) {
-        mpack_write_double(&writer, val);
+    case NT_RPC:
+    case NT_RAW:
+      writer.WriteInt(5);
+      if (!writer.WriteBinHeader(value.GetRaw().size())) {
+        return false;
       }
-      mpack_finish_array(&writer);
       break;
-    }
-    case NT_STRING_ARRAY: {
-      auto v = value.GetStringArray();
-      mpack_write_u8(&writer, 20);
-      mpack_start_array(&writer, v.size());
-      for (auto&& val : v) {
-        mpack_write_str(&writer, val.data(), val.size());
+    default:
+      // no separate payload
+      if (!WriteBinaryValue(writer, value)) {
+        return false;
       }
-      mpack_finish_array(&writer);
       break;
-    }
-    default:
-      return false;
   }
-  mpack_finish_array(&writer);
-  return mpack_writer_destroy(&writer) == mpack_ok;
+  writer.Flush();
+  return true;
 }
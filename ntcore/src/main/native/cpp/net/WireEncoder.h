@@ -59,4 +59,14 @@ bool WireEncodeText(wpi::raw_ostream& os, const ServerMessage& msg);
 bool WireEncodeBinary(wpi::raw_ostream& os, int64_t id, int64_t time,
                       const Value& value);
 
+// Gets the string or raw payload of a value, which WireEncodeBinaryHeader()
+// leaves out; empty for other value types.
+std::span<const uint8_t> WireBinaryPayload(const Value& value);
+
+// Encode a binary message up to but not including WireBinaryPayload(value).
+// The caller must send the payload immediately after; this allows it to be
+// sent by reference instead of copied.
+bool WireEncodeBinaryHeader(wpi::raw_ostream& os, int64_t id, int64_t time,
+                            const Value& value);
+
 }  // namespace nt::net
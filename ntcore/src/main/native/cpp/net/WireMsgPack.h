@@ -0,0 +1,757 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#pragma once
+
+#include <stdint.h>
+
+#include <bit>
+#include <concepts>
+#include <cstring>
+#include <limits>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <wpi/Endian.h>
+#include <wpi/SmallVector.h>
+#include <wpi/raw_ostream.h>
+
+#include "networktables/NetworkTableValue.h"
+
+// Specialized MessagePack codec for NT4 binary value messages.
+//
+// Binary messages always have the fixed shape [id, timestamp, type, value],
+// and only a handful of MessagePack types can appear in them, so this reads
+// and writes those types directly rather than going through mpack's generic
+// tag handling and per-call error checks.  Values are decoded straight into
+// nt::Value; array elements are staged on the stack, so decoding performs no
+// allocations beyond the Value's own storage for arrays of up to 64 elements.
+// Both directions accept and produce exactly what mpack does for these
+// messages; WireMsgPackTest.cpp fuzzes the two against each other.
+
+namespace nt::net {
+
+/**
+ * Streaming MessagePack reader over a contiguous buffer.
+ *
+ * Errors are sticky: once a read fails, all further reads return default
+ * values and the error is reported by GetError().  This allows a sequence of
+ * reads to be checked once at the end.
+ */
+class MsgPackReader {
+ public:
+  enum Error { kOk = 0, kInvalid, kType };
+
+  explicit MsgPackReader(std::span<const uint8_t> in)
+      : m_pos{in.data()}, m_end{in.data() + in.size()} {}
+
+  Error GetError() const { return m_error; }
+
+  static const char* GetErrorString(Error err) {
+    switch (err) {
+      case kOk:
+        return "ok";
+      case kInvalid:
+        return "invalid or truncated data";
+      case kType:
+        return "unexpected type";
+      default:
+        return "unknown error";
+    }
+  }
+
+  /**
+   * Flags an error.  The first error flagged is the one reported, and no
+   * further data is consumed.
+   */
+  void SetError(Error err) {
+    if (m_error == kOk) {
+      m_error = err;
+    }
+    m_pos = m_end;
+  }
+
+  /**
+   * Gets the number of bytes not yet consumed.
+   */
+  size_t GetRemaining() const { return m_end - m_pos; }
+
+  bool ReadBool() {
+    if (!Ensure(1)) {
+      return false;
+    }
+    uint8_t tag = *m_pos++;
+    if ((tag & ~1) != 0xc2) {
+      SetError(kType);
+      return false;
+    }
+    return (tag & 1) != 0;
+  }
+
+  int64_t ReadInt() {
+    Number num = ReadNumber();
+    if (num.kind == Number::kUint &&
+        num.u <= static_cast<uint64_t>(std::numeric_limits<int64_t>::max())) {
+      return static_cast<int64_t>(num.u);
+    } else if (num.kind == Number::kInt) {
+      return num.i;
+    }
+    SetError(kType);
+    return 0;
+  }
+
+  int32_t ReadInt32() {
+    Number num = ReadNumber();
+    if (num.kind == Number::kUint &&
+        num.u <= static_cast<uint64_t>(std::numeric_limits<int32_t>::max())) {
+      return static_cast<int32_t>(num.u);
+    } else if (num.kind == Number::kInt &&
+               num.i >= std::numeric_limits<int32_t>::min() &&
+               num.i <= std::numeric_limits<int32_t>::max()) {
+      return static_cast<int32_t>(num.i);
+    }
+    SetError(kType);
+    return 0;
+  }
+
+  float ReadFloat() {
+    Number num = ReadNumber();
+    switch (num.kind) {
+      case Number::kUint:
+        return static_cast<float>(num.u);
+      case Number::kInt:
+        return static_cast<float>(num.i);
+      case Number::kFloat:
+        return num.f;
+      case Number::kDouble:
+        return static_cast<float>(num.d);
+      default:
+        SetError(kType);
+        return 0.0f;
+    }
+  }
+
+  double ReadDouble() {
+    Number num = ReadNumber();
+    switch (num.kind) {
+      case Number::kUint:
+        return static_cast<double>(num.u);
+      case Number::kInt:
+        return static_cast<double>(num.i);
+      case Number::kFloat:
+        return num.f;
+      case Number::kDouble:
+        return num.d;
+      default:
+        SetError(kType);
+        return 0.0;
+    }
+  }
+
+  /**
+   * Reads an array header.
+   *
+   * @return number of elements
+   */
+  uint32_t ReadArray() {
+    if (!Ensure(1)) {
+      return 0;
+    }
+    uint8_t tag = *m_pos;
+    if ((tag & 0xf0) == 0x90) {
+      ++m_pos;
+      return tag & 0x0f;
+    } else if (tag == 0xdc) {
+      return ReadLength<uint16_t>();
+    } else if (tag == 0xdd) {
+      return ReadLength<uint32_t>();
+    }
+    SetError(kType);
+    return 0;
+  }
+
+  /**
+   * Reads a string.  The returned view points into the input buffer.
+   */
+  std::string_view ReadStr() {
+    if (!Ensure(1)) {
+      return {};
+    }
+    uint8_t tag = *m_pos;
+    uint32_t len;
+    if ((tag & 0xe0) == 0xa0) {
+      ++m_pos;
+      len = tag & 0x1f;
+    } else if (tag == 0xd9) {
+      len = ReadLength<uint8_t>();
+    } else if (tag == 0xda) {
+      len = ReadLength<uint16_t>();
+    } else if (tag == 0xdb) {
+      len = ReadLength<uint32_t>();
+    } else {
+      SetError(kType);
+      return std::string_view{};
+    }
+    auto data = ReadBytes(len);
+    return {reinterpret_cast<const char*>(data.data()), data.size()};
+  }
+
+  /**
+   * Reads a binary blob.  The returned span points into the input buffer.
+   */
+  std::span<const uint8_t> ReadBin() {
+    if (!Ensure(1)) {
+      return {};
+    }
+    uint8_t tag = *m_pos;
+    uint32_t len;
+    if (tag == 0xc4) {
+      len = ReadLength<uint8_t>();
+    } else if (tag == 0xc5) {
+      len = ReadLength<uint16_t>();
+    } else if (tag == 0xc6) {
+      len = ReadLength<uint32_t>();
+    } else {
+      SetError(kType);
+      return std::span<const uint8_t>{};
+    }
+    return ReadBytes(len);
+  }
+
+ private:
+  struct Number {
+    enum Kind { kNone, kUint, kInt, kFloat, kDouble } kind = kNone;
+    union {
+      uint64_t u = 0;
+      int64_t i;
+      float f;
+      double d;
+    };
+  };
+
+  bool Ensure(size_t n) {
+    if (m_error != kOk) {
+      return false;
+    }
+    if (static_cast<size_t>(m_end - m_pos) < n) {
+      SetError(kInvalid);
+      return false;
+    }
+    return true;
+  }
+
+  template <typename T>
+  uint32_t ReadLength() {
+    if (!Ensure(1 + sizeof(T))) {
+      return 0;
+    }
+    uint32_t len;
+    if constexpr (sizeof(T) == 1) {
+      len = m_pos[1];
+    } else if constexpr (sizeof(T) == 2) {
+      len = wpi::support::endian::read16be(m_pos + 1);
+    } else {
+      len = wpi::support::endian::read32be(m_pos + 1);
+    }
+    m_pos += 1 + sizeof(T);
+    return len;
+  }
+
+  std::span<const uint8_t> ReadBytes(uint32_t len) {
+    if (!Ensure(len)) {
+      return {};
+    }
+    std::span<const uint8_t> rv{m_pos, len};
+    m_pos += len;
+    return rv;
+  }
+
+  Number ReadNumber() {
+    Number num;
+    if (!Ensure(1)) {
+      return num;
+    }
+    uint8_t tag = *m_pos;
+    if (tag <= 0x7f) {
+      ++m_pos;
+      num.kind = Number::kUint;
+      num.u = tag;
+      return num;
+    } else if (tag >= 0xe0) {
+      ++m_pos;
+      num.kind = Number::kInt;
+      num.i = static_cast<int8_t>(tag);
+      return num;
+    }
+    namespace endian = wpi::support::endian;
+    switch (tag) {
+      case 0xca:
+        if (Ensure(5)) {
+          num.kind = Number::kFloat;
+          num.f = std::bit_cast<float>(endian::read32be(m_pos + 1));
+          m_pos += 5;
+        }
+        break;
+      case 0xcb:
+        if (Ensure(9)) {
+          num.kind = Number::kDouble;
+          num.d = std::bit_cast<double>(endian::read64be(m_pos + 1));
+          m_pos += 9;
+        }
+        break;
+      case 0xcc:
+        if (Ensure(2)) {
+          num.kind = Number::kUint;
+          num.u = m_pos[1];
+          m_pos += 2;
+        }
+        break;
+      case 0xcd:
+        if (Ensure(3)) {
+          num.kind = Number::kUint;
+          num.u = endian::read16be(m_pos + 1);
+          m_pos += 3;
+        }
+        break;
+      case 0xce:
+        if (Ensure(5)) {
+          num.kind = Number::kUint;
+          num.u = endian::read32be(m_pos + 1);
+          m_pos += 5;
+        }
+        break;
+      case 0xcf:
+        if (Ensure(9)) {
+          num.kind = Number::kUint;
+          num.u = endian::read64be(m_pos + 1);
+          m_pos += 9;
+        }
+        break;
+      case 0xd0:
+        if (Ensure(2)) {
+          num.kind = Number::kInt;
+          num.i = static_cast<int8_t>(m_pos[1]);
+          m_pos += 2;
+        }
+        break;
+      case 0xd1:
+        if (Ensure(3)) {
+          num.kind = Number::kInt;
+          num.i = static_cast<int16_t>(endian::read16be(m_pos + 1));
+          m_pos += 3;
+        }
+        break;
+      case 0xd2:
+        if (Ensure(5)) {
+          num.kind = Number::kInt;
+          num.i = static_cast<int32_t>(endian::read32be(m_pos + 1));
+          m_pos += 5;
+        }
+        break;
+      case 0xd3:
+        if (Ensure(9)) {
+          num.kind = Number::kInt;
+          num.i = static_cast<int64_t>(endian::read64be(m_pos + 1));
+          m_pos += 9;
+        }
+        break;
+      default:
+        SetError(kType);
+        break;
+    }
+    return num;
+  }
+
+  const uint8_t* m_pos;
+  const uint8_t* m_end;
+  Error m_error = kOk;
+};
+
+/**
+ * Streaming MessagePack writer to a raw_ostream.  Output is staged in a
+ * fixed-size internal buffer and written to the stream when it fills or when
+ * Flush() is called; the destructor does not flush.
+ *
+ * Integers are written using the smallest possible encoding, and floats and
+ * doubles are always written at full width, matching mpack.
+ */
+class MsgPackWriter {
+ public:
+  explicit MsgPackWriter(wpi::raw_ostream& os) : m_os{os} {}
+
+  MsgPackWriter(const MsgPackWriter&) = delete;
+  MsgPackWriter& operator=(const MsgPackWriter&) = delete;
+
+  void Flush() {
+    if (m_len != 0) {
+      m_os.write(m_buf, m_len);
+      m_len = 0;
+    }
+  }
+
+  void WriteBool(bool value) { Put(value ? 0xc3 : 0xc2); }
+
+  void WriteInt(int64_t value) {
+    namespace endian = wpi::support::endian;
+    uint8_t* buf = Reserve(9);
+    if (value >= -32 && value <= 127) {
+      buf[0] = static_cast<uint8_t>(value);
+      m_len += 1;
+    } else if (value > 127) {
+      if (value <= std::numeric_limits<uint8_t>::max()) {
+        buf[0] = 0xcc;
+        buf[1] = static_cast<uint8_t>(value);
+        m_len += 2;
+      } else if (value <= std::numeric_limits<uint16_t>::max()) {
+        buf[0] = 0xcd;
+        endian::write16be(buf + 1, value);
+        m_len += 3;
+      } else if (value <= std::numeric_limits<uint32_t>::max()) {
+        buf[0] = 0xce;
+        endian::write32be(buf + 1, value);
+        m_len += 5;
+      } else {
+        buf[0] = 0xcf;
+        endian::write64be(buf + 1, value);
+        m_len += 9;
+      }
+    } else if (value >= std::numeric_limits<int8_t>::min()) {
+      buf[0] = 0xd0;
+      buf[1] = static_cast<uint8_t>(value);
+      m_len += 2;
+    } else if (value >= std::numeric_limits<int16_t>::min()) {
+      buf[0] = 0xd1;
+      endian::write16be(buf + 1, static_cast<uint16_t>(value));
+      m_len += 3;
+    } else if (value >= std::numeric_limits<int32_t>::min()) {
+      buf[0] = 0xd2;
+      endian::write32be(buf + 1, static_cast<uint32_t>(value));
+      m_len += 5;
+    } else {
+      buf[0] = 0xd3;
+      endian::write64be(buf + 1, static_cast<uint64_t>(value));
+      m_len += 9;
+    }
+  }
+
+  void WriteFloat(float value) {
+    uint8_t* buf = Reserve(5);
+    buf[0] = 0xca;
+    wpi::support::endian::write32be(buf + 1, std::bit_cast<uint32_t>(value));
+    m_len += 5;
+  }
+
+  void WriteDouble(double value) {
+    uint8_t* buf = Reserve(9);
+    buf[0] = 0xcb;
+    wpi::support::endian::write64be(buf + 1, std::bit_cast<uint64_t>(value));
+    m_len += 9;
+  }
+
+  /**
+   * Writes an array header.  The caller must follow this with count values.
+   */
+  bool WriteArray(size_t count) {
+    if (count <= 15) {
+      Put(0x90 | count);
+      return true;
+    }
+    return WriteLength(0, 0xdc, 0xdd, count);
+  }
+
+  bool WriteStr(std::string_view str) {
+    if (!WriteStrHeader(str.size())) {
+      return false;
+    }
+    WriteBytes(str.data(), str.size());
+    return true;
+  }
+
+  bool WriteBin(std::span<const uint8_t> data) {
+    if (!WriteBinHeader(data.size())) {
+      return false;
+    }
+    WriteBytes(data.data(), data.size());
+    return true;
+  }
+
+  /**
+   * Writes a string header.  The caller must follow this with len bytes.
+   */
+  bool WriteStrHeader(size_t len) {
+    if (len <= 31) {
+      Put(0xa0 | len);
+      return true;
+    }
+    return WriteLength(0xd9, 0xda, 0xdb, len);
+  }
+
+  /**
+   * Writes a binary header.  The caller must follow this with len bytes.
+   */
+  bool WriteBinHeader(size_t len) { return WriteLength(0xc4, 0xc5, 0xc6, len); }
+
+ private:
+  uint8_t* Reserve(size_t n) {
+    if (m_len + n > sizeof(m_buf)) {
+      Flush();
+    }
+    return reinterpret_cast<uint8_t*>(m_buf + m_len);
+  }
+
+  void Put(unsigned int byte) {
+    *Reserve(1) = static_cast<uint8_t>(byte);
+    ++m_len;
+  }
+
+  // tag8 of 0 means there is no 8-bit length form
+  bool WriteLength(uint8_t tag8, uint8_t tag16, uint8_t tag32, size_t len) {
+    uint8_t* buf = Reserve(5);
+    if (tag8 != 0 && len <= std::numeric_limits<uint8_t>::max()) {
+      buf[0] = tag8;
+      buf[1] = static_cast<uint8_t>(len);
+      m_len += 2;
+    } else if (len <= std::numeric_limits<uint16_t>::max()) {
+      buf[0] = tag16;
+      wpi::support::endian::write16be(buf + 1, len);
+      m_len += 3;
+    } else if (len <= std::numeric_limits<uint32_t>::max()) {
+      buf[0] = tag32;
+      wpi::support::endian::write32be(buf + 1, len);
+      m_len += 5;
+    } else {
+      return false;
+    }
+    return true;
+  }
+
+  template <typename T>
+  void WriteBytes(const T* data, size_t len) {
+    if (m_len + len <= sizeof(m_buf)) {
+      std::memcpy(m_buf + m_len, data, len);
+      m_len += len;
+    } else {
+      // large payloads bypass the staging buffer
+      Flush();
+      m_os.write(reinterpret_cast<const char*>(data), len);
+    }
+  }
+
+  wpi::raw_ostream& m_os;
+  size_t m_len = 0;
+  char m_buf[128];
+};
+
+namespace detail {
+
+template <typename T, typename ReadElem>
+inline void ReadArrayValue(MsgPackReader& reader, Value* out,
+                           ReadElem readElem) {
+  uint32_t len = reader.ReadArray();
+  // every element takes at least one byte; reject impossible lengths before
+  // sizing any storage from them
+  if (len > reader.GetRemaining()) {
+    reader.SetError(MsgPackReader::kInvalid);
+    return;
+  }
+  // decode into stack storage; the Make functions copy into a single
+  // exactly-sized allocation
+  wpi::SmallVector<T, 64> arr;
+  arr.resize_for_overwrite(len);
+  for (auto&& elem : arr) {
+    elem = readElem();
+  }
+  if (reader.GetError() != MsgPackReader::kOk) {
+    return;
+  }
+  if constexpr (std::same_as<T, int>) {
+    *out = Value::MakeBooleanArray(std::span<const int>{arr}, 1);
+  } else if constexpr (std::same_as<T, int64_t>) {
+    *out = Value::MakeIntegerArray(std::span<const int64_t>{arr}, 1);
+  } else if constexpr (std::same_as<T, float>) {
+    *out = Value::MakeFloatArray(std::span<const float>{arr}, 1);
+  } else {
+    *out = Value::MakeDoubleArray(std::span<const double>{arr}, 1);
+  }
+}
+
+}  // namespace detail
+
+/**
+ * Reads the value portion of a binary message.  The value's time is set to 1;
+ * the caller is expected to set the actual time.
+ *
+ * @param reader reader
+ * @param type NT4 binary type code
+ * @param out value (output); only valid if the reader has no error
+ * @return false if the type code is not recognized (nothing is read)
+ */
+inline bool ReadBinaryValue(MsgPackReader& reader, int type, Value* out) {
+  switch (type) {
+    case 0:  // boolean
+      *out = Value::MakeBoolean(reader.ReadBool(), 1);
+      break;
+    case 2:  // integer
+      *out = Value::MakeInteger(reader.ReadInt(), 1);
+      break;
+    case 3:  // float
+      *out = Value::MakeFloat(reader.ReadFloat(), 1);
+      break;
+    case 1:  // double
+      *out = Value::MakeDouble(reader.ReadDouble(), 1);
+      break;
+    case 4: {  // string
+      auto str = reader.ReadStr();
+      if (reader.GetError() == MsgPackReader::kOk) {
+        *out = Value::MakeString(str, 1);
+      }
+      break;
+    }
+    case 5: {  // raw
+      auto data = reader.ReadBin();
+      if (reader.GetError() == MsgPackReader::kOk) {
+        *out = Value::MakeRaw(data, 1);
+      }
+      break;
+    }
+    case 16:  // boolean array
+      detail::ReadArrayValue<int>(reader, out,
+                                  [&] { return reader.ReadBool() ? 1 : 0; });
+      break;
+    case 18:  // integer array
+      detail::ReadArrayValue<int64_t>(reader, out,
+                                      [&] { return reader.ReadInt(); });
+      break;
+    case 19:  // float array
+      detail::ReadArrayValue<float>(reader, out,
+                                    [&] { return reader.ReadFloat(); });
+      break;
+    case 17:  // double array
+      detail::ReadArrayValue<double>(reader, out,
+                                     [&] { return reader.ReadDouble(); });
+      break;
+    case 20: {  // string array
+      uint32_t len = reader.ReadArray();
+      if (len > reader.GetRemaining()) {
+        reader.SetError(MsgPackReader::kInvalid);
+        break;
+      }
+      std::vector<std::string> arr;
+      arr.reserve(len);
+      for (uint32_t i = 0; i < len; ++i) {
+        auto str = reader.ReadStr();
+        if (reader.GetError() != MsgPackReader::kOk) {
+          break;
+        }
+        arr.emplace_back(str);
+      }
+      if (reader.GetError() == MsgPackReader::kOk) {
+        *out = Value::MakeStringArray(std::move(arr), 1);
+      }
+      break;
+    }
+    default:
+      return false;
+  }
+  return true;
+}
+
+/**
+ * Writes the type code and value portion of a binary message.
+ *
+ * @param writer writer
+ * @param value value
+ * @return false if the value type is not supported or is too large to encode
+ */
+inline bool WriteBinaryValue(MsgPackWriter& writer, const Value& value) {
+  switch (value.type()) {
+    case NT_BOOLEAN:
+      writer.WriteInt(0);
+      writer.WriteBool(value.GetBoolean());
+      return true;
+    case NT_INTEGER:
+      writer.WriteInt(2);
+      writer.WriteInt(value.GetInteger());
+      return true;
+    case NT_FLOAT:
+      writer.WriteInt(3);
+      writer.WriteFloat(value.GetFloat());
+      return true;
+    case NT_DOUBLE:
+      writer.WriteInt(1);
+      writer.WriteDouble(value.GetDouble());
+      return true;
+    case NT_STRING:
+      writer.WriteInt(4);
+      return writer.WriteStr(value.GetString());
+    case NT_RPC:
+    case NT_RAW:
+      writer.WriteInt(5);
+      return writer.WriteBin(value.GetRaw());
+    case NT_BOOLEAN_ARRAY: {
+      auto v = value.GetBooleanArray();
+      writer.WriteInt(16);
+      if (!writer.WriteArray(v.size())) {
+        return false;
+      }
+      for (auto val : v) {
+        writer.WriteBool(val);
+      }
+      return true;
+    }
+    case NT_INTEGER_ARRAY: {
+      auto v = value.GetIntegerArray();
+      writer.WriteInt(18);
+      if (!writer.WriteArray(v.size())) {
+        return false;
+      }
+      for (auto val : v) {
+        writer.WriteInt(val);
+      }
+      return true;
+    }
+    case NT_FLOAT_ARRAY: {
+      auto v = value.GetFloatArray();
+      writer.WriteInt(19);
+      if (!writer.WriteArray(v.size())) {
+        return false;
+      }
+      for (auto val : v) {
+        writer.WriteFloat(val);
+      }
+      return true;
+    }
+    case NT_DOUBLE_ARRAY: {
+      auto v = value.GetDoubleArray();
+      writer.WriteInt(17);
+      if (!writer.WriteArray(v.size())) {
+        return false;
+      }
+      for (auto val : v) {
+        writer.WriteDouble(val);
+      }
+      return true;
+    }
+    case NT_STRING_ARRAY: {
+      auto v = value.GetStringArray();
+      writer.WriteInt(20);
+      if (!writer.WriteArray(v.size())) {
+        return false;
+      }
+      for (auto&& val : v) {
+        if (!writer.WriteStr(val)) {
+          return false;
+        }
+      }
+      return true;
+    }
+    default:
+      return false;
+  }
+}
+
+}  // namespace nt::net
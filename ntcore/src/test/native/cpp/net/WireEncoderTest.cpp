@@ -291,4 +291,27 @@ TEST_F(WireEncoderBinaryTest, StringArray) {
                                "bye"_us));
 }
 
+TEST_F(WireEncoderBinaryTest, StringHeader) {
+  auto value = Value::MakeString("hello");
+  ASSERT_TRUE(net::WireEncodeBinaryHeader(os, 5, 6, value));
+  ASSERT_THAT(out, wpi::SpanEq("\x94\x05\x06\x04\xa5"_us));
+  ASSERT_THAT(net::WireBinaryPayload(value), wpi::SpanEq("hello"_us));
+}
+
+TEST_F(WireEncoderBinaryTest, RawHeader) {
+  std::vector<uint8_t> data(70000, 0x55);
+  auto value = Value::MakeRaw(data);
+  ASSERT_TRUE(net::WireEncodeBinaryHeader(os, 5, 6, value));
+  ASSERT_THAT(out, wpi::SpanEq("\x94\x05\x06\x05\xc6\x00\x01\x11\x70"_us));
+  ASSERT_EQ(net::WireBinaryPayload(value).data(), value.GetRaw().data());
+  ASSERT_EQ(net::WireBinaryPayload(value).size(), data.size());
+}
+
+TEST_F(WireEncoderBinaryTest, HeaderNoPayload) {
+  auto value = Value::MakeInteger(7);
+  ASSERT_TRUE(net::WireEncodeBinaryHeader(os, 5, 6, value));
+  ASSERT_THAT(out, wpi::SpanEq("\x94\x05\x06\x02\x07"_us));
+  ASSERT_TRUE(net::WireBinaryPayload(value).empty());
+}
+
 }  // namespace nt
@@ -0,0 +1,584 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include <stdint.h>
+
+#include <bit>
+#include <limits>
+#include <random>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <wpi/Endian.h>
+#include <wpi/SpanExtras.h>
+#include <wpi/mpack.h>
+#include <wpi/raw_ostream.h>
+
+#include "net/WireDecoder.h"
+#include "net/WireEncoder.h"
+#include "net/WireMsgPack.h"
+#include "networktables/NetworkTableValue.h"
+
+// These tests check the specialized binary message codec against the mpack
+// based implementation it replaced.
+
+using namespace mpack;
+
+namespace nt {
+
+namespace {
+
+// Reference decoder using mpack.
+bool MpackDecodeBinary(std::span<const uint8_t>* in, int64_t* outId,
+                       Value* outValue) {
+  mpack_reader_t reader;
+  mpack_reader_init_data(&reader, reinterpret_cast<const char*>(in->data()),
+                         in->size());
+  mpack_expect_array_match(&reader, 4);
+  *outId = mpack_expect_i64(&reader);
+  auto time = mpack_expect_i64(&reader);
+  int type = mpack_expect_int(&reader);
+  auto readArray = [&](auto&& arr, auto readElem) {
+    auto length = mpack_expect_array(&reader);
+    for (uint32_t i = 0; i < length; ++i) {
+      arr.emplace_back(readElem());
+      if (mpack_reader_error(&reader) != mpack_ok) {
+        break;
+      }
+    }
+    mpack_done_array(&reader);
+    return mpack_reader_error(&reader) == mpack_ok;
+  };
+  switch (type) {
+    case 0:
+      *outValue = Value::MakeBoolean(mpack_expect_bool(&reader), 1);
+      break;
+    case 2:
+      *outValue = Value::MakeInteger(mpack_expect_i64(&reader), 1);
+      break;
+    case 3:
+      *outValue = Value::MakeFloat(mpack_expect_float(&reader), 1);
+      break;
+    case 1:
+      *outValue = Value::MakeDouble(mpack_expect_double(&reader), 1);
+      break;
+    case 4: {
+      auto length = mpack_expect_str(&reader);
+      auto data = mpack_read_bytes_inplace(&reader, length);
+      if (mpack_reader_error(&reader) == mpack_ok) {
+        *outValue = Value::MakeString({data, length}, 1);
+      }
+      mpack_done_str(&reader);
+      break;
+    }
+    case 5: {
+      auto length = mpack_expect_bin(&reader);
+      auto data = mpack_read_bytes_inplace(&reader, length);
+      if (mpack_reader_error(&reader) == mpack_ok) {
+        *outValue =
+            Value::MakeRaw({reinterpret_cast<const uint8_t*>(data), length}, 1);
+      }
+      mpack_done_bin(&reader);
+      break;
+    }
+    case 16: {
+      std::vector<int> arr;
+      if (readArray(arr, [&] { return mpack_expect_bool(&reader); })) {
+        *outValue = Value::MakeBooleanArray(std::move(arr), 1);
+      }
+      break;
+    }
+    case 18: {
+      std::vector<int64_t> arr;
+      if (readArray(arr, [&] { return mpack_expect_i64(&reader); })) {
+        *outValue = Value::MakeIntegerArray(std::move(arr), 1);
+      }
+      break;
+    }
+    case 19: {
+      std::vector<float> arr;
+      if (readArray(arr, [&] { return mpack_expect_float(&reader); })) {
+        *outValue = Value::MakeFloatArray(std::move(arr), 1);
+      }
+      break;
+    }
+    case 17: {
+      std::vector<double> arr;
+      if (readArray(arr, [&] { return mpack_expect_double(&reader); })) {
+        *outValue = Value::MakeDoubleArray(std::move(arr), 1);
+      }
+      break;
+    }
+    case 20: {
+      std::vector<std::string> arr;
+      if (readArray(arr, [&] {
+            auto length = mpack_expect_str(&reader);
+            auto data = mpack_read_bytes_inplace(&reader, length);
+            std::string str;
+            if (mpack_reader_error(&reader) == mpack_ok) {
+              str.assign(data, length);
+            }
+            mpack_done_str(&reader);
+            return str;
+          })) {
+        *outValue = Value::MakeStringArray(std::move(arr), 1);
+      }
+      break;
+    }
+    default:
+      return false;
+  }
+  mpack_done_array(&reader);
+  if (mpack_reader_destroy(&reader) != mpack_ok) {
+    return false;
+  }
+  outValue->SetServerTime(time);
+  outValue->SetTime(time);
+  *in = wpi::drop_front(*in,
+                        in->size() - mpack_reader_remaining(&reader, nullptr));
+  return true;
+}
+
+// Reference encoder using mpack.
+std::vector<uint8_t> MpackEncodeBinary(int64_t id, int64_t time,
+                                       const Value& value) {
+  std::vector<uint8_t> out;
+  char* buf;
+  size_t size;
+  mpack_writer_t writer;
+  mpack_writer_init_growable(&writer, &buf, &size);
+  mpack_start_array(&writer, 4);
+  mpack_write_int(&writer, id);
+  mpack_write_int(&writer, time);
+  switch (value.type()) {
+    case NT_BOOLEAN:
+      mpack_write_u8(&writer, 0);
+      mpack_write_bool(&writer, value.GetBoolean());
+      break;
+    case NT_INTEGER:
+      mpack_write_u8(&writer, 2);
+      mpack_write_int(&writer, value.GetInteger());
+      break;
+    case NT_FLOAT:
+      mpack_write_u8(&writer, 3);
+      mpack_write_float(&writer, value.GetFloat());
+      break;
+    case NT_DOUBLE:
+      mpack_write_u8(&writer, 1);
+      mpack_write_double(&writer, value.GetDouble());
+      break;
+    case NT_STRING: {
+      auto v = value.GetString();
+      mpack_write_u8(&writer, 4);
+      mpack_write_str(&writer, v.data(), v.size());
+      break;
+    }
+    case NT_RAW: {
+      auto v = value.GetRaw();
+      mpack_write_u8(&writer, 5);
+      mpack_write_bin(&writer, reinterpret_cast<const char*>(v.data()),
+                      v.size());
+      break;
+    }
+    case NT_BOOLEAN_ARRAY:
+      mpack_write_u8(&writer, 16);
+      mpack_start_array(&writer, value.GetBooleanArray().size());
+      for (auto val : value.GetBooleanArray()) {
+        mpack_write_bool(&writer, val);
+      }
+      mpack_finish_array(&writer);
+      break;
+    case NT_INTEGER_ARRAY:
+      mpack_write_u8(&writer, 18);
+      mpack_start_array(&writer, value.GetIntegerArray().size());
+      for (auto val : value.GetIntegerArray()) {
+        mpack_write_int(&writer, val);
+      }
+      mpack_finish_array(&writer);
+      break;
+    case NT_FLOAT_ARRAY:
+      mpack_write_u8(&writer, 19);
+      mpack_start_array(&writer, value.GetFloatArray().size());
+      for (auto val : value.GetFloatArray()) {
+        mpack_write_float(&writer, val);
+      }
+      mpack_finish_array(&writer);
+      break;
+    case NT_DOUBLE_ARRAY:
+      mpack_write_u8(&writer, 17);
+      mpack_start_array(&writer, value.GetDoubleArray().size());
+      for (auto val : value.GetDoubleArray()) {
+        mpack_write_double(&writer, val);
+      }
+      mpack_finish_array(&writer);
+      break;
+    case NT_STRING_ARRAY:
+      mpack_write_u8(&writer, 20);
+      mpack_start_array(&writer, value.GetStringArray().size());
+      for (auto&& val : value.GetStringArray()) {
+        mpack_write_str(&writer, val.data(), val.size());
+      }
+      mpack_finish_array(&writer);
+      break;
+    default:
+      break;
+  }
+  mpack_finish_array(&writer);
+  if (mpack_writer_destroy(&writer) == mpack_ok) {
+    out.assign(buf, buf + size);
+    MPACK_FREE(buf);
+  }
+  return out;
+}
+
+std::vector<uint8_t> EncodeBinary(int64_t id, int64_t time,
+                                  const Value& value) {
+  std::vector<uint8_t> out;
+  wpi::raw_uvector_ostream os{out};
+  net::WireEncodeBinary(os, id, time, value);
+  return out;
+}
+
+// Generates random messages, using any of the valid MessagePack encodings for
+// each element rather than just the shortest one.
+class MessageGenerator {
+ public:
+  explicit MessageGenerator(uint32_t seed) : m_rng{seed} {}
+
+  std::vector<uint8_t> Generate() {
+    m_out.clear();
+    Array(4);
+    Int(RandomInt());
+    Int(RandomInt());
+    static constexpr int kTypes[] = {0, 1, 2, 3, 4, 5, 16, 17, 18, 19, 20};
+    int type = kTypes[Uniform(0, std::size(kTypes) - 1)];
+    Int(type);
+    switch (type) {
+      case 0:
+        Bool();
+        break;
+      case 1:
+      case 3:
+        Number();
+        break;
+      case 2:
+        Int(RandomInt());
+        break;
+      case 4:
+        Str();
+        break;
+      case 5:
+        Bin();
+        break;
+      default: {
+        int len = RandomLength();
+        Array(len);
+        for (int i = 0; i < len; ++i) {
+          switch (type) {
+            case 16:
+              Bool();
+              break;
+            case 17:
+            case 19:
+              Number();
+              break;
+            case 18:
+              Int(RandomInt());
+              break;
+            case 20:
+              Str();
+              break;
+          }
+        }
+        break;
+      }
+    }
+    return m_out;
+  }
+
+  // Randomly corrupts a message: flips bytes, truncates, or appends data.
+  void Mutate(std::vector<uint8_t>& msg) {
+    switch (Uniform(0, 3)) {
+      case 0:
+        if (!msg.empty()) {
+          msg[Uniform(0, msg.size() - 1)] = Uniform(0, 255);
+        }
+        break;
+      case 1:
+        msg.resize(Uniform(0, msg.size()));
+        break;
+      case 2:
+        for (int i = Uniform(1, 8); i > 0; --i) {
+          msg.push_back(Uniform(0, 255));
+        }
+        break;
+      default:
+        break;
+    }
+  }
+
+  int64_t RandomInt() {
+    switch (Uniform(0, 3)) {
+      case 0:
+        return Uniform(-40, 140);
+      case 1:
+        return Uniform(-70000, 70000);
+      default:
+        return std::uniform_int_distribution<int64_t>{}(m_rng);
+    }
+  }
+
+  int64_t Uniform(int64_t lo, int64_t hi) {
+    return std::uniform_int_distribution<int64_t>{lo, hi}(m_rng);
+  }
+
+ private:
+  int RandomLength() {
+    return Uniform(0, 9) == 0 ? Uniform(16, 300) : Uniform(0, 15);
+  }
+
+  void Byte(uint8_t b) { m_out.push_back(b); }
+
+  void BE(uint64_t v, int n) {
+    for (int i = n - 1; i >= 0; --i) {
+      Byte(static_cast<uint8_t>(v >> (i * 8)));
+    }
+  }
+
+  void Bool() { Byte(Uniform(0, 1) ? 0xc3 : 0xc2); }
+
+  void Int(int64_t v) {
+    std::vector<int> choices;
+    if (v >= -32 && v <= 127) {
+      choices.push_back(0);
+    }
+    if (v >= 0) {
+      for (int w : {1, 2, 4, 8}) {
+        if (w == 8 || static_cast<uint64_t>(v) < (1ull << (w * 8))) {
+          choices.push_back(0x10 | w);
+        }
+      }
+    }
+    for (int w : {1, 2, 4, 8}) {
+      if (w == 8 || (v >= -(1ll << (w * 8 - 1)) && v < (1ll << (w * 8 - 1)))) {
+        choices.push_back(0x20 | w);
+      }
+    }
+    int c = choices[Uniform(0, choices.size() - 1)];
+    if (c == 0) {
+      Byte(static_cast<uint8_t>(v));
+      return;
+    }
+    int w = c & 0xf;
+    int idx = w == 1 ? 0 : w == 2 ? 1 : w == 4 ? 2 : 3;
+    Byte(((c & 0x10) ? 0xcc : 0xd0) + idx);
+    BE(static_cast<uint64_t>(v), w);
+  }
+
+  void Number() {
+    switch (Uniform(0, 2)) {
+      case 0:
+        Int(RandomInt());
+        break;
+      case 1: {
+        float f = std::uniform_real_distribution<float>{-1e6, 1e6}(m_rng);
+        Byte(0xca);
+        BE(std::bit_cast<uint32_t>(f), 4);
+        break;
+      }
+      default: {
+        double d = std::uniform_real_distribution<double>{-1e9, 1e9}(m_rng);
+        Byte(0xcb);
+        BE(std::bit_cast<uint64_t>(d), 8);
+        break;
+      }
+    }
+  }
+
+  void Length(int len, int fixBase, int fixMax, int tag8, int tag16,
+              int tag32) {
+    std::vector<int> choices;
+    if (fixBase >= 0 && len <= fixMax) {
+      choices.push_back(0);
+    }
+    if (tag8 >= 0 && len <= 0xff) {
+      choices.push_back(1);
+    }
+    if (len <= 0xffff) {
+      choices.push_back(2);
+    }
+    choices.push_back(4);
+    switch (choices[Uniform(0, choices.size() - 1)]) {
+      case 0:
+        Byte(fixBase | len);
+        break;
+      case 1:
+        Byte(tag8);
+        BE(len, 1);
+        break;
+      case 2:
+        Byte(tag16);
+        BE(len, 2);
+        break;
+      default:
+        Byte(tag32);
+        BE(len, 4);
+        break;
+    }
+  }
+
+  void Array(int len) { Length(len, 0x90, 15, -1, 0xdc, 0xdd); }
+
+  void Str() {
+    int len = Uniform(0, 3) == 0 ? Uniform(32, 300) : Uniform(0, 31);
+    Length(len, 0xa0, 31, 0xd9, 0xda, 0xdb);
+    for (int i = 0; i < len; ++i) {
+      Byte(Uniform(0x20, 0x7e));
+    }
+  }
+
+  void Bin() {
+    int len = Uniform(0, 300);
+    Length(len, -1, 0, 0xc4, 0xc5, 0xc6);
+    for (int i = 0; i < len; ++i) {
+      Byte(Uniform(0, 255));
+    }
+  }
+
+  std::mt19937 m_rng;
+  std::vector<uint8_t> m_out;
+};
+
+void ExpectSameDecode(std::span<const uint8_t> msg) {
+  std::span<const uint8_t> refIn = msg;
+  int64_t refId = 0;
+  Value refValue;
+  bool refOk = MpackDecodeBinary(&refIn, &refId, &refValue);
+
+  std::span<const uint8_t> in = msg;
+  int64_t id = 0;
+  Value value;
+  std::string error;
+  bool ok = net::WireDecodeBinary(&in, &id, &value, &error, 0);
+
+  ASSERT_EQ(ok, refOk) << error;
+  if (!ok) {
+    return;
+  }
+  EXPECT_EQ(id, refId);
+  EXPECT_EQ(in.size(), refIn.size());
+  EXPECT_EQ(value.type(), refValue.type());
+  EXPECT_EQ(value.server_time(), refValue.server_time());
+  EXPECT_EQ(value.time(), refValue.time());
+  // compare encodings rather than values so NaN payloads compare equal
+  EXPECT_EQ(EncodeBinary(0, 0, value), EncodeBinary(0, 0, refValue));
+}
+
+}  // namespace
+
+TEST(WireMsgPackTest, EncodeMatchesMpack) {
+  MessageGenerator gen{1};
+  for (int i = 0; i < 2000; ++i) {
+    auto msg = gen.Generate();
+    std::span<const uint8_t> in = msg;
+    int64_t id;
+    Value value;
+    ASSERT_TRUE(MpackDecodeBinary(&in, &id, &value));
+    EXPECT_EQ(EncodeBinary(id, value.server_time(), value),
+              MpackEncodeBinary(id, value.server_time(), value));
+  }
+}
+
+TEST(WireMsgPackTest, EncodeLarge) {
+  std::vector<uint8_t> raw(70000, 0x5a);
+  std::vector<std::string> strs{"a", std::string(300, 'b'), "c"};
+  std::vector<double> doubles(20, 1.5);
+  for (auto&& value :
+       {Value::MakeRaw(raw), Value::MakeString(std::string(300, 'x')),
+        Value::MakeStringArray(strs), Value::MakeDoubleArray(doubles),
+        Value::MakeInteger(std::numeric_limits<int64_t>::min())}) {
+    EXPECT_EQ(EncodeBinary(-1, 1234567890123, value),
+              MpackEncodeBinary(-1, 1234567890123, value));
+  }
+}
+
+TEST(WireMsgPackTest, DecodeMatchesMpack) {
+  MessageGenerator gen{2};
+  for (int i = 0; i < 5000; ++i) {
+    auto msg = gen.Generate();
+    ExpectSameDecode(msg);
+  }
+}
+
+TEST(WireMsgPackTest, DecodeFuzz) {
+  MessageGenerator gen{3};
+  for (int i = 0; i < 20000; ++i) {
+    auto msg = gen.Generate();
+    gen.Mutate(msg);
+    ExpectSameDecode(msg);
+  }
+}
+
+TEST(WireMsgPackTest, DecodeRandomBytes) {
+  MessageGenerator gen{4};
+  std::vector<uint8_t> msg;
+  for (int i = 0; i < 20000; ++i) {
+    msg.clear();
+    // start with a valid header most of the time to get past the array check
+    if (gen.Uniform(0, 3) != 0) {
+      msg.push_back(0x94);
+    }
+    for (int j = gen.Uniform(0, 24); j > 0; --j) {
+      msg.push_back(gen.Uniform(0, 255));
+    }
+    ExpectSameDecode(msg);
+  }
+}
+
+TEST(WireMsgPackTest, DecodeConsecutive) {
+  std::vector<uint8_t> buf = EncodeBinary(1, 2, Value::MakeDouble(1.5));
+  auto second = EncodeBinary(3, 4, Value::MakeStringArray({"a", "b"}));
+  buf.insert(buf.end(), second.begin(), second.end());
+
+  std::span<const uint8_t> in = buf;
+  int64_t id;
+  Value value;
+  std::string error;
+  ASSERT_TRUE(net::WireDecodeBinary(&in, &id, &value, &error, 10));
+  EXPECT_EQ(id, 1);
+  EXPECT_EQ(value, Value::MakeDouble(1.5));
+  EXPECT_EQ(value.server_time(), 2);
+  EXPECT_EQ(value.time(), 12);
+  EXPECT_EQ(in.size(), second.size());
+  ASSERT_TRUE(net::WireDecodeBinary(&in, &id, &value, &error, 10));
+  EXPECT_EQ(id, 3);
+  EXPECT_EQ(value, Value::MakeStringArray({"a", "b"}));
+  EXPECT_TRUE(in.empty());
+}
+
+TEST(WireMsgPackTest, DecodeHugeArrayLength) {
+  // array claiming 2^32-1 elements with no data must fail without
+  // allocating storage for them
+  const uint8_t msg[] = {0x94, 0x01, 0x02, 0x11, 0xdd, 0xff, 0xff, 0xff, 0xff};
+  std::span<const uint8_t> in = msg;
+  int64_t id;
+  Value value;
+  std::string error;
+  EXPECT_FALSE(net::WireDecodeBinary(&in, &id, &value, &error, 0));
+  EXPECT_EQ(in.size(), sizeof(msg));
+}
+
+TEST(WireMsgPackTest, DecodeUnrecognizedType) {
+  const uint8_t msg[] = {0x94, 0x01, 0x02, 0x07, 0xc0};
+  std::span<const uint8_t> in = msg;
+  int64_t id;
+  Value value;
+  std::string error;
+  EXPECT_FALSE(net::WireDecodeBinary(&in, &id, &value, &error, 0));
+  EXPECT_EQ(error, "unrecognized type 7");
+}
+
+}  // namespace nt
@@ -23,6 +23,7 @@ def main():
         "0002-Make-serializer-public.patch",
         "0003-Make-dump_escaped-take-std-string_view.patch",
         "0004-Add-llvm-stream-support.patch",
+        "0005-Add-raw_istream-input-adapter.patch",
     ]:
         git_am(
             os.path.join(wpilib_root, "upstream_utils/json_patches", f),
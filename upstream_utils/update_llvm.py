@@ -212,6 +212,7 @@ def main():
         "0032-Fix-compilation-of-MathExtras.h-on-Windows-with-sdl.patch",
         "0033-raw_ostream-Add-SetNumBytesInBuffer.patch",
         "0034-type_traits.h-Add-is_constexpr.patch",
+        "0035-ConvertUTFWrapper-Add-SIMD-ASCII-fast-path.patch",
     ]:
         git_am(
             os.path.join(wpilib_root, "upstream_utils/llvm_patches", f),
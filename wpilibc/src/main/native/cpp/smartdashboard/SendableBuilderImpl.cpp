@@ -4,6 +4,10 @@
 
 #include "frc/smartdashboard/SendableBuilderImpl.h"
 
+#include <algorithm>
+#include <optional>
+#include <type_traits>
+
 #include <networktables/BooleanArrayTopic.h>
 #include <networktables/BooleanTopic.h>
 #include <networktables/DoubleArrayTopic.h>
@@ -24,14 +28,110 @@ using namespace frc;
 template <typename Topic>
 void SendableBuilderImpl::PropertyImpl<Topic>::Update(bool controllable,
                                                       int64_t time) {
-  if (controllable && sub && updateLocal) {
-    updateLocal(sub);
+  bool received = false;
+  if (controllable && updateLocal) {
+    received = updateLocal(sub);
+  } else if (sub) {
+    // values that cannot be applied are discarded and overwritten below
+    received = !sub.ReadQueue().empty();
   }
   if (pub && updateNetwork) {
-    updateNetwork(pub, time);
+    // if a received value was rejected or not applied, the getter returns the
+    // same value as before, but it needs to be republished to overwrite it
+    updateNetwork(pub, time, received);
   }
 }
 
+SendableBuilderImpl::PropertyArena::PropertyArena()
+    : m_stack{wpi::memory::memory_stack<>::min_block_size(512)},
+      m_start{m_stack.top()} {}
+
+SendableBuilderImpl::PropertyArena::~PropertyArena() {
+  Clear();
+}
+
+SendableBuilderImpl::PropertyArena::PropertyArena(PropertyArena&& rhs)
+    : m_stack{std::move(rhs.m_stack)},
+      m_start{rhs.m_start},
+      m_properties{std::move(rhs.m_properties)} {
+  rhs.m_properties.clear();
+}
+
+SendableBuilderImpl::PropertyArena&
+SendableBuilderImpl::PropertyArena::operator=(PropertyArena&& rhs) {
+  // properties must be destroyed before the memory backing them is released
+  Clear();
+  m_stack = std::move(rhs.m_stack);
+  m_start = rhs.m_start;
+  m_properties = std::move(rhs.m_properties);
+  rhs.m_properties.clear();
+  return *this;
+}
+
+template <typename Topic>
+SendableBuilderImpl::PropertyImpl<Topic>*
+SendableBuilderImpl::PropertyArena::New() {
+  void* mem = m_stack.allocate(sizeof(PropertyImpl<Topic>),
+                               alignof(PropertyImpl<Topic>));
+  auto prop = new (mem) PropertyImpl<Topic>;
+  m_properties.emplace_back(prop);
+  return prop;
+}
+
+void SendableBuilderImpl::PropertyArena::Clear() {
+  if (m_properties.empty()) {
+    return;
+  }
+  for (auto prop : m_properties) {
+    prop->~Property();
+  }
+  m_properties.clear();
+  m_stack.unwind(m_start);
+}
+
+// Wraps a getter so the publisher is only set when the value changes.
+template <typename Getter>
+static auto MakeUpdateNetwork(Getter getter) {
+  using Value = std::remove_cvref_t<std::invoke_result_t<Getter&>>;
+  return [getter = std::move(getter), last = std::optional<Value>{}](
+             auto& pub, int64_t time, bool force) mutable {
+    auto value = getter();
+    if (force || !last || *last != value) {
+      pub.Set(value, time);
+      last = std::move(value);
+    }
+  };
+}
+
+// Small getter variant; the getter returns a view of its buffer argument, so
+// the last published value is copied into a separate buffer for comparison.
+template <typename T, size_t Size, typename Getter>
+static auto MakeSmallUpdateNetwork(Getter getter) {
+  return [getter = std::move(getter), last = wpi::SmallVector<T, Size>{},
+          valid = false](auto& pub, int64_t time, bool force) mutable {
+    wpi::SmallVector<T, Size> buf;
+    auto value = getter(buf);
+    if (force || !valid ||
+        !std::equal(value.begin(), value.end(), last.begin(), last.end())) {
+      pub.Set(value, time);
+      last.assign(value.begin(), value.end());
+      valid = true;
+    }
+  };
+}
+
+template <typename Setter>
+static auto MakeUpdateLocal(Setter setter) {
+  return [setter = std::move(setter)](auto& sub) {
+    bool received = false;
+    for (auto&& val : sub.ReadQueue()) {
+      setter(val.value);
+      received = true;
+    }
+    return received;
+  };
+}
+
 void SendableBuilderImpl::SetTable(std::shared_ptr<nt::NetworkTable> table) {
   m_table = table;
   m_controllablePublisher = table->GetBooleanTopic(".controllable").Publish();
@@ -52,7 +152,7 @@ bool SendableBuilderImpl::IsActuator() const {
 
 void SendableBuilderImpl::Update() {
   uint64_t time = nt::Now();
-  for (auto& property : m_properties) {
+  for (auto property : m_properties.Get()) {
     property->Update(m_controllable, time);
   }
   for (auto& updateTable : m_updateTables) {
@@ -89,7 +189,7 @@ void SendableBuilderImpl::StopLiveWindowMode() {
 }
 
 void SendableBuilderImpl::ClearProperties() {
-  m_properties.clear();
+  m_properties.Clear();
 }
 
 void SendableBuilderImpl::SetSmartDashboardType(std::string_view type) {
@@ -122,31 +222,24 @@ nt::Topic SendableBuilderImpl::GetTopic(std::string_view key) {
 template <typename Topic, typename Getter, typename Setter>
 void SendableBuilderImpl::AddPropertyImpl(Topic topic, Getter getter,
                                           Setter setter) {
-  auto prop = std::make_unique<PropertyImpl<Topic>>();
+  auto prop = m_properties.New<Topic>();
   if (getter) {
     prop->pub = topic.Publish();
-    prop->updateNetwork = [=](auto& pub, int64_t time) {
-      pub.Set(getter(), time);
-    };
+    prop->updateNetwork = MakeUpdateNetwork(std::move(getter));
   }
+  // read-only properties are subscribed too, so writes from other publishers
+  // are seen and overwritten
+  prop->sub = topic.Subscribe({}, {.excludePublisher = prop->pub.GetHandle()});
   if (setter) {
-    prop->sub =
-        topic.Subscribe({}, {.excludePublisher = prop->pub.GetHandle()});
-    prop->updateLocal = [=](auto& sub) {
-      for (auto&& val : sub.ReadQueue()) {
-        setter(val.value);
-      }
-    };
+    prop->updateLocal = MakeUpdateLocal(std::move(setter));
   }
-  m_properties.emplace_back(std::move(prop));
 }
 
 template <typename Topic, typename Value>
 void SendableBuilderImpl::PublishConstImpl(Topic topic, Value value) {
-  auto prop = std::make_unique<PropertyImpl<Topic>>();
+  auto prop = m_properties.New<Topic>();
   prop->pub = topic.Publish();
   prop->pub.Set(value);
-  m_properties.emplace_back(std::move(prop));
 }
 
 void SendableBuilderImpl::AddBooleanProperty(std::string_view key,
@@ -273,57 +366,42 @@ void SendableBuilderImpl::AddRawProperty(
     std::function<std::vector<uint8_t>()> getter,
     std::function<void(std::span<const uint8_t>)> setter) {
   auto topic = m_table->GetRawTopic(key);
-  auto prop = std::make_unique<PropertyImpl<nt::RawTopic>>();
+  auto prop = m_properties.New<nt::RawTopic>();
   if (getter) {
     prop->pub = topic.Publish(typeString);
-    prop->updateNetwork = [=](auto& pub, int64_t time) {
-      pub.Set(getter(), time);
-    };
+    prop->updateNetwork = MakeUpdateNetwork(std::move(getter));
   }
+  prop->sub = topic.Subscribe(typeString, {},
+                              {.excludePublisher = prop->pub.GetHandle()});
   if (setter) {
-    prop->sub = topic.Subscribe(typeString, {},
-                                {.excludePublisher = prop->pub.GetHandle()});
-    prop->updateLocal = [=](auto& sub) {
-      for (auto&& val : sub.ReadQueue()) {
-        setter(val.value);
-      }
-    };
+    prop->updateLocal = MakeUpdateLocal(std::move(setter));
   }
-  m_properties.emplace_back(std::move(prop));
 }
 
 void SendableBuilderImpl::PublishConstRaw(std::string_view key,
                                           std::string_view typeString,
                                           std::span<const uint8_t> value) {
   auto topic = m_table->GetRawTopic(key);
-  auto prop = std::make_unique<PropertyImpl<nt::RawTopic>>();
+  auto prop = m_properties.New<nt::RawTopic>();
   prop->pub = topic.Publish(typeString);
   prop->pub.Set(value);
-  m_properties.emplace_back(std::move(prop));
 }
 
 template <typename T, size_t Size, typename Topic, typename Getter,
           typename Setter>
 void SendableBuilderImpl::AddSmallPropertyImpl(Topic topic, Getter getter,
                                                Setter setter) {
-  auto prop = std::make_unique<PropertyImpl<Topic>>();
+  auto prop = m_properties.New<Topic>();
   if (getter) {
     prop->pub = topic.Publish();
-    prop->updateNetwork = [=](auto& pub, int64_t time) {
-      wpi::SmallVector<T, Size> buf;
-      pub.Set(getter(buf), time);
-    };
+    prop->updateNetwork = MakeSmallUpdateNetwork<T, Size>(std::move(getter));
   }
+  // read-only properties are subscribed too, so writes from other publishers
+  // are seen and overwritten
+  prop->sub = topic.Subscribe({}, {.excludePublisher = prop->pub.GetHandle()});
   if (setter) {
-    prop->sub =
-        topic.Subscribe({}, {.excludePublisher = prop->pub.GetHandle()});
-    prop->updateLocal = [=](auto& sub) {
-      for (auto&& val : sub.ReadQueue()) {
-        setter(val.value);
-      }
-    };
+    prop->updateLocal = MakeUpdateLocal(std::move(setter));
   }
-  m_properties.emplace_back(std::move(prop));
 }
 
 void SendableBuilderImpl::AddSmallStringProperty(
@@ -385,22 +463,15 @@ void SendableBuilderImpl::AddSmallRawProperty(
         getter,
     std::function<void(std::span<const uint8_t>)> setter) {
   auto topic = m_table->GetRawTopic(key);
-  auto prop = std::make_unique<PropertyImpl<nt::RawTopic>>();
+  auto prop = m_properties.New<nt::RawTopic>();
   if (getter) {
     prop->pub = topic.Publish(typeString);
-    prop->updateNetwork = [=](auto& pub, int64_t time) {
-      wpi::SmallVector<uint8_t, 128> buf;
-      pub.Set(getter(buf), time);
-    };
+    prop->updateNetwork =
+        MakeSmallUpdateNetwork<uint8_t, 128>(std::move(getter));
   }
+  prop->sub = topic.Subscribe(typeString, {},
+                              {.excludePublisher = prop->pub.GetHandle()});
   if (setter) {
-    prop->sub = topic.Subscribe(typeString, {},
-                                {.excludePublisher = prop->pub.GetHandle()});
-    prop->updateLocal = [=](auto& sub) {
-      for (auto&& val : sub.ReadQueue()) {
-        setter(val.value);
-      }
-    };
+    prop->updateLocal = MakeUpdateLocal(std::move(setter));
   }
-  m_properties.emplace_back(std::move(prop));
 }
@@ -4,6 +4,8 @@
 
 #include "frc/smartdashboard/SmartDashboard.h"
 
+#include <vector>
+
 #include <hal/FRCUsageReporting.h>
 #include <networktables/NetworkTable.h>
 #include <networktables/NetworkTableInstance.h>
@@ -23,6 +25,9 @@ struct Instance {
   std::shared_ptr<nt::NetworkTable> table =
       nt::NetworkTableInstance::GetDefault().GetTable("SmartDashboard");
   wpi::StringMap<wpi::SendableRegistry::UID> tablesToData;
+  // flat copy of the tablesToData values, rebuilt only when it changes
+  std::vector<wpi::SendableRegistry::UID> dataUids;
+  bool dataUidsValid = false;
   wpi::mutex tablesToDataMutex;
 };
 }  // namespace
@@ -94,6 +99,7 @@ void SmartDashboard::PutData(std::string_view key, wpi::Sendable* data) {
   wpi::Sendable* sddata = wpi::SendableRegistry::GetSendable(uid);
   if (sddata != data) {
     uid = wpi::SendableRegistry::GetUniqueId(data);
+    inst.dataUidsValid = false;
     auto dataTable = inst.table->GetSubTable(key);
     auto builder = std::make_unique<SendableBuilderImpl>();
     auto builderPtr = builder.get();
@@ -248,7 +254,12 @@ void SmartDashboard::UpdateValues() {
   auto& inst = GetInstance();
   inst.listenerExecutor.RunListenerTasks();
   std::scoped_lock lock(inst.tablesToDataMutex);
-  for (auto& i : inst.tablesToData) {
-    wpi::SendableRegistry::Update(i.getValue());
+  if (!inst.dataUidsValid) {
+    inst.dataUids.clear();
+    for (auto& i : inst.tablesToData) {
+      inst.dataUids.emplace_back(i.getValue());
+    }
+    inst.dataUidsValid = true;
   }
+  wpi::SendableRegistry::Update(inst.dataUids);
 }
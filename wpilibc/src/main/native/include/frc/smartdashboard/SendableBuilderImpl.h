@@ -18,6 +18,7 @@
 #include <networktables/StringTopic.h>
 #include <wpi/FunctionExtras.h>
 #include <wpi/SmallVector.h>
+#include <wpi/memory/memory_stack.hpp>
 
 namespace frc {
 
@@ -60,6 +61,8 @@ class SendableBuilderImpl : public nt::NTSendableBuilder {
   /**
    * Synchronize with network table values by calling the getters for all
    * properties and setters when the network table value has changed.
+   * Values are only published when they differ from the last value
+   * published, so unchanged properties do not touch NetworkTables.
    */
   void Update() override;
 
@@ -223,8 +226,36 @@ class SendableBuilderImpl : public nt::NTSendableBuilder {
     using Subscriber = typename Topic::SubscriberType;
     Publisher pub;
     Subscriber sub;
-    std::function<void(Publisher& pub, int64_t time)> updateNetwork;
-    std::function<void(Subscriber& sub)> updateLocal;
+    // force is set when the last published value may have been overwritten
+    // by another publisher and must be republished even if unchanged
+    std::function<void(Publisher& pub, int64_t time, bool force)>
+        updateNetwork;
+    // returns true if any values were received
+    std::function<bool(Subscriber& sub)> updateLocal;
+  };
+
+  // Properties are allocated from an arena owned by the builder and are all
+  // released at once by Clear(), which ClearProperties() relies on to reuse
+  // the same memory when a Sendable is re-initialized.
+  class PropertyArena {
+   public:
+    PropertyArena();
+    ~PropertyArena();
+
+    PropertyArena(PropertyArena&& rhs);
+    PropertyArena& operator=(PropertyArena&& rhs);
+
+    template <typename Topic>
+    PropertyImpl<Topic>* New();
+
+    void Clear();
+
+    std::span<Property* const> Get() const { return m_properties; }
+
+   private:
+    wpi::memory::memory_stack<> m_stack;
+    wpi::memory::memory_stack<>::marker m_start;
+    std::vector<Property*> m_properties;
   };
 
   template <typename Topic, typename Getter, typename Setter>
@@ -237,7 +268,7 @@ class SendableBuilderImpl : public nt::NTSendableBuilder {
             typename Setter>
   void AddSmallPropertyImpl(Topic topic, Getter getter, Setter setter);
 
-  std::vector<std::unique_ptr<Property>> m_properties;
+  PropertyArena m_properties;
   std::function<void()> m_safeState;
   std::vector<wpi::unique_function<void()>> m_updateTables;
   std::shared_ptr<nt::NetworkTable> m_table;
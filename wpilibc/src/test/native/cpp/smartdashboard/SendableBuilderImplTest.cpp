@@ -0,0 +1,150 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include <frc/smartdashboard/SendableBuilderImpl.h>
+
+#include <memory>
+#include <string_view>
+
+#include <gtest/gtest.h>
+#include <networktables/DoubleTopic.h>
+#include <networktables/NetworkTableInstance.h>
+#include <networktables/StringTopic.h>
+#include <wpi/SmallVector.h>
+
+class SendableBuilderImplTest : public ::testing::Test {
+ protected:
+  SendableBuilderImplTest() { builder.SetTable(inst.GetTable("Test")); }
+
+  ~SendableBuilderImplTest() override {
+    nt::NetworkTableInstance::Destroy(inst);
+  }
+
+  nt::NetworkTableInstance inst = nt::NetworkTableInstance::Create();
+  frc::SendableBuilderImpl builder;
+};
+
+TEST_F(SendableBuilderImplTest, SkipsUnchanged) {
+  double value = 1.0;
+  int calls = 0;
+  builder.AddDoubleProperty(
+      "value",
+      [&] {
+        ++calls;
+        return value;
+      },
+      nullptr);
+  auto sub = inst.GetDoubleTopic("/Test/value").Subscribe(
+      0.0, {.keepDuplicates = true});
+
+  builder.Update();
+  EXPECT_EQ(1u, sub.ReadQueue().size());
+  // the getter is still called, but an unchanged value is not published
+  builder.Update();
+  EXPECT_EQ(2, calls);
+  EXPECT_TRUE(sub.ReadQueue().empty());
+
+  value = 2.0;
+  builder.Update();
+  auto published = sub.ReadQueue();
+  ASSERT_EQ(1u, published.size());
+  EXPECT_EQ(2.0, published[0].value);
+}
+
+TEST_F(SendableBuilderImplTest, SmallSkipsUnchanged) {
+  std::string_view value = "a";
+  builder.AddSmallStringProperty(
+      "value",
+      [&](wpi::SmallVectorImpl<char>& buf) -> std::string_view {
+        buf.assign(value.begin(), value.end());
+        return {buf.data(), buf.size()};
+      },
+      nullptr);
+  auto sub = inst.GetStringTopic("/Test/value").Subscribe(
+      "", {.keepDuplicates = true});
+
+  builder.Update();
+  EXPECT_EQ(1u, sub.ReadQueue().size());
+  builder.Update();
+  EXPECT_TRUE(sub.ReadQueue().empty());
+
+  value = "b";
+  builder.Update();
+  auto published = sub.ReadQueue();
+  ASSERT_EQ(1u, published.size());
+  EXPECT_EQ("b", published[0].value);
+}
+
+TEST_F(SendableBuilderImplTest, RepublishAfterRejectedSet) {
+  int sets = 0;
+  builder.AddDoubleProperty("value", [] { return 1.0; },
+                            [&](double) { ++sets; });
+  builder.StartListeners();
+  auto topic = inst.GetDoubleTopic("/Test/value");
+  auto sub = topic.Subscribe(0.0);
+  auto pub = topic.Publish();
+
+  builder.Update();
+  // the setter ignores the value, so it is overwritten with the getter's
+  pub.Set(5.0);
+  builder.Update();
+  EXPECT_EQ(1, sets);
+  EXPECT_EQ(1.0, sub.Get());
+}
+
+TEST_F(SendableBuilderImplTest, RepublishReadOnly) {
+  builder.AddDoubleProperty("value", [] { return 1.0; }, nullptr);
+  builder.StartListeners();
+  auto topic = inst.GetDoubleTopic("/Test/value");
+  auto sub = topic.Subscribe(0.0);
+  auto pub = topic.Publish();
+
+  builder.Update();
+  pub.Set(5.0);
+  builder.Update();
+  EXPECT_EQ(1.0, sub.Get());
+}
+
+TEST_F(SendableBuilderImplTest, RepublishNotControllable) {
+  int sets = 0;
+  builder.AddDoubleProperty("value", [] { return 1.0; },
+                            [&](double) { ++sets; });
+  auto topic = inst.GetDoubleTopic("/Test/value");
+  auto sub = topic.Subscribe(0.0);
+  auto pub = topic.Publish();
+
+  builder.Update();
+  pub.Set(5.0);
+  builder.Update();
+  EXPECT_EQ(0, sets);
+  EXPECT_EQ(1.0, sub.Get());
+
+  // the value was discarded, not applied later
+  builder.StartListeners();
+  builder.Update();
+  EXPECT_EQ(0, sets);
+}
+
+TEST_F(SendableBuilderImplTest, ClearProperties) {
+  auto state = std::make_shared<int>(1);
+  builder.AddDoubleProperty(
+      "value", [state] { return static_cast<double>(*state); }, nullptr);
+  EXPECT_EQ(2, state.use_count());
+  builder.Update();
+
+  // properties are destroyed, and their storage reused
+  builder.ClearProperties();
+  EXPECT_EQ(1, state.use_count());
+  int calls = 0;
+  builder.AddDoubleProperty(
+      "value",
+      [&] {
+        ++calls;
+        return 3.0;
+      },
+      nullptr);
+  builder.Update();
+  EXPECT_EQ(1, calls);
+  EXPECT_EQ(3.0, inst.GetDoubleTopic("/Test/value").Subscribe(0.0).Get());
+}
@@ -18,6 +18,7 @@
 #include <wpi/sha1.h>
 
 #include "WebSocketDebug.h"
+#include "WebSocketMask.h"
 #include "WebSocketSerializer.h"
 #include "wpinet/HttpParser.h"
 #include "wpinet/raw_uv_ostream.h"
@@ -406,17 +407,6 @@ void WebSocket::Shutdown() {
   m_stream.Shutdown([this] { m_stream.Close(); });
 }
 
-static inline void Unmask(std::span<uint8_t> data,
-                          std::span<const uint8_t, 4> key) {
-  int n = 0;
-  for (uint8_t& ch : data) {
-    ch ^= key[n++];
-    if (n >= 4) {
-      n = 0;
-    }
-  }
-}
-
 void WebSocket::HandleIncoming(uv::Buffer& buf, size_t size) {
   // ignore incoming data if we're failed or closed
   if (m_state == FAILED || m_state == CLOSED) {
@@ -545,9 +535,10 @@ void WebSocket::HandleIncoming(uv::Buffer& buf, size_t size) {
         // We have a complete frame
         // If the message had masking, unmask it
         if ((m_header[1] & kFlagMasking) != 0) {
-          Unmask(control ? std::span{m_controlPayload}
-                         : std::span{m_payload}.subspan(m_frameStart),
-                 std::span<const uint8_t, 4>{&m_header[m_headerSize - 4], 4});
+          detail::WebSocketMask(
+              control ? std::span{m_controlPayload}
+                      : std::span{m_payload}.subspan(m_frameStart),
+              std::span<const uint8_t, 4>{&m_header[m_headerSize - 4], 4});
         }
 
         // Handle message
@@ -770,6 +761,20 @@ void WebSocket::SendFrames(
   req->Send({});
 }
 
+void WebSocket::SendFrames(std::span<const Frame> frames,
+                           std::shared_ptr<void> owner,
+                           std::function<void(uv::Error)> callback) {
+  auto release = [owner = std::move(owner), callback = std::move(callback)](
+                     auto, uv::Error err) mutable {
+    // the buffers belong to owner; just drop the reference
+    owner.reset();
+    if (callback) {
+      callback(err);
+    }
+  };
+  SendFrames(frames, std::move(release));
+}
+
 std::span<const WebSocket::Frame> WebSocket::TrySendFrames(
     std::span<const Frame> frames,
     std::function<void(std::span<uv::Buffer>, uv::Error)> callback) {
@@ -0,0 +1,92 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include "WebSocketMask.h"
+
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define WPI_WS_MASK_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define WPI_WS_MASK_NEON 1
+#include <arm_neon.h>
+#endif
+
+size_t wpi::detail::WebSocketMaskCopy(uint8_t* dst,
+                                      std::span<const uint8_t> src,
+                                      std::span<const uint8_t, 4> key,
+                                      size_t phase) {
+  // Rotate the key so the pattern starts at the current phase; since every
+  // block below is a multiple of 4 bytes long, the phase is the same at the
+  // start of each block.  Loads and stores go through memcpy (or unaligned
+  // vector loads) so neither buffer needs to be aligned.
+  alignas(16) uint8_t pattern[16];
+  for (size_t i = 0; i < 4; ++i) {
+    pattern[i] = key[(phase + i) & 3];
+  }
+  std::memcpy(pattern + 4, pattern, 4);
+  std::memcpy(pattern + 8, pattern, 8);
+
+  const uint8_t* in = src.data();
+  size_t len = src.size();
+  size_t i = 0;
+
+#if defined(WPI_WS_MASK_SSE2)
+  __m128i vkey = _mm_load_si128(reinterpret_cast<const __m128i*>(pattern));
+  for (; i + 64 <= len; i += 64) {
+    __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+    __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i + 16));
+    __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i + 32));
+    __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i + 48));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i),
+                     _mm_xor_si128(a, vkey));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 16),
+                     _mm_xor_si128(b, vkey));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 32),
+                     _mm_xor_si128(c, vkey));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 48),
+                     _mm_xor_si128(d, vkey));
+  }
+  for (; i + 16 <= len; i += 16) {
+    __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i),
+                     _mm_xor_si128(a, vkey));
+  }
+#elif defined(WPI_WS_MASK_NEON)
+  uint8x16_t vkey = vld1q_u8(pattern);
+  for (; i + 64 <= len; i += 64) {
+    uint8x16_t a = vld1q_u8(in + i);
+    uint8x16_t b = vld1q_u8(in + i + 16);
+    uint8x16_t c = vld1q_u8(in + i + 32);
+    uint8x16_t d = vld1q_u8(in + i + 48);
+    vst1q_u8(dst + i, veorq_u8(a, vkey));
+    vst1q_u8(dst + i + 16, veorq_u8(b, vkey));
+    vst1q_u8(dst + i + 32, veorq_u8(c, vkey));
+    vst1q_u8(dst + i + 48, veorq_u8(d, vkey));
+  }
+  for (; i + 16 <= len; i += 16) {
+    vst1q_u8(dst + i, veorq_u8(vld1q_u8(in + i), vkey));
+  }
+#endif
+
+  // 64 bits at a time; the pattern bytes are in memory order, so this is
+  // independent of endianness
+  uint64_t wkey;
+  std::memcpy(&wkey, pattern, 8);
+  for (; i + 8 <= len; i += 8) {
+    uint64_t v;
+    std::memcpy(&v, in + i, 8);
+    v ^= wkey;
+    std::memcpy(dst + i, &v, 8);
+  }
+
+  // remaining bytes
+  for (size_t j = 0; i < len; ++i, ++j) {
+    dst[i] = in[i] ^ pattern[j];
+  }
+
+  return (phase + len) & 3;
+}
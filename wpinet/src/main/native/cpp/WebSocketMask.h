@@ -0,0 +1,43 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <span>
+
+namespace wpi::detail {
+
+/**
+ * Applies (or removes) a WebSocket masking key, copying from src to dst.
+ * src and dst may be the same buffer but must not otherwise overlap.
+ * There are no alignment requirements.
+ *
+ * @param dst destination; must be at least src.size() bytes
+ * @param src source data
+ * @param key masking key
+ * @param phase index into key of the first byte of src; this is nonzero
+ *              when a payload is masked in several pieces
+ * @return key phase for the byte following the end of src
+ */
+size_t WebSocketMaskCopy(uint8_t* dst, std::span<const uint8_t> src,
+                         std::span<const uint8_t, 4> key, size_t phase = 0);
+
+/**
+ * Applies (or removes) a WebSocket masking key in place.
+ *
+ * @param data data
+ * @param key masking key
+ * @param phase index into key of the first byte of data
+ * @return key phase for the byte following the end of data
+ */
+inline size_t WebSocketMask(std::span<uint8_t> data,
+                            std::span<const uint8_t, 4> key,
+                            size_t phase = 0) {
+  return WebSocketMaskCopy(data.data(), data, key, phase);
+}
+
+}  // namespace wpi::detail
@@ -6,6 +6,8 @@
 
 #include <random>
 
+#include "WebSocketMask.h"
+
 using namespace wpi::detail;
 
 static constexpr uint8_t kFlagMasking = 0x80;
@@ -72,14 +74,11 @@ size_t SerializedFrames::AddClientFrame(const WebSocket::Frame& frame) {
   internalBuf += 4;
 
   // copy and mask data
-  int n = 0;
+  size_t phase = 0;
   for (auto&& buf : frame.data) {
-    for (auto&& ch : buf.data()) {
-      *internalBuf++ = static_cast<uint8_t>(ch) ^ key[n++];
-      if (n >= 4) {
-        n = 0;
-      }
-    }
+    phase = WebSocketMaskCopy(reinterpret_cast<uint8_t*>(internalBuf),
+                              buf.bytes(), key, phase);
+    internalBuf += buf.len;
   }
   return size;
 }
@@ -402,6 +402,22 @@ class WebSocket : public std::enable_shared_from_this<WebSocket> {
       std::span<const Frame> frames,
       std::function<void(std::span<uv::Buffer>, uv::Error)> callback);
 
+  /**
+   * Send multiple frames whose payload buffers are kept alive by a shared
+   * owner rather than returned to the caller.  On the server side the
+   * payload is not copied: only the frame headers are generated, and the
+   * payload buffers are handed to the stream as-is, so each batch of frames
+   * is a single vectored write.  The reference to owner is dropped as soon
+   * as the write completes or fails.
+   *
+   * @param frames Frame type/data pairs; data must remain valid as long as
+   *               owner is alive
+   * @param owner Object that owns the frame data
+   * @param callback Callback which is invoked when the write completes.
+   */
+  void SendFrames(std::span<const Frame> frames, std::shared_ptr<void> owner,
+                  std::function<void(uv::Error)> callback = nullptr);
+
   /**
    * Try to send multiple frames. Tries to send as many frames as possible
    * immediately, and only queues the "last" frame it can (as the network queue
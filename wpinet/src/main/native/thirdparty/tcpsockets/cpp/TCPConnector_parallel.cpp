@@ -17,7 +17,7 @@ using namespace wpi;
 
 std::unique_ptr<NetworkStream> TCPConnector::connect_parallel(
     std::span<const std::pair<const char*, int>> servers, Logger& logger,
-    int timeout) {
+    int timeout, size_t* index) {
   if (servers.empty()) {
     return nullptr;
   }
@@ -36,6 +36,7 @@ std::unique_ptr<NetworkStream> TCPConnector::connect_parallel(
     wpi::mutex mtx;
     wpi::condition_variable cv;
     std::unique_ptr<NetworkStream> stream;
+    size_t index = 0;
     std::atomic<unsigned int> count{0};
     std::atomic<bool> done{false};
   };
@@ -44,7 +45,8 @@ std::unique_ptr<NetworkStream> TCPConnector::connect_parallel(
   // start worker threads; this is I/O bound so we don't limit to # of procs
   Logger* plogger = &logger;
   unsigned int num_workers = 0;
-  for (const auto& server : servers) {
+  for (size_t i = 0; i < servers.size(); ++i) {
+    const auto& server = servers[i];
     std::pair<std::string, int> server_copy{std::string{server.first},
                                             server.second};
     std::tuple<std::thread::id, std::string, int> active_tracker{
@@ -85,6 +87,7 @@ std::unique_ptr<NetworkStream> TCPConnector::connect_parallel(
           std::scoped_lock lock(result->mtx);
           if (!result->done.exchange(true)) {
             result->stream = std::move(stream);
+            result->index = i;
           }
         }
       }
@@ -107,5 +110,8 @@ std::unique_ptr<NetworkStream> TCPConnector::connect_parallel(
   }
 
   // no need to wait for remaining worker threads; shared_ptr will clean up
+  if (index && result->stream) {
+    *index = result->index;
+  }
   return std::move(result->stream);
 }
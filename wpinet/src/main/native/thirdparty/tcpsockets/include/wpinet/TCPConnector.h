@@ -24,6 +24,7 @@
 #ifndef WPINET_TCPCONNECTOR_H_
 #define WPINET_TCPCONNECTOR_H_
 
+#include <cstddef>
 #include <memory>
 #include <span>
 #include <utility>
@@ -39,9 +40,11 @@ class TCPConnector {
   static std::unique_ptr<NetworkStream> connect(const char* server, int port,
                                                 Logger& logger,
                                                 int timeout = 0);
+  // If index is not null, it is set to the index in servers of the
+  // connection returned.
   static std::unique_ptr<NetworkStream> connect_parallel(
       std::span<const std::pair<const char*, int>> servers, Logger& logger,
-      int timeout = 0);
+      int timeout = 0, size_t* index = nullptr);
 };
 
 }  // namespace wpi
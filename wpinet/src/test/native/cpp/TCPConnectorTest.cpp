@@ -0,0 +1,62 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include "wpinet/TCPConnector.h"  // NOLINT(build/include_order)
+
+#include <cstddef>
+#include <utility>
+
+#include <gtest/gtest.h>
+#include <wpi/Logger.h>
+
+#include "wpinet/NetworkStream.h"
+#include "wpinet/TCPAcceptor.h"
+
+namespace wpi {
+
+// nothing listens on this port
+static constexpr int kClosedPort = 11830;
+static constexpr int kOpenPort = 11831;
+
+class TCPConnectorParallelTest : public ::testing::Test {
+ protected:
+  void SetUp() override { ASSERT_EQ(0, acceptor.start()); }
+
+  Logger logger;
+  TCPAcceptor acceptor{kOpenPort, "127.0.0.1", logger};
+};
+
+TEST_F(TCPConnectorParallelTest, IndexOfLast) {
+  std::pair<const char*, int> servers[] = {{"127.0.0.1", kClosedPort},
+                                           {"127.0.0.1", kOpenPort}};
+  size_t index = 99;
+  auto stream = TCPConnector::connect_parallel(servers, logger, 1, &index);
+  ASSERT_TRUE(stream);
+  EXPECT_EQ(1u, index);
+  EXPECT_EQ(kOpenPort, stream->getPeerPort());
+}
+
+TEST_F(TCPConnectorParallelTest, IndexOfFirst) {
+  std::pair<const char*, int> servers[] = {{"127.0.0.1", kOpenPort},
+                                           {"127.0.0.1", kClosedPort}};
+  size_t index = 99;
+  auto stream = TCPConnector::connect_parallel(servers, logger, 1, &index);
+  ASSERT_TRUE(stream);
+  EXPECT_EQ(0u, index);
+}
+
+TEST_F(TCPConnectorParallelTest, IndexUnchangedOnFailure) {
+  std::pair<const char*, int> servers[] = {{"127.0.0.1", kClosedPort}};
+  size_t index = 99;
+  auto stream = TCPConnector::connect_parallel(servers, logger, 1, &index);
+  EXPECT_FALSE(stream);
+  EXPECT_EQ(99u, index);
+}
+
+TEST_F(TCPConnectorParallelTest, IndexOptional) {
+  std::pair<const char*, int> servers[] = {{"127.0.0.1", kOpenPort}};
+  EXPECT_TRUE(TCPConnector::connect_parallel(servers, logger, 1));
+}
+
+}  // namespace wpi
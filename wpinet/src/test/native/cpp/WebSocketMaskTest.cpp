@@ -0,0 +1,119 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include "WebSocketMask.h"  // NOLINT(build/include_order)
+
+#include <chrono>
+#include <cstring>
+#include <vector>
+
+#include <fmt/core.h>
+#include <gtest/gtest.h>
+
+namespace {
+// the original byte at a time implementation
+size_t ReferenceMask(uint8_t* dst, std::span<const uint8_t> src,
+                     std::span<const uint8_t, 4> key, size_t phase) {
+  for (uint8_t ch : src) {
+    *dst++ = ch ^ key[phase++];
+    if (phase >= 4) {
+      phase = 0;
+    }
+  }
+  return phase;
+}
+
+std::vector<uint8_t> MakeData(size_t size) {
+  std::vector<uint8_t> data(size);
+  for (size_t i = 0; i < size; ++i) {
+    data[i] = static_cast<uint8_t>(i * 7 + 3);
+  }
+  return data;
+}
+
+const uint8_t kKey[4] = {0x12, 0x34, 0x56, 0x78};
+}  // namespace
+
+namespace wpi::detail {
+
+TEST(WebSocketMaskTest, MatchesReference) {
+  auto data = MakeData(300);
+  // cover every vector/word/byte split, source and destination alignment,
+  // and starting key phase
+  for (size_t len = 0; len < 200; ++len) {
+    for (size_t srcOff = 0; srcOff < 8; ++srcOff) {
+      for (size_t dstOff = 0; dstOff < 8; dstOff += 3) {
+        for (size_t phase = 0; phase < 4; ++phase) {
+          uint8_t expected[256];
+          uint8_t actual[256];
+          std::span<const uint8_t> src{data.data() + srcOff, len};
+          size_t expectedPhase = ReferenceMask(expected, src, kKey, phase);
+          size_t actualPhase =
+              WebSocketMaskCopy(actual + dstOff, src, kKey, phase);
+          ASSERT_EQ(actualPhase, expectedPhase);
+          ASSERT_EQ(std::memcmp(actual + dstOff, expected, len), 0)
+              << "len=" << len << " srcOff=" << srcOff
+              << " dstOff=" << dstOff << " phase=" << phase;
+        }
+      }
+    }
+  }
+}
+
+TEST(WebSocketMaskTest, InPlace) {
+  auto data = MakeData(1000);
+  auto expected = data;
+  ReferenceMask(expected.data(), expected, kKey, 0);
+  WebSocketMask(std::span{data}.subspan(0, 999), kKey);
+  data[999] ^= kKey[999 % 4];
+  EXPECT_EQ(data, expected);
+}
+
+TEST(WebSocketMaskTest, Fragments) {
+  // masking a payload in pieces must give the same result as all at once
+  auto data = MakeData(517);
+  std::vector<uint8_t> expected(data.size());
+  ReferenceMask(expected.data(), data, kKey, 0);
+
+  std::vector<uint8_t> actual(data.size());
+  size_t pieces[] = {1, 2, 3, 17, 64, 5, 100, 325};
+  size_t pos = 0;
+  size_t phase = 0;
+  for (size_t piece : pieces) {
+    phase = WebSocketMaskCopy(actual.data() + pos,
+                              std::span{data}.subspan(pos, piece), kKey, phase);
+    pos += piece;
+  }
+  ASSERT_EQ(pos, data.size());
+  EXPECT_EQ(actual, expected);
+}
+
+TEST(WebSocketMaskTest, Benchmark) {
+  using std::chrono::duration_cast;
+  using std::chrono::high_resolution_clock;
+  using std::chrono::nanoseconds;
+
+  for (size_t size : {16, 125, 1024, 65536}) {
+    auto data = MakeData(size + 1);
+    size_t iters = (64 * 1024 * 1024) / size;
+
+    auto start = high_resolution_clock::now();
+    for (size_t i = 0; i < iters; ++i) {
+      ReferenceMask(data.data() + 1, std::span{data}.subspan(1), kKey, i & 3);
+    }
+    auto mid = high_resolution_clock::now();
+    for (size_t i = 0; i < iters; ++i) {
+      WebSocketMask(std::span{data}.subspan(1), kKey, i & 3);
+    }
+    auto stop = high_resolution_clock::now();
+
+    double bytes = static_cast<double>(size) * iters;
+    double refNs = duration_cast<nanoseconds>(mid - start).count();
+    double newNs = duration_cast<nanoseconds>(stop - mid).count();
+    fmt::print("size {:>6}: bytewise {:.2f} GB/s, WebSocketMask {:.2f} GB/s\n",
+               size, bytes / refNs, bytes / newNs);
+  }
+}
+
+}  // namespace wpi::detail
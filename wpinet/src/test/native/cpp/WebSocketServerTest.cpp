@@ -635,6 +635,33 @@ TEST_P(WebSocketServerDataTest, SendBinary) {
   ASSERT_EQ(gotCallback, 1);
 }
 
+TEST_P(WebSocketServerDataTest, SendFramesShared) {
+  int gotCallback = 0;
+  auto data = std::make_shared<std::vector<uint8_t>>(GetParam(), 0x03u);
+  std::weak_ptr<std::vector<uint8_t>> weakData = data;
+  auto expectData = BuildMessage(0x02, false, false, *data);
+  auto expectCont = BuildMessage(0x00, true, false, *data);
+  expectData.insert(expectData.end(), expectCont.begin(), expectCont.end());
+  setupWebSocket = [&] {
+    ws->open.connect([&](std::string_view) {
+      uv::Buffer buf{*data};
+      WebSocket::Frame frames[] = {
+          {WebSocket::Frame::kBinaryFragment, std::span{&buf, 1}},
+          {WebSocket::Frame::kFinalFragment, std::span{&buf, 1}}};
+      ws->SendFrames(frames, std::move(data), [&](uv::Error) {
+        ++gotCallback;
+        ASSERT_TRUE(weakData.expired());
+        ws->Terminate();
+      });
+    });
+  };
+
+  loop->Run();
+
+  ASSERT_EQ(wireData, expectData);
+  ASSERT_EQ(gotCallback, 1);
+}
+
 TEST_P(WebSocketServerDataTest, SendPing) {
   int gotCallback = 0;
   std::vector<uint8_t> data(GetParam(), 0x03u);
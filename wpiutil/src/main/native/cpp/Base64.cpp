@@ -57,6 +57,9 @@
 
 #include "wpi/Base64.h"
 
+#include <algorithm>
+
+#include "CpuFeatures.h"
 #include "wpi/SmallVector.h"
 #include "wpi/raw_ostream.h"
 
@@ -80,137 +83,488 @@ static const unsigned char pr2six[256] = {
     64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64,
     64, 64, 64, 64, 64, 64, 64, 64, 64};
 
-size_t Base64Decode(raw_ostream& os, std::string_view encoded) {
-  auto bytes_begin = reinterpret_cast<const unsigned char*>(encoded.data());
-  auto bytes_end = bytes_begin + encoded.size();
-  const unsigned char* end = bytes_begin;
-  while (pr2six[*end] <= 63 && end != bytes_end) {
-    ++end;
+static const char basis_64[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+/*
+ * Vectorized kernels.  Each kernel processes as many whole blocks as it can
+ * safely load and store and returns the number of input bytes consumed; the
+ * caller finishes the tail with the scalar code.  Encoders consume multiples
+ * of 3 bytes, decoders consume multiples of 4 characters and stop at the
+ * first block containing a character outside the Base64 alphabet (including
+ * padding), leaving it for the scalar code to find the end of the input.
+ *
+ * The x86 kernels are the "pshufb" formulations by Wojciech Mula and Alfred
+ * Klomp; the NEON kernels rely on the structured load/store instructions to
+ * do the (de)interleaving.
+ */
+
+using EncodeBlocksFunc = size_t (*)(const uint8_t* in, size_t len, char* out);
+using DecodeBlocksFunc = size_t (*)(const uint8_t* in, size_t len,
+                                    uint8_t* out);
+
+#ifdef WPI_CPU_X86
+WPI_TARGET("ssse3")
+static inline __m128i EncodeReshuffle(__m128i in) {
+  // Spread each 3-byte group across a 32-bit lane as [b1 b0 b2 b1], then
+  // shift the four 6-bit fields into their own bytes
+  in = _mm_shuffle_epi8(
+      in, _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+  __m128i t0 = _mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00));
+  __m128i t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+  __m128i t2 = _mm_and_si128(in, _mm_set1_epi32(0x003f03f0));
+  __m128i t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+  return _mm_or_si128(t1, t3);
+}
+
+WPI_TARGET("ssse3")
+static inline __m128i EncodeShiftLUT() {
+  return _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                       '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                       '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+}
+
+WPI_TARGET("ssse3")
+static inline __m128i EncodeTranslate(__m128i in) {
+  // Map each 6-bit value to the index of its range in the shift table
+  __m128i result = _mm_subs_epu8(in, _mm_set1_epi8(51));
+  __m128i less = _mm_cmpgt_epi8(_mm_set1_epi8(26), in);
+  result = _mm_or_si128(result, _mm_and_si128(less, _mm_set1_epi8(13)));
+  return _mm_add_epi8(_mm_shuffle_epi8(EncodeShiftLUT(), result), in);
+}
+
+WPI_TARGET("ssse3")
+static size_t EncodeBlocksSSSE3(const uint8_t* in, size_t len, char* out) {
+  size_t i = 0;
+  // 16-byte loads, 12 bytes consumed per iteration
+  for (; len - i >= 16; i += 12) {
+    __m128i str = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+    str = EncodeTranslate(EncodeReshuffle(str));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), str);
+    out += 16;
   }
-  size_t nprbytes = end - bytes_begin;
-  if (nprbytes == 0) {
-    return 0;
+  return i;
+}
+
+WPI_TARGET("avx2")
+static size_t EncodeBlocksAVX2(const uint8_t* in, size_t len, char* out) {
+  const __m256i shuf = _mm256_set_epi8(
+      10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1, 10, 11, 9, 10, 7, 8, 6,
+      7, 4, 5, 3, 4, 1, 2, 0, 1);
+  const __m256i shiftLUT = _mm256_broadcastsi128_si256(EncodeShiftLUT());
+  size_t i = 0;
+  // two 16-byte loads 12 bytes apart, 24 bytes consumed per iteration
+  for (; len - i >= 28; i += 24) {
+    __m256i str = _mm256_inserti128_si256(
+        _mm256_castsi128_si256(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i))),
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i + 12)), 1);
+    str = _mm256_shuffle_epi8(str, shuf);
+    __m256i t0 = _mm256_and_si256(str, _mm256_set1_epi32(0x0fc0fc00));
+    __m256i t1 = _mm256_mulhi_epu16(t0, _mm256_set1_epi32(0x04000040));
+    __m256i t2 = _mm256_and_si256(str, _mm256_set1_epi32(0x003f03f0));
+    __m256i t3 = _mm256_mullo_epi16(t2, _mm256_set1_epi32(0x01000010));
+    str = _mm256_or_si256(t1, t3);
+
+    __m256i result = _mm256_subs_epu8(str, _mm256_set1_epi8(51));
+    __m256i less = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), str);
+    result =
+        _mm256_or_si256(result, _mm256_and_si256(less, _mm256_set1_epi8(13)));
+    result = _mm256_add_epi8(_mm256_shuffle_epi8(shiftLUT, result), str);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), result);
+    out += 32;
+  }
+  return i;
+}
+
+WPI_TARGET("ssse3")
+static inline __m128i DecodeLutLo() {
+  return _mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+                       0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+}
+
+WPI_TARGET("ssse3")
+static inline __m128i DecodeLutHi() {
+  return _mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10,
+                       0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+}
+
+WPI_TARGET("ssse3")
+static inline __m128i DecodeLutRoll() {
+  return _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0,
+                       0);
+}
+
+WPI_TARGET("ssse3")
+static size_t DecodeBlocksSSSE3(const uint8_t* in, size_t len, uint8_t* out) {
+  const __m128i mask2F = _mm_set1_epi8(0x2F);
+  size_t i = 0;
+  // 16 characters consumed and 16 bytes (12 valid) stored per iteration;
+  // the extra margin keeps the store within the caller's output buffer
+  for (; len - i >= 24; i += 16) {
+    __m128i str = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+    __m128i hiNibbles = _mm_and_si128(_mm_srli_epi32(str, 4), mask2F);
+    __m128i loNibbles = _mm_and_si128(str, mask2F);
+    __m128i hi = _mm_shuffle_epi8(DecodeLutHi(), hiNibbles);
+    __m128i lo = _mm_shuffle_epi8(DecodeLutLo(), loNibbles);
+    if (_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_and_si128(lo, hi),
+                                         _mm_setzero_si128())) != 0) {
+      break;
+    }
+    __m128i eq2F = _mm_cmpeq_epi8(str, mask2F);
+    __m128i roll =
+        _mm_shuffle_epi8(DecodeLutRoll(), _mm_add_epi8(eq2F, hiNibbles));
+    str = _mm_add_epi8(str, roll);
+
+    // Pack four 6-bit values per 32-bit lane into three bytes
+    str = _mm_maddubs_epi16(str, _mm_set1_epi32(0x01400140));
+    str = _mm_madd_epi16(str, _mm_set1_epi32(0x00011000));
+    str = _mm_shuffle_epi8(str, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14,
+                                              13, 12, -1, -1, -1, -1));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), str);
+    out += 12;
+  }
+  return i;
+}
+
+WPI_TARGET("avx2")
+static size_t DecodeBlocksAVX2(const uint8_t* in, size_t len, uint8_t* out) {
+  const __m256i lutLo = _mm256_broadcastsi128_si256(DecodeLutLo());
+  const __m256i lutHi = _mm256_broadcastsi128_si256(DecodeLutHi());
+  const __m256i lutRoll = _mm256_broadcastsi128_si256(DecodeLutRoll());
+  const __m256i mask2F = _mm256_set1_epi8(0x2F);
+  const __m256i pack = _mm256_broadcastsi128_si256(_mm_setr_epi8(
+      2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+  size_t i = 0;
+  // 32 characters consumed and 32 bytes (24 valid) stored per iteration
+  for (; len - i >= 44; i += 32) {
+    __m256i str = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+    __m256i hiNibbles = _mm256_and_si256(_mm256_srli_epi32(str, 4), mask2F);
+    __m256i loNibbles = _mm256_and_si256(str, mask2F);
+    __m256i hi = _mm256_shuffle_epi8(lutHi, hiNibbles);
+    __m256i lo = _mm256_shuffle_epi8(lutLo, loNibbles);
+    if (_mm256_movemask_epi8(_mm256_cmpgt_epi8(_mm256_and_si256(lo, hi),
+                                               _mm256_setzero_si256())) != 0) {
+      break;
+    }
+    __m256i eq2F = _mm256_cmpeq_epi8(str, mask2F);
+    __m256i roll =
+        _mm256_shuffle_epi8(lutRoll, _mm256_add_epi8(eq2F, hiNibbles));
+    str = _mm256_add_epi8(str, roll);
+
+    str = _mm256_maddubs_epi16(str, _mm256_set1_epi32(0x01400140));
+    str = _mm256_madd_epi16(str, _mm256_set1_epi32(0x00011000));
+    str = _mm256_shuffle_epi8(str, pack);
+    // Each 128-bit lane now holds 12 bytes; make them contiguous
+    str = _mm256_permutevar8x32_epi32(
+        str, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), str);
+    out += 24;
+  }
+  // Finish any remaining whole blocks with the 128-bit kernel
+  if (len - i >= 24) {
+    i += DecodeBlocksSSSE3(in + i, len - i, out);
+  }
+  return i;
+}
+#endif  // WPI_CPU_X86
+
+#ifdef WPI_CPU_NEON
+static inline uint8x16_t EncodeTranslateNEON(uint8x16_t v) {
+  // Start from 'A' + v and add the offset of each successive range
+  uint8x16_t r = vaddq_u8(v, vdupq_n_u8('A'));
+  r = vaddq_u8(r, vandq_u8(vcgeq_u8(v, vdupq_n_u8(26)),
+                           vdupq_n_u8(('a' - 26) - 'A')));
+  r = vaddq_u8(r, vandq_u8(vcgeq_u8(v, vdupq_n_u8(52)),
+                           vdupq_n_u8(static_cast<uint8_t>(('0' - 52) -
+                                                           ('a' - 26)))));
+  r = vaddq_u8(r, vandq_u8(vceqq_u8(v, vdupq_n_u8(62)),
+                           vdupq_n_u8(static_cast<uint8_t>(('+' - 62) -
+                                                           ('0' - 52)))));
+  r = vaddq_u8(r, vandq_u8(vceqq_u8(v, vdupq_n_u8(63)),
+                           vdupq_n_u8(static_cast<uint8_t>(('/' - 63) -
+                                                           ('0' - 52)))));
+  return r;
+}
+
+static size_t EncodeBlocksNEON(const uint8_t* in, size_t len, char* out) {
+  const uint8x16_t mask3F = vdupq_n_u8(0x3F);
+  size_t i = 0;
+  for (; len - i >= 48; i += 48) {
+    uint8x16x3_t src = vld3q_u8(in + i);
+    uint8x16x4_t idx;
+    idx.val[0] = vshrq_n_u8(src.val[0], 2);
+    idx.val[1] = vandq_u8(
+        vorrq_u8(vshlq_n_u8(src.val[0], 4), vshrq_n_u8(src.val[1], 4)), mask3F);
+    idx.val[2] = vandq_u8(
+        vorrq_u8(vshlq_n_u8(src.val[1], 2), vshrq_n_u8(src.val[2], 6)), mask3F);
+    idx.val[3] = vandq_u8(src.val[2], mask3F);
+    for (int j = 0; j < 4; ++j) {
+      idx.val[j] = EncodeTranslateNEON(idx.val[j]);
+    }
+    vst4q_u8(reinterpret_cast<uint8_t*>(out), idx);
+    out += 64;
+  }
+  return i;
+}
+
+// Returns 0xFF for characters outside the Base64 alphabet
+static inline uint8x16_t DecodeTranslateNEON(uint8x16_t c) {
+  uint8x16_t upper = vsubq_u8(c, vdupq_n_u8('A'));
+  uint8x16_t lower = vsubq_u8(c, vdupq_n_u8('a'));
+  uint8x16_t digit = vsubq_u8(c, vdupq_n_u8('0'));
+  uint8x16_t r = vdupq_n_u8(0xFF);
+  r = vbslq_u8(vcltq_u8(upper, vdupq_n_u8(26)), upper, r);
+  r = vbslq_u8(vcltq_u8(lower, vdupq_n_u8(26)),
+               vaddq_u8(lower, vdupq_n_u8(26)), r);
+  r = vbslq_u8(vcltq_u8(digit, vdupq_n_u8(10)),
+               vaddq_u8(digit, vdupq_n_u8(52)), r);
+  r = vbslq_u8(vceqq_u8(c, vdupq_n_u8('+')), vdupq_n_u8(62), r);
+  r = vbslq_u8(vceqq_u8(c, vdupq_n_u8('/')), vdupq_n_u8(63), r);
+  return r;
+}
+
+static size_t DecodeBlocksNEON(const uint8_t* in, size_t len, uint8_t* out) {
+  size_t i = 0;
+  for (; len - i >= 64; i += 64) {
+    uint8x16x4_t src = vld4q_u8(in + i);
+    uint8x16_t a = DecodeTranslateNEON(src.val[0]);
+    uint8x16_t b = DecodeTranslateNEON(src.val[1]);
+    uint8x16_t c = DecodeTranslateNEON(src.val[2]);
+    uint8x16_t d = DecodeTranslateNEON(src.val[3]);
+    uint8x16_t bad = vorrq_u8(vorrq_u8(a, b), vorrq_u8(c, d));
+    uint8x8_t bad8 = vorr_u8(vget_low_u8(bad), vget_high_u8(bad));
+    if ((vget_lane_u64(vreinterpret_u64_u8(bad8), 0) &
+         UINT64_C(0x8080808080808080)) != 0) {
+      break;
+    }
+    uint8x16x3_t dst;
+    dst.val[0] = vorrq_u8(vshlq_n_u8(a, 2), vshrq_n_u8(b, 4));
+    dst.val[1] = vorrq_u8(vshlq_n_u8(b, 4), vshrq_n_u8(c, 2));
+    dst.val[2] = vorrq_u8(vshlq_n_u8(c, 6), d);
+    vst3q_u8(out, dst);
+    out += 48;
+  }
+  return i;
+}
+#endif  // WPI_CPU_NEON
+
+static EncodeBlocksFunc GetEncodeBlocks() {
+  static const EncodeBlocksFunc func = []() -> EncodeBlocksFunc {
+#if defined(WPI_CPU_X86)
+    auto& features = cpu::GetFeatures();
+    if (features.avx2) {
+      return EncodeBlocksAVX2;
+    } else if (features.ssse3) {
+      return EncodeBlocksSSSE3;
+    }
+#elif defined(WPI_CPU_NEON)
+    return EncodeBlocksNEON;
+#endif
+    return nullptr;
+  }();
+  return func;
+}
+
+static DecodeBlocksFunc GetDecodeBlocks() {
+  static const DecodeBlocksFunc func = []() -> DecodeBlocksFunc {
+#if defined(WPI_CPU_X86)
+    auto& features = cpu::GetFeatures();
+    if (features.avx2) {
+      return DecodeBlocksAVX2;
+    } else if (features.ssse3) {
+      return DecodeBlocksSSSE3;
+    }
+#elif defined(WPI_CPU_NEON)
+    return DecodeBlocksNEON;
+#endif
+    return nullptr;
+  }();
+  return func;
+}
+
+// Encodes len bytes into exactly Base64EncodedSize(len) characters.
+static void EncodeImpl(const uint8_t* in, size_t len, char* out) {
+  size_t i = 0;
+  if (auto blocks = GetEncodeBlocks()) {
+    i = blocks(in, len, out);
+    out += i / 3 * 4;
+  }
+
+  for (; (i + 2) < len; i += 3) {
+    *out++ = basis_64[(in[i] >> 2) & 0x3F];
+    *out++ = basis_64[((in[i] & 0x3) << 4) | ((in[i + 1] & 0xF0) >> 4)];
+    *out++ = basis_64[((in[i + 1] & 0xF) << 2) | ((in[i + 2] & 0xC0) >> 6)];
+    *out++ = basis_64[in[i + 2] & 0x3F];
+  }
+  if (i < len) {
+    *out++ = basis_64[(in[i] >> 2) & 0x3F];
+    if (i == (len - 1)) {
+      *out++ = basis_64[((in[i] & 0x3) << 4)];
+      *out++ = '=';
+    } else {
+      *out++ = basis_64[((in[i] & 0x3) << 4) | ((in[i + 1] & 0xF0) >> 4)];
+      *out++ = basis_64[((in[i + 1] & 0xF) << 2)];
+    }
+    *out++ = '=';
   }
+}
+
+// Decodes into out, which must hold Base64DecodedSize(len) bytes.  Returns
+// the number of bytes written.
+static size_t DecodeImpl(const unsigned char* bytes_begin, size_t len,
+                         size_t* num_read, uint8_t* out) {
+  auto bytes_end = bytes_begin + len;
+  uint8_t* out_begin = out;
 
   const unsigned char* cur = bytes_begin;
+  if (auto blocks = GetDecodeBlocks()) {
+    size_t consumed = blocks(bytes_begin, len, out);
+    cur += consumed;
+    out += consumed / 4 * 3;
+  }
+
+  const unsigned char* end = cur;
+  while (end != bytes_end && pr2six[*end] <= 63) {
+    ++end;
+  }
+  size_t nprbytes = end - cur;
+  if (end == bytes_begin) {
+    *num_read = 0;
+    return 0;
+  }
 
   while (nprbytes > 4) {
-    os << static_cast<unsigned char>(pr2six[cur[0]] << 2 | pr2six[cur[1]] >> 4);
-    os << static_cast<unsigned char>(pr2six[cur[1]] << 4 | pr2six[cur[2]] >> 2);
-    os << static_cast<unsigned char>(pr2six[cur[2]] << 6 | pr2six[cur[3]]);
+    *out++ = static_cast<uint8_t>(pr2six[cur[0]] << 2 | pr2six[cur[1]] >> 4);
+    *out++ = static_cast<uint8_t>(pr2six[cur[1]] << 4 | pr2six[cur[2]] >> 2);
+    *out++ = static_cast<uint8_t>(pr2six[cur[2]] << 6 | pr2six[cur[3]]);
     cur += 4;
     nprbytes -= 4;
   }
 
   // Note: (nprbytes == 1) would be an error, so just ignore that case
   if (nprbytes > 1) {
-    os << static_cast<unsigned char>(pr2six[cur[0]] << 2 | pr2six[cur[1]] >> 4);
+    *out++ = static_cast<uint8_t>(pr2six[cur[0]] << 2 | pr2six[cur[1]] >> 4);
   }
   if (nprbytes > 2) {
-    os << static_cast<unsigned char>(pr2six[cur[1]] << 4 | pr2six[cur[2]] >> 2);
+    *out++ = static_cast<uint8_t>(pr2six[cur[1]] << 4 | pr2six[cur[2]] >> 2);
   }
   if (nprbytes > 3) {
-    os << static_cast<unsigned char>(pr2six[cur[2]] << 6 | pr2six[cur[3]]);
+    *out++ = static_cast<uint8_t>(pr2six[cur[2]] << 6 | pr2six[cur[3]]);
+  }
+
+  *num_read = (end - bytes_begin) + ((4 - nprbytes) & 3);
+  return out - out_begin;
+}
+
+size_t Base64Decode(std::string_view encoded, size_t* num_read,
+                    std::span<uint8_t> plain) {
+  if (plain.size() < Base64DecodedSize(encoded.size())) {
+    *num_read = 0;
+    return 0;
   }
+  return DecodeImpl(reinterpret_cast<const unsigned char*>(encoded.data()),
+                    encoded.size(), num_read, plain.data());
+}
 
-  return (end - bytes_begin) + ((4 - nprbytes) & 3);
+size_t Base64Decode(raw_ostream& os, std::string_view encoded) {
+  SmallVector<uint8_t, 256> buf;
+  buf.resize_for_overwrite(Base64DecodedSize(encoded.size()));
+  size_t num_read;
+  size_t len = Base64Decode(encoded, &num_read,
+                            std::span<uint8_t>{buf.data(), buf.size()});
+  os.write(reinterpret_cast<const char*>(buf.data()), len);
+  return num_read;
 }
 
 size_t Base64Decode(std::string_view encoded, std::string* plain) {
-  plain->resize(0);
-  raw_string_ostream os(*plain);
-  size_t rv = Base64Decode(os, encoded);
-  os.flush();
-  return rv;
+  plain->resize(Base64DecodedSize(encoded.size()));
+  size_t num_read;
+  size_t len = Base64Decode(
+      encoded, &num_read,
+      {reinterpret_cast<uint8_t*>(plain->data()), plain->size()});
+  plain->resize(len);
+  return num_read;
 }
 
 std::string_view Base64Decode(std::string_view encoded, size_t* num_read,
                               SmallVectorImpl<char>& buf) {
-  buf.clear();
-  raw_svector_ostream os(buf);
-  *num_read = Base64Decode(os, encoded);
-  return os.str();
+  buf.resize_for_overwrite(Base64DecodedSize(encoded.size()));
+  size_t len = Base64Decode(
+      encoded, num_read, {reinterpret_cast<uint8_t*>(buf.data()), buf.size()});
+  buf.resize(len);
+  return {buf.data(), buf.size()};
 }
 
 size_t Base64Decode(std::string_view encoded, std::vector<uint8_t>* plain) {
-  plain->resize(0);
-  raw_uvector_ostream os(*plain);
-  return Base64Decode(os, encoded);
+  plain->resize(Base64DecodedSize(encoded.size()));
+  size_t num_read;
+  size_t len = Base64Decode(encoded, &num_read, *plain);
+  plain->resize(len);
+  return num_read;
 }
 
 std::span<uint8_t> Base64Decode(std::string_view encoded, size_t* num_read,
                                 SmallVectorImpl<uint8_t>& buf) {
-  buf.clear();
-  raw_usvector_ostream os(buf);
-  *num_read = Base64Decode(os, encoded);
-  return os.array();
+  buf.resize_for_overwrite(Base64DecodedSize(encoded.size()));
+  size_t len = Base64Decode(encoded, num_read,
+                            std::span<uint8_t>{buf.data(), buf.size()});
+  buf.resize(len);
+  return buf;
 }
 
-static const char basis_64[] =
-    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
-
-void Base64Encode(raw_ostream& os, std::string_view plain) {
-  if (plain.empty()) {
-    return;
+size_t Base64Encode(std::span<const uint8_t> plain, std::span<char> encoded) {
+  size_t len = Base64EncodedSize(plain.size());
+  if (encoded.size() < len) {
+    return 0;
   }
-  size_t len = plain.size();
+  EncodeImpl(plain.data(), plain.size(), encoded.data());
+  return len;
+}
 
-  size_t i;
-  for (i = 0; (i + 2) < len; i += 3) {
-    os << basis_64[(plain[i] >> 2) & 0x3F];
-    os << basis_64[((plain[i] & 0x3) << 4) |
-                   (static_cast<int>(plain[i + 1] & 0xF0) >> 4)];
-    os << basis_64[((plain[i + 1] & 0xF) << 2) |
-                   (static_cast<int>(plain[i + 2] & 0xC0) >> 6)];
-    os << basis_64[plain[i + 2] & 0x3F];
-  }
-  if (i < len) {
-    os << basis_64[(plain[i] >> 2) & 0x3F];
-    if (i == (len - 1)) {
-      os << basis_64[((plain[i] & 0x3) << 4)];
-      os << '=';
-    } else {
-      os << basis_64[((plain[i] & 0x3) << 4) |
-                     (static_cast<int>(plain[i + 1] & 0xF0) >> 4)];
-      os << basis_64[((plain[i + 1] & 0xF) << 2)];
-    }
-    os << '=';
-  }
+void Base64Encode(raw_ostream& os, std::string_view plain) {
+  Base64Encode(os, std::span<const uint8_t>{
+                       reinterpret_cast<const uint8_t*>(plain.data()),
+                       plain.size()});
 }
 
 void Base64Encode(std::string_view plain, std::string* encoded) {
-  encoded->resize(0);
-  raw_string_ostream os(*encoded);
-  Base64Encode(os, plain);
-  os.flush();
+  Base64Encode(std::span<const uint8_t>{
+                   reinterpret_cast<const uint8_t*>(plain.data()),
+                   plain.size()},
+               encoded);
 }
 
 std::string_view Base64Encode(std::string_view plain,
                               SmallVectorImpl<char>& buf) {
-  buf.clear();
-  raw_svector_ostream os(buf);
-  Base64Encode(os, plain);
-  return os.str();
+  return Base64Encode(std::span<const uint8_t>{
+                          reinterpret_cast<const uint8_t*>(plain.data()),
+                          plain.size()},
+                      buf);
 }
 
 void Base64Encode(raw_ostream& os, std::span<const uint8_t> plain) {
-  Base64Encode(os, std::string_view{reinterpret_cast<const char*>(plain.data()),
-                                    plain.size()});
+  // Encode in chunks through a stack buffer (chunk size is a multiple of 3 so
+  // padding only appears at the very end)
+  char buf[1024];
+  constexpr size_t kChunk = sizeof(buf) / 4 * 3;
+  while (!plain.empty()) {
+    auto chunk = plain.first((std::min)(plain.size(), kChunk));
+    os.write(buf, Base64Encode(chunk, std::span<char>{buf}));
+    plain = plain.subspan(chunk.size());
+  }
 }
 
 void Base64Encode(std::span<const uint8_t> plain, std::string* encoded) {
-  encoded->resize(0);
-  raw_string_ostream os(*encoded);
-  Base64Encode(os, plain);
-  os.flush();
+  encoded->resize(Base64EncodedSize(plain.size()));
+  Base64Encode(plain, std::span<char>{encoded->data(), encoded->size()});
 }
 
 std::string_view Base64Encode(std::span<const uint8_t> plain,
                               SmallVectorImpl<char>& buf) {
-  buf.clear();
-  raw_svector_ostream os(buf);
-  Base64Encode(os, plain);
-  return os.str();
+  buf.resize_for_overwrite(Base64EncodedSize(plain.size()));
+  Base64Encode(plain, std::span<char>{buf.data(), buf.size()});
+  return {buf.data(), buf.size()};
 }
 
 }  // namespace wpi
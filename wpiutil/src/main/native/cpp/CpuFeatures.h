@@ -0,0 +1,110 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#pragma once
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || \
+    defined(_M_IX86)
+#define WPI_CPU_X86 1
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#include <immintrin.h>
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define WPI_CPU_NEON 1
+#include <arm_neon.h>
+#endif
+
+#include <stdint.h>
+
+// GCC and Clang require functions using instructions beyond the baseline ISA
+// to be annotated with the instruction set extensions they need; MSVC makes
+// all intrinsics available unconditionally.
+#if defined(_MSC_VER) && !defined(__clang__)
+#define WPI_TARGET(x)
+#else
+#define WPI_TARGET(x) __attribute__((target(x)))
+#endif
+
+namespace wpi::cpu {
+
+/**
+ * Instruction set extensions available on the running CPU.  Only the
+ * extensions that wpiutil has kernels for are detected.
+ */
+struct Features {
+  bool ssse3 = false;
+  bool sse41 = false;
+  bool avx2 = false;
+  bool sha = false;
+};
+
+#ifdef WPI_CPU_X86
+namespace detail {
+
+inline void CpuId(uint32_t leaf, uint32_t subleaf, uint32_t regs[4]) {
+#ifdef _MSC_VER
+  int r[4];
+  __cpuidex(r, static_cast<int>(leaf), static_cast<int>(subleaf));
+  for (int i = 0; i < 4; ++i) {
+    regs[i] = static_cast<uint32_t>(r[i]);
+  }
+#else
+  __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+inline uint64_t XGetBV() {
+#ifdef _MSC_VER
+  return _xgetbv(0);
+#else
+  uint32_t lo, hi;
+  __asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+  return (static_cast<uint64_t>(hi) << 32) | lo;
+#endif
+}
+
+inline Features Detect() {
+  Features f;
+  uint32_t regs[4];
+  CpuId(0, 0, regs);
+  uint32_t maxLeaf = regs[0];
+  if (maxLeaf < 1) {
+    return f;
+  }
+  CpuId(1, 0, regs);
+  f.ssse3 = (regs[2] & (1u << 9)) != 0;
+  f.sse41 = (regs[2] & (1u << 19)) != 0;
+  // AVX state must be enabled by the OS (OSXSAVE + XCR0 bits 1 and 2)
+  bool osAvx = (regs[2] & (1u << 27)) != 0 && (regs[2] & (1u << 28)) != 0 &&
+               (XGetBV() & 0x6) == 0x6;
+  if (maxLeaf >= 7) {
+    CpuId(7, 0, regs);
+    f.avx2 = osAvx && (regs[1] & (1u << 5)) != 0;
+    f.sha = (regs[1] & (1u << 29)) != 0;
+  }
+  return f;
+}
+
+}  // namespace detail
+#endif
+
+/**
+ * Gets the instruction set extensions supported by the running CPU.  The
+ * result is computed once and cached.
+ */
+inline const Features& GetFeatures() {
+#ifdef WPI_CPU_X86
+  static const Features features = detail::Detect();
+#else
+  static const Features features;
+#endif
+  return features;
+}
+
+}  // namespace wpi::cpu
@@ -0,0 +1,119 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include "wpi/JsonWriter.h"
+
+#include "wpi/raw_ostream.h"
+
+using namespace wpi;
+
+JsonWriter::JsonWriter(raw_ostream& os, int indent)
+    : m_os{os}, m_serializer{os, ' '}, m_indent{indent} {}
+
+void JsonWriter::NextElement(Level& level) {
+  if (level.first) {
+    level.first = false;
+  } else {
+    m_os << ',';
+  }
+  if (m_indent >= 0) {
+    m_os << '\n';
+    m_os.indent(m_stack.size() * m_indent);
+  }
+}
+
+void JsonWriter::BeginValue() {
+  if (m_afterKey) {
+    m_afterKey = false;
+  } else if (!m_stack.empty()) {
+    NextElement(m_stack.back());
+  }
+}
+
+void JsonWriter::StartObject() {
+  BeginValue();
+  m_os << '{';
+  m_stack.emplace_back(Level{true});
+}
+
+void JsonWriter::EndObject() {
+  bool empty = m_stack.back().first;
+  m_stack.pop_back();
+  if (m_indent >= 0 && !empty) {
+    m_os << '\n';
+    m_os.indent(m_stack.size() * m_indent);
+  }
+  m_os << '}';
+}
+
+void JsonWriter::StartArray() {
+  BeginValue();
+  m_os << '[';
+  m_stack.emplace_back(Level{true});
+}
+
+void JsonWriter::EndArray() {
+  bool empty = m_stack.back().first;
+  m_stack.pop_back();
+  if (m_indent >= 0 && !empty) {
+    m_os << '\n';
+    m_os.indent(m_stack.size() * m_indent);
+  }
+  m_os << ']';
+}
+
+void JsonWriter::Key(std::string_view key) {
+  NextElement(m_stack.back());
+  m_os << '"';
+  m_serializer.dump_escaped(key, false);
+  if (m_indent >= 0) {
+    m_os << "\": ";
+  } else {
+    m_os << "\":";
+  }
+  m_afterKey = true;
+}
+
+void JsonWriter::Null() {
+  BeginValue();
+  m_os << "null";
+}
+
+void JsonWriter::Boolean(bool value) {
+  BeginValue();
+  if (value) {
+    m_os << "true";
+  } else {
+    m_os << "false";
+  }
+}
+
+void JsonWriter::Integer(int64_t value) {
+  BeginValue();
+  m_serializer.dump_integer(value);
+}
+
+void JsonWriter::Unsigned(uint64_t value) {
+  BeginValue();
+  m_serializer.dump_integer(value);
+}
+
+void JsonWriter::Double(double value) {
+  BeginValue();
+  m_serializer.dump_float(value);
+}
+
+void JsonWriter::String(std::string_view value) {
+  BeginValue();
+  m_os << '"';
+  m_serializer.dump_escaped(value, false);
+  m_os << '"';
+}
+
+void JsonWriter::Value(const json& value) {
+  BeginValue();
+  m_serializer.dump(value, m_indent >= 0, false,
+                    m_indent >= 0 ? m_indent : 0,
+                    m_indent >= 0 ? m_stack.size() * m_indent : 0);
+}
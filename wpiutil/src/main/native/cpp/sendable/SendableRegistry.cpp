@@ -11,6 +11,8 @@
 #include "wpi/DenseMap.h"
 #include "wpi/SmallVector.h"
 #include "wpi/UidVector.h"
+#include "wpi/memory/memory_pool.hpp"
+#include "wpi/memory/smart_ptr.hpp"
 #include "wpi/mutex.h"
 #include "wpi/sendable/Sendable.h"
 #include "wpi/sendable/SendableBuilder.h"
@@ -36,11 +38,22 @@ struct Component {
   }
 };
 
+// Components are allocated from a node pool rather than individually from the
+// heap; robot programs commonly register hundreds of them, and keeping them
+// together makes the periodic update walk much more cache friendly.
+using ComponentPool = wpi::memory::memory_pool<>;
+using ComponentPtr =
+    std::unique_ptr<Component,
+                    wpi::memory::allocator_deleter<Component, ComponentPool>>;
+
 struct SendableRegistryInst {
   wpi::recursive_mutex mutex;
 
+  // must be declared before components so it is destroyed after them
+  ComponentPool componentPool{
+      sizeof(Component), ComponentPool::min_block_size(sizeof(Component), 64)};
   std::function<std::unique_ptr<SendableBuilder>()> liveWindowFactory;
-  wpi::UidVector<std::unique_ptr<Component>, 32> components;
+  wpi::UidVector<ComponentPtr, 32> components;
   wpi::DenseMap<void*, SendableRegistry::UID> componentMap;
   int nextDataHandle = 0;
 
@@ -52,7 +65,9 @@ Component& SendableRegistryInst::GetOrAdd(void* sendable,
                                           SendableRegistry::UID* uid) {
   SendableRegistry::UID& compUid = componentMap[sendable];
   if (compUid == 0) {
-    compUid = components.emplace_back(std::make_unique<Component>()) + 1;
+    compUid = components.emplace_back(
+                  wpi::memory::allocate_unique<Component>(componentPool)) +
+              1;
   }
   if (uid) {
     *uid = compUid;
@@ -425,6 +440,20 @@ void SendableRegistry::Update(UID sendableUid) {
   }
 }
 
+void SendableRegistry::Update(std::span<const UID> sendableUids) {
+  auto& inst = GetInstance();
+  std::scoped_lock lock(inst.mutex);
+  for (auto sendableUid : sendableUids) {
+    if (sendableUid == 0 || (sendableUid - 1) >= inst.components.size()) {
+      continue;
+    }
+    auto& comp = inst.components[sendableUid - 1];
+    if (comp && comp->builder) {
+      comp->builder->Update();
+    }
+  }
+}
+
 void SendableRegistry::ForeachLiveWindow(
     int dataHandle, wpi::function_ref<void(CallbackData& data)> callback) {
   auto& inst = GetInstance();
@@ -19,6 +19,10 @@
 
 #include "wpi/sha1.h"
 
+#include <algorithm>
+#include <cstring>
+
+#include "CpuFeatures.h"
 #include "wpi/SmallVector.h"
 #include "wpi/StringExtras.h"
 #include "wpi/raw_istream.h"
@@ -212,13 +216,148 @@ static void buffer_to_block(const unsigned char* buffer,
   }
 }
 
+#ifdef WPI_CPU_X86
+/*
+ * Hash whole 512-bit blocks using the x86 SHA extensions.  Based on the
+ * public domain intrinsics implementation by Sean Gulley and Jeffrey Walton.
+ */
+
+WPI_TARGET("sha,sse4.1,ssse3")
+static void transform_blocks_shani(uint32_t digest[], const unsigned char* data,
+                                   size_t nblocks) {
+  const __m128i MASK =
+      _mm_set_epi64x(0x0001020304050607ULL, 0x08090a0b0c0d0e0fULL);
+
+  __m128i ABCD = _mm_loadu_si128(reinterpret_cast<const __m128i*>(digest));
+  __m128i E0 = _mm_set_epi32(static_cast<int>(digest[4]), 0, 0, 0);
+  ABCD = _mm_shuffle_epi32(ABCD, 0x1B);
+
+  for (; nblocks > 0; --nblocks, data += BLOCK_BYTES) {
+    const __m128i ABCD_SAVE = ABCD;
+    const __m128i E0_SAVE = E0;
+
+    __m128i MSG[4];
+    for (int i = 0; i < 4; ++i) {
+      MSG[i] = _mm_shuffle_epi8(
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 16 * i)),
+          MASK);
+    }
+
+    /* Rounds 0-3 */
+    __m128i E1;
+    E0 = _mm_add_epi32(E0, MSG[0]);
+    E1 = ABCD;
+    ABCD = _mm_sha1rnds4_epu32(ABCD, E0, 0);
+
+    /*
+     * Rounds 4-79, 4 at a time.  Each group finishes the message schedule
+     * for the next group and advances it for the two after that.  The round
+     * function selector (last argument to sha1rnds4) must be an immediate, so
+     * the loop is fully unrolled by the compiler.
+     */
+#define WPI_SHA1_ROUNDS(i, Enext, Eprev, f)                        \
+  Enext = _mm_sha1nexte_epu32(Enext, MSG[(i) % 4]);                \
+  Eprev = ABCD;                                                    \
+  if ((i) >= 3 && (i) <= 18) {                                     \
+    MSG[((i) + 1) % 4] = _mm_sha1msg2_epu32(MSG[((i) + 1) % 4],    \
+                                            MSG[(i) % 4]);         \
+  }                                                                \
+  ABCD = _mm_sha1rnds4_epu32(ABCD, Enext, f);                      \
+  if ((i) <= 16) {                                                 \
+    MSG[((i) + 3) % 4] = _mm_sha1msg1_epu32(MSG[((i) + 3) % 4],    \
+                                            MSG[(i) % 4]);         \
+  }                                                                \
+  if ((i) >= 2 && (i) <= 17) {                                     \
+    MSG[((i) + 2) % 4] = _mm_xor_si128(MSG[((i) + 2) % 4], MSG[(i) % 4]); \
+  }
+
+    WPI_SHA1_ROUNDS(1, E1, E0, 0)
+    WPI_SHA1_ROUNDS(2, E0, E1, 0)
+    WPI_SHA1_ROUNDS(3, E1, E0, 0)
+    WPI_SHA1_ROUNDS(4, E0, E1, 0)
+    WPI_SHA1_ROUNDS(5, E1, E0, 1)
+    WPI_SHA1_ROUNDS(6, E0, E1, 1)
+    WPI_SHA1_ROUNDS(7, E1, E0, 1)
+    WPI_SHA1_ROUNDS(8, E0, E1, 1)
+    WPI_SHA1_ROUNDS(9, E1, E0, 1)
+    WPI_SHA1_ROUNDS(10, E0, E1, 2)
+    WPI_SHA1_ROUNDS(11, E1, E0, 2)
+    WPI_SHA1_ROUNDS(12, E0, E1, 2)
+    WPI_SHA1_ROUNDS(13, E1, E0, 2)
+    WPI_SHA1_ROUNDS(14, E0, E1, 2)
+    WPI_SHA1_ROUNDS(15, E1, E0, 3)
+    WPI_SHA1_ROUNDS(16, E0, E1, 3)
+    WPI_SHA1_ROUNDS(17, E1, E0, 3)
+    WPI_SHA1_ROUNDS(18, E0, E1, 3)
+    WPI_SHA1_ROUNDS(19, E1, E0, 3)
+#undef WPI_SHA1_ROUNDS
+
+    /* Combine state */
+    E0 = _mm_sha1nexte_epu32(E0, E0_SAVE);
+    ABCD = _mm_add_epi32(ABCD, ABCD_SAVE);
+  }
+
+  ABCD = _mm_shuffle_epi32(ABCD, 0x1B);
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(digest), ABCD);
+  digest[4] = static_cast<uint32_t>(_mm_extract_epi32(E0, 3));
+}
+#endif
+
+/*
+ * Hash whole 512-bit blocks directly from the input, using hardware support
+ * when the CPU has it.
+ */
+
+static void transform_blocks(uint32_t digest[], const unsigned char* data,
+                             size_t nblocks, uint64_t& transforms) {
+#ifdef WPI_CPU_X86
+  if (cpu::GetFeatures().sha && cpu::GetFeatures().sse41) {
+    transform_blocks_shani(digest, data, nblocks);
+    transforms += nblocks;
+    return;
+  }
+#endif
+  for (; nblocks > 0; --nblocks, data += BLOCK_BYTES) {
+    uint32_t block[BLOCK_INTS];
+    buffer_to_block(data, block);
+    do_transform(digest, block, transforms);
+  }
+}
+
 SHA1::SHA1() {
   reset(digest, buf_size, transforms);
 }
 
 void SHA1::Update(std::string_view s) {
-  raw_mem_istream is(std::span<const char>(s.data(), s.size()));
-  Update(is);
+  Update(std::span<const uint8_t>{reinterpret_cast<const uint8_t*>(s.data()),
+                                  s.size()});
+}
+
+void SHA1::Update(std::span<const uint8_t> data) {
+  // Top up a partially filled buffer first
+  if (buf_size != 0 && !data.empty()) {
+    size_t n = (std::min)(BLOCK_BYTES - buf_size, data.size());
+    std::memcpy(&buffer[buf_size], data.data(), n);
+    buf_size += n;
+    data = data.subspan(n);
+    if (buf_size != BLOCK_BYTES) {
+      return;
+    }
+    transform_blocks(digest, buffer, 1, transforms);
+    buf_size = 0;
+  }
+
+  // Hash whole blocks in place, without copying them into the buffer
+  size_t nblocks = data.size() / BLOCK_BYTES;
+  if (nblocks > 0) {
+    transform_blocks(digest, data.data(), nblocks, transforms);
+    data = data.subspan(nblocks * BLOCK_BYTES);
+  }
+
+  if (!data.empty()) {
+    std::memcpy(buffer, data.data(), data.size());
+    buf_size = data.size();
+  }
 }
 
 void SHA1::Update(raw_istream& is) {
@@ -227,9 +366,7 @@ void SHA1::Update(raw_istream& is) {
     if (buf_size != BLOCK_BYTES) {
       return;
     }
-    uint32_t block[BLOCK_INTS];
-    buffer_to_block(buffer, block);
-    do_transform(digest, block, transforms);
+    transform_blocks(digest, buffer, 1, transforms);
     buf_size = 0;
   }
 }
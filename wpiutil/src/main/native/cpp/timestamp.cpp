@@ -4,7 +4,10 @@
 
 #include "wpi/timestamp.h"
 
+#include <algorithm>
 #include <atomic>
+#include <cmath>
+#include <mutex>
 #include <optional>
 
 #ifdef __FRC_ROBORIO__
@@ -37,6 +40,15 @@ using namespace nRoboRIO_FPGANamespace;
 
 #include <fmt/format.h>
 
+#if defined(__linux__) && (defined(__x86_64__) || defined(__aarch64__))
+#define WPI_HAVE_CYCLE_COUNTER 1
+#ifdef __x86_64__
+#include <x86intrin.h>
+
+#include "CpuFeatures.h"
+#endif
+#endif
+
 #ifdef __FRC_ROBORIO__
 namespace {
 static constexpr const char hmbName[] = "HMB_0_RAM";
@@ -226,6 +238,311 @@ uint64_t wpi::NowDefault() {
 #endif
 }
 
+#ifdef WPI_HAVE_CYCLE_COUNTER
+namespace {
+__extension__ using int128 = __int128;
+__extension__ using uint128 = unsigned __int128;
+
+// Converts CPU cycle counter values into NowDefault() time.  The conversion
+// is a fixed point linear map (time = base + (cycles - baseCycles) * mult)
+// that is periodically resynchronized against NowDefault().  Resyncs never
+// step time backwards: measured drift is corrected by adjusting the slope
+// over the next interval, and only large forward errors are stepped.  Past
+// the end of the interval (e.g. if the clock is idle) time advances at the
+// natural rate, so the correction is never applied for longer than intended.
+class CycleClock {
+ public:
+  CycleClock();
+
+  bool IsAvailable() const { return m_available; }
+  uint64_t Now();
+  wpi::NowCycleCounterStats GetStats();
+
+ private:
+  // fractional bits of mult and baseFrac
+  static constexpr int kShift = 40;
+  // time to spin measuring the counter frequency at startup
+  static constexpr uint64_t kCalibrationUs = 10000;
+  // resync interval starts short and doubles as the rate estimate improves
+  static constexpr uint64_t kMinResyncUs = 50000;
+  static constexpr uint64_t kMaxResyncUs = 1000000;
+  // errors larger than this are stepped (forward) or slewed at the maximum
+  // rate (backward) rather than corrected over a single interval
+  static constexpr int64_t kMaxSlewUs = 1000;
+
+  struct SyncPoint {
+    uint64_t cycles;
+    uint64_t time;
+  };
+
+  static uint64_t ReadCycles() {
+#ifdef __x86_64__
+    return __rdtsc();
+#else
+    uint64_t val;
+    asm volatile("isb; mrs %0, cntvct_el0" : "=r"(val)::"memory");
+    return val;
+#endif
+  }
+
+  static SyncPoint Sample();
+  static uint128 Elapsed(int64_t delta, uint64_t mult, uint64_t naturalMult,
+                         uint64_t interval);
+  void Resync(uint64_t cycles);
+  void Publish(uint64_t baseCycles, uint64_t baseTime, uint64_t baseFrac,
+               uint64_t mult, uint64_t naturalMult, uint64_t interval);
+
+  bool m_available = false;
+
+  // parameters read by Now(), published with a sequence lock
+  std::atomic<uint32_t> m_seq{0};
+  std::atomic<uint64_t> m_baseCycles{0};
+  std::atomic<uint64_t> m_baseTime{0};
+  std::atomic<uint64_t> m_baseFrac{0};
+  std::atomic<uint64_t> m_mult{0};
+  std::atomic<uint64_t> m_baseNaturalMult{0};
+  std::atomic<uint64_t> m_interval{INT64_MAX};
+
+  // resync state; only accessed with m_mutex held
+  std::mutex m_mutex;
+  SyncPoint m_anchor{0, 0};
+  uint64_t m_naturalMult = 0;
+  uint64_t m_resyncUs = kMinResyncUs;
+  wpi::NowCycleCounterStats m_stats;
+};
+}  // namespace
+
+CycleClock::CycleClock() {
+#ifdef __x86_64__
+  // the TSC must tick at a constant rate regardless of frequency scaling and
+  // sleep states (CPUID.80000007H:EDX[8])
+  uint32_t regs[4];
+  wpi::cpu::detail::CpuId(0x80000000, 0, regs);
+  if (regs[0] < 0x80000007) {
+    return;
+  }
+  wpi::cpu::detail::CpuId(0x80000007, 0, regs);
+  if ((regs[3] & (1u << 8)) == 0) {
+    return;
+  }
+  m_anchor = Sample();
+  while (wpi::NowDefault() - m_anchor.time < kCalibrationUs) {
+  }
+  SyncPoint end = Sample();
+  m_naturalMult = static_cast<uint64_t>(
+      (static_cast<uint128>(end.time - m_anchor.time) << kShift) /
+      (end.cycles - m_anchor.cycles));
+  SyncPoint base = end;
+#else
+  // the generic timer frequency is provided by firmware
+  uint64_t freq;
+  asm volatile("mrs %0, cntfrq_el0" : "=r"(freq));
+  if (freq == 0) {
+    return;
+  }
+  m_naturalMult = static_cast<uint64_t>(
+      (static_cast<uint128>(1000000) << kShift) / freq);
+  m_anchor = Sample();
+  SyncPoint base = m_anchor;
+#endif
+  if (m_naturalMult == 0) {
+    return;
+  }
+  m_stats.frequency = std::ldexp(1e6, kShift) / m_naturalMult;
+  Publish(base.cycles, base.time, uint64_t{1} << (kShift - 1), m_naturalMult,
+          m_naturalMult,
+          (static_cast<uint128>(m_resyncUs) << kShift) / m_naturalMult);
+  m_available = true;
+}
+
+CycleClock::SyncPoint CycleClock::Sample() {
+  // bracket the reference clock read with counter reads and keep the
+  // tightest of a few attempts to reject preemption
+  SyncPoint best{0, 0};
+  uint64_t bestWidth = UINT64_MAX;
+  for (int i = 0; i < 5; ++i) {
+    uint64_t before = ReadCycles();
+    uint64_t time = wpi::NowDefault();
+    uint64_t after = ReadCycles();
+    if (after - before < bestWidth) {
+      bestWidth = after - before;
+      best = {before + bestWidth / 2, time};
+    }
+  }
+  return best;
+}
+
+uint128 CycleClock::Elapsed(int64_t delta, uint64_t mult, uint64_t naturalMult,
+                            uint64_t interval) {
+  // the adjusted slope only applies over the interval it was computed for
+  uint64_t udelta = static_cast<uint64_t>(delta);
+  uint64_t adjusted = (std::min)(udelta, interval);
+  return static_cast<uint128>(adjusted) * mult +
+         static_cast<uint128>(udelta - adjusted) * naturalMult;
+}
+
+void CycleClock::Publish(uint64_t baseCycles, uint64_t baseTime,
+                         uint64_t baseFrac, uint64_t mult,
+                         uint64_t naturalMult, uint64_t interval) {
+  uint32_t seq = m_seq.load(std::memory_order_relaxed);
+  m_seq.store(seq + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  m_baseCycles.store(baseCycles, std::memory_order_relaxed);
+  m_baseTime.store(baseTime, std::memory_order_relaxed);
+  m_baseFrac.store(baseFrac, std::memory_order_relaxed);
+  m_mult.store(mult, std::memory_order_relaxed);
+  m_baseNaturalMult.store(naturalMult, std::memory_order_relaxed);
+  m_interval.store(interval, std::memory_order_relaxed);
+  m_seq.store(seq + 2, std::memory_order_release);
+}
+
+uint64_t CycleClock::Now() {
+  for (;;) {
+    uint64_t baseCycles, baseTime, baseFrac, mult, naturalMult, interval;
+    uint32_t seq;
+    do {
+      seq = m_seq.load(std::memory_order_acquire);
+      baseCycles = m_baseCycles.load(std::memory_order_relaxed);
+      baseTime = m_baseTime.load(std::memory_order_relaxed);
+      baseFrac = m_baseFrac.load(std::memory_order_relaxed);
+      mult = m_mult.load(std::memory_order_relaxed);
+      naturalMult = m_baseNaturalMult.load(std::memory_order_relaxed);
+      interval = m_interval.load(std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_acquire);
+    } while ((seq & 1) != 0 || seq != m_seq.load(std::memory_order_relaxed));
+
+    uint64_t cycles = ReadCycles();
+    int64_t delta = static_cast<int64_t>(cycles - baseCycles);
+    // a reader on another core may observe a counter value slightly before
+    // the base; clamp rather than wrap.  Large jumps either way resync.
+    if ((delta >= static_cast<int64_t>(interval) ||
+         delta < -static_cast<int64_t>(interval)) &&
+        m_mutex.try_lock()) {
+      Resync(cycles);
+      m_mutex.unlock();
+      continue;
+    }
+    if (delta < 0) {
+      delta = 0;
+    }
+    uint128 elapsed = Elapsed(delta, mult, naturalMult, interval) + baseFrac;
+    return baseTime + static_cast<uint64_t>(elapsed >> kShift);
+  }
+}
+
+void CycleClock::Resync(uint64_t cycles) {
+  uint64_t baseCycles = m_baseCycles.load(std::memory_order_relaxed);
+  // another thread may have resynced between the caller's read and the lock
+  int64_t sinceBase = static_cast<int64_t>(cycles - baseCycles);
+  int64_t current = m_interval.load(std::memory_order_relaxed);
+  if (sinceBase > -current && sinceBase < current) {
+    return;
+  }
+
+  SyncPoint s = Sample();
+
+  // where the current mapping puts the sample, in fixed point
+  using fixed = int128;
+  int64_t delta = static_cast<int64_t>(s.cycles - baseCycles);
+  if (delta < 0) {
+    delta = 0;
+  }
+  fixed predicted =
+      (static_cast<fixed>(m_baseTime.load(std::memory_order_relaxed))
+       << kShift) +
+      m_baseFrac.load(std::memory_order_relaxed) +
+      static_cast<fixed>(Elapsed(delta, m_mult.load(std::memory_order_relaxed),
+                                 m_baseNaturalMult.load(
+                                     std::memory_order_relaxed),
+                                 static_cast<uint64_t>(current)));
+  // NowDefault() truncates, so the midpoint of its microsecond is the best
+  // estimate of the actual time
+  fixed actual = (static_cast<fixed>(s.time) << kShift) +
+                 (fixed{1} << (kShift - 1));
+  fixed error = actual - predicted;
+  double drift = std::ldexp(static_cast<double>(error), -kShift);
+
+  // refine the natural rate over the longest baseline available
+  if (s.cycles > m_anchor.cycles && s.time > m_anchor.time) {
+    m_naturalMult = static_cast<uint64_t>(
+        (static_cast<uint128>(s.time - m_anchor.time) << kShift) /
+        (s.cycles - m_anchor.cycles));
+  }
+
+  uint64_t interval = static_cast<uint64_t>(
+      (static_cast<uint128>(m_resyncUs) << kShift) / m_naturalMult);
+  fixed base = predicted;
+  int64_t mult = m_naturalMult;
+  if (error > (static_cast<fixed>(kMaxSlewUs) << kShift)) {
+    // too far behind to slew; step forward and restart rate estimation
+    base = actual;
+    m_anchor = s;
+    ++m_stats.stepCount;
+  } else {
+    if (s.cycles < m_anchor.cycles) {
+      m_anchor = s;
+    }
+    // correct the error over the next interval, bounded so the slope stays
+    // within 50% of nominal (and thus positive)
+    fixed maxAdjust = static_cast<fixed>(kMaxSlewUs) << kShift;
+    if (error < -maxAdjust) {
+      error = -maxAdjust;
+    }
+    int64_t adjust = static_cast<int64_t>(error / interval);
+    adjust = std::clamp<int64_t>(adjust, -mult / 2, mult / 2);
+    mult += adjust;
+  }
+
+  m_resyncUs = (std::min)(m_resyncUs * 2, kMaxResyncUs);
+  m_stats.frequency = std::ldexp(1e6, kShift) / m_naturalMult;
+  m_stats.lastDrift = drift;
+  m_stats.maxDrift = (std::max)(m_stats.maxDrift, std::abs(drift));
+  ++m_stats.resyncCount;
+
+  Publish(s.cycles, static_cast<uint64_t>(base >> kShift),
+          static_cast<uint64_t>(base & ((fixed{1} << kShift) - 1)),
+          static_cast<uint64_t>(mult), m_naturalMult, interval);
+}
+
+wpi::NowCycleCounterStats CycleClock::GetStats() {
+  std::scoped_lock lock{m_mutex};
+  return m_stats;
+}
+
+static CycleClock& GetCycleClock() {
+  static CycleClock clock;
+  return clock;
+}
+#endif
+
+bool wpi::IsNowCycleCounterAvailable() {
+#ifdef WPI_HAVE_CYCLE_COUNTER
+  return GetCycleClock().IsAvailable();
+#else
+  return false;
+#endif
+}
+
+uint64_t wpi::NowCycleCounter() {
+#ifdef WPI_HAVE_CYCLE_COUNTER
+  auto& clock = GetCycleClock();
+  if (clock.IsAvailable()) {
+    return clock.Now();
+  }
+#endif
+  return NowDefault();
+}
+
+wpi::NowCycleCounterStats wpi::GetNowCycleCounterStats() {
+#ifdef WPI_HAVE_CYCLE_COUNTER
+  auto& clock = GetCycleClock();
+  if (clock.IsAvailable()) {
+    return clock.GetStats();
+  }
+#endif
+  return {};
+}
+
 static std::atomic<uint64_t (*)()> now_impl{wpi::NowDefault};
 
 void wpi::impl::SetupNowDefaultOnRio() {
@@ -330,6 +647,10 @@ uint64_t WPI_Now(void) {
   return wpi::Now();
 }
 
+uint64_t WPI_NowCycleCounter(void) {
+  return wpi::NowCycleCounter();
+}
+
 uint64_t WPI_GetSystemTime(void) {
   return wpi::GetSystemTime();
 }
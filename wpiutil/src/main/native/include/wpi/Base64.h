@@ -18,6 +18,41 @@ template <typename T>
 class SmallVectorImpl;
 class raw_ostream;
 
+/**
+ * Gets the number of characters produced by Base64-encoding the given number
+ * of bytes (including padding).
+ *
+ * @param plainLen number of bytes to encode
+ * @return Number of encoded characters
+ */
+constexpr size_t Base64EncodedSize(size_t plainLen) {
+  return ((plainLen + 2) / 3) * 4;
+}
+
+/**
+ * Gets the maximum number of bytes produced by Base64-decoding the given
+ * number of characters.
+ *
+ * @param encodedLen number of encoded characters
+ * @return Maximum number of decoded bytes
+ */
+constexpr size_t Base64DecodedSize(size_t encodedLen) {
+  return ((encodedLen + 3) / 4) * 3;
+}
+
+/**
+ * Base64-decodes into a caller-provided buffer without allocating. Decoding
+ * stops at the first character not in the Base64 alphabet (e.g. padding).
+ *
+ * @param encoded encoded text
+ * @param num_read number of encoded characters consumed (output)
+ * @param plain output buffer; must be at least
+ *              Base64DecodedSize(encoded.size()) bytes
+ * @return Number of decoded bytes, or 0 if the output buffer is too small
+ */
+size_t Base64Decode(std::string_view encoded, size_t* num_read,
+                    std::span<uint8_t> plain);
+
 size_t Base64Decode(raw_ostream& os, std::string_view encoded);
 
 size_t Base64Decode(std::string_view encoded, std::string* plain);
@@ -30,6 +65,17 @@ size_t Base64Decode(std::string_view encoded, std::vector<uint8_t>* plain);
 std::span<uint8_t> Base64Decode(std::string_view encoded, size_t* num_read,
                                 SmallVectorImpl<uint8_t>& buf);
 
+/**
+ * Base64-encodes into a caller-provided buffer without allocating.
+ *
+ * @param plain data to encode
+ * @param encoded output buffer; must be at least
+ *                Base64EncodedSize(plain.size()) characters
+ * @return Number of encoded characters, or 0 if the output buffer is too
+ *         small
+ */
+size_t Base64Encode(std::span<const uint8_t> plain, std::span<char> encoded);
+
 void Base64Encode(raw_ostream& os, std::string_view plain);
 
 void Base64Encode(std::string_view plain, std::string* encoded);
@@ -0,0 +1,139 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#pragma once
+
+#include <stdint.h>
+
+#include <string_view>
+
+#include "wpi/SmallVector.h"
+#include "wpi/json.h"
+
+namespace wpi {
+
+class raw_ostream;
+
+/**
+ * Streaming JSON writer. Values are written to the output stream as they are
+ * provided, so large documents can be produced without first building a
+ * wpi::json tree. The output is identical to wpi::json::dump() with the same
+ * indent setting.
+ *
+ * Only the state needed to place separators is tracked; callers are
+ * responsible for balancing Start/End calls and for calling Key() before each
+ * value inside an object.
+ */
+class JsonWriter {
+ public:
+  /**
+   * Constructs a writer.
+   *
+   * @param os output stream
+   * @param indent number of spaces per nesting level, or -1 for compact
+   *               output with no whitespace
+   */
+  explicit JsonWriter(raw_ostream& os, int indent = -1);
+
+  JsonWriter(const JsonWriter&) = delete;
+  JsonWriter& operator=(const JsonWriter&) = delete;
+
+  /**
+   * Starts an object. Must be balanced by a call to EndObject().
+   */
+  void StartObject();
+
+  /**
+   * Ends the current object.
+   */
+  void EndObject();
+
+  /**
+   * Starts an array. Must be balanced by a call to EndArray().
+   */
+  void StartArray();
+
+  /**
+   * Ends the current array.
+   */
+  void EndArray();
+
+  /**
+   * Writes an object key. Must be followed by exactly one value (which may
+   * be an object or array).
+   *
+   * @param key key
+   */
+  void Key(std::string_view key);
+
+  /**
+   * Writes a null value.
+   */
+  void Null();
+
+  /**
+   * Writes a boolean value.
+   *
+   * @param value value
+   */
+  void Boolean(bool value);
+
+  /**
+   * Writes a signed integer value.
+   *
+   * @param value value
+   */
+  void Integer(int64_t value);
+
+  /**
+   * Writes an unsigned integer value.
+   *
+   * @param value value
+   */
+  void Unsigned(uint64_t value);
+
+  /**
+   * Writes a floating point value. Non-finite values are written as null.
+   *
+   * @param value value
+   */
+  void Double(double value);
+
+  /**
+   * Writes a string value.
+   *
+   * @param value value (UTF-8)
+   */
+  void String(std::string_view value);
+
+  /**
+   * Writes a wpi::json value (of any type) at the current position.
+   *
+   * @param value value
+   */
+  void Value(const json& value);
+
+  /**
+   * Gets the output stream.
+   *
+   * @return Output stream
+   */
+  raw_ostream& GetStream() { return m_os; }
+
+ private:
+  struct Level {
+    bool first;
+  };
+
+  void BeginValue();
+  void NextElement(Level& level);
+
+  raw_ostream& m_os;
+  json::serializer m_serializer;
+  int m_indent;
+  bool m_afterKey = false;
+  SmallVector<Level, 16> m_stack;
+};
+
+}  // namespace wpi
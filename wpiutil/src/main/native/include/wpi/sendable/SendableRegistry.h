@@ -6,6 +6,7 @@
 
 #include <functional>
 #include <memory>
+#include <span>
 #include <string>
 #include <string_view>
 
@@ -296,6 +297,15 @@ class SendableRegistry final {
    */
   static void Update(UID sendableUid);
 
+  /**
+   * Updates published information from multiple objects.  This is equivalent
+   * to calling Update(UID) for each element, but only acquires the registry
+   * lock once.
+   *
+   * @param sendableUids sendable unique ids
+   */
+  static void Update(std::span<const UID> sendableUids);
+
   /**
    * Data passed to ForeachLiveWindow() callback function
    */
@@ -22,6 +22,7 @@
 
 #include <stdint.h>
 
+#include <span>
 #include <string>
 #include <string_view>
 
@@ -34,6 +35,7 @@ class SHA1 {
  public:
   SHA1();
   void Update(std::string_view s);
+  void Update(std::span<const uint8_t> data);
   void Update(raw_istream& is);
   std::string Final();
   std::string_view Final(SmallVectorImpl<char>& buf);
@@ -44,6 +44,14 @@ void WPI_SetNowImpl(uint64_t (*func)(void));
  */
 uint64_t WPI_Now(void);
 
+/**
+ * A Now() implementation that reads the CPU cycle counter (TSC on x86-64,
+ * CNTVCT_EL0 on ARM64) and converts it to the time base of WPI_NowDefault().
+ * Falls back to WPI_NowDefault() if no usable counter is available.
+ * @return Time in microseconds.
+ */
+uint64_t WPI_NowCycleCounter(void);
+
 /**
  * Return the current system time in microseconds since the Unix epoch
  * (January 1st, 1970 00:00 UTC).
@@ -116,6 +124,62 @@ void SetNowImpl(uint64_t (*func)());
  */
 uint64_t Now();
 
+/**
+ * Statistics for the cycle counter Now() implementation.
+ */
+struct NowCycleCounterStats {
+  /** Estimated cycle counter frequency, in Hz. */
+  double frequency = 0;
+
+  /** Number of times the counter has been resynchronized. */
+  uint64_t resyncCount = 0;
+
+  /**
+   * Number of times time was stepped forward because the counter fell too
+   * far behind NowDefault() to be slewed.
+   */
+  uint64_t stepCount = 0;
+
+  /**
+   * Difference between NowDefault() and the counter time at the most recent
+   * resync, in microseconds. Positive values mean the counter was behind.
+   */
+  double lastDrift = 0;
+
+  /** Largest absolute drift seen at any resync, in microseconds. */
+  double maxDrift = 0;
+};
+
+/**
+ * Returns whether a CPU cycle counter usable by NowCycleCounter() is
+ * available. Currently this requires Linux on x86-64 with an invariant TSC,
+ * or Linux on ARM64.
+ *
+ * The first call calibrates the counter, which may take several
+ * milliseconds.
+ *
+ * @return True if NowCycleCounter() reads the cycle counter
+ */
+bool IsNowCycleCounterAvailable();
+
+/**
+ * A Now() implementation that reads the CPU cycle counter instead of making
+ * a system call. It is calibrated against NowDefault() on first use and
+ * periodically resynchronized while in use; drift is corrected by slewing
+ * so that time never goes backwards. Falls back to NowDefault() if no usable
+ * counter is available. To use it, call SetNowImpl(NowCycleCounter).
+ *
+ * @return Time in microseconds, in the same time base as NowDefault().
+ */
+uint64_t NowCycleCounter();
+
+/**
+ * Gets calibration and drift statistics for NowCycleCounter().
+ *
+ * @return Statistics; all zero if the cycle counter is not available
+ */
+NowCycleCounterStats GetNowCycleCounterStats();
+
 /**
  * Return the current system time in microseconds since the Unix epoch
  * (January 1st, 1970 00:00 UTC).
@@ -26,6 +26,8 @@
 #include <wpi/detail/iterators/iterator_traits.h>
 #include <wpi/detail/macro_scope.h>
 
+#include <wpi/raw_istream.h>
+
 WPI_JSON_NAMESPACE_BEGIN
 namespace detail
 {
@@ -133,6 +135,65 @@ class input_stream_adapter
 };
 #endif  // JSON_NO_IO
 
+/*!
+Input adapter for a wpi::raw_istream. Whatever the stream already has
+available is read in blocks into an internal buffer, so the lexer doesn't pay
+for a virtual call per character and the input never needs to be fully
+materialized in memory. Otherwise only a single character is requested, so
+parsing a socket stream never waits for more data than the value needs.
+Bytes read past the end of the value stay in the adapter's buffer and are
+lost to the stream, so data following the value can't be read from it
+afterwards.
+*/
+class raw_istream_adapter
+{
+  public:
+    using char_type = char;
+
+    explicit raw_istream_adapter(raw_istream& i)
+        : is(&i), buf(std::make_unique<char[]>(buf_size))
+    {}
+
+    // delete because of pointer members
+    raw_istream_adapter(const raw_istream_adapter&) = delete;
+    raw_istream_adapter& operator=(raw_istream_adapter&) = delete;
+    raw_istream_adapter& operator=(raw_istream_adapter&&) = delete;
+
+    raw_istream_adapter(raw_istream_adapter&& rhs) noexcept
+        : is(rhs.is), buf(std::move(rhs.buf)), cur(rhs.cur), end(rhs.end)
+    {
+        rhs.is = nullptr;
+    }
+
+    std::char_traits<char>::int_type get_character()
+    {
+        if (JSON_HEDLEY_UNLIKELY(cur == end))
+        {
+            cur = 0;
+            end = is->readsome(buf.get(), buf_size);
+            if (end == 0)
+            {
+                is->read(buf.get(), 1);
+                end = is->read_count();
+            }
+            if (end == 0)
+            {
+                return std::char_traits<char>::eof();
+            }
+        }
+        return std::char_traits<char>::to_int_type(buf[cur++]);
+    }
+
+  private:
+    static constexpr std::size_t buf_size = 4096;
+
+    /// the associated input stream
+    raw_istream* is = nullptr;
+    std::unique_ptr<char[]> buf;
+    std::size_t cur = 0;
+    std::size_t end = 0;
+};
+
 // General-purpose iterator-based adapter. It might not be as fast as
 // theoretically possible for some containers, but it is extremely versatile.
 template<typename IteratorType>
@@ -436,6 +497,16 @@ inline input_stream_adapter input_adapter(std::istream&& stream)
 }
 #endif  // JSON_NO_IO
 
+inline raw_istream_adapter input_adapter(raw_istream& stream)
+{
+    return raw_istream_adapter(stream);
+}
+
+inline raw_istream_adapter input_adapter(raw_istream&& stream)
+{
+    return raw_istream_adapter(stream);
+}
+
 using contiguous_bytes_input_adapter = decltype(input_adapter(std::declval<const char*>(), std::declval<const char*>()));
 
 // Null-delimited strings, and the like.
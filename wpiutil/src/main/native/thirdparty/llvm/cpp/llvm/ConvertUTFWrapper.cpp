@@ -15,8 +15,84 @@
 #include <string_view>
 #include <vector>
 
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include <emmintrin.h>
+#define CONVERTUTF_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define CONVERTUTF_NEON 1
+#endif
+
 namespace wpi {
 
+/**
+ * Copies the leading run of ASCII code units from UTF-16 to UTF-8, 8 code
+ * units at a time where SIMD is available.  Most strings are entirely ASCII,
+ * so this usually leaves nothing for the general conversion.
+ * \returns the number of code units copied.
+ */
+static size_t convertASCIIPrefix(const UTF16 *Src, const UTF16 *SrcEnd,
+                                 UTF8 *Dst) {
+  size_t Len = SrcEnd - Src;
+  size_t I = 0;
+#if defined(CONVERTUTF_SSE2)
+  const __m128i NonASCII = _mm_set1_epi16(static_cast<short>(0xFF80));
+  for (; Len - I >= 8; I += 8) {
+    __m128i V = _mm_loadu_si128(reinterpret_cast<const __m128i *>(Src + I));
+    if (_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(V, NonASCII),
+                                          _mm_setzero_si128())) != 0xFFFF)
+      break;
+    _mm_storel_epi64(reinterpret_cast<__m128i *>(Dst + I),
+                     _mm_packus_epi16(V, V));
+  }
+#elif defined(CONVERTUTF_NEON)
+  for (; Len - I >= 8; I += 8) {
+    uint16x8_t V = vld1q_u16(Src + I);
+    uint16x4_t Any = vorr_u16(vget_low_u16(V), vget_high_u16(V));
+    if (vget_lane_u64(vreinterpret_u64_u16(Any), 0) & 0xFF80FF80FF80FF80ULL)
+      break;
+    vst1_u8(Dst + I, vmovn_u16(V));
+  }
+#endif
+  for (; I < Len && Src[I] < 0x80; ++I)
+    Dst[I] = static_cast<UTF8>(Src[I]);
+  return I;
+}
+
+/**
+ * Copies the leading run of ASCII code units from UTF-8 to UTF-16, 16 code
+ * units at a time where SIMD is available.
+ * \returns the number of code units copied.
+ */
+static size_t convertASCIIPrefix(const UTF8 *Src, const UTF8 *SrcEnd,
+                                 UTF16 *Dst) {
+  size_t Len = SrcEnd - Src;
+  size_t I = 0;
+#if defined(CONVERTUTF_SSE2)
+  for (; Len - I >= 16; I += 16) {
+    __m128i V = _mm_loadu_si128(reinterpret_cast<const __m128i *>(Src + I));
+    if (_mm_movemask_epi8(V) != 0)
+      break;
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(Dst + I),
+                     _mm_unpacklo_epi8(V, _mm_setzero_si128()));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(Dst + I + 8),
+                     _mm_unpackhi_epi8(V, _mm_setzero_si128()));
+  }
+#elif defined(CONVERTUTF_NEON)
+  for (; Len - I >= 16; I += 16) {
+    uint8x16_t V = vld1q_u8(Src + I);
+    uint8x8_t Any = vorr_u8(vget_low_u8(V), vget_high_u8(V));
+    if (vget_lane_u64(vreinterpret_u64_u8(Any), 0) & 0x8080808080808080ULL)
+      break;
+    vst1q_u16(Dst + I, vmovl_u8(vget_low_u8(V)));
+    vst1q_u16(Dst + I + 8, vmovl_u8(vget_high_u8(V)));
+  }
+#endif
+  for (; I < Len && Src[I] < 0x80; ++I)
+    Dst[I] = Src[I];
+  return I;
+}
+
 bool ConvertUTF8toWide(unsigned WideCharWidth, std::string_view Source,
                        char *&ResultPtr, const UTF8 *&ErrorPtr) {
   assert(WideCharWidth == 1 || WideCharWidth == 2 || WideCharWidth == 4);
@@ -114,10 +190,14 @@ bool convertUTF16ToUTF8String(std::span<const char> SrcBytes, SmallVectorImpl<ch
 
   // Just allocate enough space up front.  We'll shrink it later.  Allocate
   // enough that we can fit a null terminator without reallocating.
-  Out.resize(SrcBytes.size() * UNI_MAX_UTF8_BYTES_PER_CODE_POINT + 1);
+  Out.resize_for_overwrite(SrcBytes.size() * UNI_MAX_UTF8_BYTES_PER_CODE_POINT + 1);
   UTF8 *Dst = reinterpret_cast<UTF8 *>(&Out[0]);
   UTF8 *DstEnd = Dst + Out.size();
 
+  size_t ASCIILen = convertASCIIPrefix(Src, SrcEnd, Dst);
+  Src += ASCIILen;
+  Dst += ASCIILen;
+
   ConversionResult CR =
       ConvertUTF16toUTF8(&Src, SrcEnd, &Dst, DstEnd, strictConversion);
   assert(CR != targetExhausted);
@@ -217,10 +297,14 @@ bool convertUTF8ToUTF16String(std::string_view SrcUTF8,
   // UTF-8 encoding.  Allocate one extra byte for the null terminator though,
   // so that someone calling DstUTF16.data() gets a null terminated string.
   // We resize down later so we don't have to worry that this over allocates.
-  DstUTF16.resize(SrcUTF8.size()+1);
+  DstUTF16.resize_for_overwrite(SrcUTF8.size()+1);
   UTF16 *Dst = &DstUTF16[0];
   UTF16 *DstEnd = Dst + DstUTF16.size();
 
+  size_t ASCIILen = convertASCIIPrefix(Src, SrcEnd, Dst);
+  Src += ASCIILen;
+  Dst += ASCIILen;
+
   ConversionResult CR =
       ConvertUTF8toUTF16(&Src, SrcEnd, &Dst, DstEnd, strictConversion);
   assert(CR != targetExhausted);
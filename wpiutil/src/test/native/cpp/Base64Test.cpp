@@ -2,6 +2,10 @@
 // Open Source Software; you can modify and/or share it under the terms of
 // the WPILib BSD license file in the root directory of this project.
 
+#include <algorithm>
+#include <string>
+#include <vector>
+
 #include <gtest/gtest.h>
 
 #include "wpi/Base64.h"
@@ -84,6 +88,28 @@ static Base64TestParam sample[] = {
      "mQgc28gb24uLi4K"},
 };
 
+TEST_P(Base64Test, EncodeSpan) {
+  std::string_view plain = GetPlain();
+  std::string_view expected = GetParam().encoded;
+  char buf[128];
+  ASSERT_EQ(expected.size(), Base64EncodedSize(plain.size()));
+  size_t len = Base64Encode(
+      std::span<const uint8_t>{reinterpret_cast<const uint8_t*>(plain.data()),
+                               plain.size()},
+      std::span<char>{buf});
+  ASSERT_EQ(expected, std::string_view(buf, len));
+}
+
+TEST_P(Base64Test, DecodeSpan) {
+  std::string_view encoded = GetParam().encoded;
+  uint8_t buf[128];
+  size_t num_read;
+  size_t len = Base64Decode(encoded, &num_read, std::span<uint8_t>{buf});
+  EXPECT_EQ(encoded.size(), num_read);
+  ASSERT_EQ(GetPlain(),
+            std::string_view(reinterpret_cast<const char*>(buf), len));
+}
+
 INSTANTIATE_TEST_SUITE_P(Base64SampleTests, Base64Test,
                          ::testing::ValuesIn(sample));
 
@@ -101,4 +127,80 @@ static Base64TestParam standard[] = {
 INSTANTIATE_TEST_SUITE_P(Base64StandardTests, Base64Test,
                          ::testing::ValuesIn(standard));
 
+static std::vector<uint8_t> MakeBuffer(size_t len) {
+  std::vector<uint8_t> buf(len);
+  uint32_t x = 12345;
+  for (auto&& b : buf) {
+    x = x * 1103515245 + 12345;
+    b = x >> 24;
+  }
+  return buf;
+}
+
+TEST(Base64LongTest, RoundTrip) {
+  // Cover every tail length around the vector block sizes
+  for (size_t len = 0; len < 300; ++len) {
+    auto plain = MakeBuffer(len);
+    std::string encoded;
+    Base64Encode(plain, &encoded);
+    ASSERT_EQ(Base64EncodedSize(len), encoded.size());
+
+    std::vector<uint8_t> decoded;
+    EXPECT_EQ(encoded.size(), Base64Decode(encoded, &decoded));
+    ASSERT_EQ(plain, decoded) << "len " << len;
+  }
+}
+
+TEST(Base64LongTest, MatchesShortEncodes) {
+  // Encoding 3 bytes at a time only uses the scalar code
+  auto plain = MakeBuffer(3 * 1000);
+  std::string encoded;
+  Base64Encode(plain, &encoded);
+  for (size_t i = 0; i < plain.size(); i += 3) {
+    std::string piece;
+    Base64Encode(std::span<const uint8_t>{plain}.subspan(i, 3), &piece);
+    ASSERT_EQ(piece, encoded.substr(i / 3 * 4, 4)) << "offset " << i;
+  }
+}
+
+TEST(Base64LongTest, AllCharacters) {
+  std::string encoded;
+  for (int i = 0; i < 16; ++i) {
+    encoded +=
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  }
+  std::vector<uint8_t> decoded;
+  EXPECT_EQ(encoded.size(), Base64Decode(encoded, &decoded));
+  std::string reencoded;
+  Base64Encode(decoded, &reencoded);
+  ASSERT_EQ(encoded, reencoded);
+}
+
+TEST(Base64LongTest, StopsAtInvalid) {
+  auto plain = MakeBuffer(600);
+  std::string encoded;
+  Base64Encode(plain, &encoded);
+  // Terminate the input at each position of a long string
+  for (size_t pos = 0; pos < encoded.size(); pos += 7) {
+    std::string truncated = encoded;
+    truncated[pos] = '.';
+    SmallVector<uint8_t, 64> buf;
+    size_t num_read;
+    auto decoded = Base64Decode(truncated, &num_read, buf);
+    EXPECT_EQ((pos + 3) / 4 * 4, num_read) << "pos " << pos;
+    ASSERT_EQ(pos * 3 / 4, decoded.size()) << "pos " << pos;
+    ASSERT_TRUE(std::equal(decoded.begin(), decoded.end(), plain.begin()));
+  }
+}
+
+TEST(Base64LongTest, BufferTooSmall) {
+  auto plain = MakeBuffer(30);
+  char encoded[39];
+  EXPECT_EQ(0u, Base64Encode(plain, std::span<char>{encoded}));
+  uint8_t decoded[29];
+  size_t num_read;
+  EXPECT_EQ(0u, Base64Decode("AAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAA",
+                             &num_read, std::span<uint8_t>{decoded}));
+}
+
 }  // namespace wpi
@@ -0,0 +1,134 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "wpi/json.h"
+#include "wpi/raw_istream.h"
+
+namespace {
+
+// Collects a flat list of the number values in a document, as a typed loader
+// would, without building a DOM.
+class NumberCollector : public wpi::json::json_sax_t {
+ public:
+  std::vector<double> numbers;
+  std::vector<std::string> keys;
+  int depth = 0;
+
+  bool null() override { return true; }
+  bool boolean(bool) override { return true; }
+  bool number_integer(number_integer_t val) override {
+    numbers.push_back(val);
+    return true;
+  }
+  bool number_unsigned(number_unsigned_t val) override {
+    numbers.push_back(val);
+    return true;
+  }
+  bool number_float(number_float_t val, const string_t&) override {
+    numbers.push_back(val);
+    return true;
+  }
+  bool string(string_t&) override { return true; }
+  bool binary(binary_t&) override { return true; }
+  bool start_object(std::size_t) override {
+    ++depth;
+    return true;
+  }
+  bool key(string_t& val) override {
+    keys.emplace_back(val);
+    return true;
+  }
+  bool end_object() override {
+    --depth;
+    return true;
+  }
+  bool start_array(std::size_t) override {
+    ++depth;
+    return true;
+  }
+  bool end_array() override {
+    --depth;
+    return true;
+  }
+  bool parse_error(std::size_t, const std::string&,
+                   const wpi::detail::exception&) override {
+    return false;
+  }
+};
+
+std::string MakeLargeDocument() {
+  // Larger than the adapter's internal buffer so refills are exercised
+  wpi::json j = wpi::json::array();
+  for (int i = 0; i < 2000; ++i) {
+    j.push_back({{"id", i}, {"x", i * 0.5}, {"name", "tag"}});
+  }
+  return j.dump();
+}
+
+// Like a socket stream: never reports buffered data, and fails the test if
+// asked for more than one character, as that read could block.
+class UnbufferedIstream : public wpi::raw_istream {
+ public:
+  explicit UnbufferedIstream(std::string_view text) : m_text{text} {}
+
+  void close() override {}
+  size_t in_avail() const override { return 0; }
+
+ private:
+  void read_impl(void* data, size_t len) override {
+    EXPECT_EQ(1u, len);
+    if (m_pos >= m_text.size()) {
+      error_detected();
+      set_read_count(0);
+      return;
+    }
+    static_cast<char*>(data)[0] = m_text[m_pos++];
+    set_read_count(1);
+  }
+
+  std::string_view m_text;
+  size_t m_pos = 0;
+};
+
+}  // namespace
+
+TEST(JsonRawIstreamTest, Parse) {
+  std::string text = MakeLargeDocument();
+  wpi::raw_mem_istream is{text.data(), text.size()};
+  wpi::json j = wpi::json::parse(is);
+  EXPECT_EQ(wpi::json::parse(text), j);
+}
+
+TEST(JsonRawIstreamTest, SaxParse) {
+  std::string text = MakeLargeDocument();
+  wpi::raw_mem_istream is{text.data(), text.size()};
+  NumberCollector sax;
+  ASSERT_TRUE(wpi::json::sax_parse(is, &sax));
+  EXPECT_EQ(0, sax.depth);
+  ASSERT_EQ(4000u, sax.numbers.size());
+  EXPECT_EQ(1999, sax.numbers[3998]);
+  EXPECT_EQ(999.5, sax.numbers[3999]);
+  EXPECT_EQ(6000u, sax.keys.size());
+}
+
+TEST(JsonRawIstreamTest, ParseError) {
+  std::string text = "[1, 2";
+  wpi::raw_mem_istream is{text.data(), text.size()};
+  NumberCollector sax;
+  EXPECT_FALSE(wpi::json::sax_parse(is, &sax));
+  wpi::raw_mem_istream is2{text.data(), text.size()};
+  EXPECT_THROW(wpi::json::parse(is2), wpi::json::parse_error);
+}
+
+TEST(JsonRawIstreamTest, ParseUnbuffered) {
+  UnbufferedIstream is{"{\"a\": [1, 2.5]}"};
+  wpi::json j = wpi::json::parse(is);
+  EXPECT_EQ(wpi::json::parse("{\"a\": [1, 2.5]}"), j);
+}
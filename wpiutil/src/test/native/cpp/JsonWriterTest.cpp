@@ -0,0 +1,136 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include "wpi/JsonWriter.h"  // NOLINT(build/include_order)
+
+#include <cmath>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "wpi/json.h"
+#include "wpi/raw_ostream.h"
+
+namespace {
+
+wpi::json MakeDocument() {
+  return {{"name", "a\"b\n\xc3\xa9"},
+          {"id", 5},
+          {"big", UINT64_C(18446744073709551615)},
+          {"neg", -3},
+          {"pi", 3.25},
+          {"flag", true},
+          {"none", nullptr},
+          {"list", {1, 2.5, "three", false}},
+          {"empty_list", wpi::json::array()},
+          {"empty_obj", wpi::json::object()},
+          {"nested", {{"x", {{"y", {1, {{"z", 0}}}}}}}}};
+}
+
+// Keys are written in sorted order to match wpi::json object ordering
+void WriteDocument(wpi::JsonWriter& w) {
+  w.StartObject();
+  w.Key("big");
+  w.Unsigned(UINT64_C(18446744073709551615));
+  w.Key("empty_list");
+  w.StartArray();
+  w.EndArray();
+  w.Key("empty_obj");
+  w.StartObject();
+  w.EndObject();
+  w.Key("flag");
+  w.Boolean(true);
+  w.Key("id");
+  w.Integer(5);
+  w.Key("list");
+  w.StartArray();
+  w.Integer(1);
+  w.Double(2.5);
+  w.String("three");
+  w.Boolean(false);
+  w.EndArray();
+  w.Key("name");
+  w.String("a\"b\n\xc3\xa9");
+  w.Key("neg");
+  w.Integer(-3);
+  w.Key("nested");
+  w.StartObject();
+  w.Key("x");
+  w.StartObject();
+  w.Key("y");
+  w.StartArray();
+  w.Integer(1);
+  w.StartObject();
+  w.Key("z");
+  w.Integer(0);
+  w.EndObject();
+  w.EndArray();
+  w.EndObject();
+  w.EndObject();
+  w.Key("none");
+  w.Null();
+  w.Key("pi");
+  w.Double(3.25);
+  w.EndObject();
+}
+
+}  // namespace
+
+TEST(JsonWriterTest, Compact) {
+  std::string out;
+  wpi::raw_string_ostream os{out};
+  wpi::JsonWriter w{os};
+  WriteDocument(w);
+  os.flush();
+  EXPECT_EQ(MakeDocument().dump(), out);
+}
+
+TEST(JsonWriterTest, Pretty) {
+  std::string out;
+  wpi::raw_string_ostream os{out};
+  wpi::JsonWriter w{os, 4};
+  WriteDocument(w);
+  os.flush();
+  EXPECT_EQ(MakeDocument().dump(4), out);
+}
+
+TEST(JsonWriterTest, EmbeddedValue) {
+  wpi::json doc = MakeDocument();
+  for (int indent : {-1, 2}) {
+    std::string out;
+    wpi::raw_string_ostream os{out};
+    wpi::JsonWriter w{os, indent};
+    w.StartArray();
+    w.Value(doc);
+    w.StartObject();
+    w.Key("doc");
+    w.Value(doc);
+    w.EndObject();
+    w.EndArray();
+    os.flush();
+    wpi::json expected = {doc, {{"doc", doc}}};
+    EXPECT_EQ(expected.dump(indent), out);
+  }
+}
+
+TEST(JsonWriterTest, NonFinite) {
+  std::string out;
+  wpi::raw_string_ostream os{out};
+  wpi::JsonWriter w{os};
+  w.StartArray();
+  w.Double(NAN);
+  w.Double(INFINITY);
+  w.EndArray();
+  os.flush();
+  EXPECT_EQ("[null,null]", out);
+}
+
+TEST(JsonWriterTest, TopLevelScalar) {
+  std::string out;
+  wpi::raw_string_ostream os{out};
+  wpi::JsonWriter w{os, 2};
+  w.String("x");
+  os.flush();
+  EXPECT_EQ("\"x\"", out);
+}
@@ -0,0 +1,82 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include "wpi/timestamp.h"  // NOLINT(build/include_order)
+
+#include <stdint.h>
+
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+TEST(TimestampTest, CycleCounterFallback) {
+  if (wpi::IsNowCycleCounterAvailable()) {
+    GTEST_SKIP() << "cycle counter available";
+  }
+  auto stats = wpi::GetNowCycleCounterStats();
+  EXPECT_EQ(stats.frequency, 0);
+  uint64_t before = wpi::NowDefault();
+  uint64_t now = wpi::NowCycleCounter();
+  EXPECT_GE(now, before);
+  EXPECT_LE(now, wpi::NowDefault());
+}
+
+TEST(TimestampTest, CycleCounterTracksDefault) {
+  if (!wpi::IsNowCycleCounterAvailable()) {
+    GTEST_SKIP() << "no cycle counter";
+  }
+  EXPECT_GT(wpi::GetNowCycleCounterStats().frequency, 0);
+
+  // run across several resyncs
+  auto start = wpi::NowDefault();
+  uint64_t prev = wpi::NowCycleCounter();
+  while (wpi::NowDefault() - start < 300000) {
+    uint64_t before = wpi::NowDefault();
+    uint64_t now = wpi::NowCycleCounter();
+    uint64_t after = wpi::NowDefault();
+    ASSERT_GE(now, prev);
+    // generous bounds to tolerate preemption between calls
+    EXPECT_LE(before, now + 2000);
+    EXPECT_LE(now, after + 2000);
+    prev = now;
+    std::this_thread::sleep_for(std::chrono::microseconds(100));
+  }
+
+  auto stats = wpi::GetNowCycleCounterStats();
+  EXPECT_GT(stats.resyncCount, 0u);
+  EXPECT_GE(stats.maxDrift, std::abs(stats.lastDrift));
+}
+
+TEST(TimestampTest, CycleCounterTracksDefaultAfterIdle) {
+  if (!wpi::IsNowCycleCounterAvailable()) {
+    GTEST_SKIP() << "no cycle counter";
+  }
+  // resync with a slope correction, then idle for longer than the maximum
+  // resync interval; the correction must not keep being applied
+  auto start = wpi::NowDefault();
+  while (wpi::NowDefault() - start < 100000) {
+    wpi::NowCycleCounter();
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  uint64_t prev = wpi::NowCycleCounter();
+  std::this_thread::sleep_for(std::chrono::milliseconds(2500));
+  uint64_t before = wpi::NowDefault();
+  uint64_t now = wpi::NowCycleCounter();
+  uint64_t after = wpi::NowDefault();
+  EXPECT_GE(now, prev);
+  EXPECT_LE(before, now + 2000);
+  EXPECT_LE(now, after + 2000);
+}
+
+TEST(TimestampTest, CycleCounterAsNowImpl) {
+  wpi::SetNowImpl(wpi::NowCycleCounter);
+  uint64_t a = wpi::Now();
+  uint64_t b = wpi::Now();
+  wpi::SetNowImpl(nullptr);
+  EXPECT_LE(a, b);
+  uint64_t c = wpi::Now();
+  EXPECT_LE(b, c + 2000);
+}
@@ -88,6 +88,40 @@ TEST(ConvertUTFTest, Empty) {
   EXPECT_TRUE(std::string{Result}.empty());
 }
 
+TEST(ConvertUTFTest, ASCIIPrefix) {
+  // Lengths around the SIMD block sizes, with a non-ASCII character at each
+  // position (or none).  U+0100 has a non-zero high byte but a clear low
+  // byte top bit, so it checks that the whole code unit is tested.
+  for (size_t Len : {15, 16, 17, 31, 32, 33}) {
+    for (size_t Pos = 0; Pos <= Len; ++Pos) {
+      std::vector<UTF16> Wide;
+      std::string Narrow;
+      for (size_t I = 0; I < Len; ++I) {
+        if (I != Pos) {
+          Wide.push_back('a' + I % 26);
+          Narrow.push_back('a' + I % 26);
+        } else if (Pos % 2 == 0) {
+          Wide.push_back(0x00E9);
+          Narrow += "\xc3\xa9";
+        } else {
+          Wide.push_back(0x0100);
+          Narrow += "\xc4\x80";
+        }
+      }
+
+      SmallString<64> Result;
+      EXPECT_TRUE(convertUTF16ToUTF8String(std::span<const UTF16>(Wide),
+                                           Result));
+      EXPECT_EQ(Narrow, std::string{Result}) << Len << ' ' << Pos;
+
+      SmallVector<UTF16, 64> WideResult;
+      EXPECT_TRUE(convertUTF8ToUTF16String(Narrow, WideResult));
+      EXPECT_EQ(Wide, std::vector<UTF16>(WideResult.begin(), WideResult.end()))
+          << Len << ' ' << Pos;
+    }
+  }
+}
+
 TEST(ConvertUTFTest, HasUTF16BOM) {
   bool HasBOM = hasUTF16ByteOrderMark("\xff\xfe");
   EXPECT_TRUE(HasBOM);
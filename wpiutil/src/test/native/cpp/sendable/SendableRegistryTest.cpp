@@ -0,0 +1,89 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include "wpi/sendable/SendableRegistry.h"  // NOLINT(build/include_order)
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <fmt/format.h>
+#include <gtest/gtest.h>
+
+#include "wpi/sendable/Sendable.h"
+
+namespace wpi::impl {
+void ResetSendableRegistry();
+}  // namespace wpi::impl
+
+namespace {
+class TestSendable : public wpi::Sendable {
+ public:
+  void InitSendable(wpi::SendableBuilder& builder) override {}
+};
+
+class SendableRegistryTest : public ::testing::Test {
+ protected:
+  void SetUp() override { wpi::impl::ResetSendableRegistry(); }
+  void TearDown() override { wpi::impl::ResetSendableRegistry(); }
+};
+}  // namespace
+
+TEST_F(SendableRegistryTest, AddRemove) {
+  TestSendable sendable;
+  wpi::SendableRegistry::Add(&sendable, "Sub", "Name");
+  EXPECT_TRUE(wpi::SendableRegistry::Contains(&sendable));
+  EXPECT_EQ(wpi::SendableRegistry::GetName(&sendable), "Name");
+  EXPECT_EQ(wpi::SendableRegistry::GetSubsystem(&sendable), "Sub");
+  EXPECT_TRUE(wpi::SendableRegistry::Remove(&sendable));
+  EXPECT_FALSE(wpi::SendableRegistry::Contains(&sendable));
+  EXPECT_FALSE(wpi::SendableRegistry::Remove(&sendable));
+}
+
+TEST_F(SendableRegistryTest, ManyComponents) {
+  // exceed a single pool block and churn through removals so freed nodes
+  // are reused
+  std::vector<std::unique_ptr<TestSendable>> sendables;
+  for (int i = 0; i < 300; ++i) {
+    sendables.emplace_back(std::make_unique<TestSendable>());
+    wpi::SendableRegistry::Add(sendables.back().get(), "Module", i);
+  }
+  for (int i = 0; i < 300; i += 2) {
+    EXPECT_TRUE(wpi::SendableRegistry::Remove(sendables[i].get()));
+  }
+  for (int i = 0; i < 300; i += 2) {
+    wpi::SendableRegistry::Add(sendables[i].get(), "Other", i);
+  }
+  for (int i = 0; i < 300; ++i) {
+    EXPECT_EQ(wpi::SendableRegistry::GetName(sendables[i].get()),
+              fmt::format("{}[{}]", i % 2 == 0 ? "Other" : "Module", i));
+  }
+}
+
+TEST_F(SendableRegistryTest, UniqueId) {
+  TestSendable a;
+  TestSendable b;
+  auto uidA = wpi::SendableRegistry::GetUniqueId(&a);
+  auto uidB = wpi::SendableRegistry::GetUniqueId(&b);
+  EXPECT_NE(uidA, uidB);
+  EXPECT_EQ(wpi::SendableRegistry::GetUniqueId(&a), uidA);
+  EXPECT_EQ(wpi::SendableRegistry::GetSendable(uidA), &a);
+  EXPECT_EQ(wpi::SendableRegistry::GetSendable(uidB), &b);
+  EXPECT_EQ(wpi::SendableRegistry::GetSendable(0), nullptr);
+
+  // components without a builder are skipped
+  wpi::SendableRegistry::UID uids[] = {0, uidA, uidB, 1000};
+  wpi::SendableRegistry::Update(uids);
+}
+
+TEST_F(SendableRegistryTest, Move) {
+  TestSendable from;
+  TestSendable to;
+  TestSendable child;
+  wpi::SendableRegistry::Add(&from, "Name");
+  wpi::SendableRegistry::AddChild(&from, &child);
+  wpi::SendableRegistry::Move(&to, &from);
+  EXPECT_FALSE(wpi::SendableRegistry::Contains(&from));
+  EXPECT_EQ(wpi::SendableRegistry::GetName(&to), "Name");
+}
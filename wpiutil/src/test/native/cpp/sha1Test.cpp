@@ -19,6 +19,7 @@
         -- Volker Grabsch <vog@notjusthosting.com>
 */
 
+#include <span>
 #include <string>
 
 #include <gtest/gtest.h>
@@ -56,6 +57,24 @@ TEST(SHA1Test, Standard3) {
   ASSERT_EQ(checksum.Final(), "34aa973cd4c4daa4f61eeb2bdbad27316534016f");
 }
 
+TEST(SHA1Test, Standard3SingleUpdate) {
+  SHA1 checksum;
+  checksum.Update(std::string(1000000, 'a'));
+  ASSERT_EQ(checksum.Final(), "34aa973cd4c4daa4f61eeb2bdbad27316534016f");
+}
+
+TEST(SHA1Test, Standard3OddChunks) {
+  // Chunks that straddle block boundaries exercise the partial buffer
+  SHA1 checksum;
+  std::string chunk(97, 'a');
+  for (int i = 0; i < 1000000 / 97; ++i) {
+    checksum.Update(std::span<const uint8_t>{
+        reinterpret_cast<const uint8_t*>(chunk.data()), chunk.size()});
+  }
+  checksum.Update(std::string(1000000 % 97, 'a'));
+  ASSERT_EQ(checksum.Final(), "34aa973cd4c4daa4f61eeb2bdbad27316534016f");
+}
+
 /*
  * Other tests
  */